@@ -119,5 +119,28 @@ Catalog::initialize()
   initializeAdapters();
 }
 
+void
+Catalog::shutdown()
+{
+  if (m_adapters.empty()) {
+    m_face->getIoService().stop();
+    return;
+  }
+
+  // the face stops once the last adapter is done
+  std::shared_ptr<size_t> nRunning = std::make_shared<size_t>(m_adapters.size());
+  std::shared_ptr<ndn::Face> face = m_face;
+  for (auto i = m_adapters.begin();
+       i != m_adapters.end();
+       ++i)
+  {
+    (*i)->shutdown([nRunning, face] {
+        if (--*nRunning == 0) {
+          face->getIoService().stop();
+        }
+      });
+  }
+}
+
 } // namespace catalog
 } // namespace atmos
@@ -78,6 +78,13 @@ public:
   void
   addAdapter(std::unique_ptr<util::CatalogAdapter>& adapter);
 
+  /**
+   * Function that lets the adapters finish their work in progress, then stops the face, so that
+   * processEvents() returns; called in the face's thread
+   */
+  void
+  shutdown();
+
 protected:
 
   /**
@@ -21,6 +21,7 @@
 #include "query/query-adapter.hpp"
 #include "publish/publish-adapter.hpp"
 
+#include <boost/asio/signal_set.hpp>
 #include <memory>
 #include <getopt.h>
 #include <ndn-cxx/face.hpp>
@@ -34,8 +35,10 @@ void
 usage()
 {
   std::cout << "\n Usage:\n atmos-catalog "
-    "[-h] [-f config file] \n"
+    "[-h] [-a] [-e] [-f config file] \n"
     "   [-f config file]    - set the configuration file\n"
+    "   [-a]                - run the SQL statements on the non-blocking MySQL client\n"
+    "   [-e]                - keep the catalog in the embedded SQLite database set by dbFile\n"
     "   [-h]                - print help and exit\n"
     "\n";
 }
@@ -45,13 +48,21 @@ main(int argc, char** argv)
 {
   int option;
   std::string configFile(DEFAULT_CONFIG_FILE);
+  bool isNonBlockingDatabase = false;
+  bool isEmbeddedDatabase = false;
 
 #ifdef HAVE_LOG4CXX
   log4cxx::PropertyConfigurator::configure(LOG4CXX_CONFIG_FILE);
 #endif
 
-  while ((option = getopt(argc, argv, "f:h")) != -1) {
+  while ((option = getopt(argc, argv, "aef:h")) != -1) {
     switch (option) {
+      case 'a':
+        isNonBlockingDatabase = true;
+        break;
+      case 'e':
+        isEmbeddedDatabase = true;
+        break;
       case 'f':
         configFile.assign(optarg);
         break;
@@ -77,10 +88,34 @@ main(int argc, char** argv)
   // We may have to save digest in Database later
   std::shared_ptr<chronosync::Socket> syncSocket;
 
-  std::unique_ptr<atmos::util::CatalogAdapter>
-    queryAdapter(new atmos::query::QueryAdapter<ConnectionPool_T>(face, keyChain, syncSocket));
-  std::unique_ptr<atmos::util::CatalogAdapter>
-    publishAdapter(new atmos::publish::PublishAdapter<ConnectionPool_T>(face, keyChain, syncSocket));
+  std::unique_ptr<atmos::util::CatalogAdapter> queryAdapter;
+  std::unique_ptr<atmos::util::CatalogAdapter> publishAdapter;
+  if (isEmbeddedDatabase) {
+    queryAdapter.reset(new atmos::query::QueryAdapter<atmos::util::SqliteDatabase>(face,
+                                                                                    keyChain,
+                                                                                    syncSocket));
+    publishAdapter.reset(new atmos::publish::PublishAdapter<atmos::util::SqliteDatabase>(face,
+                                                                                        keyChain,
+                                                                                        syncSocket));
+  }
+  else if (isNonBlockingDatabase) {
+#ifdef HAVE_MYSQL_NONBLOCKING
+    queryAdapter.reset(new atmos::query::QueryAdapter<atmos::util::AsyncMysqlClient>(face,
+                                                                                      keyChain,
+                                                                                      syncSocket));
+    publishAdapter.reset(new atmos::publish::PublishAdapter<atmos::util::AsyncMysqlClient>(face,
+                                                                                          keyChain,
+                                                                                          syncSocket));
+#else
+    std::cerr << "atmos-catalog is built without the non-blocking MySQL client" << std::endl;
+    return 1;
+#endif // HAVE_MYSQL_NONBLOCKING
+  }
+  else {
+    queryAdapter.reset(new atmos::query::QueryAdapter<atmos::util::DatabasePool>(face, keyChain, syncSocket));
+    publishAdapter.reset(new atmos::publish::PublishAdapter<atmos::util::DatabasePool>(face, keyChain,
+                                                                             syncSocket));
+  }
 
   atmos::catalog::Catalog catalogInstance(face, keyChain, configFile);
   catalogInstance.addAdapter(publishAdapter);
@@ -94,6 +129,15 @@ main(int argc, char** argv)
     return 1;
   }
 
+  // the adapters finish the work in progress before the face stops
+  boost::asio::signal_set signals(face->getIoService(), SIGINT, SIGTERM);
+  signals.async_wait([&catalogInstance] (const boost::system::error_code& error, int) {
+      if (!error) {
+        _LOG_DEBUG("Shutting down");
+        catalogInstance.shutdown();
+      }
+    });
+
 #ifndef NDEBUG
   try {
 #endif
@@ -0,0 +1,97 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "publish/publication-session.hpp"
+
+namespace atmos {
+namespace publish {
+
+PublicationSession::PublicationSession(const ndn::Name& publisher,
+                                       const ndn::name::Component& nonce)
+  : publisher(publisher)
+  , nonce(nonce)
+  , startTime(std::chrono::steady_clock::now())
+  , nSegments(0)
+  , nBytes(0)
+{
+}
+
+ndn::Name
+PublicationSession::getName() const
+{
+  return ndn::Name(publisher).append(nonce);
+}
+
+PublicationSessionTable::PublicationSessionTable(size_t maxSessions)
+  : m_maxSessions(maxSessions)
+  , m_activeMetric(util::MetricsRegistry::getDefault().get("publish.sessions.active"))
+  , m_rejectedMetric(util::MetricsRegistry::getDefault().get("publish.sessions.rejected"))
+{
+}
+
+std::shared_ptr<PublicationSession>
+PublicationSessionTable::insert(const ndn::Name& publisher, const ndn::name::Component& nonce)
+{
+  Key key(publisher, nonce);
+  if (m_sessions.count(key) > 0) {
+    return nullptr;
+  }
+  if (isFull()) {
+    m_rejectedMetric.add();
+    return nullptr;
+  }
+
+  std::shared_ptr<PublicationSession> session =
+    std::make_shared<PublicationSession>(publisher, nonce);
+  m_sessions[key] = session;
+  m_activeMetric.set(m_sessions.size());
+  return session;
+}
+
+std::shared_ptr<PublicationSession>
+PublicationSessionTable::find(const ndn::Name& publisher,
+                              const ndn::name::Component& nonce) const
+{
+  auto it = m_sessions.find(Key(publisher, nonce));
+  if (it == m_sessions.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+void
+PublicationSessionTable::erase(const ndn::Name& publisher, const ndn::name::Component& nonce)
+{
+  m_sessions.erase(Key(publisher, nonce));
+  m_activeMetric.set(m_sessions.size());
+}
+
+void
+PublicationSessionTable::clear()
+{
+  for (const auto& item : m_sessions) {
+    if (item.second->fetcher != nullptr) {
+      item.second->fetcher->stop();
+    }
+  }
+  m_sessions.clear();
+  m_activeMetric.set(0);
+}
+
+} // namespace publish
+} // namespace atmos
@@ -0,0 +1,135 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_PUBLISH_PUBLICATION_SESSION_HPP
+#define ATMOS_PUBLISH_PUBLICATION_SESSION_HPP
+
+#include "util/metrics.hpp"
+#include "util/pipelined-fetcher.hpp"
+
+#include <ndn-cxx/name.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <utility>
+
+namespace atmos {
+namespace publish {
+
+#define MAX_PUBLICATION_SESSIONS 64
+
+/**
+ * State of one publication, from its publish Interest to its last segment
+ */
+struct PublicationSession : boost::noncopyable
+{
+public:
+  PublicationSession(const ndn::Name& publisher, const ndn::name::Component& nonce);
+
+  /**
+   * @return the name of the publication, i.e., the prefix of its segments
+   */
+  ndn::Name
+  getName() const;
+
+  const ndn::Name publisher;
+  const ndn::name::Component nonce;
+  // fetches the segments with the window of this session
+  std::shared_ptr<util::PipelinedFetcher> fetcher;
+  const std::chrono::steady_clock::time_point startTime;
+  // @{ segments handed to the adapter and the size of their content
+  uint64_t nSegments;
+  uint64_t nBytes;
+  // @}
+};
+
+/**
+ * PublicationSessionTable holds the publications being fetched, keyed by publisher prefix and
+ * nonce, so that publishers can publish in parallel without sharing any fetch state.
+ *
+ * The number of sessions is bounded, the publish Interests beyond it are turned down. The table
+ * reports "publish.sessions.active" and "publish.sessions.rejected" to the default
+ * MetricsRegistry. It is only used from the Face thread.
+ */
+class PublicationSessionTable : boost::noncopyable
+{
+public:
+  explicit
+  PublicationSessionTable(size_t maxSessions);
+
+  /**
+   * Open a session
+   *
+   * @return the new session, or nullptr if the publication already has one, or the table is
+   *         full
+   */
+  std::shared_ptr<PublicationSession>
+  insert(const ndn::Name& publisher, const ndn::name::Component& nonce);
+
+  /**
+   * @return the session of the publication, or nullptr
+   */
+  std::shared_ptr<PublicationSession>
+  find(const ndn::Name& publisher, const ndn::name::Component& nonce) const;
+
+  /**
+   * Close a session, its fetcher must be done or stopped by the caller
+   */
+  void
+  erase(const ndn::Name& publisher, const ndn::name::Component& nonce);
+
+  /**
+   * Stop the fetchers of all sessions, and close them
+   */
+  void
+  clear();
+
+  size_t
+  size() const
+  {
+    return m_sessions.size();
+  }
+
+  bool
+  isFull() const
+  {
+    return m_sessions.size() >= m_maxSessions;
+  }
+
+  void
+  setMaxSessions(size_t maxSessions)
+  {
+    m_maxSessions = maxSessions;
+  }
+
+private:
+  typedef std::pair<ndn::Name, ndn::name::Component> Key;
+
+  size_t m_maxSessions;
+  std::map<Key, std::shared_ptr<PublicationSession>> m_sessions;
+  util::Metric& m_activeMetric;
+  util::Metric& m_rejectedMetric;
+};
+
+} // namespace publish
+} // namespace atmos
+
+#endif // ATMOS_PUBLISH_PUBLICATION_SESSION_HPP
@@ -19,8 +19,26 @@
 #ifndef ATMOS_PUBLISH_PUBLISH_ADAPTER_HPP
 #define ATMOS_PUBLISH_PUBLISH_ADAPTER_HPP
 
+#include "publish/publication-session.hpp"
+#include "util/async-mysql-client.hpp"
+#include "util/bulk-statement.hpp"
 #include "util/catalog-adapter.hpp"
+#include "util/compression.hpp"
+#include "util/cuckoo-filter.hpp"
+#include "util/database-pool.hpp"
+#include "util/digest-tree.hpp"
+#include "util/index-provisioning.hpp"
+#include "util/ingest-writer.hpp"
 #include "util/mysql-util.hpp"
+#include "util/name-tokenizer.hpp"
+#include "util/pipeline-stage.hpp"
+#include "util/pipelined-fetcher.hpp"
+#include "util/rows.hpp"
+#include "util/sha256.hpp"
+#include "util/sqlite-database.hpp"
+#include "util/sync-fetcher.hpp"
+#include "util/table-snapshot.hpp"
+#include "util/update-batcher.hpp"
 #include <mysql/mysql.h>
 
 #include <json/reader.h>
@@ -33,11 +51,25 @@
 #include <ndn-cxx/name.hpp>
 #include <ndn-cxx/security/key-chain.hpp>
 #include <ndn-cxx/security/validator-config.hpp>
+#include <ndn-cxx/util/scheduler.hpp>
 #include <ndn-cxx/util/string-helper.hpp>
 
 #include <ChronoSync/socket.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <map>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 #include <unordered_map>
 #include <mutex>
@@ -50,7 +82,45 @@ namespace publish {
   INIT_LOGGER("PublishAdapter");
 #endif
 
-#define RETRY_WHEN_TIMEOUT 2
+// interval between two attempts to write the pending updates when the write pool is exhausted
+#define WRITE_RETRY_INTERVAL_MS 200
+// updates waiting for each stage of the ingest pipeline
+#define INGEST_QUEUE_SIZE 256
+// names the duplicate filter holds before it starts to forget some
+#define DUPLICATE_FILTER_CAPACITY 1048576
+// digests looked up by one query, when the duplicate filter is loaded or confirms duplicates
+#define DUPLICATE_QUERY_SIZE 1000
+// names deleted by one transaction, so that a large withdrawal does not hold the table
+#define REMOVE_CHUNK_SIZE 500
+// names read by one query when the table snapshot is built
+#define SNAPSHOT_QUERY_SIZE 1000
+// bytes of the table snapshot per Data packet
+#define SNAPSHOT_SEGMENT_SIZE 7000
+// seconds a table snapshot is served before it is built again
+#define SNAPSHOT_MAX_AGE_S 600
+// seconds before a snapshot that could not be built is tried again
+#define SNAPSHOT_RETRY_INTERVAL_S 10
+// missing sync updates beyond which a new catalog loads the snapshot of a peer instead
+#define BOOTSTRAP_THRESHOLD 10000
+// Interests for the first segment of a peer's snapshot, which it may still be building, one
+// second apart then twice as long each time, up to BOOTSTRAP_MAX_RETRY_INTERVAL_S
+#define BOOTSTRAP_MAX_TRIES 8
+#define BOOTSTRAP_MAX_RETRY_INTERVAL_S 60
+// seconds between two reconciliations with another catalog
+#define RECONCILE_INTERVAL_S 3600
+// seconds without updates from a catalog, after which it is reconciled with once heard again
+#define RECONCILE_SILENCE_S 300
+// seconds a digest tree is served before it is built again
+#define DIGEST_TREE_MAX_AGE_S 600
+// names of a differing digest range below which they are fetched rather than compared by parts
+#define RECONCILE_LEAF_SIZE 32
+// seconds a removed name is not loaded again by a reconciliation, while the other catalogs
+// apply its removal
+#define RECONCILE_TOMBSTONE_S 86400
+// reconciliation Interests in flight
+#define RECONCILE_WINDOW 8
+// seconds the last sync update is served to the other catalogs before the catalog stops
+#define SHUTDOWN_LINGER_S 5
 
 /**
  * PublishAdapter handles the Publish usecases for the catalog
@@ -81,6 +151,13 @@ public:
                 const std::vector<std::string>& nameFields,
                 const std::string& databaseTable);
 
+  /**
+   * Stop taking publications, let the parse stage hand the ones it has over to the batcher,
+   * then announce them, and serve the update for SHUTDOWN_LINGER_S before onDone
+   */
+  virtual void
+  shutdown(const std::function<void()>& onDone);
+
 protected:
   /**
    * Helper function that configures piblishAdapter instance according to publish section
@@ -105,13 +182,34 @@ protected:
   onTimeout(const ndn::Interest& interest);
 
   /**
-   * Data containing the actual thing we need to publish
+   * Data containing the actual thing we need to publish, handed over in segment order by the
+   * fetcher of the publication while the next segments are being fetched
    *
-   * @param interest: Interest that caused this Data to be routed
-   * @param data:     Data that needs to be handled
+   * @param data: Data that needs to be handled
    */
   virtual void
-  onPublishedData(const ndn::Interest& interest, const ndn::Data& data);
+  onPublishedData(const ndn::Data& data);
+
+  /**
+   * Helper function that accounts a segment to the session of its publication, then handles it
+   *
+   * @param publisher: prefix of the publisher
+   * @param nonce:     nonce of the publication
+   * @param data:      the segment
+   */
+  void
+  onSessionSegment(const ndn::Name& publisher, const ndn::name::Component& nonce,
+                   const ndn::Data& data);
+
+  /**
+   * Helper function that closes the session of a publication once all its segments are
+   * received, or the fetch failed
+   *
+   * @param reason: empty if all segments are received
+   */
+  void
+  closeSession(const ndn::Name& publisher, const ndn::name::Component& nonce,
+               const std::string& reason);
 
   /**
    * Helper function to initialize the DatabaseHandler
@@ -119,6 +217,26 @@ protected:
   void
   initializeDatabase(const util::ConnectionDetails&  databaseId);
 
+  /**
+   * Helper function that generates the statements creating the sync table and the data table
+   */
+  std::vector<std::string>
+  getCreateTableStatements();
+
+  /**
+   * Helper function that creates the configured indexes of the data table, and drops the ones
+   * the catalog created before but are no longer configured; the table stays available while
+   * the indexes are built
+   */
+  void
+  provisionIndexes();
+
+  /**
+   * Helper function that parses the "indexes" section of the database settings
+   */
+  void
+  parseIndexes(const util::ConfigSection& section);
+
   void
   closeDatabaseHandler();
 
@@ -141,6 +259,15 @@ protected:
   bool
   validatePublicationChanges(const std::shared_ptr<const ndn::Data>& data);
 
+  /**
+   * Helper function that checks the parsed changes of a publication against the trust model
+   *
+   * @param dataName: name of the Data that contains the changes
+   * @param changes:  the parsed payload
+   */
+  bool
+  checkPublicationChanges(const ndn::Name& dataName, const Json::Value& changes);
+
   /**
    * Helper function that processes the sync update
    *
@@ -149,6 +276,206 @@ protected:
   void
   processSyncUpdate(const std::vector<chronosync::MissingDataInfo>& updates);
 
+  /**
+   * Serve the segments of the table snapshot, named <prefix>/snapshot/<catalogId>/<version>/
+   * <segment>. An Interest for <prefix>/snapshot/<catalogId> gets the first segment of the
+   * current snapshot, whose name tells the version to fetch
+   */
+  void
+  onSnapshotInterest(const ndn::InterestFilter& filter, const ndn::Interest& interest);
+
+  /**
+   * Build a new snapshot of the data table on its own thread, unless one is being built or the
+   * table is being loaded from the snapshot of another catalog
+   */
+  void
+  buildSnapshot();
+
+  /**
+   * Build the snapshot again every m_snapshotMaxAge
+   */
+  void
+  scheduleSnapshot();
+
+  /**
+   * Helper function that reads the snapshot of the data table, the session vector first, so that
+   * the names cover at least the updates it lists. The table is read by pages and encoded as
+   * it is read, only the encoding is kept
+   *
+   * @param segments: the encoded snapshot, cut in SNAPSHOT_SEGMENT_SIZE pieces
+   * @return false if the database cannot be read
+   */
+  bool
+  readSnapshot(std::vector<std::string>& segments);
+
+  /**
+   * Helper function that starts serving the snapshot built by buildSnapshot, on the Face thread
+   *
+   * @param content: the segments of the encoded snapshot, null if it could not be built
+   */
+  void
+  onSnapshotBuilt(const std::shared_ptr<const std::vector<std::string>>& content);
+
+  void
+  signData(ndn::Data& data);
+
+  /**
+   * @return the number of updates the catalog misses, past the ones already written
+   */
+  uint64_t
+  countMissingUpdates(const std::vector<chronosync::MissingDataInfo>& updates) const;
+
+  /**
+   * Fetch the table snapshot of the catalog with the most updates, and load it instead of
+   * fetching their updates one by one; the sync updates are held until it is loaded. The
+   * digests of the table are read first, the rows the snapshot does not have are deleted
+   * once it is loaded
+   */
+  void
+  startBootstrap(const std::vector<chronosync::MissingDataInfo>& updates);
+
+  /**
+   * Helper function that asks for the first segment of a peer's snapshot, again with a backoff
+   * while the peer does not answer, e.g., as it builds its first snapshot
+   *
+   * @param nTries: Interests sent so far
+   */
+  void
+  requestSnapshot(const ndn::Name& snapshotPrefix, size_t nTries);
+
+  /**
+   * Helper function that fetches the segments of a snapshot version, and validates each of them
+   * with the sync validator
+   */
+  void
+  fetchSnapshot(const ndn::Name& versionName);
+
+  /**
+   * Helper function that decodes the validated segments that are next in order, and hands
+   * their names over to the ingest writer, on the Face thread
+   */
+  void
+  loadSnapshotSegments();
+
+  /**
+   * Helper function that deletes the rows of the table, as it was before the snapshot was
+   * loaded, that the snapshot does not have, on the bootstrap thread
+   */
+  void
+  removeDeletedRows(const util::TableSnapshot::SessionVector& vector);
+
+  /**
+   * Helper function that gives up on the snapshot, the sync updates are fetched instead
+   */
+  void
+  abortBootstrap(const std::string& reason);
+
+  /**
+   * Helper function that saves the session vector of the loaded snapshot, then fetches the
+   * held sync updates past it. When the snapshot could not be loaded, all of them are fetched
+   */
+  void
+  finishBootstrap(bool isLoaded, const util::TableSnapshot::SessionVector& vector);
+
+  /**
+   * @return the prefix of a service of the catalog that owns a sync session, e.g.,
+   *         <prefix>/snapshot/<catalogId>, empty if the session name is not the one of a catalog
+   */
+  static ndn::Name
+  getPeerPrefix(const ndn::Name& session, const std::string& service);
+
+  /**
+   * A digest range asked for by a reconciliation
+   */
+  struct ReconcileRange
+  {
+    std::string hexPrefix;
+    // the names of the range are asked for, rather than its children
+    bool isLeaf;
+    // names the other catalog has in the range
+    uint64_t count;
+  };
+
+  /**
+   * Serve the digest tree of the data table: the children of a node, under
+   * <prefix>/reconcile/<catalogId>/nodes/<hexPrefix>, and the names of a digest range, under
+   * <prefix>/reconcile/<catalogId>/names/<hexPrefix>. The root is <.../nodes>
+   */
+  void
+  onReconcileInterest(const ndn::InterestFilter& filter, const ndn::Interest& interest);
+
+  /**
+   * Reconcile stage, reads the names of a digest range asked for by another catalog
+   */
+  void
+  serveReconcileNames(ndn::Interest& interest);
+
+  /**
+   * Compare the data table with the one of the catalog that owns a sync session, and load the
+   * names it is missing; the digest tree is built again first. One reconciliation runs at a time
+   */
+  void
+  reconcile(const ndn::Name& session);
+
+  /**
+   * Reconcile with the next catalog heard of, every m_reconcileInterval
+   */
+  void
+  scheduleReconcile();
+
+  /**
+   * Build a new digest tree of the data table on its own thread, unless one is being built
+   */
+  void
+  buildDigestTree();
+
+  /**
+   * Helper function that reads the first 64 bits of the sha256 column
+   *
+   * @return false if the database cannot be read
+   */
+  bool
+  readDigests(std::vector<uint64_t>& keys);
+
+  /**
+   * Helper function that serves the digest tree built by buildDigestTree and starts the pending
+   * reconciliation, on the Face thread
+   *
+   * @param tree: the new tree, null if it could not be built
+   */
+  void
+  onDigestTreeBuilt(const std::shared_ptr<const util::DigestTree>& tree);
+
+  /**
+   * Helper function that asks the peer for the next digest ranges to compare, within the window
+   */
+  void
+  sendReconcileInterests();
+
+  /**
+   * Helper function that compares the children of a node with the local ones, or loads the names
+   * of a range the local table is missing; a range whose names do not fit in one Data is
+   * compared by parts instead
+   *
+   * @param range: the digest range the Data answers for
+   */
+  void
+  onReconcileData(const ReconcileRange& range, const ndn::Data& data);
+
+  /**
+   * Helper function that hands the removal of a name over to the ingest writer, and keeps its
+   * tombstone for m_tombstoneRetention, can be called from any thread
+   */
+  void
+  removeName(const std::string& name, const std::string& digest);
+
+  /**
+   * Helper function that forgets the tombstones older than m_tombstoneRetention, must be called
+   * with m_mutex held
+   */
+  void
+  expireTombstones(const std::chrono::steady_clock::time_point& now);
+
   /**
    * Helper function that processes the update data
    *
@@ -158,27 +485,222 @@ protected:
   processUpdateData(const std::shared_ptr<const ndn::Data>& data);
 
   /**
-   * Helper function that add data to or remove data from database
+   * An update on its way through the ingest pipeline
+   */
+  struct IngestItem
+  {
+    std::shared_ptr<const ndn::Data> data;
+    // a publication is checked against the publisher prefix, then announced through sync
+    bool isPublication;
+    // parsed payload, set by the parse stage
+    std::shared_ptr<Json::Value> changes;
+    // @{ without data, the item marks the updates of a ChronoSync session up to syncSeq as
+    // fetched; it follows them through the pipeline, and is written in the same transaction
+    std::string syncSession;
+    chronosync::SeqNo syncSeq;
+    // @}
+  };
+
+  /**
+   * Queue an item for the parse stage without waiting, from the Face thread. The items the stage
+   * has no room for wait in m_parseBacklog, and are pushed again in order, while
+   * isIngestBacklogged pauses the fetchers
+   */
+  void
+  pushToParseStage(IngestItem item);
+
+  void
+  drainParseBacklog();
+
+  /**
+   * Run a function on the Face thread, unless the adapter is destroyed by then; can be called
+   * from any thread
+   */
+  void
+  postToFace(const std::function<void()>& function);
+
+  /**
+   * Parse stage of the ingest pipeline, parses the payload once and checks it
+   */
+  void
+  parseUpdate(IngestItem& item);
+
+  /**
+   * Tokenize stage of the ingest pipeline, validates the added names against the name fields,
+   * hashes them, and hands the changes over to the ingest writer
+   */
+  void
+  tokenizeUpdate(IngestItem& item);
+
+  /**
+   * Helper function that validates file names against the name fields, hashes them, and hands
+   * them over to the ingest writer
    *
-   * @param sql: sql string to do the add or remove jobs
-   * @param op:  enum value indicates the database operation, could be REMOVE, ADD
+   * @param keys: if not null, the first 64 bits of the digests of the names handed over are
+   *              appended to it
    */
-  virtual void
-  operateDatabase(const std::string& sql,
-                  util::DatabaseOperation op);
+  void
+  addNames(const std::vector<std::string>& names, std::vector<uint64_t>* keys = nullptr);
 
   /**
-   * Helper function that parses jsonValue to generate sql string, return value indicates
-   * if it is successfully
+   * @return true if a stage of the ingest pipeline does not keep up, and the fetchers should
+   *         slow down
+   */
+  bool
+  isIngestBacklogged() const;
+
+  /**
+   * Helper function that computes the sha256 column of a file name
+   */
+  static std::string
+  digestName(const std::string& fileName);
+
+  /**
+   * Helper function that writes a batch of updates, called by the ingest writer in its own
+   * thread. The deletions are run first, in chunks of m_removeChunkSize names, each in its own
+   * transaction; then the insertions, in one transaction
+   *
+   * @param batch: the deletions and insertions to apply
+   * @return false if the database cannot be reached, and the batch should be tried again
+   */
+  virtual bool
+  writeBatch(const util::IngestBatch& batch);
+
+  /**
+   * Helper function that deletes the removed names of a batch by their sha256, which is
+   * indexed, one chunk per transaction so that the queries get the table in between
+   *
+   * @return false if the database cannot be reached
+   */
+  bool
+  removeNames(const util::IngestBatch& batch);
+
+  /**
+   * Helper function that writes the insertions of a batch in one transaction. If the database
+   * rejects it, the batch is split in halves that are written on their own, until the rows it
+   * rejects are isolated and dropped
+   *
+   * @return false if the database cannot be reached
+   */
+  bool
+  insertNames(const util::IngestBatch& batch);
+
+  enum WriteResult {
+    WRITE_DONE,
+    // e.g., the connection was lost, the statements may succeed later
+    WRITE_RETRY,
+    // the statements would be rejected again
+    WRITE_REJECTED
+  };
+
+  /**
+   * Helper function that runs statements in one transaction
+   */
+  WriteResult
+  executeStatements(const std::vector<util::BulkStatement>& statements);
+
+  /**
+   * Helper function that generates the insertions of a batch; the statements point into the
+   * batch. A malformed name is logged and left out
+   */
+  void
+  batch2Statements(const util::IngestBatch& batch, std::vector<util::BulkStatement>& statements);
+
+  /**
+   * Helper function that marks the added names of a batch which are already in the database, so
+   * they are not written again. The duplicate filter tells which names may be there, those are
+   * looked up in the database; the other names are new, and added to the filter
+   *
+   * @param isStored: set to true for each added name found in the database
+   */
+  void
+  findStoredNames(const util::IngestBatch& batch, std::vector<bool>& isStored);
+
+  /**
+   * Helper function that removes names from the duplicate filter
+   *
+   * @param digests: the sha256 of the names
+   */
+  void
+  forgetNames(const std::vector<std::string>& digests);
+
+  /**
+   * Helper function that fills a duplicate filter with the sha256 of the names in the
+   * database, on its own thread, then hands it over to the writer thread. The filter is sized
+   * for twice the names in the table, and at least for m_duplicateFilterCapacity
+   */
+  void
+  loadDuplicateFilter();
+
+  /**
+   * Helper function that runs a SELECT statement on the data table from any thread but the
+   * Face thread, return value indicates if it succeeded
+   *
+   * @param sql:  the statement
+   * @param rows: vector to save the rows, a NULL column is an empty string
+   */
+  bool
+  queryDatabase(const std::string& sql, util::Rows& rows);
+
+  /**
+   * @return the SQL dialect of the database handler
+   */
+  static util::SqlDialect
+  getSqlDialect();
+
+  /**
+   * Helper function that gets the file names of an operation from jsonValue, return value
+   * indicates if they are all strings
    *
-   * @param sqlString: streamstream to save the sql string
    * @param jsonValue: Json value that contains the update information
    * @param op:        enum value indicates the database operation, could be REMOVE, ADD
+   * @param names:     vector to save the file names
+   */
+  bool
+  json2Names(Json::Value& jsonValue,
+             util::DatabaseOperation op,
+             std::vector<std::string>& names);
+
+  /**
+   * Helper function that adds the rows adding or removing file names to a statement, return
+   * value indicates if all names are well formed
+   *
+   * @param names:     the file names, which must outlive the statement
+   * @param digests:   the sha256 of each name
+   * @param op:        enum value indicates the database operation, could be REMOVE, ADD
+   * @param statement: statement made by makeStatement for the same operation
+   */
+  bool
+  names2Statement(const std::vector<std::string>& names,
+                  const std::vector<std::string>& digests,
+                  util::DatabaseOperation op,
+                  util::BulkStatement& statement);
+
+  /**
+   * Helper function that adds the row inserting a file name to a statement, return value
+   * indicates if the name is well formed
+   */
+  bool
+  name2Row(const std::string& fileName, const std::string& digest,
+           util::BulkStatement& statement);
+
+  /**
+   * Helper function that makes the empty statement of an operation on the data table
+   *
+   * @param op: enum value indicates the database operation, could be REMOVE, ADD
+   */
+  util::BulkStatement
+  makeStatement(util::DatabaseOperation op);
+
+  /**
+   * Helper function that splits a file name into the values of the name fields, return value
+   * indicates if the name has one component per name field
+   *
+   * @param fileName: ndn uri string for a file name
+   * @param fields:   vector to save the values, which point into fileName
    */
   bool
-  json2Sql(std::stringstream& sqlString,
-           Json::Value& jsonValue,
-           util::DatabaseOperation op);
+  splitName(const std::string& fileName, std::vector<util::ValueRef>& fields);
 
   /**
    * Helper function to generate sql string based on file name, return value indicates
@@ -192,28 +714,31 @@ protected:
               std::string& fileName);
 
   /**
-   * Check the local database for the latest sequence number for a ChronoSync update
-   *
-   * @param update: the MissingDataInfo object
+   * Load the sequence numbers up to which the updates of each ChronoSync session were written,
+   * before the catalog started
    */
-  chronosync::SeqNo
-  getLatestSeqNo(const chronosync::MissingDataInfo& update);
+  void
+  loadSyncProgress();
 
   /**
-   * Update the local database with the update message
-   *
-   * @param update: the MissingDataInfo object
+   * Helper function that keeps the rows of chronosync_update_info in m_storedSyncSeqNos
    */
   void
-  renewUpdateInformation(const chronosync::MissingDataInfo& update);
+  storeSyncProgress(const util::Rows& rows);
 
   /**
-   * Insert the update message into the local database
-   *
-   * @param update: the MissingDataInfo object
+   * Helper function that fetches a ChronoSync update for the sync fetcher, and reports the
+   * outcome to it
    */
   void
-  addUpdateInformation(const chronosync::MissingDataInfo& update);
+  fetchSyncUpdate(const ndn::Name& session, chronosync::SeqNo seq);
+
+  /**
+   * Helper function that saves the sequence number up to which all updates of a session are
+   * fetched, so that a restart resumes from there
+   */
+  void
+  onSyncProgress(const ndn::Name& session, chronosync::SeqNo seq);
 
   void
   onFetchUpdateDataTimeout(const ndn::Interest& interest);
@@ -232,14 +757,120 @@ protected:
   // Handle to the Catalog's database
   std::shared_ptr<DatabaseHandler> m_databaseHandler;
   std::unique_ptr<ndn::ValidatorConfig> m_publishValidator;
+  // validates the sync updates, and the snapshot and reconciliation Data of the other catalogs,
+  // which are not fetched without it
+  std::shared_ptr<ndn::ValidatorConfig> m_syncValidator;
   RegisteredPrefixList m_registeredPrefixList;
   std::shared_ptr<chronosync::Socket>& m_socket; // SyncSocket
   std::vector<std::string> m_tableColumns;
-  // mutex to control critical sections
+  // indexes of the data table, only maintained when the "indexes" section is configured
+  bool m_isIndexManaged;
+  std::vector<util::IndexDefinition> m_indexes;
+  // builds the indexes of a DatabasePool catalog, joined before the pool is closed
+  std::thread m_provisionThread;
+  // batches the updates of all publications and sync sessions into transactions
+  std::unique_ptr<util::IngestWriter> m_ingestWriter;
+  // names deleted by one transaction
+  size_t m_removeChunkSize;
+  // @{ sha256 of the names in the data table, only used by the writer thread; null until the
+  // filter is loaded, or when disabled with a capacity of 0
+  std::unique_ptr<util::CuckooFilter> m_duplicateFilter;
+  size_t m_duplicateFilterCapacity;
+  // filter handed over by the loading thread, needs m_mutex protection
+  std::unique_ptr<util::CuckooFilter> m_loadedDuplicateFilter;
+  std::thread m_duplicateFilterThread;
+  // @}
+  // @{ ingest pipeline: fetch and verify on the Face thread, then parse, then tokenize and
+  // hash, then the ingest writer
+  std::unique_ptr<util::PipelineStage<IngestItem>> m_parseStage;
+  std::unique_ptr<util::PipelineStage<IngestItem>> m_tokenizeStage;
+  // items the parse stage had no room for, only accessed on the Face thread
+  std::deque<IngestItem> m_parseBacklog;
+  std::atomic<size_t> m_nParseBacklog;
+  // drains the parse stage at shutdown, the Face thread must not wait for it
+  std::thread m_shutdownThread;
+  // @}
+  ndn::util::scheduler::Scheduler m_scheduler;
+  // publications whose segments are being fetched, each with its own window
+  PublicationSessionTable m_sessions;
+  // window and retransmission settings each session starts with
+  util::PipelinedFetcher::Options m_fetchOptions;
+  // fetches the ChronoSync updates of all sessions, within its windows
+  std::unique_ptr<util::SyncFetcher> m_syncFetcher;
+  util::SyncFetcher::Options m_syncFetchOptions;
+  // coalesces the validated publications into few sync updates
+  std::unique_ptr<util::UpdateBatcher> m_updateBatcher;
+  util::UpdateBatcher::Options m_updateBatchOptions;
+  // sequence numbers in chronosync_update_info when the catalog started, only read for the
+  // sessions the sync fetcher has not seen yet
+  std::unordered_map<ndn::Name, chronosync::SeqNo> m_storedSyncSeqNos;
+  // @{ table snapshot served to the catalogs that join, built at startup then every
+  // m_snapshotMaxAge; only accessed on the Face thread but for the thread that builds it
+  ndn::Name m_snapshotName;
+  // the encoded snapshot, one string per segment
+  std::shared_ptr<const std::vector<std::string>> m_snapshotContent;
+  // signed when first asked for
+  std::vector<std::shared_ptr<ndn::Data>> m_snapshotSegments;
+  std::chrono::seconds m_snapshotMaxAge;
+  bool m_isBuildingSnapshot;
+  // the snapshot being built reads a table that a bootstrap replaces
+  bool m_isSnapshotOutdated;
+  std::thread m_snapshotThread;
+  // @}
+  // @{ bootstrap from the snapshot of a peer, only accessed on the Face thread but for the
+  // thread that reads the table; a threshold of 0 disables it
+  uint64_t m_bootstrapThreshold;
+  bool m_isBootstrapChecked;
+  bool m_isBootstrapping;
+  std::vector<chronosync::MissingDataInfo> m_pendingSyncUpdates;
+  std::shared_ptr<util::PipelinedFetcher> m_snapshotFetcher;
+  // decodes the segments in order, null once the snapshot is loaded or given up on
+  std::unique_ptr<util::TableSnapshot::Reader> m_snapshotReader;
+  // validated segments waiting for the ones before them
+  std::map<uint64_t, std::shared_ptr<const ndn::Data>> m_validatedSegments;
+  uint64_t m_nextSnapshotSegment;
+  uint64_t m_nFetchedSegments;
+  bool m_isSnapshotFetched;
+  uint64_t m_nSnapshotNames;
+  // the first 64 bits of the digests the table had before the snapshot is loaded, sorted, and
+  // whether the snapshot has them; the rows of the others are deleted
+  std::vector<uint64_t> m_bootstrapKeys;
+  std::vector<bool> m_isBootstrapKeySeen;
+  std::thread m_bootstrapThread;
+  // @}
+  // @{ reconciliation of the data table with the other catalogs, only accessed on the Face
+  // thread but for the thread that builds the digest tree
+  std::shared_ptr<const util::DigestTree> m_digestTree;
+  std::chrono::steady_clock::time_point m_digestTreeTime;
+  bool m_isBuildingDigestTree;
+  std::thread m_digestTreeThread;
+  // 0 disables the periodic reconciliations, or the ones after a silence
+  std::chrono::seconds m_reconcileInterval;
+  std::chrono::seconds m_reconcileSilence;
+  bool m_isReconciling;
+  // <prefix>/reconcile/<catalogId> of the catalog being reconciled with
+  ndn::Name m_reconcilePeer;
+  // digest ranges to ask the peer
+  std::deque<ReconcileRange> m_reconcileQueue;
+  size_t m_nReconcileOutstanding;
+  // when each sync session last had updates
+  std::unordered_map<ndn::Name, std::chrono::steady_clock::time_point> m_syncLastHeard;
+  size_t m_nextReconcileSession;
+  std::unique_ptr<util::PipelineStage<ndn::Interest>> m_reconcileStage;
+  // @{ the first 64 bits of the digests of the names removed within m_tombstoneRetention, and
+  // when, oldest first; need m_mutex protection
+  std::unordered_map<uint64_t, std::chrono::steady_clock::time_point> m_tombstones;
+  std::deque<std::pair<std::chrono::steady_clock::time_point, uint64_t>> m_tombstoneQueue;
+  // @}
+  std::chrono::seconds m_tombstoneRetention;
+  // @}
+  // set when the adapter is destroyed, so that its threads give up
+  std::atomic<bool> m_isClosing;
+  // does not own the adapter, the functions posted to the Face thread hold a weak_ptr to it so
+  // that they do nothing once it is destroyed
+  std::shared_ptr<PublishAdapter> m_self;
+  // mutex to control critical sections, e.g., the duplicate filter handover
   std::mutex m_mutex;
-  // TODO: create thread for each request, and the variables below should be within the thread
-  bool m_mustBeFresh;
-  bool m_isFinished;
   ndn::Name m_catalogId;
 };
 
@@ -250,10 +881,34 @@ PublishAdapter<DatabaseHandler>::PublishAdapter(const std::shared_ptr<ndn::Face>
                                                 std::shared_ptr<chronosync::Socket>& syncSocket)
   : util::CatalogAdapter(face, keyChain)
   , m_socket(syncSocket)
-  , m_mustBeFresh(true)
-  , m_isFinished(false)
+  , m_isIndexManaged(false)
+  , m_removeChunkSize(REMOVE_CHUNK_SIZE)
+  , m_duplicateFilterCapacity(DUPLICATE_FILTER_CAPACITY)
+  , m_nParseBacklog(0)
+  , m_scheduler(face->getIoService())
+  , m_sessions(MAX_PUBLICATION_SESSIONS)
+  , m_snapshotMaxAge(SNAPSHOT_MAX_AGE_S)
+  , m_isBuildingSnapshot(false)
+  , m_isSnapshotOutdated(false)
+  , m_bootstrapThreshold(BOOTSTRAP_THRESHOLD)
+  , m_isBootstrapChecked(false)
+  , m_isBootstrapping(false)
+  , m_nextSnapshotSegment(0)
+  , m_nFetchedSegments(0)
+  , m_isSnapshotFetched(false)
+  , m_nSnapshotNames(0)
+  , m_isBuildingDigestTree(false)
+  , m_reconcileInterval(RECONCILE_INTERVAL_S)
+  , m_reconcileSilence(RECONCILE_SILENCE_S)
+  , m_isReconciling(false)
+  , m_nReconcileOutstanding(0)
+  , m_nextReconcileSession(0)
+  , m_tombstoneRetention(RECONCILE_TOMBSTONE_S)
+  , m_isClosing(false)
+  , m_self(this, [] (PublishAdapter*) {})
   , m_catalogId("catalogIdPlaceHolder")
 {
+  m_fetchOptions.pauseInterval = ndn::time::milliseconds(WRITE_RETRY_INTERVAL_MS);
 }
 
 template <typename DatabaseHandler>
@@ -265,20 +920,25 @@ PublishAdapter<DatabaseHandler>::setCatalogId()
 
 template <>
 void
-PublishAdapter<ConnectionPool_T>::setCatalogId()
+PublishAdapter<util::DatabasePool>::setCatalogId()
 {
-  // use public key digest as the catalog ID
-  ndn::Name keyId;
-  if (m_signingId.empty()) {
-    keyId = m_keyChain->getDefaultKeyNameForIdentity(m_keyChain->getDefaultIdentity());
-  } else {
-    keyId = m_keyChain->getDefaultKeyNameForIdentity(m_signingId);
-  }
+  m_catalogId = computeCatalogId();
+}
+
+#ifdef HAVE_MYSQL_NONBLOCKING
+template <>
+void
+PublishAdapter<util::AsyncMysqlClient>::setCatalogId()
+{
+  m_catalogId = computeCatalogId();
+}
+#endif // HAVE_MYSQL_NONBLOCKING
 
-  std::shared_ptr<ndn::PublicKey> pKey = m_keyChain->getPib().getPublicKey(keyId);
-  ndn::Block keyDigest = pKey->computeDigest();
-  m_catalogId.clear();
-  m_catalogId.append(ndn::toHex(*keyDigest.getBuffer()));
+template <>
+void
+PublishAdapter<util::SqliteDatabase>::setCatalogId()
+{
+  m_catalogId = computeCatalogId();
 }
 
 template <typename DatabaseHandler>
@@ -295,12 +955,34 @@ PublishAdapter<DatabaseHandler>::setFilters()
                                 bind(&publish::PublishAdapter<DatabaseHandler>::onRegisterFailure,
                                      this, _1, _2));
 
-    ndn::Name catalogSync = ndn::Name(m_prefix).append("sync").append(m_catalogId);
-    m_socket.reset(new chronosync::Socket(m_syncPrefix,
+    ndn::Name snapshotPrefix = ndn::Name(m_prefix).append("snapshot").append(m_catalogId);
+    m_registeredPrefixList[snapshotPrefix] =
+      m_face->setInterestFilter(snapshotPrefix,
+                                bind(&PublishAdapter<DatabaseHandler>::onSnapshotInterest,
+                                     this, _1, _2),
+                                bind(&publish::PublishAdapter<DatabaseHandler>::onRegisterSuccess,
+                                     this, _1),
+                                bind(&publish::PublishAdapter<DatabaseHandler>::onRegisterFailure,
+                                     this, _1, _2));
+
+    ndn::Name reconcilePrefix = ndn::Name(m_prefix).append("reconcile").append(m_catalogId);
+    m_registeredPrefixList[reconcilePrefix] =
+      m_face->setInterestFilter(reconcilePrefix,
+                                bind(&PublishAdapter<DatabaseHandler>::onReconcileInterest,
+                                     this, _1, _2),
+                                bind(&publish::PublishAdapter<DatabaseHandler>::onRegisterSuccess,
+                                     this, _1),
+                                bind(&publish::PublishAdapter<DatabaseHandler>::onRegisterFailure,
+                                     this, _1, _2));
+
+    ndn::Name catalogSync = ndn::Name(m_prefix).append("sync").append(m_catalogId);
+    m_socket.reset(new chronosync::Socket(m_syncPrefix,
                                           catalogSync,
                                           *m_face,
                                           bind(&PublishAdapter<DatabaseHandler>::processSyncUpdate,
-                                               this, _1)));
+                                               this, _1),
+                                          ndn::Name(),
+                                          m_syncValidator));
 }
 
 template <typename DatabaseHandler>
@@ -311,9 +993,29 @@ PublishAdapter<DatabaseHandler>::closeDatabaseHandler()
 
 template <>
 void
-PublishAdapter<ConnectionPool_T>::closeDatabaseHandler()
+PublishAdapter<util::DatabasePool>::closeDatabaseHandler()
+{
+  m_databaseHandler->stop();
+}
+
+#ifdef HAVE_MYSQL_NONBLOCKING
+template <>
+void
+PublishAdapter<util::AsyncMysqlClient>::closeDatabaseHandler()
+{
+  if (m_databaseHandler != nullptr) {
+    m_databaseHandler->close();
+  }
+}
+#endif // HAVE_MYSQL_NONBLOCKING
+
+template <>
+void
+PublishAdapter<util::SqliteDatabase>::closeDatabaseHandler()
 {
-  ConnectionPool_stop(*m_databaseHandler);
+  if (m_databaseHandler != nullptr) {
+    m_databaseHandler->close();
+  }
 }
 
 template <typename DatabaseHandler>
@@ -324,9 +1026,88 @@ PublishAdapter<DatabaseHandler>::~PublishAdapter()
       m_face->unsetInterestFilter(itr.second);
   }
 
+  // the publications validated within the last updateDelay are announced while the socket is up
+  if (m_updateBatcher != nullptr) {
+    m_updateBatcher->flush();
+  }
+
+  m_sessions.clear();
+  // the snapshot threads may still hand names over to the ingest writer
+  m_isClosing = true;
+  if (m_snapshotFetcher != nullptr) {
+    m_snapshotFetcher->stop();
+  }
+  if (m_snapshotThread.joinable()) {
+    m_snapshotThread.join();
+  }
+  if (m_bootstrapThread.joinable()) {
+    m_bootstrapThread.join();
+  }
+  if (m_digestTreeThread.joinable()) {
+    m_digestTreeThread.join();
+  }
+  if (m_duplicateFilterThread.joinable()) {
+    m_duplicateFilterThread.join();
+  }
+  if (m_provisionThread.joinable()) {
+    m_provisionThread.join();
+  }
+  if (m_shutdownThread.joinable()) {
+    m_shutdownThread.join();
+  }
+  if (m_reconcileStage != nullptr) {
+    m_reconcileStage->stop();
+  }
+  // each stage hands what it has over to the next one before it stops
+  if (m_parseStage != nullptr) {
+    m_parseStage->stop();
+  }
+  if (m_tokenizeStage != nullptr) {
+    m_tokenizeStage->stop();
+  }
+  if (m_ingestWriter != nullptr) {
+    // write what is buffered while the database is still open
+    m_ingestWriter->stop();
+  }
+  // the threads are joined, the functions they posted to the Face thread are left to expire
+  m_self.reset();
+
   closeDatabaseHandler();
 }
 
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::shutdown(const std::function<void()>& onDone)
+{
+  for (const auto& itr : m_registeredPrefixList) {
+    if (static_cast<bool>(itr.second))
+      m_face->unsetInterestFilter(itr.second);
+  }
+  m_registeredPrefixList.clear();
+
+  if (m_parseStage == nullptr || m_updateBatcher == nullptr) {
+    onDone();
+    return;
+  }
+
+  // the parse stage posts the validated publications to the batcher, on the Face thread, so
+  // the flush is posted after the last of them
+  std::shared_ptr<std::deque<IngestItem>> backlog = std::make_shared<std::deque<IngestItem>>();
+  backlog->swap(m_parseBacklog);
+  m_nParseBacklog = 0;
+  m_shutdownThread = std::thread([this, backlog, onDone] {
+      for (auto& item : *backlog) {
+        m_parseStage->push(std::move(item));
+      }
+      m_parseStage->stop();
+
+      postToFace([this, onDone] {
+          m_updateBatcher->flush();
+          m_scheduler.scheduleEvent(ndn::time::seconds(SHUTDOWN_LINGER_S), onDone);
+        });
+    });
+}
+
 template <typename DatabaseHandler>
 void
 PublishAdapter<DatabaseHandler>::setConfigFile(util::ConfigFile& config,
@@ -360,7 +1141,15 @@ PublishAdapter<DatabaseHandler>::onConfig(const util::ConfigSection& section,
     return;
   }
 
-  std::string signingId, dbServer, dbName, dbUser, dbPasswd;
+  std::string signingId, dbServer, dbName, dbUser, dbPasswd, dbFile;
+  size_t maxConnections = MAX_DB_CONNECTIONS;
+  bool hasMaxConnections = false;
+  size_t maxWaiting = MAX_DB_CONNECTIONS;
+  size_t acquireTimeout = DB_ACQUIRE_TIMEOUT_MS;
+  unsigned int dbPort = DB_DEFAULT_PORT;
+  util::IngestWriter::Options ingestOptions;
+  ingestOptions.retryInterval = std::chrono::milliseconds(WRITE_RETRY_INTERVAL_MS);
+  size_t queueSize = INGEST_QUEUE_SIZE;
   std::string syncPrefix("ndn:/ndn-atmos/broadcast/chronosync");
 
   for (auto item = section.begin();
@@ -388,6 +1177,9 @@ PublishAdapter<DatabaseHandler>::onConfig(const util::ConfigSection& section,
         if (subItem->first == "dbServer") {
           dbServer = subItem->second.get_value<std::string>();
         }
+        if (subItem->first == "dbPort") {
+          dbPort = subItem->second.get_value<unsigned int>();
+        }
         if (subItem->first == "dbName") {
           dbName = subItem->second.get_value<std::string>();
         }
@@ -397,25 +1189,77 @@ PublishAdapter<DatabaseHandler>::onConfig(const util::ConfigSection& section,
         if (subItem->first == "dbPasswd") {
           dbPasswd = subItem->second.get_value<std::string>();
         }
+        if (subItem->first == "dbFile") {
+          dbFile = subItem->second.get_value<std::string>();
+        }
+        if (subItem->first == "indexes") {
+          parseIndexes(subItem->second);
+        }
+        if (subItem->first == "maxConnections") {
+          maxConnections = subItem->second.get_value<size_t>();
+          hasMaxConnections = true;
+        }
+        if (subItem->first == "maxWaiting") {
+          maxWaiting = subItem->second.get_value<size_t>();
+        }
+        if (subItem->first == "acquireTimeout") {
+          acquireTimeout = subItem->second.get_value<size_t>();
+        }
+        if (subItem->first == "batchSize") {
+          ingestOptions.maxBatchSize = subItem->second.get_value<size_t>();
+        }
+        if (subItem->first == "batchDelay") {
+          ingestOptions.maxDelay = std::chrono::milliseconds(subItem->second.get_value<size_t>());
+        }
+        if (subItem->first == "duplicateFilter") {
+          m_duplicateFilterCapacity = subItem->second.get_value<size_t>();
+        }
+        if (subItem->first == "removeChunkSize") {
+          m_removeChunkSize = subItem->second.get_value<size_t>();
+        }
       }
 
-      // Items below must not be empty
-      if (dbServer.empty()){
-        throw Error("Invalid value for \"dbServer\""
+      if (maxConnections == 0){
+        throw Error("Invalid value for \"maxConnections\""
                     " in \"publish\" section");
       }
-      if (dbName.empty()){
-        throw Error("Invalid value for \"dbName\""
+      if (dbPort == 0 || dbPort > 65535){
+        throw Error("Invalid value for \"dbPort\""
                     " in \"publish\" section");
       }
-      if (dbUser.empty()){
-        throw Error("Invalid value for \"dbUser\""
+      if (ingestOptions.maxBatchSize == 0){
+        throw Error("Invalid value for \"batchSize\""
                     " in \"publish\" section");
       }
-      if (dbPasswd.empty()){
-        throw Error("Invalid value for \"dbPasswd\""
+      if (m_removeChunkSize == 0){
+        throw Error("Invalid value for \"removeChunkSize\""
                     " in \"publish\" section");
       }
+
+      // Items below must not be empty, unless the embedded database is used
+      if (dbFile.empty()) {
+        if (dbServer.empty()){
+          throw Error("Invalid value for \"dbServer\""
+                      " in \"publish\" section");
+        }
+        if (dbName.empty()){
+          throw Error("Invalid value for \"dbName\""
+                      " in \"publish\" section");
+        }
+        if (dbUser.empty()){
+          throw Error("Invalid value for \"dbUser\""
+                      " in \"publish\" section");
+        }
+        if (dbPasswd.empty()){
+          throw Error("Invalid value for \"dbPasswd\""
+                      " in \"publish\" section");
+        }
+      }
+      else if (!hasMaxConnections) {
+        // each connection of the embedded database is opened up front, and more readers than
+        // cores only contend for the same file
+        maxConnections = std::max(std::thread::hardware_concurrency(), 1u);
+      }
     }
     else if (item->first == "sync") {
       const util::ConfigSection& synSection = item->second;
@@ -429,7 +1273,121 @@ PublishAdapter<DatabaseHandler>::onConfig(const util::ConfigSection& section,
                         " in \"publish\\sync\" section");
           }
         }
-        // todo: parse the sync_security section
+        if (subItem->first == "maxFetches") {
+          m_syncFetchOptions.maxOutstanding = subItem->second.get_value<size_t>();
+          if (m_syncFetchOptions.maxOutstanding == 0) {
+            throw Error("Invalid value for \"maxFetches\""
+                        " in \"publish\\sync\" section");
+          }
+        }
+        if (subItem->first == "maxSessionFetches") {
+          m_syncFetchOptions.maxPerSession = subItem->second.get_value<size_t>();
+          if (m_syncFetchOptions.maxPerSession == 0) {
+            throw Error("Invalid value for \"maxSessionFetches\""
+                        " in \"publish\\sync\" section");
+          }
+        }
+        if (subItem->first == "maxRetries") {
+          m_syncFetchOptions.maxRetries = subItem->second.get_value<size_t>();
+        }
+        if (subItem->first == "retryInterval") {
+          m_syncFetchOptions.initialBackoff =
+            ndn::time::milliseconds(subItem->second.get_value<size_t>());
+        }
+        if (subItem->first == "maxRetryInterval") {
+          m_syncFetchOptions.maxBackoff =
+            ndn::time::milliseconds(subItem->second.get_value<size_t>());
+        }
+        if (subItem->first == "updateDelay") {
+          m_updateBatchOptions.maxDelay =
+            ndn::time::milliseconds(subItem->second.get_value<size_t>());
+        }
+        if (subItem->first == "updateCompression") {
+          m_updateBatchOptions.canCompress = subItem->second.get_value<bool>();
+        }
+        if (subItem->first == "updateSize") {
+          m_updateBatchOptions.maxNames = subItem->second.get_value<size_t>();
+          if (m_updateBatchOptions.maxNames == 0) {
+            throw Error("Invalid value for \"updateSize\""
+                        " in \"publish\\sync\" section");
+          }
+        }
+        if (subItem->first == "sync_data_security") {
+          m_syncValidator = std::make_shared<ndn::ValidatorConfig>(m_face.get());
+          m_syncValidator->load(subItem->second, filename);
+        }
+      }
+    }
+    else if (item->first == "sessions") {
+      const util::ConfigSection& sessionsSection = item->second;
+      for (auto subItem = sessionsSection.begin();
+           subItem != sessionsSection.end();
+           ++subItem) {
+        if (subItem->first == "maxSessions") {
+          size_t maxSessions = subItem->second.get_value<size_t>();
+          if (maxSessions == 0) {
+            throw Error("Invalid value for \"maxSessions\""
+                        " in \"publish\\sessions\" section");
+          }
+          m_sessions.setMaxSessions(maxSessions);
+        }
+        if (subItem->first == "maxWindow") {
+          m_fetchOptions.maxWindow = subItem->second.get_value<size_t>();
+          if (m_fetchOptions.maxWindow == 0) {
+            throw Error("Invalid value for \"maxWindow\""
+                        " in \"publish\\sessions\" section");
+          }
+        }
+        if (subItem->first == "maxRetries") {
+          m_fetchOptions.maxRetries = subItem->second.get_value<size_t>();
+        }
+      }
+    }
+    else if (item->first == "snapshot") {
+      const util::ConfigSection& snapshotSection = item->second;
+      for (auto subItem = snapshotSection.begin();
+           subItem != snapshotSection.end();
+           ++subItem) {
+        if (subItem->first == "maxAge") {
+          m_snapshotMaxAge = std::chrono::seconds(subItem->second.get_value<size_t>());
+          if (m_snapshotMaxAge.count() == 0) {
+            throw Error("Invalid value for \"maxAge\""
+                        " in \"publish\\snapshot\" section");
+          }
+        }
+        if (subItem->first == "bootstrapThreshold") {
+          m_bootstrapThreshold = subItem->second.get_value<uint64_t>();
+        }
+      }
+    }
+    else if (item->first == "reconcile") {
+      const util::ConfigSection& reconcileSection = item->second;
+      for (auto subItem = reconcileSection.begin();
+           subItem != reconcileSection.end();
+           ++subItem) {
+        if (subItem->first == "interval") {
+          m_reconcileInterval = std::chrono::seconds(subItem->second.get_value<size_t>());
+        }
+        if (subItem->first == "silence") {
+          m_reconcileSilence = std::chrono::seconds(subItem->second.get_value<size_t>());
+        }
+        if (subItem->first == "tombstoneRetention") {
+          m_tombstoneRetention = std::chrono::seconds(subItem->second.get_value<size_t>());
+        }
+      }
+    }
+    else if (item->first == "pipeline") {
+      const util::ConfigSection& pipelineSection = item->second;
+      for (auto subItem = pipelineSection.begin();
+           subItem != pipelineSection.end();
+           ++subItem) {
+        if (subItem->first == "queueSize") {
+          queueSize = subItem->second.get_value<size_t>();
+          if (queueSize == 0) {
+            throw Error("Invalid value for \"queueSize\""
+                        " in \"publish\\pipeline\" section");
+          }
+        }
       }
     }
   }
@@ -440,76 +1398,414 @@ PublishAdapter<DatabaseHandler>::onConfig(const util::ConfigSection& section,
 
   m_syncPrefix = syncPrefix;
   util::ConnectionDetails mysqlId(dbServer, dbUser, dbPasswd, dbName);
+  mysqlId.port = dbPort;
+  mysqlId.maxConnections = maxConnections;
+  mysqlId.maxWaiting = maxWaiting;
+  mysqlId.acquireTimeout = std::chrono::milliseconds(acquireTimeout);
+  mysqlId.file = dbFile;
 
   initializeDatabase(mysqlId);
+  loadSyncProgress();
+
+  if (m_duplicateFilterCapacity > 0) {
+    // the names are written without the filter until it is loaded, the upsert leaves the ones
+    // already stored alone
+    m_duplicateFilterThread = std::thread(&PublishAdapter<DatabaseHandler>::loadDuplicateFilter,
+                                          this);
+  }
+
+  // the producers slow down once ten batches are waiting
+  ingestOptions.maxBacklog = 10 * ingestOptions.maxBatchSize;
+  m_ingestWriter.reset(new util::IngestWriter(ingestOptions,
+                                              bind(&PublishAdapter<DatabaseHandler>::writeBatch,
+                                                   this, _1),
+                                              "publish"));
+  // the sync updates are fetched at the pace the ingest pipeline keeps up with
+  m_syncFetcher.reset(new util::SyncFetcher(
+                        m_scheduler, m_syncFetchOptions,
+                        bind(&PublishAdapter<DatabaseHandler>::fetchSyncUpdate, this, _1, _2),
+                        bind(&PublishAdapter<DatabaseHandler>::onSyncProgress, this, _1, _2),
+                        "sync",
+                        bind(&PublishAdapter<DatabaseHandler>::isIngestBacklogged, this)));
+  m_updateBatcher.reset(new util::UpdateBatcher(
+                          m_scheduler, m_updateBatchOptions,
+                          [this] (const std::string& payload) {
+                            m_socket->publishData(reinterpret_cast<const uint8_t*>(
+                                                    payload.data()),
+                                                  payload.size(), ndn::time::seconds(3600));
+                          },
+                          "sync"));
+  // one thread per stage, so the updates reach the writer in the order they came in
+  m_tokenizeStage.reset(new util::PipelineStage<IngestItem>(
+                          "publish.stage.tokenize", queueSize, 1,
+                          bind(&PublishAdapter<DatabaseHandler>::tokenizeUpdate, this, _1)));
+  m_parseStage.reset(new util::PipelineStage<IngestItem>(
+                       "publish.stage.parse", queueSize, 1,
+                       bind(&PublishAdapter<DatabaseHandler>::parseUpdate, this, _1)));
+  // the names asked for by the other catalogs are read from the database on their own thread
+  m_reconcileStage.reset(new util::PipelineStage<ndn::Interest>(
+                           "publish.stage.reconcile", queueSize, 1,
+                           bind(&PublishAdapter<DatabaseHandler>::serveReconcileNames,
+                                this, _1)));
   setFilters();
+  // a catalog that joins may ask for the snapshot, or reconcile, right away
+  buildSnapshot();
+  scheduleSnapshot();
+  buildDigestTree();
+  scheduleReconcile();
 }
 
 template <typename DatabaseHandler>
 void
-PublishAdapter<DatabaseHandler>::initializeDatabase(const util::ConnectionDetails& databaseId)
+PublishAdapter<DatabaseHandler>::parseIndexes(const util::ConfigSection& section)
 {
-  //empty
+  m_isIndexManaged = true;
+  m_indexes.clear();
+
+  // the columns come from the config file, only accept the name fields
+  auto parseColumns = [this] (const std::string& value) -> std::vector<std::string> {
+    std::vector<std::string> columns;
+    std::istringstream ss(value);
+    std::string column;
+    while (std::getline(ss, column, ',')) {
+      if (std::find(m_nameFields.begin(), m_nameFields.end(), column) == m_nameFields.end()) {
+        throw Error("Unknown name field \"" + column + "\" in \"publish\\database\\indexes\""
+                    " section");
+      }
+      columns.push_back(column);
+    }
+    return columns;
+  };
+
+  for (auto item = section.begin(); item != section.end(); ++item) {
+    if (item->first == "prefix") {
+      size_t nColumns = item->second.get_value<size_t>();
+      if (nColumns == 0 || nColumns > m_nameFields.size()) {
+        throw Error("Invalid value for \"prefix\" in \"publish\\database\\indexes\" section");
+      }
+      std::vector<std::string> columns(m_nameFields.begin(), m_nameFields.begin() + nColumns);
+      m_indexes.push_back(util::IndexDefinition::fromColumns(columns));
+    }
+    else if (item->first == "single") {
+      for (const auto& column : parseColumns(item->second.get_value<std::string>())) {
+        m_indexes.push_back(util::IndexDefinition::fromColumns({column}));
+      }
+    }
+    else if (item->first == "composite") {
+      std::vector<std::string> columns = parseColumns(item->second.get_value<std::string>());
+      if (columns.empty()) {
+        throw Error("Empty value for \"composite\" in \"publish\\database\\indexes\" section");
+      }
+      m_indexes.push_back(util::IndexDefinition::fromColumns(columns));
+    }
+  }
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::provisionIndexes()
+{
+  // empty
 }
 
 template <>
 void
-PublishAdapter<ConnectionPool_T>::initializeDatabase(const util::ConnectionDetails& databaseId)
+PublishAdapter<util::DatabasePool>::provisionIndexes()
 {
-  m_databaseHandler = zdbConnectionSetup(databaseId);
+  if (!m_isIndexManaged) {
+    return;
+  }
 
-  Connection_T conn = ConnectionPool_getConnection(*m_databaseHandler);
+  // building an index reads the whole table, do not hold up the start of the catalog
+  std::shared_ptr<util::DatabasePool> pool = m_databaseHandler;
+  std::string table = m_databaseTable;
+  std::vector<util::IndexDefinition> indexes = m_indexes;
+  if (m_provisionThread.joinable()) {
+    m_provisionThread.join();
+  }
+  m_provisionThread = std::thread([pool, table, indexes] {
+      Connection_T conn = pool->acquire();
+      if (!conn) {
+        _LOG_ERROR("No available database connections, indexes are not provisioned");
+        return;
+      }
 
-  if (conn != NULL) {
+      util::TableIndexes existing;
+      std::string showIndexSql("SHOW INDEX FROM " + table + ";");
+      TRY {
+        ResultSet_T res4Index = Connection_executeQuery(conn, reinterpret_cast<const char*>(showIndexSql.c_str()), showIndexSql.size());
+        while (ResultSet_next(res4Index)) {
+          std::string indexName(ResultSet_getStringByName(res4Index, "Key_name"));
+          if (existing.empty() || existing.back().first != indexName) {
+            existing.push_back(std::make_pair(indexName, std::vector<std::string>()));
+          }
+          const char* columnName = ResultSet_getStringByName(res4Index, "Column_name");
+          existing.back().second.push_back(columnName != NULL ? columnName : "");
+        }
+      }
+      CATCH(SQLException) {
+        _LOG_ERROR(Connection_getLastError(conn));
+      }
+      END_TRY;
+
+      util::IndexChanges changes(indexes, existing);
+      if (!changes.empty()) {
+        std::string alterSql = changes.getOnlineAlterStatement(table);
+        _LOG_DEBUG("Provisioning indexes: " << alterSql);
+        TRY {
+          Connection_execute(conn, reinterpret_cast<const char*>(alterSql.c_str()), alterSql.size());
+        }
+        CATCH(SQLException) {
+          _LOG_ERROR(Connection_getLastError(conn));
+        }
+        END_TRY;
+      }
 
-    // Ignore errors (when database already exists, errors are expected)
-    std::string createSyncTable =
-      "CREATE TABLE `chronosync_update_info` (\
-       `id` int(11) NOT NULL AUTO_INCREMENT,  \
-       `session_name` varchar(1000) NOT NULL, \
-       `seq_num` int(11) NOT NULL,            \
-       PRIMARY KEY (`id`),                    \
-       UNIQUE KEY `id_UNIQUE` (`id`)          \
-       ) ENGINE=InnoDB DEFAULT CHARSET=utf8;";
-
-    // must use libzdb's try-catch style
-    TRY {
-      Connection_execute(conn,
-                         reinterpret_cast<const char*>(createSyncTable.c_str()), createSyncTable.size());
-    }
-    CATCH(SQLException) {
-      _LOG_ERROR(Connection_getLastError(conn));
-    }
-    END_TRY;
+      pool->release(conn);
+    });
+}
+
+#ifdef HAVE_MYSQL_NONBLOCKING
+template <>
+void
+PublishAdapter<util::AsyncMysqlClient>::provisionIndexes()
+{
+  if (!m_isIndexManaged) {
+    return;
+  }
+
+  // the ALTER TABLE occupies one connection of the client until the indexes are built
+  std::shared_ptr<util::AsyncMysqlClient> client = m_databaseHandler;
+  std::string table = m_databaseTable;
+  std::vector<util::IndexDefinition> indexes = m_indexes;
+  auto onError = [] (const std::string& reason) {
+    _LOG_ERROR(reason);
+  };
+  client->query("SHOW INDEX FROM " + table + ";",
+                [client, table, indexes, onError] (const util::Rows& rows) {
+                  // Key_name and Column_name are the 3rd and 5th columns
+                  util::TableIndexes existing;
+                  for (const auto& row : rows) {
+                    if (existing.empty() || existing.back().first != row[2]) {
+                      existing.push_back(std::make_pair(row[2], std::vector<std::string>()));
+                    }
+                    existing.back().second.push_back(row[4]);
+                  }
+
+                  util::IndexChanges changes(indexes, existing);
+                  if (!changes.empty()) {
+                    std::string alterSql = changes.getOnlineAlterStatement(table);
+                    _LOG_DEBUG("Provisioning indexes: " << alterSql);
+                    client->query(alterSql, util::AsyncMysqlClient::ResultCallback(), onError);
+                  }
+                },
+                onError);
+}
+#endif // HAVE_MYSQL_NONBLOCKING
 
-    // create SQL string for table creation, id, sha256, and name are columns that we need
-    std::stringstream ss;
-    ss << "CREATE TABLE `" << m_databaseTable << "` (\
-       `id` int(100) NOT NULL AUTO_INCREMENT,        \
-       `sha256` varchar(64) NOT NULL,                \
-       `name` varchar(1000) NOT NULL,";
-    for (size_t i = 0; i < m_nameFields.size(); i++) {
-      ss << "`" << m_nameFields[i] << "` varchar(100) NOT NULL, ";
+template <>
+void
+PublishAdapter<util::SqliteDatabase>::provisionIndexes()
+{
+  if (!m_isIndexManaged) {
+    return;
+  }
+
+  util::TableIndexes existing;
+  try {
+    // the name of the index is the 2nd column of index_list, the name of the column the 3rd
+    // column of index_info
+    for (const auto& index : m_databaseHandler->query("PRAGMA index_list(" +
+                                                      m_databaseTable + ");")) {
+      std::vector<std::string> columns;
+      for (const auto& column : m_databaseHandler->query("PRAGMA index_info(" + index[1] + ");")) {
+        columns.push_back(column[2]);
+      }
+      existing.push_back(std::make_pair(index[1], columns));
     }
-    ss << "`has_metadata` tinyint(1) DEFAULT NULL, ";
-    ss << "PRIMARY KEY (`id`), UNIQUE KEY `sha256` (`sha256`)\
-       ) ENGINE=InnoDB DEFAULT CHARSET=utf8;";
 
-    // must use libzdb's try-catch style
-    TRY {
-      Connection_execute(conn,
-                         reinterpret_cast<const char*>(ss.str().c_str()), ss.str().size());
+    // SQLite has no online DDL, but the embedded catalogs are small
+    util::IndexChanges changes(m_indexes, existing);
+    for (const auto& name : changes.toDrop) {
+      m_databaseHandler->execute("DROP INDEX IF EXISTS " + name + ";");
     }
-    CATCH(SQLException) {
-      _LOG_ERROR(Connection_getLastError(conn));
+    for (const auto& index : changes.toCreate) {
+      std::string createSql("CREATE INDEX IF NOT EXISTS " + index.name + " ON " +
+                            m_databaseTable + " (");
+      for (size_t i = 0; i < index.columns.size(); i++) {
+        createSql += i == 0 ? "" : ", ";
+        createSql += index.columns[i];
+      }
+      createSql += ");";
+      _LOG_DEBUG("Provisioning index: " << createSql);
+      m_databaseHandler->execute(createSql);
     }
-    END_TRY;
+  }
+  catch (const util::SqliteDatabase::Error& e) {
+    _LOG_ERROR(e.what());
+  }
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::initializeDatabase(const util::ConnectionDetails& databaseId)
+{
+  //empty
+}
+
+template <typename DatabaseHandler>
+std::vector<std::string>
+PublishAdapter<DatabaseHandler>::getCreateTableStatements()
+{
+  std::vector<std::string> statements;
+
+  std::string createSyncTable =
+    "CREATE TABLE `chronosync_update_info` (\
+     `id` int(11) NOT NULL AUTO_INCREMENT,  \
+     `session_name` varchar(1000) NOT NULL, \
+     `seq_num` int(11) NOT NULL,            \
+     PRIMARY KEY (`id`),                    \
+     UNIQUE KEY `id_UNIQUE` (`id`)          \
+     ) ENGINE=InnoDB DEFAULT CHARSET=utf8;";
+  statements.push_back(createSyncTable);
+
+  // create SQL string for table creation, id, sha256, and name are columns that we need
+  std::stringstream ss;
+  ss << "CREATE TABLE `" << m_databaseTable << "` (\
+     `id` int(100) NOT NULL AUTO_INCREMENT,        \
+     `sha256` varchar(64) NOT NULL,                \
+     `name` varchar(1000) NOT NULL,";
+  for (size_t i = 0; i < m_nameFields.size(); i++) {
+    ss << "`" << m_nameFields[i] << "` varchar(100) NOT NULL, ";
+  }
+  ss << "`has_metadata` tinyint(1) DEFAULT NULL, ";
+  ss << "PRIMARY KEY (`id`), UNIQUE KEY `sha256` (`sha256`)\
+     ) ENGINE=InnoDB DEFAULT CHARSET=utf8;";
+  statements.push_back(ss.str());
+
+  return statements;
+}
+
+template <>
+std::vector<std::string>
+PublishAdapter<util::SqliteDatabase>::getCreateTableStatements()
+{
+  std::vector<std::string> statements;
 
-    Connection_close(conn);
+  statements.push_back("CREATE TABLE IF NOT EXISTS chronosync_update_info ( \
+     id INTEGER PRIMARY KEY AUTOINCREMENT,                                  \
+     session_name TEXT NOT NULL UNIQUE,                                     \
+     seq_num INTEGER NOT NULL);");
+
+  std::stringstream ss;
+  ss << "CREATE TABLE IF NOT EXISTS " << m_databaseTable << " (\
+     id INTEGER PRIMARY KEY AUTOINCREMENT,                  \
+     sha256 TEXT NOT NULL UNIQUE,                           \
+     name TEXT NOT NULL,";
+  for (size_t i = 0; i < m_nameFields.size(); i++) {
+    ss << m_nameFields[i] << " TEXT NOT NULL, ";
+  }
+  ss << "has_metadata INTEGER DEFAULT NULL);";
+  statements.push_back(ss.str());
+
+  // the queries select on the name fields, and the removals on the name
+  statements.push_back("CREATE INDEX IF NOT EXISTS " + m_databaseTable + "_name ON " +
+                       m_databaseTable + " (name);");
+  for (size_t i = 0; i < m_nameFields.size(); i++) {
+    statements.push_back("CREATE INDEX IF NOT EXISTS " + m_databaseTable + "_" + m_nameFields[i] +
+                         " ON " + m_databaseTable + " (" + m_nameFields[i] + ");");
+  }
+
+  return statements;
+}
+
+template <>
+void
+PublishAdapter<util::DatabasePool>::initializeDatabase(const util::ConnectionDetails& databaseId)
+{
+  m_databaseHandler = std::make_shared<util::DatabasePool>(databaseId, "publish");
+
+  Connection_T conn = m_databaseHandler->acquire();
+
+  if (conn != NULL) {
+    // Ignore errors (when database already exists, errors are expected)
+    std::vector<std::string> statements = getCreateTableStatements();
+    for (size_t i = 0; i < statements.size(); i++) {
+      // must use libzdb's try-catch style
+      TRY {
+        Connection_execute(conn,
+                           reinterpret_cast<const char*>(statements[i].c_str()),
+                           statements[i].size());
+      }
+      CATCH(SQLException) {
+        _LOG_ERROR(Connection_getLastError(conn));
+      }
+      END_TRY;
+    }
+
+    m_databaseHandler->release(conn);
   }
   else {
     throw Error("cannot connect to the Database");
   }
+
+  provisionIndexes();
+}
+
+#ifdef HAVE_MYSQL_NONBLOCKING
+template <>
+void
+PublishAdapter<util::AsyncMysqlClient>::initializeDatabase(const util::ConnectionDetails& databaseId)
+{
+  m_databaseHandler = std::make_shared<util::AsyncMysqlClient>(m_face->getIoService(),
+                                                               databaseId,
+                                                               databaseId.maxConnections);
+
+  // Ignore errors (when database already exists, errors are expected); the statements run
+  // once the client is connected, connection failures are retried by the client
+  std::vector<std::string> statements = getCreateTableStatements();
+  // the statements may run on different connections, the indexes are provisioned once the
+  // table surely exists
+  std::shared_ptr<size_t> nPending = std::make_shared<size_t>(statements.size());
+  std::function<void()> onStatementDone = [this, nPending] {
+    if (--*nPending == 0) {
+      provisionIndexes();
+    }
+  };
+  for (size_t i = 0; i < statements.size(); i++) {
+    m_databaseHandler->query(statements[i],
+                             [onStatementDone] (const util::Rows&) {
+                               onStatementDone();
+                             },
+                             [onStatementDone] (const std::string& reason) {
+                               _LOG_DEBUG(reason);
+                               onStatementDone();
+                             });
+  }
+}
+#endif // HAVE_MYSQL_NONBLOCKING
+
+template <>
+void
+PublishAdapter<util::SqliteDatabase>::initializeDatabase(const util::ConnectionDetails& databaseId)
+{
+  if (databaseId.file.empty()) {
+    throw Error("Invalid value for \"dbFile\" in \"publish\" section");
+  }
+
+  try {
+    m_databaseHandler = std::make_shared<util::SqliteDatabase>(databaseId.file,
+                                                               databaseId.maxConnections);
+    std::vector<std::string> statements = getCreateTableStatements();
+    for (size_t i = 0; i < statements.size(); i++) {
+      m_databaseHandler->execute(statements[i]);
+    }
+  }
+  catch (const util::SqliteDatabase::Error& e) {
+    throw Error(std::string("cannot initialize the Database: ") + e.what());
+  }
+
+  provisionIndexes();
 }
 
 template <typename DatabaseHandler>
@@ -522,6 +1818,23 @@ PublishAdapter<DatabaseHandler>::onPublishInterest(const ndn::InterestFilter& fi
   // Example Interest : /cmip5/publish/<uri>/<nonce>
   _LOG_DEBUG(interest.getName().toUri());
 
+  ndn::Name publication = interest.getName().getSubName(m_prefix.size()+1);
+  ndn::Name publisher = publication.getPrefix(-1);
+  const ndn::name::Component& nonce = publication[-1];
+
+  //TODO: if already in catalog, what do we do?
+  // a repeated publish Interest of a session in progress is acknowledged again, and does not
+  // fetch the publication twice
+  std::shared_ptr<PublicationSession> session;
+  if (m_sessions.find(publisher, nonce) == nullptr) {
+    session = m_sessions.insert(publisher, nonce);
+    if (session == nullptr) {
+      // without the ACK, the publisher tries again later
+      _LOG_ERROR("Too many publications in progress, turning down " << publication);
+      return;
+    }
+  }
+
   //send back ACK
   char buf[] = "ACK";
   std::shared_ptr<ndn::Data> data = std::make_shared<ndn::Data>(interest.getName());
@@ -532,46 +1845,95 @@ PublishAdapter<DatabaseHandler>::onPublishInterest(const ndn::InterestFilter& fi
 
   _LOG_DEBUG("Ack interest : " << interest.getName().toUri());
 
+  if (session == nullptr) {
+    _LOG_DEBUG("Already fetching " << publication);
+    return;
+  }
 
-  //TODO: if already in catalog, what do we do?
   //ask for content
-  ndn::Name interestStr = interest.getName().getSubName(m_prefix.size()+1);
-  size_t m_nextSegment = 0;
-  std::shared_ptr<ndn::Interest> retrieveInterest =
-    std::make_shared<ndn::Interest>(interestStr.appendSegment(m_nextSegment));
-  retrieveInterest->setInterestLifetime(ndn::time::milliseconds(4000));
-  retrieveInterest->setMustBeFresh(m_mustBeFresh);
-  m_face->expressInterest(*retrieveInterest,
-                          bind(&PublishAdapter<DatabaseHandler>::onPublishedData,
-                               this,_1, _2),
-                          bind(&publish::PublishAdapter<DatabaseHandler>::onTimeout, this, _1));
-
-  _LOG_DEBUG("Expressing Interest " << retrieveInterest->toUri());
+  session->fetcher =
+    util::PipelinedFetcher::fetch(*m_face, m_scheduler, publication, m_fetchOptions,
+                                  bind(&PublishAdapter<DatabaseHandler>::onSessionSegment,
+                                       this, publisher, nonce, _1),
+                                  bind(&PublishAdapter<DatabaseHandler>::closeSession,
+                                       this, publisher, nonce, std::string()),
+                                  bind(&PublishAdapter<DatabaseHandler>::closeSession,
+                                       this, publisher, nonce, _1),
+                                  // the ingest cannot keep up, fetch more once the pending
+                                  // updates are processed
+                                  [this] { return isIngestBacklogged(); });
+
   _LOG_DEBUG("<< PublishAdapter::onPublishInterest");
 }
 
 template <typename DatabaseHandler>
 void
-PublishAdapter<DatabaseHandler>::onTimeout(const ndn::Interest& interest)
+PublishAdapter<DatabaseHandler>::onSessionSegment(const ndn::Name& publisher,
+                                                  const ndn::name::Component& nonce,
+                                                  const ndn::Data& data)
 {
-  _LOG_ERROR(interest.getName() << "timed out");
+  std::shared_ptr<PublicationSession> session = m_sessions.find(publisher, nonce);
+  if (session != nullptr) {
+    session->nSegments++;
+    session->nBytes += data.getContent().value_size();
+  }
+  util::MetricsRegistry::getDefault().get("publish.segments").add();
+
+  onPublishedData(data);
 }
 
 template <typename DatabaseHandler>
 void
-PublishAdapter<DatabaseHandler>::onValidationFailed(const std::shared_ptr<const ndn::Data>& data,
-                                                    const std::string& failureInfo)
+PublishAdapter<DatabaseHandler>::closeSession(const ndn::Name& publisher,
+                                              const ndn::name::Component& nonce,
+                                              const std::string& reason)
 {
-  _LOG_ERROR(data->getName() << " validation failed: " << failureInfo);
+  std::shared_ptr<PublicationSession> session = m_sessions.find(publisher, nonce);
+  if (session == nullptr) {
+    return;
+  }
+
+  int64_t duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - session->startTime).count();
+  uint64_t nRetransmissions = session->fetcher->getNRetransmissions();
+  util::MetricsRegistry::getDefault().get("publish.retransmissions").add(nRetransmissions);
+
+  if (reason.empty()) {
+    util::MetricsRegistry::getDefault().get("publish.sessions.completed").add();
+    _LOG_DEBUG("Fetched " << session->getName() << ": " << session->nSegments << " segments, "
+               << session->nBytes << " bytes, " << nRetransmissions << " retransmissions in "
+               << duration << " ms");
+  }
+  else {
+    util::MetricsRegistry::getDefault().get("publish.sessions.failed").add();
+    _LOG_ERROR("Cannot fetch " << session->getName() << " after " << session->nSegments
+               << " segments: " << reason);
+  }
+  m_sessions.erase(publisher, nonce);
 }
 
 template <typename DatabaseHandler>
 void
-PublishAdapter<DatabaseHandler>::onPublishedData(const ndn::Interest& interest,
-                                                 const ndn::Data& data)
+PublishAdapter<DatabaseHandler>::onTimeout(const ndn::Interest& interest)
 {
-  _LOG_DEBUG(">> PublishAdapter::onPublishedData");
-  _LOG_DEBUG("Recv data : " << data.getName());
+  _LOG_ERROR(interest.getName() << "timed out");
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::onValidationFailed(const std::shared_ptr<const ndn::Data>& data,
+                                                    const std::string& failureInfo)
+{
+  _LOG_ERROR(data->getName() << " validation failed: " << failureInfo);
+  util::MetricsRegistry::getDefault().get("publish.stage.verify.failed").add();
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::onPublishedData(const ndn::Data& data)
+{
+  _LOG_DEBUG(">> PublishAdapter::onPublishedData");
+  _LOG_DEBUG("Recv data : " << data.getName());
   if (data.getContent().empty()) {
     return;
   }
@@ -588,395 +1950,1793 @@ PublishAdapter<DatabaseHandler>::onPublishedData(const ndn::Interest& interest,
 
 template <typename DatabaseHandler>
 void
-PublishAdapter<DatabaseHandler>::validatePublishedDataPaylod(const std::shared_ptr<const ndn::Data>& data)
+PublishAdapter<DatabaseHandler>::validatePublishedDataPaylod(const std::shared_ptr<const ndn::Data>& data)
+{
+  _LOG_DEBUG(">> PublishAdapter::onValidatePublishedDataPayload");
+  util::MetricsRegistry::getDefault().get("publish.stage.verify.processed").add();
+
+  // the payload is checked by the parse stage, which then announces it through sync
+  pushToParseStage(IngestItem{data, true, nullptr, std::string(), 0});
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::processUpdateData(const std::shared_ptr<const ndn::Data>& data)
+{
+  _LOG_DEBUG(">> PublishAdapter::processUpdateData");
+  pushToParseStage(IngestItem{data, false, nullptr, std::string(), 0});
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::pushToParseStage(IngestItem item)
+{
+  // the Face thread must not wait for the stage; the fetchers pause before it is full, so the
+  // backlog only takes the few updates already on their way
+  if (m_parseBacklog.empty() && m_parseStage->tryPush(item)) {
+    return;
+  }
+  m_parseBacklog.push_back(std::move(item));
+  m_nParseBacklog = m_parseBacklog.size();
+  if (m_parseBacklog.size() == 1) {
+    m_scheduler.scheduleEvent(ndn::time::milliseconds(WRITE_RETRY_INTERVAL_MS),
+                              [this] { drainParseBacklog(); });
+  }
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::drainParseBacklog()
+{
+  while (!m_parseBacklog.empty() && m_parseStage->tryPush(m_parseBacklog.front())) {
+    m_parseBacklog.pop_front();
+  }
+  m_nParseBacklog = m_parseBacklog.size();
+  if (!m_parseBacklog.empty()) {
+    m_scheduler.scheduleEvent(ndn::time::milliseconds(WRITE_RETRY_INTERVAL_MS),
+                              [this] { drainParseBacklog(); });
+  }
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::postToFace(const std::function<void()>& function)
+{
+  std::weak_ptr<PublishAdapter> self = m_self;
+  m_face->getIoService().post([self, function] {
+      if (!self.expired()) {
+        function();
+      }
+    });
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::parseUpdate(IngestItem& item)
+{
+  if (!item.data) {
+    m_tokenizeStage->push(std::move(item));
+    return;
+  }
+
+  std::string payload(reinterpret_cast<const char*>(item.data->getContent().value()),
+                      item.data->getContent().value_size());
+
+  if (payload.length() <= 0) {
+    return;
+  }
+
+  // the large updates of other catalogs are compressed
+  if (!item.isPublication && util::isCompressed(payload)) {
+    try {
+      payload = util::decompress(payload);
+    }
+    catch (const util::CompressionError& e) {
+      _LOG_ERROR("Fail to decompress the update data " << item.data->getName() << ": "
+                 << e.what());
+      return;
+    }
+  }
+
+  // the data payload must be JSON format
+  //    http://redmine.named-data.net/projects/ndn-atmos/wiki/Sync
+  item.changes = std::make_shared<Json::Value>();
+  Json::Reader jsonReader;
+  if (!jsonReader.parse(payload, *item.changes)) {
+    // todo: logging events
+    _LOG_DEBUG("Fail to parse the update data " << item.data->getName());
+    return;
+  }
+
+  if (item.isPublication) {
+    // validate published data payload, if failed, return
+    if (!checkPublicationChanges(item.data->getName(), *item.changes)) {
+      _LOG_ERROR("Data validation failed : " << item.data->getName());
+      _LOG_DEBUG(payload);
+      return;
+    }
+
+    // the changes are announced with those of the other publications validated meanwhile;
+    // ChronoSync runs on the Face thread
+    std::shared_ptr<std::vector<std::string>> added = std::make_shared<std::vector<std::string>>();
+    std::shared_ptr<std::vector<std::string>> removed =
+      std::make_shared<std::vector<std::string>>();
+    json2Names(*item.changes, util::ADD, *added);
+    json2Names(*item.changes, util::REMOVE, *removed);
+    postToFace([this, added, removed] {
+        // in the order the local table applies them
+        for (const auto& name : *added) {
+          m_updateBatcher->add(name);
+        }
+        for (const auto& name : *removed) {
+          m_updateBatcher->remove(name);
+        }
+      });
+  }
+
+  m_tokenizeStage->push(std::move(item));
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::tokenizeUpdate(IngestItem& item)
+{
+  if (!item.data) {
+    m_ingestWriter->setProgress(item.syncSession, item.syncSeq);
+    return;
+  }
+
+  // the writer folds the updates into batches, in the order they come in: the additions of
+  // this Data, then its removals
+  std::vector<std::string> names;
+  if (json2Names(*item.changes, util::ADD, names)) {
+    addNames(names);
+  }
+
+  names.clear();
+  if (json2Names(*item.changes, util::REMOVE, names)) {
+    // the rows are deleted by their sha256, which is indexed
+    std::vector<util::ValueRef> refs;
+    for (const auto& name : names) {
+      refs.push_back(util::ValueRef{name.data(), name.size()});
+    }
+    std::string digests(refs.size() * SHA256_HEX_SIZE, '0');
+    util::sha256HexBatch(refs.data(), refs.size(), &digests[0]);
+    for (size_t i = 0; i < names.size(); ++i) {
+      removeName(names[i], digests.substr(i * SHA256_HEX_SIZE, SHA256_HEX_SIZE));
+    }
+  }
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::addNames(const std::vector<std::string>& names,
+                                          std::vector<uint64_t>* keys)
+{
+  std::vector<util::ValueRef> fields;
+  std::vector<util::ValueRef> validNames;
+  for (const auto& name : names) {
+    fields.clear();
+    if (!splitName(name, fields)) {
+      _LOG_ERROR("Malformed file name " << name);
+      continue;
+    }
+    validNames.push_back(util::ValueRef{name.data(), name.size()});
+  }
+
+  // all names are hashed in one go
+  std::string digests(validNames.size() * SHA256_HEX_SIZE, '0');
+  util::sha256HexBatch(validNames.data(), validNames.size(), &digests[0]);
+  for (size_t i = 0; i < validNames.size(); ++i) {
+    m_ingestWriter->add(std::string(validNames[i].data, validNames[i].size),
+                        digests.substr(i * SHA256_HEX_SIZE, SHA256_HEX_SIZE));
+    if (keys != nullptr) {
+      keys->push_back(util::sha256HexKey(&digests[i * SHA256_HEX_SIZE]));
+    }
+  }
+}
+
+template <typename DatabaseHandler>
+bool
+PublishAdapter<DatabaseHandler>::isIngestBacklogged() const
+{
+  return m_nParseBacklog > 0 || m_parseStage->isBacklogged() ||
+         m_tokenizeStage->isBacklogged() || m_ingestWriter->isBacklogged();
+}
+
+template <typename DatabaseHandler>
+std::string
+PublishAdapter<DatabaseHandler>::digestName(const std::string& fileName)
+{
+  return util::sha256Hex(fileName);
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::loadSyncProgress()
+{
+  util::Rows rows;
+  if (queryDatabase("SELECT session_name, seq_num FROM chronosync_update_info", rows)) {
+    storeSyncProgress(rows);
+  }
+}
+
+#ifdef HAVE_MYSQL_NONBLOCKING
+template <>
+void
+PublishAdapter<util::AsyncMysqlClient>::loadSyncProgress()
+{
+  // the Face thread, which runs the statements, is not started yet; a session that announces
+  // updates before the rows come in is fetched from its first update, which is harmless
+  m_databaseHandler->query("SELECT session_name, seq_num FROM chronosync_update_info",
+                           bind(&PublishAdapter<util::AsyncMysqlClient>::storeSyncProgress,
+                                this, _1),
+                           [] (const std::string& reason) {
+                             _LOG_ERROR(reason);
+                           });
+}
+#endif // HAVE_MYSQL_NONBLOCKING
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::storeSyncProgress(const util::Rows& rows)
+{
+  for (const auto& row : rows) {
+    chronosync::SeqNo& seqNo = m_storedSyncSeqNos[ndn::Name(row[0])];
+    seqNo = std::max<chronosync::SeqNo>(seqNo, std::strtoull(row[1].c_str(), nullptr, 10));
+  }
+  _LOG_DEBUG("Loaded the progress of " << m_storedSyncSeqNos.size() << " sync sessions");
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::fetchSyncUpdate(const ndn::Name& session, chronosync::SeqNo seq)
+{
+  _LOG_DEBUG("Interest for [" << session << ":" << seq << "]");
+
+  // the sync fetcher tries again with a backoff, rather than ChronoSync right away
+  m_socket->fetchData(session, seq,
+                      [this, session, seq] (const std::shared_ptr<const ndn::Data>& data) {
+                        processUpdateData(data);
+                        m_syncFetcher->onFetched(session, seq);
+                      },
+                      [this, session, seq] (const std::shared_ptr<const ndn::Data>& data,
+                                            const std::string& failureInfo) {
+                        // invalid Data would be invalid again, it is not fetched again
+                        onValidationFailed(data, failureInfo);
+                        m_syncFetcher->onFetched(session, seq);
+                      },
+                      [this, session, seq] (const ndn::Interest& interest) {
+                        onFetchUpdateDataTimeout(interest);
+                        m_syncFetcher->onFailed(session, seq);
+                      },
+                      0);
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::onSyncProgress(const ndn::Name& session, chronosync::SeqNo seq)
+{
+  // the updates are committed once the marker reaches the ingest writer behind them
+  pushToParseStage(IngestItem{nullptr, false, nullptr, session.toUri(), seq});
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::onFetchUpdateDataTimeout(const ndn::Interest& interest)
+{
+  _LOG_DEBUG("UpdateData retrieval timed out: " << interest.getName());
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::processSyncUpdate(const std::vector<chronosync::MissingDataInfo>&
+                                                   updates)
+{
+  _LOG_DEBUG(">> PublishAdapter::processSyncUpdate");
+
+  if (updates.empty()) {
+    return;
+  }
+
+  // a catalog that misses many updates when it first hears from the others, e.g., a new one,
+  // loads the table of one of them instead
+  if (!m_isBootstrapChecked) {
+    m_isBootstrapChecked = true;
+    if (m_bootstrapThreshold > 0 && countMissingUpdates(updates) > m_bootstrapThreshold) {
+      if (m_syncValidator != nullptr) {
+        startBootstrap(updates);
+      }
+      else {
+        _LOG_ERROR("No snapshot is loaded without the sync_data_security section, the updates"
+                   " are fetched one by one");
+      }
+    }
+  }
+  if (m_isBootstrapping) {
+    m_pendingSyncUpdates.insert(m_pendingSyncUpdates.end(), updates.begin(), updates.end());
+    return;
+  }
+
+  // a catalog heard again after a while, e.g., once a partition heals, may have missed updates
+  // that are no longer announced
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  for (const auto& update : updates) {
+    auto heard = m_syncLastHeard.find(update.session);
+    if (heard != m_syncLastHeard.end() && m_reconcileSilence.count() > 0 &&
+        now - heard->second > m_reconcileSilence) {
+      reconcile(update.session);
+    }
+    m_syncLastHeard[update.session] = now;
+  }
+
+  // multiple updates from different catalog are possible
+  for (size_t i = 0; i < updates.size(); ++i) {
+    // for a session not seen since the catalog started, only fetch the updates past the ones
+    // written before; the sync fetcher tracks the others
+    chronosync::SeqNo localSeqNo = 0;
+    if (!m_syncFetcher->hasSession(updates[i].session)) {
+      auto stored = m_storedSyncSeqNos.find(updates[i].session);
+      if (stored != m_storedSyncSeqNos.end()) {
+        localSeqNo = stored->second;
+      }
+    }
+    // the progress is saved in the local DB with the updates it covers, so that a gap left
+    // when this node reboots is fetched again
+    m_syncFetcher->addMissing(updates[i].session, updates[i].low, updates[i].high, localSeqNo);
+  }
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::onSnapshotInterest(const ndn::InterestFilter& filter,
+                                                    const ndn::Interest& interest)
+{
+  _LOG_DEBUG(">> PublishAdapter::onSnapshotInterest " << interest.getName());
+
+  // the table is being loaded from the snapshot of another catalog
+  if (m_isBootstrapping) {
+    return;
+  }
+
+  if (m_snapshotContent == nullptr) {
+    // the first snapshot is being built, the catalog that joins asks again
+    return;
+  }
+
+  const ndn::Name& name = interest.getName();
+  uint64_t segment = 0;
+  if (name.size() > filter.getPrefix().size()) {
+    // the segments of a snapshot that is no longer served are not answered, the catalog that
+    // fetches it gives up and fetches the sync updates instead
+    if (name.size() != m_snapshotName.size() + 1 || !m_snapshotName.isPrefixOf(name) ||
+        !name[-1].isSegment()) {
+      return;
+    }
+    segment = name[-1].toSegment();
+  }
+  if (segment >= m_snapshotSegments.size()) {
+    return;
+  }
+
+  std::shared_ptr<ndn::Data>& data = m_snapshotSegments[segment];
+  if (data == nullptr) {
+    const std::string& content = (*m_snapshotContent)[segment];
+    data = std::make_shared<ndn::Data>(ndn::Name(m_snapshotName).appendSegment(segment));
+    data->setFreshnessPeriod(ndn::time::seconds(10));
+    data->setContent(reinterpret_cast<const uint8_t*>(content.data()), content.size());
+    data->setFinalBlockId(ndn::name::Component::fromSegment(m_snapshotSegments.size() - 1));
+    signData(*data);
+  }
+  m_face->put(*data);
+  util::MetricsRegistry::getDefault().get("publish.snapshot.served").add();
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::buildSnapshot()
+{
+  // the table is built again once the bootstrap ends
+  if (m_isBuildingSnapshot || m_isBootstrapping) {
+    return;
+  }
+  m_isBuildingSnapshot = true;
+  m_isSnapshotOutdated = false;
+  if (m_snapshotThread.joinable()) {
+    m_snapshotThread.join();
+  }
+
+  // the table is read on its own thread, the snapshot is then served from the Face thread
+  m_snapshotThread = std::thread([this] {
+      std::shared_ptr<std::vector<std::string>> content =
+        std::make_shared<std::vector<std::string>>();
+      try {
+        if (!readSnapshot(*content)) {
+          content.reset();
+        }
+      }
+      catch (const util::CompressionError& e) {
+        _LOG_ERROR(e.what());
+        content.reset();
+      }
+      postToFace([this, content] {
+          onSnapshotBuilt(content);
+        });
+    });
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::scheduleSnapshot()
+{
+  m_scheduler.scheduleEvent(ndn::time::seconds(m_snapshotMaxAge.count()), [this] {
+      buildSnapshot();
+      scheduleSnapshot();
+    });
+}
+
+template <typename DatabaseHandler>
+bool
+PublishAdapter<DatabaseHandler>::readSnapshot(std::vector<std::string>& segments)
+{
+  // the updates written after the vector is read may be in the snapshot, they are fetched
+  // again by the catalog that loads it, which is harmless
+  util::Rows rows;
+  if (!queryDatabase("SELECT session_name, seq_num FROM chronosync_update_info", rows)) {
+    return false;
+  }
+  util::TableSnapshot::SessionVector vector;
+  for (const auto& row : rows) {
+    uint64_t& seqNo = vector[row[0]];
+    seqNo = std::max<uint64_t>(seqNo, std::strtoull(row[1].c_str(), nullptr, 10));
+  }
+
+  // by pages of ids, so that the table is not locked while the snapshot is read
+  util::TableSnapshot::Writer writer(vector);
+  std::string output;
+  std::string lastId = "0";
+  while (!m_isClosing) {
+    rows.clear();
+    if (!queryDatabase("SELECT id, name FROM " + m_databaseTable + " WHERE id > " + lastId +
+                       " ORDER BY id LIMIT " + std::to_string(SNAPSHOT_QUERY_SIZE), rows)) {
+      return false;
+    }
+    for (const auto& row : rows) {
+      writer.addName(row[1]);
+    }
+    bool isLastPage = rows.size() < SNAPSHOT_QUERY_SIZE;
+    if (isLastPage) {
+      writer.finish();
+    }
+
+    output.append(writer.takeOutput());
+    while (output.size() >= SNAPSHOT_SEGMENT_SIZE) {
+      segments.push_back(output.substr(0, SNAPSHOT_SEGMENT_SIZE));
+      output.erase(0, SNAPSHOT_SEGMENT_SIZE);
+    }
+    if (isLastPage) {
+      if (!output.empty() || segments.empty()) {
+        segments.push_back(output);
+      }
+      return true;
+    }
+    lastId = rows.back()[0];
+  }
+  return false;
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::onSnapshotBuilt(
+  const std::shared_ptr<const std::vector<std::string>>& content)
+{
+  m_isBuildingSnapshot = false;
+  if (m_isSnapshotOutdated) {
+    // not while the bootstrap runs, it builds the snapshot once it ends
+    buildSnapshot();
+    return;
+  }
+  if (content == nullptr) {
+    _LOG_ERROR("Cannot read the table snapshot");
+    m_scheduler.scheduleEvent(ndn::time::seconds(SNAPSHOT_RETRY_INTERVAL_S),
+                              bind(&PublishAdapter<DatabaseHandler>::buildSnapshot, this));
+    return;
+  }
+
+  size_t nBytes = 0;
+  for (const auto& segment : *content) {
+    nBytes += segment.size();
+  }
+  m_snapshotName = ndn::Name(m_prefix).append("snapshot").append(m_catalogId).appendVersion();
+  m_snapshotContent = content;
+  m_snapshotSegments.assign(content->size(), nullptr);
+  util::MetricsRegistry::getDefault().get("publish.snapshot.builds").add();
+  util::MetricsRegistry::getDefault().get("publish.snapshot.bytes").set(nBytes);
+  _LOG_DEBUG("Built " << m_snapshotName << ", " << nBytes << " bytes");
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::signData(ndn::Data& data)
+{
+  if (m_signingId.empty())
+    m_keyChain->sign(data);
+  else {
+    ndn::Name keyName = m_keyChain->getDefaultKeyNameForIdentity(m_signingId);
+    ndn::Name certName = m_keyChain->getDefaultCertificateNameForKey(keyName);
+    m_keyChain->sign(data, certName);
+  }
+}
+
+template <typename DatabaseHandler>
+uint64_t
+PublishAdapter<DatabaseHandler>::countMissingUpdates(
+  const std::vector<chronosync::MissingDataInfo>& updates) const
+{
+  uint64_t nMissing = 0;
+  for (const auto& update : updates) {
+    chronosync::SeqNo low = update.low;
+    auto stored = m_storedSyncSeqNos.find(update.session);
+    if (stored != m_storedSyncSeqNos.end()) {
+      low = std::max(low, stored->second + 1);
+    }
+    if (update.high >= low) {
+      nMissing += update.high - low + 1;
+    }
+  }
+  return nMissing;
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::startBootstrap(
+  const std::vector<chronosync::MissingDataInfo>& updates)
+{
+  // the catalog with the most updates
+  const chronosync::MissingDataInfo* peer = &updates.front();
+  for (const auto& update : updates) {
+    if (update.high - update.low > peer->high - peer->low) {
+      peer = &update;
+    }
+  }
+  ndn::Name snapshotPrefix = getPeerPrefix(peer->session, "snapshot");
+  if (snapshotPrefix.empty()) {
+    return;
+  }
+
+  _LOG_DEBUG("Bootstrap from " << snapshotPrefix);
+  util::MetricsRegistry::getDefault().get("publish.snapshot.bootstraps").add();
+  m_isBootstrapping = true;
+  // a snapshot being built reads the table as it is replaced
+  m_isSnapshotOutdated = m_isBuildingSnapshot;
+
+  // the rows that the peer deleted meanwhile are found among the ones the table has now
+  m_bootstrapThread = std::thread([this, snapshotPrefix] {
+      std::shared_ptr<std::vector<uint64_t>> keys = std::make_shared<std::vector<uint64_t>>();
+      if (readDigests(*keys)) {
+        std::sort(keys->begin(), keys->end());
+      }
+      else {
+        keys.reset();
+      }
+      postToFace([this, snapshotPrefix, keys] {
+          if (m_bootstrapThread.joinable()) {
+            m_bootstrapThread.join();
+          }
+          if (keys == nullptr) {
+            abortBootstrap("Cannot read the digests of the table");
+            return;
+          }
+          m_bootstrapKeys.swap(*keys);
+          m_isBootstrapKeySeen.assign(m_bootstrapKeys.size(), false);
+          requestSnapshot(snapshotPrefix, 0);
+        });
+    });
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::requestSnapshot(const ndn::Name& snapshotPrefix, size_t nTries)
+{
+  // the first segment tells the version of the snapshot the peer serves
+  ndn::Interest interest(snapshotPrefix);
+  interest.setMustBeFresh(true);
+  m_face->expressInterest(interest,
+                          [this] (const ndn::Interest& interest, const ndn::Data& data) {
+                            if (m_isClosing) {
+                              return;
+                            }
+                            fetchSnapshot(data.getName().getPrefix(-1));
+                          },
+                          [this, nTries] (const ndn::Interest& interest) {
+                            if (nTries + 1 >= BOOTSTRAP_MAX_TRIES) {
+                              abortBootstrap("No table snapshot under " +
+                                             interest.getName().toUri());
+                              return;
+                            }
+                            // the peer may still be building its first snapshot
+                            ndn::time::seconds delay(std::min<int>(BOOTSTRAP_MAX_RETRY_INTERVAL_S,
+                                                                   1 << nTries));
+                            m_scheduler.scheduleEvent(delay,
+                                                      bind(&PublishAdapter<DatabaseHandler>::
+                                                             requestSnapshot,
+                                                           this, interest.getName(), nTries + 1));
+                          });
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::fetchSnapshot(const ndn::Name& versionName)
+{
+  m_snapshotReader.reset(new util::TableSnapshot::Reader);
+  m_validatedSegments.clear();
+  m_nextSnapshotSegment = 0;
+  m_nFetchedSegments = 0;
+  m_isSnapshotFetched = false;
+  m_nSnapshotNames = 0;
+
+  m_snapshotFetcher = util::PipelinedFetcher::fetch(
+    *m_face, m_scheduler, versionName, m_fetchOptions,
+    [this] (const ndn::Data& segment) {
+      ++m_nFetchedSegments;
+      // the segments are decoded in order, whatever order they are validated in
+      m_syncValidator->validate(segment,
+                                [this] (const std::shared_ptr<const ndn::Data>& data) {
+                                  if (m_snapshotReader == nullptr) {
+                                    return;
+                                  }
+                                  m_validatedSegments[data->getName()[-1].toSegment()] = data;
+                                  loadSnapshotSegments();
+                                },
+                                [this] (const std::shared_ptr<const ndn::Data>& data,
+                                        const std::string& reason) {
+                                  if (m_snapshotReader == nullptr) {
+                                    return;
+                                  }
+                                  abortBootstrap("Invalid snapshot segment " +
+                                                 data->getName().toUri() + ": " + reason);
+                                });
+    },
+    [this] {
+      m_snapshotFetcher.reset();
+      m_isSnapshotFetched = true;
+      loadSnapshotSegments();
+    },
+    [this] (const std::string& reason) {
+      abortBootstrap("Cannot fetch the table snapshot: " + reason);
+    },
+    bind(&PublishAdapter<DatabaseHandler>::isIngestBacklogged, this));
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::loadSnapshotSegments()
+{
+  // the names of a segment are handed over at once, the fetcher waits while the ingest
+  // pipeline is backlogged
+  auto it = m_validatedSegments.begin();
+  while (it != m_validatedSegments.end() && it->first == m_nextSnapshotSegment) {
+    const ndn::Block& content = it->second->getContent();
+    std::vector<std::string> names;
+    try {
+      m_snapshotReader->write(reinterpret_cast<const char*>(content.value()),
+                              content.value_size());
+      names = m_snapshotReader->takeNames();
+    }
+    catch (const util::TableSnapshot::Error& e) {
+      abortBootstrap(std::string("Cannot load the table snapshot: ") + e.what());
+      return;
+    }
+    it = m_validatedSegments.erase(it);
+    ++m_nextSnapshotSegment;
+
+    std::vector<uint64_t> keys;
+    addNames(names, &keys);
+    for (uint64_t key : keys) {
+      auto range = std::equal_range(m_bootstrapKeys.begin(), m_bootstrapKeys.end(), key);
+      for (auto seen = range.first; seen != range.second; ++seen) {
+        m_isBootstrapKeySeen[seen - m_bootstrapKeys.begin()] = true;
+      }
+    }
+    m_nSnapshotNames += names.size();
+  }
+
+  if (!m_isSnapshotFetched || m_nextSnapshotSegment < m_nFetchedSegments) {
+    return;
+  }
+  try {
+    m_snapshotReader->finish();
+  }
+  catch (const util::TableSnapshot::Error& e) {
+    abortBootstrap(std::string("Cannot load the table snapshot: ") + e.what());
+    return;
+  }
+  util::MetricsRegistry::getDefault().get("publish.snapshot.loadedNames").add(m_nSnapshotNames);
+  _LOG_DEBUG("Loaded " << m_nSnapshotNames << " names from the table snapshot");
+
+  util::TableSnapshot::SessionVector vector = m_snapshotReader->getVector();
+  m_snapshotReader.reset();
+  m_bootstrapThread = std::thread(&PublishAdapter<DatabaseHandler>::removeDeletedRows,
+                                  this, vector);
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::removeDeletedRows(
+  const util::TableSnapshot::SessionVector& vector)
+{
+  // the deletions are written after the names of the snapshot, a row the snapshot has is kept
+  uint64_t nRemoved = 0;
+  std::string lastId = "0";
+  bool isDone = std::find(m_isBootstrapKeySeen.begin(), m_isBootstrapKeySeen.end(), false) ==
+                m_isBootstrapKeySeen.end();
+  while (!isDone && !m_isClosing) {
+    util::Rows rows;
+    if (!queryDatabase("SELECT id, sha256, name FROM " + m_databaseTable + " WHERE id > " +
+                       lastId + " ORDER BY id LIMIT " + std::to_string(SNAPSHOT_QUERY_SIZE),
+                       rows)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(WRITE_RETRY_INTERVAL_MS));
+      continue;
+    }
+    for (const auto& row : rows) {
+      if (row[1].size() < 16) {
+        continue;
+      }
+      // the rows written since the digests were read are not among them
+      uint64_t key = util::sha256HexKey(row[1].data());
+      auto found = std::lower_bound(m_bootstrapKeys.begin(), m_bootstrapKeys.end(), key);
+      if (found == m_bootstrapKeys.end() || *found != key ||
+          m_isBootstrapKeySeen[found - m_bootstrapKeys.begin()]) {
+        continue;
+      }
+      while (m_ingestWriter->isBacklogged() && !m_isClosing) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(WRITE_RETRY_INTERVAL_MS));
+      }
+      removeName(row[2], row[1]);
+      ++nRemoved;
+    }
+    isDone = rows.size() < SNAPSHOT_QUERY_SIZE;
+    if (!rows.empty()) {
+      lastId = rows.back()[0];
+    }
+  }
+  if (m_isClosing) {
+    return;
+  }
+  util::MetricsRegistry::getDefault().get("publish.snapshot.removedNames").add(nRemoved);
+  _LOG_DEBUG("Removed " << nRemoved << " names the table snapshot does not have");
+
+  postToFace([this, vector] {
+      finishBootstrap(true, vector);
+    });
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::abortBootstrap(const std::string& reason)
+{
+  _LOG_ERROR(reason);
+  if (m_snapshotFetcher != nullptr) {
+    m_snapshotFetcher->stop();
+    m_snapshotFetcher.reset();
+  }
+  m_snapshotReader.reset();
+  m_validatedSegments.clear();
+  finishBootstrap(false, util::TableSnapshot::SessionVector());
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::finishBootstrap(bool isLoaded,
+                                                 const util::TableSnapshot::SessionVector& vector)
+{
+  if (m_bootstrapThread.joinable()) {
+    m_bootstrapThread.join();
+  }
+  std::vector<uint64_t>().swap(m_bootstrapKeys);
+  std::vector<bool>().swap(m_isBootstrapKeySeen);
+
+  if (!isLoaded) {
+    util::MetricsRegistry::getDefault().get("publish.snapshot.bootstraps.failed").add();
+  }
+  else {
+    // the table now holds the snapshot, the updates past its vector are fetched as those of a
+    // catalog that restarted, including the ones the table had applied before
+    for (auto& stored : m_storedSyncSeqNos) {
+      if (vector.count(stored.first.toUri()) == 0 && stored.second > 0) {
+        stored.second = 0;
+        m_ingestWriter->setProgress(stored.first.toUri(), 0);
+      }
+    }
+    for (const auto& session : vector) {
+      m_storedSyncSeqNos[ndn::Name(session.first)] = session.second;
+      m_ingestWriter->setProgress(session.first, session.second);
+    }
+  }
+
+  m_isBootstrapping = false;
+  buildSnapshot();
+  std::vector<chronosync::MissingDataInfo> updates;
+  updates.swap(m_pendingSyncUpdates);
+  processSyncUpdate(updates);
+}
+
+template <typename DatabaseHandler>
+ndn::Name
+PublishAdapter<DatabaseHandler>::getPeerPrefix(const ndn::Name& session,
+                                               const std::string& service)
+{
+  // the session of a catalog is <prefix>/sync/<catalogId>/<session number>
+  if (session.size() < 3) {
+    return ndn::Name();
+  }
+  return ndn::Name(session.getPrefix(-3)).append(service).append(session.get(-2));
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::onReconcileInterest(const ndn::InterestFilter& filter,
+                                                     const ndn::Interest& interest)
+{
+  _LOG_DEBUG(">> PublishAdapter::onReconcileInterest " << interest.getName());
+
+  // the table is being loaded from the snapshot of another catalog
+  if (m_isBootstrapping) {
+    return;
+  }
+
+  const ndn::Name& name = interest.getName();
+  size_t base = filter.getPrefix().size();
+  if (name.size() <= base || name.size() > base + 2) {
+    return;
+  }
+  std::string kind = name[base].toUri();
+  std::string hexPrefix = name.size() > base + 1 ? name[base + 1].toUri() : std::string();
+
+  if (kind == "names") {
+    // the other catalog asks again if the names cannot be read soon
+    if (!hexPrefix.empty() && !m_reconcileStage->isBacklogged()) {
+      m_reconcileStage->push(interest);
+    }
+    return;
+  }
+  if (kind != "nodes") {
+    return;
+  }
+
+  if (m_digestTree == nullptr || std::chrono::steady_clock::now() - m_digestTreeTime >
+                                   std::chrono::seconds(DIGEST_TREE_MAX_AGE_S)) {
+    buildDigestTree();
+  }
+  if (m_digestTree == nullptr) {
+    return;
+  }
+
+  std::vector<util::DigestTree::Node> children;
+  try {
+    children = m_digestTree->getChildren(hexPrefix);
+  }
+  catch (const util::DigestTree::Error& e) {
+    _LOG_DEBUG(e.what());
+    return;
+  }
+
+  // [[count, fingerprint], ...], one per child
+  Json::Value nodes(Json::arrayValue);
+  for (const auto& child : children) {
+    std::ostringstream fingerprint;
+    fingerprint << std::hex << std::uppercase << std::setw(16) << std::setfill('0')
+                << child.fingerprint;
+    Json::Value node(Json::arrayValue);
+    node.append(static_cast<Json::UInt64>(child.count));
+    node.append(fingerprint.str());
+    nodes.append(node);
+  }
+  Json::FastWriter writer;
+  std::string payload = writer.write(nodes);
+
+  std::shared_ptr<ndn::Data> data = std::make_shared<ndn::Data>(name);
+  data->setFreshnessPeriod(ndn::time::seconds(1));
+  data->setContent(reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+  signData(*data);
+  m_face->put(*data);
+  util::MetricsRegistry::getDefault().get("publish.reconcile.served").add();
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::serveReconcileNames(ndn::Interest& interest)
+{
+  // the sha256 column is upper-case hex
+  std::string hexPrefix = interest.getName()[-1].toUri();
+  if (hexPrefix.size() > SHA256_HEX_SIZE ||
+      hexPrefix.find_first_not_of("0123456789ABCDEF") != std::string::npos) {
+    return;
+  }
+  std::string hexEnd = hexPrefix;
+  ++hexEnd.back();
+
+  util::Rows rows;
+  if (!queryDatabase("SELECT name FROM " + m_databaseTable + " WHERE sha256 >= '" + hexPrefix +
+                     "' AND sha256 < '" + hexEnd + "' ORDER BY sha256 LIMIT " +
+                     std::to_string(2 * RECONCILE_LEAF_SIZE), rows)) {
+    return;
+  }
+
+  // the names that do not fit in one packet are left out, the other catalog sees fewer names than
+  // the range has and compares its parts instead
+  Json::Value names(Json::arrayValue);
+  size_t size = 0;
+  for (const auto& row : rows) {
+    size += row[0].size() + 3;
+    if (size > SNAPSHOT_SEGMENT_SIZE) {
+      break;
+    }
+    names.append(row[0]);
+  }
+  Json::FastWriter writer;
+  std::shared_ptr<std::string> payload = std::make_shared<std::string>(writer.write(names));
+
+  ndn::Name name = interest.getName();
+  postToFace([this, name, payload] {
+      std::shared_ptr<ndn::Data> data = std::make_shared<ndn::Data>(name);
+      data->setFreshnessPeriod(ndn::time::seconds(1));
+      data->setContent(reinterpret_cast<const uint8_t*>(payload->data()), payload->size());
+      signData(*data);
+      m_face->put(*data);
+      util::MetricsRegistry::getDefault().get("publish.reconcile.served").add();
+    });
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::reconcile(const ndn::Name& session)
+{
+  if (m_isReconciling || m_isBootstrapping) {
+    return;
+  }
+  if (m_syncValidator == nullptr) {
+    _LOG_DEBUG("No reconciliation without the sync_data_security section");
+    return;
+  }
+  m_reconcilePeer = getPeerPrefix(session, "reconcile");
+  if (m_reconcilePeer.empty()) {
+    return;
+  }
+
+  _LOG_DEBUG("Reconcile with " << m_reconcilePeer);
+  m_isReconciling = true;
+  // the walk starts once the tree covers the names written so far
+  buildDigestTree();
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::scheduleReconcile()
+{
+  if (m_reconcileInterval.count() == 0) {
+    return;
+  }
+
+  m_scheduler.scheduleEvent(ndn::time::seconds(m_reconcileInterval.count()), [this] {
+      if (!m_syncLastHeard.empty()) {
+        auto session = m_syncLastHeard.begin();
+        std::advance(session, m_nextReconcileSession++ % m_syncLastHeard.size());
+        reconcile(session->first);
+      }
+      scheduleReconcile();
+    });
+}
+
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::buildDigestTree()
 {
-  _LOG_DEBUG(">> PublishAdapter::onValidatePublishedDataPayload");
-
-  // validate published data payload, if failed, return
-  if (!validatePublicationChanges(data)) {
-    _LOG_ERROR("Data validation failed : " << data->getName());
-    const std::string payload(reinterpret_cast<const char*>(data->getContent().value()),
-                              data->getContent().value_size());
-    _LOG_DEBUG(payload);
+  if (m_isBuildingDigestTree) {
     return;
   }
+  m_isBuildingDigestTree = true;
+  if (m_digestTreeThread.joinable()) {
+    m_digestTreeThread.join();
+  }
 
-  // todo: return value to indicate if the insertion succeeds
-  processUpdateData(data);
-
-  // ideally, data should not be stale?
-  m_socket->publishData(data->getContent(), ndn::time::seconds(3600));
+  m_digestTreeThread = std::thread([this] {
+      std::shared_ptr<util::DigestTree> tree;
+      std::vector<uint64_t> keys;
+      if (readDigests(keys)) {
+        tree = std::make_shared<util::DigestTree>(std::move(keys));
+      }
+      postToFace([this, tree] {
+          onDigestTreeBuilt(tree);
+        });
+    });
+}
 
-  // if this is not the final block, continue to fetch the next one
-  const ndn::name::Component& finalBlockId = data->getMetaInfo().getFinalBlockId();
-  if (finalBlockId == data->getName()[-1]) {
-    m_isFinished = true;
+template <typename DatabaseHandler>
+bool
+PublishAdapter<DatabaseHandler>::readDigests(std::vector<uint64_t>& keys)
+{
+  // by pages of ids, so that the table is not locked while it is read
+  std::string lastId = "0";
+  while (!m_isClosing) {
+    util::Rows rows;
+    if (!queryDatabase("SELECT id, sha256 FROM " + m_databaseTable + " WHERE id > " + lastId +
+                       " ORDER BY id LIMIT " + std::to_string(SNAPSHOT_QUERY_SIZE), rows)) {
+      return false;
+    }
+    for (const auto& row : rows) {
+      if (row[1].size() >= 16) {
+        keys.push_back(util::sha256HexKey(row[1].data()));
+      }
+    }
+    if (rows.size() < SNAPSHOT_QUERY_SIZE) {
+      return true;
+    }
+    lastId = rows.back()[0];
   }
-  //else, get the next segment
-  if (!m_isFinished) {
-    ndn::Name nextInterestName = data->getName().getPrefix(-1);
-    uint64_t incomingSegment = data->getName()[-1].toSegment();
-    incomingSegment++;
+  return false;
+}
 
-    _LOG_DEBUG("Next Interest Name " << nextInterestName << " Segment " << incomingSegment);
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::onDigestTreeBuilt(
+  const std::shared_ptr<const util::DigestTree>& tree)
+{
+  m_isBuildingDigestTree = false;
+  if (tree != nullptr) {
+    m_digestTree = tree;
+    m_digestTreeTime = std::chrono::steady_clock::now();
+    util::MetricsRegistry::getDefault().get("publish.reconcile.treeSize").set(tree->size());
+  }
+  else {
+    _LOG_ERROR("Cannot read the digests of the table");
+  }
 
-    std::shared_ptr<ndn::Interest> nextInterest =
-      std::make_shared<ndn::Interest>(nextInterestName.appendSegment(incomingSegment));
-    nextInterest->setInterestLifetime(ndn::time::milliseconds(4000));
-    nextInterest->setMustBeFresh(m_mustBeFresh);
-    m_face->expressInterest(*nextInterest,
-                            bind(&publish::PublishAdapter<DatabaseHandler>::onPublishedData,
-                                 this,_1, _2),
-                            bind(&publish::PublishAdapter<DatabaseHandler>::onTimeout,
-                                 this, _1));
+  // a reconciliation that waits for the tree
+  if (m_isReconciling && m_reconcileQueue.empty() && m_nReconcileOutstanding == 0) {
+    if (tree == nullptr) {
+      m_isReconciling = false;
+      return;
+    }
+    m_reconcileQueue.push_back(ReconcileRange{std::string(), false, 0});
+    sendReconcileInterests();
   }
 }
 
 template <typename DatabaseHandler>
 void
-PublishAdapter<DatabaseHandler>::processUpdateData(const std::shared_ptr<const ndn::Data>& data)
+PublishAdapter<DatabaseHandler>::sendReconcileInterests()
 {
-  _LOG_DEBUG(">> PublishAdapter::processUpdateData");
+  while (m_nReconcileOutstanding < RECONCILE_WINDOW && !m_reconcileQueue.empty()) {
+    ReconcileRange range = m_reconcileQueue.front();
+    m_reconcileQueue.pop_front();
+
+    ndn::Name name(m_reconcilePeer);
+    name.append(range.isLeaf ? "names" : "nodes");
+    if (!range.hexPrefix.empty()) {
+      name.append(range.hexPrefix);
+    }
+    ndn::Interest interest(name);
+    interest.setMustBeFresh(true);
+
+    ++m_nReconcileOutstanding;
+    m_face->expressInterest(interest,
+                            [this, range] (const ndn::Interest& interest,
+                                           const ndn::Data& data) {
+                              m_syncValidator->validate(
+                                data,
+                                [this, range] (const std::shared_ptr<const ndn::Data>& data) {
+                                  --m_nReconcileOutstanding;
+                                  onReconcileData(range, *data);
+                                  sendReconcileInterests();
+                                },
+                                [this] (const std::shared_ptr<const ndn::Data>& data,
+                                        const std::string& reason) {
+                                  _LOG_ERROR("Invalid reconciliation data " << data->getName()
+                                             << ": " << reason);
+                                  util::MetricsRegistry::getDefault()
+                                    .get("publish.reconcile.invalid").add();
+                                  --m_nReconcileOutstanding;
+                                  sendReconcileInterests();
+                                });
+                            },
+                            [this] (const ndn::Interest& interest) {
+                              // the range is compared again by the next reconciliation
+                              _LOG_DEBUG("Reconciliation timed out: " << interest.getName());
+                              util::MetricsRegistry::getDefault()
+                                .get("publish.reconcile.timeouts").add();
+                              --m_nReconcileOutstanding;
+                              sendReconcileInterests();
+                            });
+  }
 
-  const std::string payload(reinterpret_cast<const char*>(data->getContent().value()),
-                            data->getContent().value_size());
+  if (m_nReconcileOutstanding == 0 && m_reconcileQueue.empty() && m_isReconciling) {
+    _LOG_DEBUG("Reconciled with " << m_reconcilePeer);
+    util::MetricsRegistry::getDefault().get("publish.reconcile.rounds").add();
+    m_isReconciling = false;
+  }
+}
 
-  if (payload.length() <= 0) {
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::onReconcileData(const ReconcileRange& range,
+                                                 const ndn::Data& data)
+{
+  const std::string& hexPrefix = range.hexPrefix;
+  util::MetricsRegistry::getDefault().get("publish.reconcile.fetched").add();
+
+  const std::string payload(reinterpret_cast<const char*>(data.getContent().value()),
+                            data.getContent().value_size());
+  Json::Value value;
+  Json::Reader reader;
+  if (!reader.parse(payload, value) || !value.isArray()) {
+    _LOG_ERROR("Malformed reconciliation data " << data.getName());
     return;
   }
 
-  // the data payload must be JSON format
-  //    http://redmine.named-data.net/projects/ndn-atmos/wiki/Sync
-  Json::Value parsedFromPayload;
-  Json::Reader jsonReader;
-  if (!jsonReader.parse(payload, parsedFromPayload)) {
-    // todo: logging events
-    _LOG_DEBUG("Fail to parse the update data");
+  if (!range.isLeaf) {
+    if (value.size() != util::DigestTree::FANOUT) {
+      _LOG_ERROR("Malformed reconciliation data " << data.getName());
+      return;
+    }
+    std::vector<util::DigestTree::Node> children = m_digestTree->getChildren(hexPrefix);
+    for (Json::ArrayIndex i = 0; i < value.size(); ++i) {
+      const Json::Value& node = value[i];
+      if (!node.isArray() || node.size() != 2 || !node[0].isUInt64() || !node[1].isString() ||
+          node[1].asString().size() != 16 ||
+          node[1].asString().find_first_not_of("0123456789ABCDEF") != std::string::npos) {
+        _LOG_ERROR("Malformed reconciliation data " << data.getName());
+        return;
+      }
+      // the fingerprint is the hex of a 64-bit value, as the keys of the digests
+      util::DigestTree::Node remote{node[0].asUInt64(),
+                                    util::sha256HexKey(node[1].asString().data())};
+
+      // the names only the local table has are left alone, the other catalog loads them when it
+      // reconciles in turn
+      if (remote == children[i] || remote.count == 0) {
+        continue;
+      }
+      std::string child = hexPrefix + "0123456789ABCDEF"[i];
+      m_reconcileQueue.push_back(ReconcileRange{child,
+                                                remote.count <= RECONCILE_LEAF_SIZE ||
+                                                child.size() > util::DigestTree::MAX_DEPTH,
+                                                remote.count});
+    }
     return;
   }
 
-  std::stringstream ss;
-  if (json2Sql(ss, parsedFromPayload, util::ADD)) {
-    // todo: before use, check if the connection is not NULL
-    // we may need to use lock here to ensure thread safe
-    operateDatabase(ss.str(), util::ADD);
+  // the names did not fit in one Data, the parts of the range are compared
+  if (value.size() < range.count && hexPrefix.size() <= util::DigestTree::MAX_DEPTH) {
+    m_reconcileQueue.push_back(ReconcileRange{hexPrefix, false, range.count});
   }
 
-  ss.str("");
-  ss.clear();
-  if (json2Sql(ss, parsedFromPayload, util::REMOVE)) {
-    operateDatabase(ss.str(), util::REMOVE);
+  std::vector<std::string> names;
+  for (const auto& name : value) {
+    if (name.isString()) {
+      names.push_back(name.asString());
+    }
+  }
+  std::vector<util::ValueRef> refs;
+  for (const auto& name : names) {
+    refs.push_back(util::ValueRef{name.data(), name.size()});
+  }
+  std::string digests(refs.size() * SHA256_HEX_SIZE, '0');
+  util::sha256HexBatch(refs.data(), refs.size(), &digests[0]);
+
+  // only the names of the range that the local table does not have, and did not remove lately:
+  // the other catalog may not have applied the removal yet
+  std::vector<std::string> missingNames;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    expireTombstones(std::chrono::steady_clock::now());
+    for (size_t i = 0; i < names.size(); ++i) {
+      uint64_t key = util::sha256HexKey(&digests[i * SHA256_HEX_SIZE]);
+      if (digests.compare(i * SHA256_HEX_SIZE, hexPrefix.size(), hexPrefix) == 0 &&
+          !m_digestTree->contains(key) && m_tombstones.count(key) == 0) {
+        missingNames.push_back(names[i]);
+      }
+    }
+  }
+  if (!missingNames.empty()) {
+    _LOG_DEBUG("Reconciliation found " << missingNames.size() << " missing names under "
+               << hexPrefix);
+    util::MetricsRegistry::getDefault().get("publish.reconcile.names").add(missingNames.size());
+    addNames(missingNames);
   }
 }
 
 template <typename DatabaseHandler>
-chronosync::SeqNo
-PublishAdapter<DatabaseHandler>::getLatestSeqNo(const chronosync::MissingDataInfo& update)
+void
+PublishAdapter<DatabaseHandler>::removeName(const std::string& name, const std::string& digest)
 {
-  // empty
-  return 0;
+  m_ingestWriter->remove(name, digest);
+  if (m_tombstoneRetention.count() == 0) {
+    return;
+  }
+
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  uint64_t key = util::sha256HexKey(digest.data());
+  std::lock_guard<std::mutex> lock(m_mutex);
+  expireTombstones(now);
+  m_tombstones[key] = now;
+  m_tombstoneQueue.push_back(std::make_pair(now, key));
+  util::MetricsRegistry::getDefault().get("publish.reconcile.tombstones")
+    .set(m_tombstones.size());
 }
 
-template <>
-chronosync::SeqNo
-PublishAdapter<ConnectionPool_T>::getLatestSeqNo(const chronosync::MissingDataInfo& update)
+template <typename DatabaseHandler>
+void
+PublishAdapter<DatabaseHandler>::expireTombstones(const std::chrono::steady_clock::time_point& now)
 {
-  _LOG_DEBUG(">> PublishAdapter::getLatestSeqNo");
+  while (!m_tombstoneQueue.empty() && now - m_tombstoneQueue.front().first > m_tombstoneRetention) {
+    auto tombstone = m_tombstones.find(m_tombstoneQueue.front().second);
+    // a name removed again since keeps its later tombstone
+    if (tombstone != m_tombstones.end() && tombstone->second == m_tombstoneQueue.front().first) {
+      m_tombstones.erase(tombstone);
+    }
+    m_tombstoneQueue.pop_front();
+  }
+}
 
-  Connection_T conn = ConnectionPool_getConnection(*m_databaseHandler);
+template <typename DatabaseHandler>
+bool
+PublishAdapter<DatabaseHandler>::writeBatch(const util::IngestBatch& batch)
+{
+  if (!removeNames(batch)) {
+    return false;
+  }
+  return insertNames(batch);
+}
 
-  if (!conn) {
-    _LOG_DEBUG("No available database connections");
-    return 0;
+template <typename DatabaseHandler>
+bool
+PublishAdapter<DatabaseHandler>::insertNames(const util::IngestBatch& batch)
+{
+  std::vector<util::BulkStatement> statements;
+  batch2Statements(batch, statements);
+  if (statements.empty()) {
+    return true;
   }
 
-  PreparedStatement_T ps4SeqNum =
-    Connection_prepareStatement(conn,
-                                "SELECT seq_num FROM chronosync_update_info WHERE session_name = ?");
-  PreparedStatement_setString(ps4SeqNum, 1, update.session.toUri().c_str());
-  ResultSet_T res4SeqNum;
-  TRY {
-     res4SeqNum = PreparedStatement_executeQuery(ps4SeqNum);
+  WriteResult result = executeStatements(statements);
+  if (result != WRITE_REJECTED) {
+    return result == WRITE_DONE;
   }
-  CATCH(SQLException) {
-    _LOG_ERROR(Connection_getLastError(conn));
+  if (batch.added.size() <= 1) {
+    _LOG_ERROR("Dropping " << (batch.added.empty() ? "the sync progress" : batch.added[0])
+               << ", rejected by the database");
+    util::MetricsRegistry::getDefault().get("publish.ingest.rejected").add(batch.added.size());
+    return true;
   }
-  END_TRY;
 
-  while (ResultSet_next(res4SeqNum)) {
-    return ResultSet_getInt(res4SeqNum, 1);
-  }
+  // the progress is saved with the second half, once all the names before it are written; when
+  // the second half cannot be written, the whole batch is tried again, and the names of the first
+  // half are found in the table then
+  size_t half = batch.added.size() / 2;
+  util::IngestBatch first, second;
+  first.added.assign(batch.added.begin(), batch.added.begin() + half);
+  first.addedDigests.assign(batch.addedDigests.begin(), batch.addedDigests.begin() + half);
+  second.added.assign(batch.added.begin() + half, batch.added.end());
+  second.addedDigests.assign(batch.addedDigests.begin() + half, batch.addedDigests.end());
+  second.progress = batch.progress;
+  return insertNames(first) && insertNames(second);
+}
 
-  Connection_close(conn);
+template <typename DatabaseHandler>
+bool
+PublishAdapter<DatabaseHandler>::removeNames(const util::IngestBatch& batch)
+{
+  util::Metric& pending = util::MetricsRegistry::getDefault().get("publish.removals.pending");
+  util::Metric& chunks = util::MetricsRegistry::getDefault().get("publish.removals.chunks");
+  util::Metric& removed = util::MetricsRegistry::getDefault().get("publish.removals.names");
+
+  const size_t nNames = batch.removed.size();
+  for (size_t begin = 0; begin < nNames; begin += m_removeChunkSize) {
+    size_t end = std::min(nNames, begin + m_removeChunkSize);
+    pending.set(nNames - begin);
+
+    std::vector<util::BulkStatement> statements;
+    statements.push_back(makeStatement(util::REMOVE));
+    for (size_t i = begin; i < end; ++i) {
+      statements.back().addValue(batch.removedDigests[i].data(), batch.removedDigests[i].size());
+    }
+    // the chunks already deleted are deleted again when the batch is tried again, which is
+    // harmless
+    // a rejected deletion would be rejected again, the names are left in the table
+    if (executeStatements(statements) == WRITE_RETRY) {
+      return false;
+    }
+    chunks.add();
+    removed.add(end - begin);
+  }
+  pending.set(0);
 
-  return 0;
+  forgetNames(batch.removedDigests);
+  return true;
 }
 
 template <typename DatabaseHandler>
-void
-PublishAdapter<DatabaseHandler>::renewUpdateInformation(const chronosync::MissingDataInfo& update)
+typename PublishAdapter<DatabaseHandler>::WriteResult
+PublishAdapter<DatabaseHandler>::executeStatements(
+  const std::vector<util::BulkStatement>& statements)
 {
-  //empty
+  // empty
+  return WRITE_DONE;
 }
 
 template <>
-void
-PublishAdapter<ConnectionPool_T>::renewUpdateInformation(const chronosync::MissingDataInfo& update)
+PublishAdapter<util::DatabasePool>::WriteResult
+PublishAdapter<util::DatabasePool>::executeStatements(
+  const std::vector<util::BulkStatement>& statements)
 {
-  Connection_T conn = ConnectionPool_getConnection(*m_databaseHandler);
-
+  // runs on the writer thread, which can wait for a connection
+  Connection_T conn = m_databaseHandler->acquire();
   if (!conn) {
     _LOG_DEBUG("No available database connections");
-    return;
+    return WRITE_RETRY;
   }
 
-  PreparedStatement_T ps4UpdateSeqNum =
-    Connection_prepareStatement(conn,
-                                "UPDATE chronosync_update_info SET seq_num = ? WHERE session_name = ?");
-  PreparedStatement_setLLong(ps4UpdateSeqNum, 1, update.high);
-  PreparedStatement_setString(ps4UpdateSeqNum, 1, update.session.toUri().c_str());
-
+  WriteResult result = WRITE_DONE;
   TRY {
-     PreparedStatement_execute(ps4UpdateSeqNum);
+    Connection_beginTransaction(conn);
+    for (const auto& statement : statements) {
+      util::zdbExecuteBulk(conn, statement);
+    }
+    Connection_commit(conn);
   }
   CATCH(SQLException) {
-    _LOG_ERROR(Connection_getLastError(conn));
+    std::string error(Connection_getLastError(conn));
+    _LOG_ERROR(error);
+    TRY {
+      Connection_rollback(conn);
+    }
+    CATCH(SQLException) {
+      _LOG_ERROR(Connection_getLastError(conn));
+    }
+    END_TRY;
+
+    // libzdb has no error numbers; a lost connection or a lock conflict goes away, the other
+    // failures would happen again
+    bool isTransient = !Connection_ping(conn) ||
+                       error.find("Deadlock found") != std::string::npos ||
+                       error.find("Lock wait timeout") != std::string::npos;
+    result = isTransient ? WRITE_RETRY : WRITE_REJECTED;
   }
   END_TRY;
 
-  Connection_close(conn);
+  m_databaseHandler->release(conn);
+  return result;
+}
+
+#ifdef HAVE_MYSQL_NONBLOCKING
+template <>
+PublishAdapter<util::AsyncMysqlClient>::WriteResult
+PublishAdapter<util::AsyncMysqlClient>::executeStatements(
+  const std::vector<util::BulkStatement>& bulkStatements)
+{
+  // the non-blocking client has no prepared statements, the values are escaped instead
+  std::vector<std::string> statements;
+  for (const auto& statement : bulkStatements) {
+    statements.push_back(statement.toSql([this] (const util::ValueRef& value) {
+          return "'" + m_databaseHandler->escape(std::string(value.data, value.size)) + "'";
+        }));
+  }
+
+  std::shared_ptr<std::promise<WriteResult>> done =
+    std::make_shared<std::promise<WriteResult>>();
+  std::future<WriteResult> isDone = done->get_future();
+  m_databaseHandler->transaction(statements,
+                                 [done] { done->set_value(WRITE_DONE); },
+                                 [done] (unsigned int errorNo, const std::string& reason) {
+                                   _LOG_ERROR(reason);
+                                   done->set_value(
+                                     util::AsyncMysqlClient::isTransientError(errorNo) ?
+                                     WRITE_RETRY : WRITE_REJECTED);
+                                 });
+
+  // the statements run on the Face thread, wait for them so that the batches stay in order
+  while (isDone.wait_for(std::chrono::milliseconds(WRITE_RETRY_INTERVAL_MS)) !=
+         std::future_status::ready) {
+    if (m_face->getIoService().stopped()) {
+      return WRITE_RETRY;
+    }
+  }
+  return isDone.get();
+}
+#endif // HAVE_MYSQL_NONBLOCKING
 
+template <>
+PublishAdapter<util::SqliteDatabase>::WriteResult
+PublishAdapter<util::SqliteDatabase>::executeStatements(
+  const std::vector<util::BulkStatement>& statements)
+{
+  try {
+    m_databaseHandler->executeBulk(statements);
+  }
+  catch (const util::SqliteDatabase::Error& e) {
+    _LOG_ERROR(e.what());
+    return e.isTransient() ? WRITE_RETRY : WRITE_REJECTED;
+  }
+  return WRITE_DONE;
 }
 
 template <typename DatabaseHandler>
 void
-PublishAdapter<DatabaseHandler>::addUpdateInformation(const chronosync::MissingDataInfo& update)
+PublishAdapter<DatabaseHandler>::batch2Statements(const util::IngestBatch& batch,
+                                                  std::vector<util::BulkStatement>& statements)
 {
-  //empty
+  if (!batch.added.empty()) {
+    // sync makes the catalog see the names it holds again, those are not written
+    std::vector<bool> isStored;
+    findStoredNames(batch, isStored);
+
+    util::BulkStatement statement = makeStatement(util::ADD);
+    for (size_t i = 0; i < batch.added.size(); ++i) {
+      if (isStored[i]) {
+        continue;
+      }
+      if (!name2Row(batch.added[i], batch.addedDigests[i], statement)) {
+        _LOG_ERROR("Dropping the malformed file name " << batch.added[i]);
+      }
+    }
+    if (!statement.empty()) {
+      statements.push_back(std::move(statement));
+    }
+  }
+
+  if (!batch.progress.empty()) {
+    // session_name is not a unique key on MySQL, the rows of the sessions are replaced
+    util::BulkStatement removeProgress =
+      util::BulkStatement::remove("chronosync_update_info", "session_name");
+    util::BulkStatement insertProgress =
+      util::BulkStatement::insert("chronosync_update_info", {"session_name", "seq_num"});
+    for (const auto& item : batch.progress) {
+      removeProgress.addValue(item.first.data(), item.first.size());
+      insertProgress.addValue(item.first.data(), item.first.size());
+      insertProgress.addOwnedValue(std::to_string(item.second));
+    }
+    statements.push_back(std::move(removeProgress));
+    statements.push_back(std::move(insertProgress));
+  }
 }
 
-template <>
+template <typename DatabaseHandler>
 void
-PublishAdapter<ConnectionPool_T>::addUpdateInformation(const chronosync::MissingDataInfo& update)
+PublishAdapter<DatabaseHandler>::findStoredNames(const util::IngestBatch& batch,
+                                                 std::vector<bool>& isStored)
 {
-  Connection_T conn = ConnectionPool_getConnection(*m_databaseHandler);
-
-  if (!conn) {
-    _LOG_DEBUG("No available database connections");
+  isStored.assign(batch.added.size(), false);
+  if (!m_duplicateFilter) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_duplicateFilter = std::move(m_loadedDuplicateFilter);
+  }
+  if (!m_duplicateFilter) {
     return;
   }
 
-  PreparedStatement_T ps4UpdateChronosync =
-    Connection_prepareStatement(conn, "INSERT INTO chronosync_update_info (session_name, seq_num) VALUES (?, ?)");
+  std::vector<size_t> candidates;
+  for (size_t i = 0; i < batch.added.size(); ++i) {
+    uint64_t key = util::sha256HexKey(batch.addedDigests[i].data());
+    if (m_duplicateFilter->contains(key)) {
+      candidates.push_back(i);
+    }
+    else {
+      m_duplicateFilter->add(key);
+    }
+  }
 
-  PreparedStatement_setString(ps4UpdateChronosync, 1, update.session.toUri().c_str());
-  PreparedStatement_setLLong(ps4UpdateChronosync, 1, update.high);
+  // the digests are hex, they can be inlined
+  std::unordered_set<std::string> stored;
+  for (size_t begin = 0; begin < candidates.size(); begin += DUPLICATE_QUERY_SIZE) {
+    size_t end = std::min(candidates.size(), begin + DUPLICATE_QUERY_SIZE);
+    std::string sql = "SELECT sha256 FROM " + m_databaseTable + " WHERE sha256 IN (";
+    for (size_t i = begin; i < end; ++i) {
+      sql += (i == begin ? "'" : ",'") + batch.addedDigests[candidates[i]] + "'";
+    }
+    sql += ")";
 
-  TRY {
-     PreparedStatement_execute(ps4UpdateChronosync);
-  }
-  CATCH(SQLException) {
-    _LOG_ERROR(Connection_getLastError(conn));
+    util::Rows rows;
+    if (!queryDatabase(sql, rows)) {
+      // the upsert leaves the duplicates alone anyway
+      return;
+    }
+    for (const auto& row : rows) {
+      stored.insert(row[0]);
+    }
   }
-  END_TRY;
-
-  Connection_close(conn);
 
+  size_t nStored = 0;
+  for (size_t i : candidates) {
+    if (stored.count(batch.addedDigests[i]) > 0) {
+      isStored[i] = true;
+      ++nStored;
+    }
+  }
+  util::MetricsRegistry::getDefault().get("publish.duplicates.skipped").add(nStored);
+  util::MetricsRegistry::getDefault().get("publish.duplicates.falsePositives")
+    .add(candidates.size() - nStored);
+  util::MetricsRegistry::getDefault().get("publish.duplicates.filterSize")
+    .set(m_duplicateFilter->size());
 }
 
 template <typename DatabaseHandler>
 void
-PublishAdapter<DatabaseHandler>::onFetchUpdateDataTimeout(const ndn::Interest& interest)
+PublishAdapter<DatabaseHandler>::forgetNames(const std::vector<std::string>& digests)
 {
-  // todo: record event, and use recovery Interest to fetch the whole table
-  _LOG_ERROR("UpdateData retrieval timed out: " << interest.getName());
+  if (!m_duplicateFilter) {
+    return;
+  }
+
+  for (const auto& digest : digests) {
+    m_duplicateFilter->remove(util::sha256HexKey(digest.data()));
+  }
 }
 
 template <typename DatabaseHandler>
 void
-PublishAdapter<DatabaseHandler>::processSyncUpdate(const std::vector<chronosync::MissingDataInfo>&
-                                                   updates)
+PublishAdapter<DatabaseHandler>::loadDuplicateFilter()
 {
-  _LOG_DEBUG(">> PublishAdapter::processSyncUpdate");
+  _LOG_DEBUG(">> PublishAdapter::loadDuplicateFilter");
 
-  if (updates.empty()) {
-    return;
+  // sized for the names published from now on as well
+  std::unique_ptr<util::CuckooFilter> filter;
+  while (!filter) {
+    if (m_isClosing) {
+      return;
+    }
+    util::Rows rows;
+    if (queryDatabase("SELECT COUNT(*) FROM " + m_databaseTable, rows) && !rows.empty()) {
+      size_t nNames = std::strtoull(rows[0][0].c_str(), nullptr, 10);
+      filter.reset(new util::CuckooFilter(std::max(m_duplicateFilterCapacity, 2 * nNames)));
+    }
+    else {
+      std::this_thread::sleep_for(std::chrono::milliseconds(WRITE_RETRY_INTERVAL_MS));
+    }
   }
 
-  // multiple updates from different catalog are possible
-  for (size_t i = 0; i < updates.size(); ++i) {
-    // check if the session is in local DB
-    // if yes, only fetch packets whose seq number is bigger than the one in the DB
-    // if no, directly fetch Data
-    chronosync::SeqNo localSeqNo = getLatestSeqNo(updates[i]);
-    bool update = false;
-
-    for (chronosync::SeqNo seq = updates[i].low; seq <= updates[i].high; ++seq) {
-      if (seq > localSeqNo) {
-        m_socket->fetchData(updates[i].session, seq,
-                            bind(&PublishAdapter<DatabaseHandler>::processUpdateData,this, _1),
-                            bind(&PublishAdapter<DatabaseHandler>::onValidationFailed,
-                                 this, _1, _2),
-                            bind(&PublishAdapter<DatabaseHandler>::onFetchUpdateDataTimeout,
-                                 this, _1),
-                            RETRY_WHEN_TIMEOUT);
-
-        _LOG_DEBUG("Interest for [" << updates[i].session << ":" << seq << "]");
-
-        update = true;
+  // by pages of ids, so that a large table is not held in memory
+  std::string lastId = "0";
+  while (true) {
+    if (m_isClosing) {
+      return;
+    }
+    util::Rows rows;
+    if (!queryDatabase("SELECT id, sha256 FROM " + m_databaseTable + " WHERE id > " + lastId +
+                       " ORDER BY id LIMIT " + std::to_string(DUPLICATE_QUERY_SIZE), rows)) {
+      // the database cannot be reached, the page is read again
+      std::this_thread::sleep_for(std::chrono::milliseconds(WRITE_RETRY_INTERVAL_MS));
+      continue;
+    }
+    for (const auto& row : rows) {
+      if (row[1].size() >= 16) {
+        filter->add(util::sha256HexKey(row[1].data()));
       }
     }
-    // update the seq session name and seq number in local DB
-    // indicating they are processed. So latter when this node reboots again, won't redo it
-    if (update) {
-      if (localSeqNo > 0)
-        renewUpdateInformation(updates[i]);
-      else
-        addUpdateInformation(updates[i]);
+    if (rows.size() < DUPLICATE_QUERY_SIZE) {
+      break;
     }
+    lastId = rows.back()[0];
+  }
+
+  if (filter->size() * 100 > filter->getCapacity() * 95) {
+    _LOG_ERROR("The duplicate filter is full, set a larger \"duplicateFilter\" in the "
+               "\"publishAdapter\\database\" section");
   }
+  _LOG_DEBUG("Loaded " << filter->size() << " names into the duplicate filter");
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_loadedDuplicateFilter = std::move(filter);
 }
 
 template <typename DatabaseHandler>
-void
-PublishAdapter<DatabaseHandler>::operateDatabase(const std::string& sql, util::DatabaseOperation op)
+bool
+PublishAdapter<DatabaseHandler>::queryDatabase(const std::string& sql,
+                                               util::Rows& rows)
 {
   // empty
+  return false;
 }
 
 template <>
-void
-PublishAdapter<ConnectionPool_T>::operateDatabase(const std::string& sql, util::DatabaseOperation op)
+bool
+PublishAdapter<util::DatabasePool>::queryDatabase(const std::string& sql,
+                                                  util::Rows& rows)
 {
-  Connection_T conn = ConnectionPool_getConnection(*m_databaseHandler);
-
+  Connection_T conn = m_databaseHandler->acquire();
   if (!conn) {
     _LOG_DEBUG("No available database connections");
-    return;
+    return false;
   }
 
+  bool isDone = true;
   TRY {
-    Connection_execute(conn, reinterpret_cast<const char*>(sql.c_str()), sql.size());
+    ResultSet_T result = Connection_executeQuery(conn, "%s", sql.c_str());
+    int nColumns = ResultSet_getColumnCount(result);
+    while (ResultSet_next(result)) {
+      rows.push_back(util::Row());
+      for (int i = 1; i <= nColumns; ++i) {
+        const char* value = ResultSet_getString(result, i);
+        rows.back().push_back(value == NULL ? "" : value);
+      }
+    }
   }
   CATCH(SQLException) {
     _LOG_ERROR(Connection_getLastError(conn));
+    isDone = false;
   }
   END_TRY;
 
-  Connection_close(conn);
+  m_databaseHandler->release(conn);
+  return isDone;
+}
+
+#ifdef HAVE_MYSQL_NONBLOCKING
+template <>
+bool
+PublishAdapter<util::AsyncMysqlClient>::queryDatabase(const std::string& sql,
+                                                      util::Rows& rows)
+{
+  // the callbacks may still run after we stop waiting, they only touch shared state
+  std::shared_ptr<std::promise<bool>> done = std::make_shared<std::promise<bool>>();
+  std::shared_ptr<util::Rows> result = std::make_shared<util::Rows>();
+  std::future<bool> isDone = done->get_future();
+  m_databaseHandler->query(sql,
+                           [done, result] (const util::Rows& resultRows) {
+                             *result = resultRows;
+                             done->set_value(true);
+                           },
+                           [done] (const std::string& reason) {
+                             _LOG_ERROR(reason);
+                             done->set_value(false);
+                           });
+
+  while (isDone.wait_for(std::chrono::milliseconds(WRITE_RETRY_INTERVAL_MS)) !=
+         std::future_status::ready) {
+    if (m_face->getIoService().stopped()) {
+      return false;
+    }
+  }
+  if (!isDone.get()) {
+    return false;
+  }
+  rows.insert(rows.end(), result->begin(), result->end());
+  return true;
+}
+#endif // HAVE_MYSQL_NONBLOCKING
+
+template <>
+bool
+PublishAdapter<util::SqliteDatabase>::queryDatabase(const std::string& sql,
+                                                    util::Rows& rows)
+{
+  try {
+    util::Rows result = m_databaseHandler->query(sql);
+    rows.insert(rows.end(), result.begin(), result.end());
+  }
+  catch (const util::SqliteDatabase::Error& e) {
+    _LOG_ERROR(e.what());
+    return false;
+  }
+  return true;
+}
+
+template <typename DatabaseHandler>
+util::SqlDialect
+PublishAdapter<DatabaseHandler>::getSqlDialect()
+{
+  return util::DIALECT_MYSQL;
+}
+
+template <>
+util::SqlDialect
+PublishAdapter<util::SqliteDatabase>::getSqlDialect()
+{
+  return util::DIALECT_SQLITE;
 }
 
 template<typename DatabaseHandler>
 bool
-PublishAdapter<DatabaseHandler>::json2Sql(std::stringstream& sqlString,
-                                          Json::Value& jsonValue,
-                                          util::DatabaseOperation op)
+PublishAdapter<DatabaseHandler>::json2Names(Json::Value& jsonValue,
+                                            util::DatabaseOperation op,
+                                            std::vector<std::string>& names)
 {
   if (jsonValue.type() != Json::objectValue) {
     return false;
   }
-  if (op == util::ADD) {
-    size_t updateNumber = jsonValue["add"].size();
-    if (updateNumber <= 0)
-      return false;
 
-    sqlString << "INSERT INTO " << m_databaseTable << " (";
-    for (size_t i = 0; i < m_tableColumns.size(); ++i) {
-      if (i != 0)
-        sqlString << ", ";
-      sqlString << m_tableColumns[i];
-    }
-    sqlString << ") VALUES";
-
-    for (size_t i = 0; i < updateNumber; ++i) { //parse each file name
-      if (i > 0)
-        sqlString << ",";
-      // cast might be overflowed
-      Json::Value item = jsonValue["add"][static_cast<int>(i)];
-      if (!item.isConvertibleTo(Json::stringValue)) {
-        _LOG_ERROR("Malformed JsonQuery string");
-        return false;
-      }
-      std::string fileName(item.asString());
-      // use digest sha256 for now, may be removed
-      ndn::util::Digest<CryptoPP::SHA256> digest;
-      digest.update(reinterpret_cast<const uint8_t*>(fileName.data()), fileName.length());
-
-      sqlString << "('" << digest.toString() << "','" << fileName << "'";
-
-      // parse the ndn name to get each value for each field
-      if (!name2Fields(sqlString, fileName))
-        return false;
-      sqlString << ")";
-    }
-    sqlString << ";";
-  }
-  else if (op == util::REMOVE) {
-    // remove files from db
-    size_t updateNumber = jsonValue["remove"].size();
-    if (updateNumber <= 0)
+  const Json::Value& items = jsonValue[op == util::ADD ? "add" : "remove"];
+  size_t updateNumber = items.size();
+  if (updateNumber <= 0)
+    return false;
+
+  for (size_t i = 0; i < updateNumber; ++i) { //parse each file name
+    // cast might be overflowed
+    const Json::Value& item = items[static_cast<int>(i)];
+    if (!item.isConvertibleTo(Json::stringValue)) {
+      _LOG_ERROR("Malformed JsonQuery string");
       return false;
+    }
+    names.push_back(item.asString());
+  }
+  return true;
+}
 
-    sqlString << "DELETE FROM " << m_databaseTable << " WHERE name IN (";
-    for (size_t i = 0; i < updateNumber; ++i) {
-      if (i > 0)
-        sqlString << ",";
-      // cast might be overflowed
-      Json::Value item = jsonValue["remove"][static_cast<int>(i)];
-      if (!item.isConvertibleTo(Json::stringValue)) {
-        _LOG_ERROR("Malformed JsonQuery");
-        return false;
-      }
-      std::string fileName(item.asString());
+template<typename DatabaseHandler>
+util::BulkStatement
+PublishAdapter<DatabaseHandler>::makeStatement(util::DatabaseOperation op)
+{
+  if (op == util::ADD) {
+    // a name already in the table is left alone, rather than failing the whole batch
+    return util::BulkStatement::upsert(m_databaseTable, m_tableColumns, "sha256", getSqlDialect());
+  }
+  return util::BulkStatement::remove(m_databaseTable, "sha256");
+}
 
-      sqlString << "'" << fileName << "'";
+template<typename DatabaseHandler>
+bool
+PublishAdapter<DatabaseHandler>::names2Statement(const std::vector<std::string>& names,
+                                                 const std::vector<std::string>& digests,
+                                                 util::DatabaseOperation op,
+                                                 util::BulkStatement& statement)
+{
+  for (size_t i = 0; i < names.size(); ++i) {
+    const std::string& fileName = names[i];
+    if (op == util::REMOVE) {
+      statement.addValue(digests[i].data(), digests[i].size());
+      continue;
     }
-    sqlString << ");";
+
+    if (!name2Row(fileName, digests[i], statement))
+      return false;
   }
   return true;
 }
 
 template<typename DatabaseHandler>
 bool
-PublishAdapter<DatabaseHandler>::name2Fields(std::stringstream& sqlString,
-                                             std::string& fileName)
+PublishAdapter<DatabaseHandler>::name2Row(const std::string& fileName, const std::string& digest,
+                                          util::BulkStatement& statement)
 {
-  size_t start = 0;
-  size_t pos = 0;
-  size_t count = 0;
-  std::string token;
-  std::string delimiter = "/";
-  // fileName must starts with either ndn:/ or /
-  std::string nameWithNdn("ndn:/");
-  std::string nameWithSlash("/");
-  if (fileName.find(nameWithNdn) == 0) {
-    start = nameWithNdn.size();
-  }
-  else if (fileName.find(nameWithSlash) == 0) {
-    start = nameWithSlash.size();
-  }
-  else
+  // parse the ndn name to get each value for each field
+  std::vector<util::ValueRef> fields;
+  if (!splitName(fileName, fields))
     return false;
 
-  while ((pos = fileName.find(delimiter, start)) != std::string::npos) {
-    count++;
-    token = fileName.substr(start, pos - start);
-    // exclude the sha256 and name (already processed)
-    if (count >= m_tableColumns.size() - 2) {
-      return false;
-    }
-    sqlString << ",'" << token << "'";
-    start = pos + 1;
+  statement.addValue(digest.data(), digest.size());
+  statement.addValue(fileName.data(), fileName.size());
+  for (const auto& field : fields) {
+    statement.addValue(field.data, field.size);
   }
+  return true;
+}
 
-  // sha256 and name have been processed, and the last token will be processed later
-  if (count != m_tableColumns.size() - 3  || std::string::npos == start)
+template<typename DatabaseHandler>
+bool
+PublishAdapter<DatabaseHandler>::name2Fields(std::stringstream& sqlString,
+                                             std::string& fileName)
+{
+  std::vector<util::ValueRef> fields;
+  if (!splitName(fileName, fields))
     return false;
-  token = fileName.substr(start, std::string::npos - start);
-  sqlString << ",'" << token << "'";
+
+  for (const auto& field : fields) {
+    sqlString << ",'";
+    sqlString.write(field.data, field.size);
+    sqlString << "'";
+  }
   return true;
 }
 
+template<typename DatabaseHandler>
+bool
+PublishAdapter<DatabaseHandler>::splitName(const std::string& fileName,
+                                           std::vector<util::ValueRef>& fields)
+{
+  // exclude the sha256 and name, which are not name fields
+  return util::splitName(util::ValueRef{fileName.data(), fileName.size()},
+                         m_tableColumns.size() - 2, fields);
+}
+
 template<typename DatabaseHandler>
 bool
 PublishAdapter<DatabaseHandler>::validatePublicationChanges(const
@@ -984,10 +3744,6 @@ PublishAdapter<DatabaseHandler>::validatePublicationChanges(const
 {
   _LOG_DEBUG(">> PublishAdapter::validatePublicationChanges");
 
-  // The data name must be "/<publisher-prefix>/<nonce>"
-  // the prefix is the data name removes the last component
-  ndn::Name publisherPrefix = data->getName().getPrefix(-1);
-
   const std::string payload(reinterpret_cast<const char*>(data->getContent().value()),
                             data->getContent().value_size());
   Json::Value parsedFromString;
@@ -997,18 +3753,29 @@ PublishAdapter<DatabaseHandler>::validatePublicationChanges(const
     _LOG_DEBUG("Fail to parse the published Data" << data->getName());
     return false;
   }
+  return checkPublicationChanges(data->getName(), parsedFromString);
+}
+
+template<typename DatabaseHandler>
+bool
+PublishAdapter<DatabaseHandler>::checkPublicationChanges(const ndn::Name& dataName,
+                                                         const Json::Value& changes)
+{
+  // The data name must be "/<publisher-prefix>/<nonce>"
+  // the prefix is the data name removes the last component
+  ndn::Name publisherPrefix = dataName.getPrefix(-1);
 
   // validate added files...
-  for (size_t i = 0; i < parsedFromString["add"].size(); i++) {
+  for (size_t i = 0; i < changes["add"].size(); i++) {
     if (!publisherPrefix.isPrefixOf(
-          ndn::Name(parsedFromString["add"][static_cast<int>(i)].asString())))
+          ndn::Name(changes["add"][static_cast<int>(i)].asString())))
       return false;
   }
 
   // validate removed files ...
-  for (size_t i = 0; i < parsedFromString["remove"].size(); i++) {
+  for (size_t i = 0; i < changes["remove"].size(); i++) {
     if (!publisherPrefix.isPrefixOf(
-          ndn::Name(parsedFromString["remove"][static_cast<int>(i)].asString())))
+          ndn::Name(changes["remove"][static_cast<int>(i)].asString())))
       return false;
   }
   return true;
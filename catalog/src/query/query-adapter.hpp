@@ -19,9 +19,20 @@
 #ifndef ATMOS_QUERY_QUERY_ADAPTER_HPP
 #define ATMOS_QUERY_QUERY_ADAPTER_HPP
 
+#include "query/query-planner.hpp"
+#include "util/async-mysql-client.hpp"
 #include "util/catalog-adapter.hpp"
 #include "util/mysql-util.hpp"
+#include "util/catalog-snapshot.hpp"
 #include "util/config-file.hpp"
+#include "util/database-pool.hpp"
+#include "util/metrics.hpp"
+#include "util/name-tokenizer.hpp"
+#include "util/outbound-data-queue.hpp"
+#include "util/query-trace.hpp"
+#include "util/rows.hpp"
+#include "util/sharded-content-store.hpp"
+#include "util/sqlite-database.hpp"
 
 #include <thread>
 
@@ -37,16 +48,17 @@
 #include <ndn-cxx/security/key-chain.hpp>
 #include <ndn-cxx/util/time.hpp>
 #include <ndn-cxx/encoding/encoding-buffer.hpp>
-#include <ndn-cxx/util/in-memory-storage-lru.hpp>
 #include <ndn-cxx/util/string-helper.hpp>
 #include <ChronoSync/socket.hpp>
 
 #include "mysql/mysql.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
 #include <map>
 #include <unordered_map>
 #include <memory>
-#include <mutex>
 #include <sstream>
 #include <string>
 #include <array>
@@ -132,6 +144,15 @@ protected:
   void
   getFiltersMenu(Json::Value& value);
 
+  /**
+   * Helper function that makes the filter menu data segments and sends them
+   *
+   * @param interest: filters-initialization Interest being answered
+   * @param filters:  Json::Value that holds the distinct values of each filter category
+   */
+  void
+  sendFiltersMenu(std::shared_ptr<const ndn::Interest> interest, const Json::Value& filters);
+
   /**
    * Helper function that makes query-results data
    *
@@ -191,11 +212,12 @@ protected:
   signData(ndn::Data& data);
 
   /**
-   * Helper function that publishes query-results data segments
+   * Helper function that publishes query-results data segments, the distinct values of
+   * nameField among the rows that plan selects
    */
   virtual void
   prepareSegmentsBySqlString(const ndn::Name& segmentPrefix,
-                             const std::string& sqlString,
+                             const QueryPlan& plan,
                              bool lastComponent,
                              const std::string& nameField);
 
@@ -210,12 +232,75 @@ protected:
                    bool autocomplete,
                    bool lastComponent);
 
+  /**
+   * Helper function that packs the query results into Data segments, caches and sends them
+   *
+   * @param nextEntry: fills in the next result entry, returns false when there is none left
+   */
+  void
+  packSegments(const std::function<bool(Json::Value&)>& nextEntry,
+               const ndn::Name& segmentPrefix,
+               int resultCount,
+               bool autocomplete,
+               bool lastComponent);
+
+  /**
+   * Helper function that publishes the rows returned by AsyncMysqlClient or SqliteDatabase
+   */
+  void
+  generateSegments(const std::vector<std::vector<std::string>>& rows,
+                   const ndn::Name& segmentPrefix,
+                   int resultCount,
+                   bool autocomplete,
+                   bool lastComponent);
+
+#ifdef HAVE_MYSQL_NONBLOCKING
+
+  /**
+   * Helper function that runs countSql to get the result count, then resultsSql to get the
+   * results, and publishes them as segments; both run on the non-blocking client
+   */
+  void
+  generateSegmentsAsync(const std::string& countSql,
+                        const std::string& resultsSql,
+                        const ndn::Name& segmentPrefix,
+                        bool autocomplete,
+                        bool lastComponent);
+
+  /**
+   * Helper function that returns the WHERE clause of plan with the values escaped in place of
+   * the parameters, since the non-blocking API has no prepared statements
+   */
+  std::string
+  getEscapedWhereClause(const QueryPlan& plan);
+#endif // HAVE_MYSQL_NONBLOCKING
+
+  /**
+   * Helper function that runs a job which queries the database; the job gets its own thread
+   * unless the DatabaseHandler never blocks
+   */
+  void
+  runDatabaseJob(const std::function<void()>& job);
+
   /**
    * Helper function to set the DatabaseHandler
    */
   void
   setDatabaseHandler(const util::ConnectionDetails&  databaseId);
 
+  /**
+   * Helper function that gives the indexes of the database table to the query planner
+   */
+  void
+  loadIndexes();
+
+  /**
+   * Helper function that plans a filter query, and counts the queries run on each index in
+   * the "query.index.<index>" metrics ("query.index.none" when no index fits)
+   */
+  QueryPlan
+  planQuery(const std::vector<std::pair<std::string, std::string>>& queryParams);
+
   void
   closeDatabaseHandler();
 
@@ -229,14 +314,15 @@ protected:
   setCatalogId();
 
   /**
-   * Helper function that generates the sqlQuery string for autocomplete query
-   * @param sqlQuery:      stringstream to save the sqlQuery string
+   * Helper function that generates the WHERE clause of an autocomplete query
+   * @param plan:          the typed components, compared with '=' to their name fields, whose
+   *                       values are bound as statement parameters
    * @param jsonValue:     Json value that contains the query information
    * @param lastComponent: Flag to mark the last component query
    * @param nameField:     stringstream to save the nameField string
    */
   bool
-  json2AutocompletionSql(std::stringstream& sqlQuery,
+  json2AutocompletionSql(QueryPlan& plan,
                          Json::Value& jsonValue,
                          bool& lastComponent,
                          std::stringstream& nameField);
@@ -253,8 +339,21 @@ protected:
   getQueryResultsName(std::shared_ptr<const ndn::Interest> interest,
                       const ndn::Name::Component& version);
 
-  std::string
-  getChronoSyncDigest();
+  /**
+   * Helper function that publishes a new catalog snapshot when the ChronoSync root digest has
+   * changed, and drops the filter responses generated from the previous one. It must run on the
+   * Face thread, the only thread that touches the sync socket
+   */
+  void
+  refreshSnapshot();
+
+  /**
+   * Helper function that answers /<prefix>/metrics with the metrics of the catalog in JSON
+   *
+   * @param dataName: name of the Data to send
+   */
+  void
+  sendMetrics(const ndn::Name& dataName);
 
 protected:
   typedef std::unordered_map<ndn::Name, const ndn::RegisteredPrefixId*> RegisteredPrefixList;
@@ -262,17 +361,24 @@ protected:
   std::shared_ptr<DatabaseHandler> m_dbConnPool;
   const std::shared_ptr<chronosync::Socket>& m_socket;
 
-  // mutex to control critical sections
-  std::mutex m_mutex;
-  // @{ needs m_mutex protection
-  // The Queries we are currently writing to
-  ndn::util::InMemoryStorageLru m_activeQueryToFirstResponse;
-  ndn::util::InMemoryStorageLru m_cache;
-  std::string m_chronosyncDigest;
-  // @}
+  // worker threads send Data through this queue, only the Face thread calls Face::put
+  util::OutboundDataQueue m_outboundQueue;
+
+  // The Queries we are currently writing to, both stores are thread-safe
+  util::ShardedContentStore m_activeQueryToFirstResponse;
+  util::ShardedContentStore m_cache;
+
+  // catalog state the query results are generated from, each query pins one snapshot
+  util::SnapshotHolder m_snapshots;
   RegisteredPrefixList m_registeredPrefixList;
   ndn::Name m_catalogId; // should be replaced with the PK digest
   std::vector<std::string> m_filterCategoryNames;
+  // records the incoming queries when "queryTrace" is configured
+  std::unique_ptr<util::QueryTraceWriter> m_queryTrace;
+  // read replicas of the database, the queries are spread over them and the primary
+  util::ReplicaSet m_replicas;
+  // builds the WHERE clause of the filter queries, only changed during configuration
+  QueryPlanner m_planner;
 };
 
 template <typename DatabaseHandler>
@@ -281,9 +387,10 @@ QueryAdapter<DatabaseHandler>::QueryAdapter(const std::shared_ptr<ndn::Face>& fa
                                             const std::shared_ptr<chronosync::Socket>& syncSocket)
   : util::CatalogAdapter(face, keyChain)
   , m_socket(syncSocket)
-  , m_activeQueryToFirstResponse(100000)
-  , m_cache(250000)
-  , m_chronosyncDigest("0")
+  , m_outboundQueue(*face)
+  , m_activeQueryToFirstResponse(100000, 0)
+  , m_cache(250000, 0)
+  , m_snapshots("0")
   , m_catalogId("catalogIdPlaceHolder") // initialize for unitests
 {
 }
@@ -309,6 +416,7 @@ QueryAdapter<DatabaseHandler>::setConfigFile(util::ConfigFile& config,
                                              const std::string& databaseTable)
 {
   m_nameFields = nameFields;
+  m_planner.setNameFields(nameFields);
   m_databaseTable = databaseTable;
   config.addSectionHandler("queryAdapter", bind(&QueryAdapter<DatabaseHandler>::onConfig, this,
                                                 _1, _2, _3, prefix));
@@ -325,7 +433,12 @@ QueryAdapter<DatabaseHandler>::onConfig(const util::ConfigSection& section,
   if (isDryRun) {
     return;
   }
-  std::string signingId, dbServer, dbName, dbUser, dbPasswd;
+  std::string signingId, dbServer, dbName, dbUser, dbPasswd, dbFile;
+  size_t maxConnections = MAX_DB_CONNECTIONS;
+  bool hasMaxConnections = false;
+  size_t maxWaiting = MAX_DB_CONNECTIONS;
+  size_t acquireTimeout = DB_ACQUIRE_TIMEOUT_MS;
+  unsigned int dbPort = DB_DEFAULT_PORT;
   for (auto item = section.begin();
        item != section.end();
        ++item)
@@ -344,6 +457,14 @@ QueryAdapter<DatabaseHandler>::onConfig(const util::ConfigSection& section,
         m_filterCategoryNames.push_back(token);
       }
     }
+    if (item->first == "queryTrace") {
+      std::string traceFile = item->second.get_value<std::string>();
+      if (traceFile.empty()) {
+        throw Error("Empty value for \"queryTrace\""
+                    " in \"query\" section");
+      }
+      m_queryTrace.reset(new util::QueryTraceWriter(traceFile));
+    }
     if (item->first == "database") {
       const util::ConfigSection& dataSection = item->second;
       for (auto subItem = dataSection.begin();
@@ -353,6 +474,9 @@ QueryAdapter<DatabaseHandler>::onConfig(const util::ConfigSection& section,
         if (subItem->first == "dbServer") {
           dbServer = subItem->second.get_value<std::string>();
         }
+        if (subItem->first == "dbPort") {
+          dbPort = subItem->second.get_value<unsigned int>();
+        }
         if (subItem->first == "dbName") {
           dbName = subItem->second.get_value<std::string>();
         }
@@ -362,23 +486,77 @@ QueryAdapter<DatabaseHandler>::onConfig(const util::ConfigSection& section,
         if (subItem->first == "dbPasswd") {
           dbPasswd = subItem->second.get_value<std::string>();
         }
+        if (subItem->first == "dbFile") {
+          dbFile = subItem->second.get_value<std::string>();
+        }
+        if (subItem->first == "maxConnections") {
+          maxConnections = subItem->second.get_value<size_t>();
+          hasMaxConnections = true;
+        }
+        if (subItem->first == "maxWaiting") {
+          maxWaiting = subItem->second.get_value<size_t>();
+        }
+        if (subItem->first == "acquireTimeout") {
+          acquireTimeout = subItem->second.get_value<size_t>();
+        }
+        if (subItem->first == "replica") {
+          util::ReplicaSet::Replica replica;
+          replica.server = subItem->second.get<std::string>("dbServer", "");
+          replica.port = subItem->second.get<unsigned int>("dbPort", 0);
+          replica.weight = subItem->second.get<size_t>("weight", 1);
+          if (replica.server.empty()) {
+            throw Error("Invalid value for \"dbServer\" of \"replica\""
+                        " in \"query\" section");
+          }
+          m_replicas.replicas.push_back(replica);
+        }
+        if (subItem->first == "primaryWeight") {
+          m_replicas.primaryWeight = subItem->second.get_value<size_t>();
+        }
+        if (subItem->first == "maxReplicaLag") {
+          m_replicas.maxLag = std::chrono::seconds(subItem->second.get_value<size_t>());
+        }
+        if (subItem->first == "healthCheckInterval") {
+          m_replicas.checkInterval =
+            std::chrono::milliseconds(subItem->second.get_value<size_t>());
+        }
       }
 
-      if (dbServer.empty()){
-        throw Error("Invalid value for \"dbServer\""
+      if (m_replicas.checkInterval.count() == 0){
+        throw Error("Invalid value for \"healthCheckInterval\""
                     " in \"query\" section");
       }
-      if (dbName.empty()){
-        throw Error("Invalid value for \"dbName\""
+      if (maxConnections == 0){
+        throw Error("Invalid value for \"maxConnections\""
                     " in \"query\" section");
       }
-      if (dbUser.empty()){
-        throw Error("Invalid value for \"dbUser\""
+      if (dbPort == 0 || dbPort > 65535){
+        throw Error("Invalid value for \"dbPort\""
                     " in \"query\" section");
       }
-      if (dbPasswd.empty()){
-        throw Error("Invalid value for \"dbPasswd\""
-                    " in \"query\" section");
+      // the embedded database only needs its file
+      if (dbFile.empty()) {
+        if (dbServer.empty()){
+          throw Error("Invalid value for \"dbServer\""
+                      " in \"query\" section");
+        }
+        if (dbName.empty()){
+          throw Error("Invalid value for \"dbName\""
+                      " in \"query\" section");
+        }
+        if (dbUser.empty()){
+          throw Error("Invalid value for \"dbUser\""
+                      " in \"query\" section");
+        }
+        if (dbPasswd.empty()){
+          throw Error("Invalid value for \"dbPasswd\""
+                      " in \"query\" section");
+        }
+      }
+      else if (!hasMaxConnections) {
+        // each connection of the embedded database is opened up front, and more readers than
+        // cores only contend for the same file
+        maxConnections = std::max(std::thread::hardware_concurrency(), 1u);
       }
     }
   }
@@ -388,12 +566,21 @@ QueryAdapter<DatabaseHandler>::onConfig(const util::ConfigSection& section,
   }
 
   m_prefix = prefix;
+  // all segments of one query result share /<prefix>/query/<json-query>, hence one shard
+  m_activeQueryToFirstResponse.setKeyLength(m_prefix.size() + 2);
+  m_cache.setKeyLength(m_prefix.size() + 2);
 
   m_signingId = ndn::Name(signingId);
   setCatalogId();
 
   util::ConnectionDetails mysqlId(dbServer, dbUser, dbPasswd, dbName);
+  mysqlId.port = dbPort;
+  mysqlId.maxConnections = maxConnections;
+  mysqlId.maxWaiting = maxWaiting;
+  mysqlId.acquireTimeout = std::chrono::milliseconds(acquireTimeout);
+  mysqlId.file = dbFile;
   setDatabaseHandler(mysqlId);
+  loadIndexes();
   setFilters();
 }
 
@@ -406,20 +593,25 @@ QueryAdapter<DatabaseHandler>::setCatalogId()
 
 template <>
 void
-QueryAdapter<ConnectionPool_T>::setCatalogId()
+QueryAdapter<util::DatabasePool>::setCatalogId()
 {
-  // use public key digest as the catalog ID
-  ndn::Name keyId;
-  if (m_signingId.empty()) {
-    keyId = m_keyChain->getDefaultKeyNameForIdentity(m_keyChain->getDefaultIdentity());
-  } else {
-    keyId = m_keyChain->getDefaultKeyNameForIdentity(m_signingId);
-  }
+  m_catalogId = computeCatalogId();
+}
 
-  std::shared_ptr<ndn::PublicKey> pKey = m_keyChain->getPib().getPublicKey(keyId);
-  ndn::Block keyDigest = pKey->computeDigest();
-  m_catalogId.clear();
-  m_catalogId.append(ndn::toHex(*keyDigest.getBuffer()));
+#ifdef HAVE_MYSQL_NONBLOCKING
+template <>
+void
+QueryAdapter<util::AsyncMysqlClient>::setCatalogId()
+{
+  m_catalogId = computeCatalogId();
+}
+#endif // HAVE_MYSQL_NONBLOCKING
+
+template <>
+void
+QueryAdapter<util::SqliteDatabase>::setCatalogId()
+{
+  m_catalogId = computeCatalogId();
 }
 
 template <typename DatabaseHandler>
@@ -431,9 +623,34 @@ QueryAdapter<DatabaseHandler>::setDatabaseHandler(const util::ConnectionDetails&
 
 template <>
 void
-QueryAdapter<ConnectionPool_T>::setDatabaseHandler(const util::ConnectionDetails& databaseId)
+QueryAdapter<util::DatabasePool>::setDatabaseHandler(const util::ConnectionDetails& databaseId)
+{
+  // the reads go to the primary and its replicas, the writes of PublishAdapter to the primary
+  m_dbConnPool = std::make_shared<util::DatabasePool>(databaseId, m_replicas, "query");
+}
+
+#ifdef HAVE_MYSQL_NONBLOCKING
+template <>
+void
+QueryAdapter<util::AsyncMysqlClient>::setDatabaseHandler(const util::ConnectionDetails& databaseId)
 {
-  m_dbConnPool = zdbConnectionSetup(databaseId);
+  // the statements run on the Face thread, no worker thread holds a connection; the client
+  // only talks to the primary, the replicas are used by the DatabasePool handler
+  m_dbConnPool = std::make_shared<util::AsyncMysqlClient>(m_face->getIoService(), databaseId,
+                                                          databaseId.maxConnections);
+}
+#endif // HAVE_MYSQL_NONBLOCKING
+
+template <>
+void
+QueryAdapter<util::SqliteDatabase>::setDatabaseHandler(const util::ConnectionDetails& databaseId)
+{
+  if (databaseId.file.empty()) {
+    throw Error("Invalid value for \"dbFile\" in \"query\" section");
+  }
+  // each query thread reads on its own connection, up to maxConnections at the same time
+  m_dbConnPool = std::make_shared<util::SqliteDatabase>(databaseId.file,
+                                                        databaseId.maxConnections);
 }
 
 template <typename DatabaseHandler>
@@ -444,9 +661,127 @@ QueryAdapter<DatabaseHandler>::closeDatabaseHandler()
 
 template <>
 void
-QueryAdapter<ConnectionPool_T>::closeDatabaseHandler()
+QueryAdapter<util::DatabasePool>::closeDatabaseHandler()
 {
-  ConnectionPool_stop(*m_dbConnPool);
+  m_dbConnPool->stop();
+}
+
+#ifdef HAVE_MYSQL_NONBLOCKING
+template <>
+void
+QueryAdapter<util::AsyncMysqlClient>::closeDatabaseHandler()
+{
+  if (m_dbConnPool != nullptr) {
+    m_dbConnPool->close();
+  }
+}
+#endif // HAVE_MYSQL_NONBLOCKING
+
+template <>
+void
+QueryAdapter<util::SqliteDatabase>::closeDatabaseHandler()
+{
+  if (m_dbConnPool != nullptr) {
+    m_dbConnPool->close();
+  }
+}
+
+template <typename DatabaseHandler>
+void
+QueryAdapter<DatabaseHandler>::loadIndexes()
+{
+  // empty
+}
+
+template <typename DatabaseHandler>
+QueryPlan
+QueryAdapter<DatabaseHandler>::planQuery(const std::vector<std::pair<std::string,
+                                                                     std::string>>& queryParams)
+{
+  QueryPlan plan = m_planner.plan(queryParams);
+  util::MetricsRegistry::getDefault().get("query.index." +
+                                          (plan.index.empty() ? "none" : plan.index)).add();
+  return plan;
+}
+
+template <>
+void
+QueryAdapter<util::DatabasePool>::loadIndexes()
+{
+  Connection_T conn = m_dbConnPool->acquire();
+  if (!conn) {
+    _LOG_DEBUG("No available database connections");
+    return;
+  }
+
+  // one row per column, in index order
+  std::vector<std::pair<std::string, std::vector<std::string>>> indexes;
+  std::string showIndexSql("SHOW INDEX FROM " + m_databaseTable + ";");
+  TRY {
+    ResultSet_T res4Index = Connection_executeQuery(conn, reinterpret_cast<const char*>(showIndexSql.c_str()), showIndexSql.size());
+    while (ResultSet_next(res4Index)) {
+      std::string indexName(ResultSet_getStringByName(res4Index, "Key_name"));
+      if (indexes.empty() || indexes.back().first != indexName) {
+        indexes.push_back(std::make_pair(indexName, std::vector<std::string>()));
+      }
+      // an index on an expression has no column
+      const char* columnName = ResultSet_getStringByName(res4Index, "Column_name");
+      indexes.back().second.push_back(columnName != NULL ? columnName : "");
+    }
+  }
+  CATCH(SQLException) {
+    _LOG_ERROR(Connection_getLastError(conn));
+  }
+  END_TRY;
+
+  m_dbConnPool->release(conn);
+  m_planner.setIndexes(indexes);
+}
+
+#ifdef HAVE_MYSQL_NONBLOCKING
+template <>
+void
+QueryAdapter<util::AsyncMysqlClient>::loadIndexes()
+{
+  // the queries run on the Face thread as well, the planner is never used concurrently
+  m_dbConnPool->query("SHOW INDEX FROM " + m_databaseTable + ";",
+                      [this] (const util::Rows& rows) {
+                        // Key_name and Column_name are the 3rd and 5th columns
+                        std::vector<std::pair<std::string, std::vector<std::string>>> indexes;
+                        for (const auto& row : rows) {
+                          if (indexes.empty() || indexes.back().first != row[2]) {
+                            indexes.push_back(std::make_pair(row[2], std::vector<std::string>()));
+                          }
+                          indexes.back().second.push_back(row[4]);
+                        }
+                        m_planner.setIndexes(indexes);
+                      },
+                      [] (const std::string& reason) {
+                        _LOG_ERROR(reason);
+                      });
+}
+#endif // HAVE_MYSQL_NONBLOCKING
+
+template <>
+void
+QueryAdapter<util::SqliteDatabase>::loadIndexes()
+{
+  std::vector<std::pair<std::string, std::vector<std::string>>> indexes;
+  try {
+    // the name of the index is the 2nd column of index_list, the name of the column the 3rd
+    // column of index_info
+    for (const auto& index : m_dbConnPool->query("PRAGMA index_list(" + m_databaseTable + ");")) {
+      std::vector<std::string> columns;
+      for (const auto& column : m_dbConnPool->query("PRAGMA index_info(" + index[1] + ");")) {
+        columns.push_back(column[2]);
+      }
+      indexes.push_back(std::make_pair(index[1], columns));
+    }
+  }
+  catch (const util::SqliteDatabase::Error& e) {
+    _LOG_ERROR(e.what());
+  }
+  m_planner.setIndexes(indexes);
 }
 
 
@@ -478,13 +813,18 @@ QueryAdapter<DatabaseHandler>::onIncomingQueryInterest(const ndn::InterestFilter
   _LOG_DEBUG("Interest : " << interest.getName());
   std::shared_ptr<const ndn::Interest> interestPtr = interest.shared_from_this();
 
+  // worker threads below pin the snapshot, and never read the sync socket themselves
+  refreshSnapshot();
+
   if (interest.getName()[filter.getPrefix().size()] == ndn::Name::Component("filters-initialization")) {
-    std::thread queryThread(&QueryAdapter<DatabaseHandler>::onFiltersInitializationInterest,
-                            this,
-                            interestPtr);
-    queryThread.detach();
+    runDatabaseJob(std::bind(&QueryAdapter<DatabaseHandler>::onFiltersInitializationInterest,
+                             this, interestPtr));
   }
   else if (interest.getName()[filter.getPrefix().size()] == ndn::Name::Component("query")) {
+    if (m_queryTrace != nullptr) {
+      // canonical query is /<prefix>/query/<json-query>
+      m_queryTrace->record(interest.getName(), filter.getPrefix().size() + 2);
+    }
 
     auto data = m_cache.find(interest);
     if (data) {
@@ -506,10 +846,10 @@ QueryAdapter<DatabaseHandler>::onIncomingQueryInterest(const ndn::InterestFilter
       interestPtr = std::make_shared<ndn::Interest>(queryInterest);
     }
 
-    std::thread queryThread(&QueryAdapter<DatabaseHandler>::runJsonQuery,
-                            this,
-                            interestPtr);
-    queryThread.detach();
+    runDatabaseJob(std::bind(&QueryAdapter<DatabaseHandler>::runJsonQuery, this, interestPtr));
+  }
+  else if (interest.getName()[filter.getPrefix().size()] == ndn::Name::Component("metrics")) {
+    sendMetrics(interest.getName());
   }
 
   // ignore other Interests
@@ -517,30 +857,83 @@ QueryAdapter<DatabaseHandler>::onIncomingQueryInterest(const ndn::InterestFilter
 
 template <typename DatabaseHandler>
 void
-QueryAdapter<DatabaseHandler>::onFiltersInitializationInterest(std::shared_ptr<const ndn::Interest> interest)
+QueryAdapter<DatabaseHandler>::runDatabaseJob(const std::function<void()>& job)
 {
-  _LOG_DEBUG(">> QueryAdapter::onFiltersInitializationInterest");
+  std::thread queryThread(job);
+  queryThread.detach();
+}
 
-  if(m_socket != nullptr) {
-    const ndn::ConstBufferPtr digestPtr = m_socket->getRootDigest();
-    std::string digestStr = ndn::toHex(digestPtr->buf(), digestPtr->size());
-    _LOG_DEBUG("Original digest :" << m_chronosyncDigest);
-    _LOG_DEBUG("New digest : " << digestStr);
-    // if the m_chronosyncDigest and the rootdigest are not equal
-    if (digestStr != m_chronosyncDigest) {
-      // (1) update chronosyncDigest
-      // (2) clear all staled ACK data
-      m_mutex.lock();
-      m_chronosyncDigest = digestStr;
-      m_activeQueryToFirstResponse.erase(ndn::Name("/"));
-      m_mutex.unlock();
-      _LOG_DEBUG("Change digest to " << m_chronosyncDigest);
-    }
+template <>
+void
+QueryAdapter<util::DatabasePool>::runDatabaseJob(const std::function<void()>& job)
+{
+  if (m_dbConnPool->isSaturated()) {
+    // the job could not get a connection anyway; do not answer, so that the consumer
+    // retransmits the Interest once the load is lower
+    util::MetricsRegistry::getDefault().get("query.rejected").add();
+    _LOG_DEBUG("Database pool saturated, query is not processed");
+    return;
   }
 
+  std::thread queryThread(job);
+  queryThread.detach();
+}
+
+#ifdef HAVE_MYSQL_NONBLOCKING
+template <>
+void
+QueryAdapter<util::AsyncMysqlClient>::runDatabaseJob(const std::function<void()>& job)
+{
+  // the job only submits statements to the non-blocking client, run it on the Face thread
+  job();
+}
+#endif // HAVE_MYSQL_NONBLOCKING
+
+template <typename DatabaseHandler>
+void
+QueryAdapter<DatabaseHandler>::refreshSnapshot()
+{
+  if (m_socket == nullptr) {
+    return;
+  }
+
+  const ndn::ConstBufferPtr digestPtr = m_socket->getRootDigest();
+  std::string digestStr = ndn::toHex(digestPtr->buf(), digestPtr->size());
+  if (m_snapshots.advance(digestStr)) {
+    // clear all staled ACK data
+    m_activeQueryToFirstResponse.erase(ndn::Name("/"));
+    _LOG_DEBUG("Change digest to " << digestStr);
+  }
+}
+
+template <typename DatabaseHandler>
+void
+QueryAdapter<DatabaseHandler>::sendMetrics(const ndn::Name& dataName)
+{
+  Json::Value metrics;
+  util::MetricsRegistry::getDefault().toJson(metrics);
+
+  Json::FastWriter fastWriter;
+  const std::string payload = fastWriter.write(metrics);
+
+  std::shared_ptr<ndn::Data> data = std::make_shared<ndn::Data>(dataName);
+  data->setContent(reinterpret_cast<const uint8_t*>(payload.c_str()), payload.size());
+  // the values keep changing, never cache them for long
+  data->setFreshnessPeriod(ndn::time::milliseconds(1000));
+
+  signData(*data);
+  m_face->put(*data);
+}
+
+template <typename DatabaseHandler>
+void
+QueryAdapter<DatabaseHandler>::onFiltersInitializationInterest(std::shared_ptr<const ndn::Interest> interest)
+{
+  _LOG_DEBUG(">> QueryAdapter::onFiltersInitializationInterest");
+
   auto data = m_activeQueryToFirstResponse.find(*interest);
   if (data) {
-    m_face->put(*data);
+    m_outboundQueue.push(data);
   }
   else {
     populateFiltersMenu(interest);
@@ -555,9 +948,58 @@ QueryAdapter<DatabaseHandler>::populateFiltersMenu(std::shared_ptr<const ndn::In
 {
   _LOG_DEBUG(">> QueryAdapter::populateFiltersMenu");
   Json::Value filters;
-  Json::FastWriter fastWriter;
   getFiltersMenu(filters);
+  sendFiltersMenu(interest, filters);
+  _LOG_DEBUG("<< QueryAdapter::populateFiltersMenu");
+}
 
+#ifdef HAVE_MYSQL_NONBLOCKING
+template <>
+void
+QueryAdapter<util::AsyncMysqlClient>::populateFiltersMenu(std::shared_ptr<const ndn::Interest> interest)
+{
+  _LOG_DEBUG(">> QueryAdapter::populateFiltersMenu");
+
+  // all categories are queried at the same time, the menu is sent when the last one completes
+  std::shared_ptr<Json::Value> filters = std::make_shared<Json::Value>(Json::arrayValue);
+  filters->resize(m_filterCategoryNames.size());
+  std::shared_ptr<size_t> nPending = std::make_shared<size_t>(m_filterCategoryNames.size());
+  std::function<void()> onCategoryDone = [this, interest, filters, nPending] {
+    if (--*nPending == 0) {
+      sendFiltersMenu(interest, *filters);
+    }
+  };
+
+  for (size_t i = 0; i < m_filterCategoryNames.size(); i++) {
+    std::string columnName = m_filterCategoryNames[i];
+    std::string getFilterSql("SELECT DISTINCT " + columnName +
+                             " FROM " + m_databaseTable + ";");
+
+    m_dbConnPool->query(getFilterSql,
+                        [filters, i, columnName, onCategoryDone]
+                        (const util::Rows& rows) {
+                          Json::Value& category = (*filters)[static_cast<int>(i)];
+                          for (const auto& row : rows) {
+                            category[columnName].append(row[0]);
+                          }
+                          onCategoryDone();
+                        },
+                        [onCategoryDone] (const std::string& reason) {
+                          _LOG_ERROR(reason);
+                          onCategoryDone();
+                        });
+  }
+
+  _LOG_DEBUG("<< QueryAdapter::populateFiltersMenu");
+}
+#endif // HAVE_MYSQL_NONBLOCKING
+
+template <typename DatabaseHandler>
+void
+QueryAdapter<DatabaseHandler>::sendFiltersMenu(std::shared_ptr<const ndn::Interest> interest,
+                                               const Json::Value& filters)
+{
+  Json::FastWriter fastWriter;
   const std::string filterValue = fastWriter.write(filters);
 
   if (!filters.empty()) {
@@ -580,17 +1022,10 @@ QueryAdapter<DatabaseHandler>::populateFiltersMenu(std::shared_ptr<const ndn::In
 
       _LOG_DEBUG("Populate Filter Data :" << segmentName);
 
-      m_mutex.lock();
       // save the filter results in the activeQueryToFirstResponse structure
       // when version changes, the activeQueryToFirstResponse should be cleaned
       m_activeQueryToFirstResponse.insert(*filterData);
-      try {
-        m_face->put(*filterData);
-      }
-      catch (std::exception& e) {
-        _LOG_ERROR(e.what());
-      }
-      m_mutex.unlock();
+      m_outboundQueue.push(filterData);
 
       seqNo++;
       startIndex = payloadLength * seqNo + 1;
@@ -604,12 +1039,9 @@ QueryAdapter<DatabaseHandler>::populateFiltersMenu(std::shared_ptr<const ndn::In
     filterData->setFinalBlockId(ndn::Name::Component::fromSegment(seqNo));
 
     signData(*filterData);
-    m_mutex.lock();
     m_activeQueryToFirstResponse.insert(*filterData);
-    m_face->put(*filterData);
-    m_mutex.unlock();
+    m_outboundQueue.push(filterData);
   }
-  _LOG_DEBUG("<< QueryAdapter::populateFiltersMenu");
 }
 
 template <typename DatabaseHandler>
@@ -622,12 +1054,12 @@ QueryAdapter<DatabaseHandler>::getFiltersMenu(Json::Value& value)
 // get distinct value of each column
 template <>
 void
-QueryAdapter<ConnectionPool_T>::getFiltersMenu(Json::Value& value)
+QueryAdapter<util::DatabasePool>::getFiltersMenu(Json::Value& value)
 {
   _LOG_DEBUG(">> QueryAdapter::getFiltersMenu");
   Json::Value tmp;
 
-  Connection_T conn = ConnectionPool_getConnection(*m_dbConnPool);
+  Connection_T conn = m_dbConnPool->acquire();
   if (!conn) {
     _LOG_DEBUG("No available database connections");
     return;
@@ -655,6 +1087,35 @@ QueryAdapter<ConnectionPool_T>::getFiltersMenu(Json::Value& value)
     tmp.clear();
   }
 
+  m_dbConnPool->release(conn);
+  _LOG_DEBUG("<< QueryAdapter::getFiltersMenu");
+}
+
+template <>
+void
+QueryAdapter<util::SqliteDatabase>::getFiltersMenu(Json::Value& value)
+{
+  _LOG_DEBUG(">> QueryAdapter::getFiltersMenu");
+  Json::Value tmp;
+
+  for (size_t i = 0; i < m_filterCategoryNames.size(); i++) {
+    std::string columnName = m_filterCategoryNames[i];
+    std::string getFilterSql("SELECT DISTINCT " + columnName +
+                             " FROM " + m_databaseTable + ";");
+
+    try {
+      for (const auto& row : m_dbConnPool->query(getFilterSql)) {
+        tmp[columnName].append(row[0]);
+      }
+    }
+    catch (const util::SqliteDatabase::Error& e) {
+      _LOG_ERROR(e.what());
+    }
+
+    value.append(tmp);
+    tmp.clear();
+  }
+
   _LOG_DEBUG("<< QueryAdapter::getFiltersMenu");
 }
 
@@ -716,15 +1177,13 @@ QueryAdapter<DatabaseHandler>::sendNack(const ndn::Name& dataPrefix)
 
   _LOG_DEBUG("Send Nack: " << ndn::Name(dataPrefix).appendSegment(segmentNo));
 
-  m_mutex.lock();
   m_cache.insert(*nack);
-  m_face->put(*nack);
-  m_mutex.unlock();
+  m_outboundQueue.push(nack);
 }
 
 template <typename DatabaseHandler>
 bool
-QueryAdapter<DatabaseHandler>::json2AutocompletionSql(std::stringstream& sqlQuery,
+QueryAdapter<DatabaseHandler>::json2AutocompletionSql(QueryPlan& plan,
                                                       Json::Value& jsonValue,
                                                       bool& lastComponent,
                                                       std::stringstream& fieldName)
@@ -765,45 +1224,37 @@ QueryAdapter<DatabaseHandler>::json2AutocompletionSql(std::stringstream& sqlQuer
     }
   }
 
-  // 1. get the expected column number by parsing the typedString, so we can get the filed name
-  size_t pos = 0;
-  size_t start = 1; // start from the 1st char which is not '/'
-  size_t count = 0; // also the name to query for
-  std::string token;
-  std::string delimiter = "/";
-  std::map<std::string, std::string> typedComponents;
-  while ((pos = typedString.find(delimiter, start)) != std::string::npos) {
-    token = typedString.substr(start, pos - start);
-    if (count >= m_nameFields.size() - 1) {
-      return false;
-    }
-
-    // add column name and value (token) into map
-    typedComponents.insert(std::pair<std::string, std::string>(m_nameFields[count], token));
-    count++;
-    start = pos + 1;
+  // 1. split the typedString: the components before the last '/' are the typed values, the
+  // empty one after it stands for the name field to complete
+  std::vector<util::ValueRef> components;
+  if (!util::tokenizeName(util::ValueRef{typedString.data(), typedString.size()},
+                          m_nameFields.size(), components, false)) {
+    return false;
   }
+  size_t count = components.size() - 1; // also the name to query for
 
-  // 2. generate the sql string (append what appears in the typed string, like activity='xxx'),
-  // return true
+  // 2. generate the WHERE clause (what appears in the typed string, like activity = ?), return
+  // true
   if (count == m_nameFields.size() - 1)
     lastComponent = true; // indicate this query is to query the last component
 
-  bool more = false;
+  // the conditions are ordered by field name
+  std::vector<size_t> typedFields;
+  for (size_t i = 0; i < count; ++i) {
+    typedFields.push_back(i);
+  }
+  std::sort(typedFields.begin(), typedFields.end(), [this] (size_t lhs, size_t rhs) {
+      return m_nameFields[lhs] < m_nameFields[rhs];
+    });
 
   fieldName << m_nameFields[count];
-  for (std::map<std::string, std::string>::iterator it = typedComponents.begin();
-       it != typedComponents.end(); ++it) {
-    if (more)
-      sqlQuery << " AND";
-    else
-      sqlQuery << " WHERE";
-
-    sqlQuery << " " << it->first << "='" << it->second << "'";
-
-    more = true;
+  // the typed values are user input, they are bound rather than pasted into the statement
+  plan.predicates.clear();
+  for (size_t field : typedFields) {
+    plan.predicates.push_back(Predicate{m_nameFields[field], "=",
+                                        std::string(components[field].data,
+                                                    components[field].size)});
   }
-  sqlQuery << ";";
   return true;
 }
 
@@ -844,31 +1295,24 @@ QueryAdapter<databasehandler>::doPrefixBasedSearch(Json::Value& jsonValue,
     }
   }
 
-  // 1. get the expected column number by parsing the typedString, so we can get the filed name
-  size_t pos = 0;
-  size_t start = 1; // start from the 1st char which is not '/'
-  size_t count = 0; // also the name to query for
-  size_t typedStringlen = typedString.length();
-  std::string token;
-  std::string delimiter = "/";
-
-  while ((pos = typedString.find(delimiter, start)) != std::string::npos) {
-    token = typedString.substr(start, pos - start);
-    if (count >= m_nameFields.size()) {
-      return false;
-    }
-
-    // add column name and value (token) into map
-    typedComponents.push_back(std::make_pair(m_nameFields[count], token));
-
-    count++;
-    start = pos + 1;
+  // 1. split the typedString into one value per name field, we may have a component after the
+  // last "/"
+  std::vector<util::ValueRef> components;
+  if (!util::tokenizeName(util::ValueRef{typedString.data(), typedString.size()},
+                          m_nameFields.size() + 1, components, false)) {
+    return false;
+  }
+  if (components.back().size == 0) {
+    components.pop_back();
+  }
+  if (components.size() > m_nameFields.size()) {
+    return false;
   }
 
-  // we may have a component after the last "/"
-  if (start < typedStringlen) {
-    typedComponents.push_back(std::make_pair(m_nameFields[count],
-                                             typedString.substr(start, typedStringlen - start)));
+  for (size_t i = 0; i < components.size(); ++i) {
+    typedComponents.push_back(std::make_pair(m_nameFields[i],
+                                             std::string(components[i].data,
+                                                         components[i].size)));
   }
 
   return true;
@@ -933,29 +1377,10 @@ QueryAdapter<DatabaseHandler>::runJsonQuery(std::shared_ptr<const ndn::Interest>
     return;
   }
 
-  // the version should be replaced with ChronoSync state digest
-  ndn::name::Component version;
-
-  if(m_socket != nullptr) {
-    const ndn::ConstBufferPtr digestPtr = m_socket->getRootDigest();
-    std::string digestStr = ndn::toHex(digestPtr->buf(), digestPtr->size());
-    _LOG_DEBUG("Original digest " << m_chronosyncDigest);
-    _LOG_DEBUG("New digest : " << digestStr);
-    // if the m_chronosyncDigest and the rootdigest are not equal
-    if (digestStr != m_chronosyncDigest) {
-      // (1) update chronosyncDigest
-      // (2) clear all staled ACK data
-      m_mutex.lock();
-      m_chronosyncDigest = digestStr;
-      m_activeQueryToFirstResponse.erase(ndn::Name("/"));
-      m_mutex.unlock();
-      _LOG_DEBUG("Change digest to " << m_chronosyncDigest);
-    }
-    version = ndn::name::Component::fromEscapedString(digestStr);
-  }
-  else {
-    version = ndn::name::Component::fromEscapedString(m_chronosyncDigest);
-  }
+  // the version is the ChronoSync state digest of the snapshot pinned for this query, so all
+  // the segments of the result are consistent even if sync updates arrive in the meantime
+  std::shared_ptr<const util::CatalogSnapshot> snapshot = m_snapshots.pin();
+  ndn::name::Component version = ndn::name::Component::fromEscapedString(snapshot->digest);
 
   // 2) From the remainder of the ndn::Interest's ndn::Name, get the JSON out
   Json::Value parsedFromString;
@@ -978,14 +1403,15 @@ QueryAdapter<DatabaseHandler>::runJsonQuery(std::shared_ptr<const ndn::Interest>
   // if Json::Value contains ? as key, is autocompletion
   if (parsedFromString.get("?", tmp) != tmp) {
     bool lastComponent = false;
-    std::stringstream sqlQuery, fieldName;
+    QueryPlan plan;
+    std::stringstream fieldName;
 
     // must generate the sql string for autocomple, the selected column is changing
-    if (!json2AutocompletionSql(sqlQuery, parsedFromString, lastComponent, fieldName)) {
+    if (!json2AutocompletionSql(plan, parsedFromString, lastComponent, fieldName)) {
       sendNack(segmentPrefix);
       return;
     }
-    prepareSegmentsBySqlString(segmentPrefix, sqlQuery.str(), lastComponent, fieldName.str());
+    prepareSegmentsBySqlString(segmentPrefix, plan, lastComponent, fieldName.str());
   }
   else if (parsedFromString.get("??", tmp) != tmp) {
     if (!doPrefixBasedSearch(parsedFromString, typedComponents)) {
@@ -1014,47 +1440,33 @@ prepareSegmentsByParams(std::vector<std::pair<std::string, std::string>>& queryP
 
 template <>
 void
-QueryAdapter<ConnectionPool_T>::
+QueryAdapter<util::DatabasePool>::
 prepareSegmentsByParams(std::vector<std::pair<std::string, std::string>>& queryParams,
                         const ndn::Name& segmentPrefix)
 {
   _LOG_DEBUG(">> QueryAdapter::prepareSegmentsByParams");
 
   // the prepared_statement cannot improve the performance, but can simplify the code
-  Connection_T conn = ConnectionPool_getConnection(*m_dbConnPool);
+  Connection_T conn = m_dbConnPool->acquire();
   if (!conn) {
     // do not answer for this request due to lack of connections, request will come back later
     _LOG_DEBUG("No available database connections");
     return;
   }
+
+  // only the constrained name fields are in the WHERE clause, so that an index can be used
+  QueryPlan plan = planQuery(queryParams);
+  _LOG_DEBUG("Query plan" << plan.getWhereClause() << " on index " << plan.index);
+
   std::string getRecordNumSqlStr("SELECT count(name) FROM ");
   getRecordNumSqlStr += m_databaseTable;
-  getRecordNumSqlStr += " WHERE ";
-  for (size_t i = 0; i < m_nameFields.size(); i++) {
-    getRecordNumSqlStr += m_nameFields[i];
-    getRecordNumSqlStr += " LIKE ?";
-    if (i != m_nameFields.size() - 1) {
-      getRecordNumSqlStr += " AND ";
-    }
-  }
+  getRecordNumSqlStr += plan.getWhereClause();
 
   PreparedStatement_T ps4RecordNum =
     Connection_prepareStatement(conn, reinterpret_cast<const char*>(getRecordNumSqlStr.c_str()), getRecordNumSqlStr.size());
 
-  // before query, initialize all params for statement
-  for (size_t i = 0; i < m_nameFields.size(); i++) {
-    PreparedStatement_setString(ps4RecordNum, i + 1, "%");
-  }
-
-  // reset params based on the query
-  for (std::vector<std::pair<std::string, std::string>>::iterator it = queryParams.begin();
-       it != queryParams.end(); ++it) {
-    // dictionary is faster
-    for (size_t i = 0; i < m_nameFields.size(); i++) {
-      if (it->first == m_nameFields[i]) {
-        PreparedStatement_setString(ps4RecordNum, i + 1, it->second.c_str());
-      }
-    }
+  for (size_t i = 0; i < plan.predicates.size(); i++) {
+    PreparedStatement_setString(ps4RecordNum, i + 1, plan.predicates[i].value.c_str());
   }
 
   ResultSet_T res4RecordNum;
@@ -1076,32 +1488,13 @@ prepareSegmentsByParams(std::vector<std::pair<std::string, std::string>>& queryP
   // get name list statement
   std::string getNameListSqlStr("SELECT name, has_metadata FROM ");
   getNameListSqlStr += m_databaseTable;
-  getNameListSqlStr += " WHERE ";
-  for (size_t i = 0; i < m_nameFields.size(); i++) {
-    getNameListSqlStr += m_nameFields[i];
-    getNameListSqlStr += " LIKE ?";
-    if (i != m_nameFields.size() - 1) {
-      getNameListSqlStr += " AND ";
-    }
-  }
+  getNameListSqlStr += plan.getWhereClause();
 
   PreparedStatement_T ps4Name =
     Connection_prepareStatement(conn, reinterpret_cast<const char*>(getNameListSqlStr.c_str()), getNameListSqlStr.size());
 
-  // before query, initialize all params for statement
-  for (size_t i = 0; i < m_nameFields.size(); i++) {
-    PreparedStatement_setString(ps4Name, i + 1, "%");
-  }
-
-  // reset params based on the query
-  for (std::vector<std::pair<std::string, std::string>>::iterator it = queryParams.begin();
-       it != queryParams.end(); ++it) {
-    // dictionary is faster
-    for (size_t i = 0; i < m_nameFields.size(); i++) {
-      if (it->first == m_nameFields[i]) {
-        PreparedStatement_setString(ps4Name, i + 1, it->second.c_str());
-      }
-    }
+  for (size_t i = 0; i < plan.predicates.size(); i++) {
+    PreparedStatement_setString(ps4Name, i + 1, plan.predicates[i].value.c_str());
   }
 
   ResultSet_T res4Name;
@@ -1115,7 +1508,55 @@ prepareSegmentsByParams(std::vector<std::pair<std::string, std::string>>& queryP
 
   generateSegments(res4Name, segmentPrefix, resultCount, false, false);
 
-  Connection_close(conn);
+  m_dbConnPool->release(conn);
+}
+
+#ifdef HAVE_MYSQL_NONBLOCKING
+template <>
+void
+QueryAdapter<util::AsyncMysqlClient>::
+prepareSegmentsByParams(std::vector<std::pair<std::string, std::string>>& queryParams,
+                        const ndn::Name& segmentPrefix)
+{
+  _LOG_DEBUG(">> QueryAdapter::prepareSegmentsByParams");
+
+  QueryPlan plan = planQuery(queryParams);
+  std::string whereClause = getEscapedWhereClause(plan);
+
+  generateSegmentsAsync("SELECT count(name) FROM " + m_databaseTable + whereClause,
+                        "SELECT name, has_metadata FROM " + m_databaseTable + whereClause,
+                        segmentPrefix, false, false);
+}
+#endif // HAVE_MYSQL_NONBLOCKING
+
+template <>
+void
+QueryAdapter<util::SqliteDatabase>::
+prepareSegmentsByParams(std::vector<std::pair<std::string, std::string>>& queryParams,
+                        const ndn::Name& segmentPrefix)
+{
+  _LOG_DEBUG(">> QueryAdapter::prepareSegmentsByParams");
+
+  QueryPlan plan = planQuery(queryParams);
+  std::string whereClause = plan.getWhereClause();
+  std::vector<std::string> values = plan.getValues();
+
+  util::Rows countRows, rows;
+  try {
+    countRows = m_dbConnPool->query("SELECT count(name) FROM " + m_databaseTable + whereClause,
+                                    values);
+    rows = m_dbConnPool->query("SELECT name, has_metadata FROM " + m_databaseTable + whereClause,
+                               values);
+  }
+  catch (const util::SqliteDatabase::Error& e) {
+    _LOG_ERROR(e.what());
+  }
+
+  uint64_t resultCount = 0;
+  if (!countRows.empty()) {
+    resultCount = std::strtoull(countRows.front()[0].c_str(), nullptr, 10);
+  }
+  generateSegments(rows, segmentPrefix, resultCount, false, false);
 }
 
 template <typename DatabaseHandler>
@@ -1126,33 +1567,118 @@ QueryAdapter<DatabaseHandler>::generateSegments(ResultSet_T& res,
                                                 bool autocomplete,
                                                 bool lastComponent)
 {
-  uint64_t segmentno = 0;
-  Json::Value tmp, buf, resultjson;
-  Json::FastWriter fastWriter;
-
   bool twoColumns = false;
   if (ResultSet_getColumnCount(res) > 1) {
     twoColumns = true;
   }
 
+  packSegments([&res, twoColumns] (Json::Value& entry) -> bool {
+                 if (!ResultSet_next(res)) {
+                   return false;
+                 }
+                 entry["name"] = ResultSet_getString(res, 1);
+                 if (twoColumns) {
+                   entry["has_metadata"] = ResultSet_getInt(res, 2);
+                 } else {
+                   entry["has_metadata"] = 0;
+                 }
+                 return true;
+               },
+               segmentPrefix, resultCount, autocomplete, lastComponent);
+}
+
+template <typename DatabaseHandler>
+void
+QueryAdapter<DatabaseHandler>::generateSegments(const std::vector<std::vector<std::string>>& rows,
+                                                const ndn::Name& segmentPrefix,
+                                                int resultCount,
+                                                bool autocomplete,
+                                                bool lastComponent)
+{
+  size_t next = 0;
+  packSegments([&rows, &next] (Json::Value& entry) -> bool {
+                 if (next == rows.size()) {
+                   return false;
+                 }
+                 const std::vector<std::string>& row = rows[next++];
+                 entry["name"] = row[0];
+                 if (row.size() > 1) {
+                   entry["has_metadata"] = std::atoi(row[1].c_str());
+                 } else {
+                   entry["has_metadata"] = 0;
+                 }
+                 return true;
+               },
+               segmentPrefix, resultCount, autocomplete, lastComponent);
+}
+
+#ifdef HAVE_MYSQL_NONBLOCKING
+template <typename DatabaseHandler>
+void
+QueryAdapter<DatabaseHandler>::generateSegmentsAsync(const std::string& countSql,
+                                                     const std::string& resultsSql,
+                                                     const ndn::Name& segmentPrefix,
+                                                     bool autocomplete,
+                                                     bool lastComponent)
+{
+  auto onError = [] (const std::string& reason) {
+    _LOG_ERROR(reason);
+  };
+
+  m_dbConnPool->query(countSql,
+                      [=] (const util::Rows& countRows) {
+                        uint64_t resultCount = 0;
+                        if (!countRows.empty()) {
+                          resultCount = std::strtoull(countRows.front()[0].c_str(), nullptr, 10);
+                        }
+                        m_dbConnPool->query(resultsSql,
+                                            [=] (const util::Rows& rows) {
+                                              generateSegments(rows, segmentPrefix, resultCount,
+                                                               autocomplete, lastComponent);
+                                            },
+                                            onError);
+                      },
+                      onError);
+}
+
+template <typename DatabaseHandler>
+std::string
+QueryAdapter<DatabaseHandler>::getEscapedWhereClause(const QueryPlan& plan)
+{
+  std::string whereClause;
+  for (size_t i = 0; i < plan.predicates.size(); i++) {
+    whereClause += i == 0 ? " WHERE " : " AND ";
+    whereClause += plan.predicates[i].column;
+    whereClause += " " + plan.predicates[i].op + " '";
+    whereClause += m_dbConnPool->escape(plan.predicates[i].value);
+    whereClause += "'";
+  }
+  return whereClause;
+}
+#endif // HAVE_MYSQL_NONBLOCKING
+
+template <typename DatabaseHandler>
+void
+QueryAdapter<DatabaseHandler>::packSegments(const std::function<bool(Json::Value&)>& nextEntry,
+                                            const ndn::Name& segmentPrefix,
+                                            int resultCount,
+                                            bool autocomplete,
+                                            bool lastComponent)
+{
+  uint64_t segmentno = 0;
+  Json::Value tmp, buf, resultjson;
+  Json::FastWriter fastWriter;
+
   uint64_t viewstart = 0, viewend = 0;
-  while (ResultSet_next(res)) {
-    tmp["name"] = ResultSet_getString(res, 1);
-    if (twoColumns) {
-      tmp["has_metadata"] = ResultSet_getInt(res, 2);
-    } else {
-      tmp["has_metadata"] = 0;
-    }
+  while (nextEntry(tmp)) {
     buf.append(tmp);
     const std::string tmpString = fastWriter.write(buf);
     if (tmpString.length() > PAYLOAD_LIMIT) {
       std::shared_ptr<ndn::Data> data
         = makeReplyData(segmentPrefix, resultjson, segmentno, false,
                         autocomplete, resultCount, viewstart, viewend, lastComponent);
-      m_mutex.lock();
       m_cache.insert(*data);
-      m_face->put(*data);
-      m_mutex.unlock();
+      m_outboundQueue.push(data);
 
       buf.clear();
       resultjson.clear();
@@ -1167,16 +1693,14 @@ QueryAdapter<DatabaseHandler>::generateSegments(ResultSet_T& res,
   std::shared_ptr<ndn::Data> data
     = makeReplyData(segmentPrefix, resultjson, segmentno, true,
                     autocomplete, resultCount, viewstart, viewend, lastComponent);
-  m_mutex.lock();
   m_cache.insert(*data);
-  m_face->put(*data);
-  m_mutex.unlock();
+  m_outboundQueue.push(data);
 }
 
 template <typename DatabaseHandler>
 void
 QueryAdapter<DatabaseHandler>::prepareSegmentsBySqlString(const ndn::Name& segmentPrefix,
-                                                          const std::string& sqlString,
+                                                          const QueryPlan& plan,
                                                           bool lastComponent,
                                                           const std::string& nameField)
 {
@@ -1186,16 +1710,16 @@ QueryAdapter<DatabaseHandler>::prepareSegmentsBySqlString(const ndn::Name& segme
 
 template <>
 void
-QueryAdapter<ConnectionPool_T>::prepareSegmentsBySqlString(const ndn::Name& segmentPrefix,
-                                                          const std::string& sqlString,
+QueryAdapter<util::DatabasePool>::prepareSegmentsBySqlString(const ndn::Name& segmentPrefix,
+                                                          const QueryPlan& plan,
                                                           bool lastComponent,
                                                           const std::string& nameField)
 {
   _LOG_DEBUG(">> QueryAdapter::prepareSegmentsBySqlString");
 
-  _LOG_DEBUG(sqlString);
+  _LOG_DEBUG(plan.getWhereClause());
 
-  Connection_T conn = ConnectionPool_getConnection(*m_dbConnPool);
+  Connection_T conn = m_dbConnPool->acquire();
   if (!conn) {
     _LOG_DEBUG("No available database connections");
     return;
@@ -1206,11 +1730,18 @@ QueryAdapter<ConnectionPool_T>::prepareSegmentsBySqlString(const ndn::Name& segm
   getRecordNumSqlStr += nameField;
   getRecordNumSqlStr += ") FROM ";
   getRecordNumSqlStr += m_databaseTable;
-  getRecordNumSqlStr += sqlString;
+  getRecordNumSqlStr += plan.getWhereClause();
+
+  PreparedStatement_T ps4RecordNum =
+    Connection_prepareStatement(conn, reinterpret_cast<const char*>(getRecordNumSqlStr.c_str()), getRecordNumSqlStr.size());
+
+  for (size_t i = 0; i < plan.predicates.size(); i++) {
+    PreparedStatement_setString(ps4RecordNum, i + 1, plan.predicates[i].value.c_str());
+  }
 
   ResultSet_T res4RecordNum;
   TRY {
-    res4RecordNum = Connection_executeQuery(conn, reinterpret_cast<const char*>(getRecordNumSqlStr.c_str()), getRecordNumSqlStr.size());
+    res4RecordNum = PreparedStatement_executeQuery(ps4RecordNum);
   }
   CATCH(SQLException) {
     _LOG_ERROR(Connection_getLastError(conn));
@@ -1227,11 +1758,18 @@ QueryAdapter<ConnectionPool_T>::prepareSegmentsBySqlString(const ndn::Name& segm
   getNextFieldsSqlStr += nameField;
   getNextFieldsSqlStr += " FROM ";
   getNextFieldsSqlStr += m_databaseTable;
-  getNextFieldsSqlStr += sqlString;
+  getNextFieldsSqlStr += plan.getWhereClause();
+
+  PreparedStatement_T ps4NextFields =
+    Connection_prepareStatement(conn, reinterpret_cast<const char*>(getNextFieldsSqlStr.c_str()), getNextFieldsSqlStr.size());
+
+  for (size_t i = 0; i < plan.predicates.size(); i++) {
+    PreparedStatement_setString(ps4NextFields, i + 1, plan.predicates[i].value.c_str());
+  }
 
   ResultSet_T res4NextFields;
   TRY {
-    res4NextFields = Connection_executeQuery(conn, reinterpret_cast<const char*>(getNextFieldsSqlStr.c_str()), getNextFieldsSqlStr.size());
+    res4NextFields = PreparedStatement_executeQuery(ps4NextFields);
   }
   CATCH(SQLException) {
     _LOG_ERROR(Connection_getLastError(conn));
@@ -1240,7 +1778,58 @@ QueryAdapter<ConnectionPool_T>::prepareSegmentsBySqlString(const ndn::Name& segm
 
   generateSegments(res4NextFields, segmentPrefix, resultCount, true, lastComponent);
 
-  Connection_close(conn);
+  m_dbConnPool->release(conn);
+}
+
+#ifdef HAVE_MYSQL_NONBLOCKING
+template <>
+void
+QueryAdapter<util::AsyncMysqlClient>::prepareSegmentsBySqlString(const ndn::Name& segmentPrefix,
+                                                                const QueryPlan& plan,
+                                                                bool lastComponent,
+                                                                const std::string& nameField)
+{
+  _LOG_DEBUG(">> QueryAdapter::prepareSegmentsBySqlString");
+
+  std::string whereClause = getEscapedWhereClause(plan);
+  _LOG_DEBUG(whereClause);
+
+  generateSegmentsAsync("SELECT COUNT( DISTINCT " + nameField + ") FROM " +
+                          m_databaseTable + whereClause,
+                        "SELECT DISTINCT " + nameField + " FROM " + m_databaseTable + whereClause,
+                        segmentPrefix, true, lastComponent);
+}
+#endif // HAVE_MYSQL_NONBLOCKING
+
+template <>
+void
+QueryAdapter<util::SqliteDatabase>::prepareSegmentsBySqlString(const ndn::Name& segmentPrefix,
+                                                              const QueryPlan& plan,
+                                                              bool lastComponent,
+                                                              const std::string& nameField)
+{
+  _LOG_DEBUG(">> QueryAdapter::prepareSegmentsBySqlString");
+
+  std::string whereClause = plan.getWhereClause();
+  std::vector<std::string> values = plan.getValues();
+  _LOG_DEBUG(whereClause);
+
+  util::Rows countRows, rows;
+  try {
+    countRows = m_dbConnPool->query("SELECT COUNT( DISTINCT " + nameField + ") FROM " +
+                                    m_databaseTable + whereClause, values);
+    rows = m_dbConnPool->query("SELECT DISTINCT " + nameField + " FROM " +
+                               m_databaseTable + whereClause, values);
+  }
+  catch (const util::SqliteDatabase::Error& e) {
+    _LOG_ERROR(e.what());
+  }
+
+  uint64_t resultCount = 0;
+  if (!countRows.empty()) {
+    resultCount = std::strtoull(countRows.front()[0].c_str(), nullptr, 10);
+  }
+  generateSegments(rows, segmentPrefix, resultCount, true, lastComponent);
 }
 
 template <typename DatabaseHandler>
@@ -0,0 +1,163 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "query/query-planner.hpp"
+
+#include <map>
+
+namespace atmos {
+namespace query {
+
+std::string
+QueryPlan::getWhereClause() const
+{
+  std::string whereClause;
+  for (size_t i = 0; i < predicates.size(); i++) {
+    whereClause += i == 0 ? " WHERE " : " AND ";
+    whereClause += predicates[i].column;
+    whereClause += " ";
+    whereClause += predicates[i].op;
+    whereClause += " ?";
+  }
+  return whereClause;
+}
+
+std::vector<std::string>
+QueryPlan::getValues() const
+{
+  std::vector<std::string> values;
+  for (const auto& predicate : predicates) {
+    values.push_back(predicate.value);
+  }
+  return values;
+}
+
+QueryPlanner::QueryPlanner(const std::vector<std::string>& nameFields)
+  : m_nameFields(nameFields)
+{
+}
+
+void
+QueryPlanner::setNameFields(const std::vector<std::string>& nameFields)
+{
+  m_nameFields = nameFields;
+}
+
+void
+QueryPlanner::setIndexes(const std::vector<std::pair<std::string,
+                                                     std::vector<std::string>>>& indexes)
+{
+  m_indexes = indexes;
+}
+
+bool
+QueryPlanner::hasWildcard(const std::string& value)
+{
+  return value.find_first_of("%_\\") != std::string::npos;
+}
+
+QueryPlan
+QueryPlanner::plan(const std::vector<std::pair<std::string, std::string>>& queryParams) const
+{
+  std::vector<const std::string*> values(m_nameFields.size(), nullptr);
+  for (const auto& param : queryParams) {
+    for (size_t i = 0; i < m_nameFields.size(); i++) {
+      if (param.first == m_nameFields[i]) {
+        values[i] = &param.second;
+      }
+    }
+  }
+
+  // constrained columns, in name field order
+  std::vector<Predicate> predicates;
+  std::map<std::string, size_t> predicateOfColumn;
+  for (size_t i = 0; i < m_nameFields.size(); i++) {
+    if (values[i] == nullptr) {
+      continue;
+    }
+    const std::string& value = *values[i];
+    if (!value.empty() && value.find_first_not_of('%') == std::string::npos) {
+      // matches every value of a NOT NULL column
+      continue;
+    }
+
+    Predicate predicate;
+    predicate.column = m_nameFields[i];
+    predicate.op = hasWildcard(value) ? "LIKE" : "=";
+    predicate.value = value;
+    predicateOfColumn[predicate.column] = predicates.size();
+    predicates.push_back(predicate);
+  }
+
+  // the best index has the most leading columns compared with '=', and may end with a column
+  // compared with a LIKE that has a fixed prefix, which is a range of the index
+  int bestScore = 0;
+  size_t bestIndex = 0;
+  size_t bestLength = 0;
+  for (size_t i = 0; i < m_indexes.size(); i++) {
+    int score = 0;
+    size_t length = 0;
+    for (const auto& column : m_indexes[i].second) {
+      auto it = predicateOfColumn.find(column);
+      if (it == predicateOfColumn.end()) {
+        break;
+      }
+      const Predicate& predicate = predicates[it->second];
+      if (predicate.op == "=") {
+        score += 2;
+        length++;
+        continue;
+      }
+      if (!predicate.value.empty() && !hasWildcard(predicate.value.substr(0, 1))) {
+        score += 1;
+        length++;
+      }
+      break;
+    }
+    if (score > bestScore) {
+      bestScore = score;
+      bestIndex = i;
+      bestLength = length;
+    }
+  }
+
+  QueryPlan plan;
+  std::vector<bool> isPlanned(predicates.size(), false);
+  if (bestScore > 0) {
+    plan.index = m_indexes[bestIndex].first;
+    for (size_t i = 0; i < bestLength; i++) {
+      size_t predicate = predicateOfColumn[m_indexes[bestIndex].second[i]];
+      plan.predicates.push_back(predicates[predicate]);
+      isPlanned[predicate] = true;
+    }
+  }
+  for (size_t i = 0; i < predicates.size(); i++) {
+    if (!isPlanned[i] && predicates[i].op == "=") {
+      plan.predicates.push_back(predicates[i]);
+    }
+  }
+  for (size_t i = 0; i < predicates.size(); i++) {
+    if (!isPlanned[i] && predicates[i].op != "=") {
+      plan.predicates.push_back(predicates[i]);
+    }
+  }
+  return plan;
+}
+
+} // namespace query
+} // namespace atmos
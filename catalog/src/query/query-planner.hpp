@@ -0,0 +1,111 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_QUERY_QUERY_PLANNER_HPP
+#define ATMOS_QUERY_QUERY_PLANNER_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace atmos {
+namespace query {
+
+/**
+ * Condition of a query on one column, whose value is bound as a statement parameter
+ */
+struct Predicate
+{
+public:
+  std::string column;
+  // "=" or "LIKE"
+  std::string op;
+  std::string value;
+};
+
+/**
+ * The WHERE clause of a query, as chosen by the QueryPlanner
+ */
+struct QueryPlan
+{
+public:
+  /**
+   * @return " WHERE <column> <op> ? AND ...", or an empty string when nothing is constrained
+   */
+  std::string
+  getWhereClause() const;
+
+  /**
+   * @return the values to bind to the parameters of the WHERE clause, in order
+   */
+  std::vector<std::string>
+  getValues() const;
+
+  std::vector<Predicate> predicates;
+  // the index whose leading columns the predicates start with, empty if none
+  std::string index;
+};
+
+/**
+ * QueryPlanner turns the name field values of a filter query into a WHERE clause that the
+ * database can run on an index.
+ *
+ * Only the name fields the query constrains get a predicate, since a LIKE '%' on the other ones
+ * matches everything and keeps the database from using an index. A value without LIKE wildcards
+ * ('%', '_') nor escape ('\') is compared with '='. The predicates on the leading columns of the
+ * index that fits the query best come first, then the other equalities, then the LIKE ones.
+ */
+class QueryPlanner
+{
+public:
+  explicit
+  QueryPlanner(const std::vector<std::string>& nameFields = std::vector<std::string>());
+
+  void
+  setNameFields(const std::vector<std::string>& nameFields);
+
+  /**
+   * Set the indexes of the table
+   *
+   * @param indexes: name of each index and its columns, in index order
+   */
+  void
+  setIndexes(const std::vector<std::pair<std::string, std::vector<std::string>>>& indexes);
+
+  /**
+   * @param queryParams: name field and value pairs; unknown fields are ignored, and the last
+   *                     value wins when a field appears more than once
+   */
+  QueryPlan
+  plan(const std::vector<std::pair<std::string, std::string>>& queryParams) const;
+
+  /**
+   * @return true if the value contains a LIKE wildcard or escape character
+   */
+  static bool
+  hasWildcard(const std::string& value);
+
+private:
+  std::vector<std::string> m_nameFields;
+  std::vector<std::pair<std::string, std::vector<std::string>>> m_indexes;
+};
+
+} // namespace query
+} // namespace atmos
+
+#endif // ATMOS_QUERY_QUERY_PLANNER_HPP
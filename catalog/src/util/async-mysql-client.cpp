@@ -0,0 +1,471 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/async-mysql-client.hpp"
+
+#ifdef HAVE_MYSQL_NONBLOCKING
+
+#include "util/logger.hpp"
+
+#include <mysql/errmsg.h>
+#include <mysql/mysqld_error.h>
+
+#include <iostream>
+
+namespace atmos {
+namespace util {
+#ifdef HAVE_LOG4CXX
+  INIT_LOGGER("AsyncMysqlClient");
+#endif
+
+// seconds to wait before connecting again after a connection failure
+static const long RECONNECT_INTERVAL = 1;
+
+struct AsyncMysqlClient::Connection
+{
+  explicit
+  Connection(boost::asio::io_service& ioService)
+    : mysql(nullptr)
+    , connectResult(nullptr)
+    , timer(ioService)
+    , waitId(0)
+    , isConnected(false)
+    , error(0)
+    , result(nullptr)
+  {
+  }
+
+  MYSQL* mysql;
+  MYSQL* connectResult;
+  // wraps the socket of mysql, created once MariaDB has opened it
+  std::unique_ptr<boost::asio::posix::stream_descriptor> socket;
+  boost::asio::deadline_timer timer;
+  // identifies the current round of waits, completions of older rounds are ignored
+  uint64_t waitId;
+  bool isConnected;
+  Continuation cont;
+  std::function<void()> onComplete;
+  int error;
+  MYSQL_RES* result;
+  Request request;
+};
+
+AsyncMysqlClient::AsyncMysqlClient(boost::asio::io_service& ioService,
+                                   const ConnectionDetails& details,
+                                   size_t nConnections)
+  : m_ioService(ioService)
+  , m_details(details)
+  , m_isClosed(false)
+{
+  for (size_t i = 0; i < nConnections; ++i) {
+    std::shared_ptr<Connection> conn = std::make_shared<Connection>(m_ioService);
+    m_connections.push_back(conn);
+    startConnect(conn);
+  }
+}
+
+AsyncMysqlClient::~AsyncMysqlClient()
+{
+  close();
+}
+
+void
+AsyncMysqlClient::query(const std::string& sql,
+                        const ResultCallback& onResult,
+                        const ErrorCallback& onError)
+{
+  Request request;
+  request.sql = sql;
+  request.onResult = onResult;
+  if (onError) {
+    request.onError = [onError] (unsigned int, const std::string& reason) { onError(reason); };
+  }
+  // runs right away when called from the io_service thread
+  m_ioService.dispatch(std::bind(&AsyncMysqlClient::enqueue, this, request));
+}
+
+void
+AsyncMysqlClient::transaction(const std::vector<std::string>& statements,
+                              const std::function<void()>& onCommit,
+                              const TransactionErrorCallback& onError)
+{
+  Request request;
+  request.sql = "START TRANSACTION";
+  request.next.assign(statements.begin(), statements.end());
+  request.next.push_back("COMMIT");
+  if (onCommit) {
+    request.onResult = [onCommit] (const Rows&) { onCommit(); };
+  }
+  request.onError = onError;
+  request.isTransaction = true;
+  m_ioService.dispatch(std::bind(&AsyncMysqlClient::enqueue, this, request));
+}
+
+bool
+AsyncMysqlClient::isTransientError(unsigned int errorNo)
+{
+  switch (errorNo) {
+  case CR_CONN_HOST_ERROR:
+  case CR_SERVER_GONE_ERROR:
+  case CR_SERVER_LOST:
+  case ER_LOCK_WAIT_TIMEOUT:
+  case ER_LOCK_DEADLOCK:
+    return true;
+  default:
+    return false;
+  }
+}
+
+std::string
+AsyncMysqlClient::escape(const std::string& value) const
+{
+  std::lock_guard<std::mutex> lock(m_handleMutex);
+  // a connected handle has the character set of the server session, any other one has the
+  // character set the connections ask for
+  MYSQL* mysql = nullptr;
+  for (const auto& conn : m_connections) {
+    if (conn->mysql != nullptr && (mysql == nullptr || conn->isConnected)) {
+      mysql = conn->mysql;
+    }
+  }
+  if (mysql == nullptr) {
+    throw Error("cannot escape a value, the client is closed");
+  }
+
+  std::string escaped(value.size() * 2 + 1, '\0');
+  unsigned long length = mysql_real_escape_string(mysql, &escaped[0],
+                                                  value.data(), value.size());
+  escaped.resize(length);
+  return escaped;
+}
+
+void
+AsyncMysqlClient::close()
+{
+  if (m_isClosed) {
+    return;
+  }
+  m_isClosed = true;
+
+  m_pendingRequests.clear();
+  m_idleConnections.clear();
+  for (const auto& conn : m_connections) {
+    closeConnection(conn);
+  }
+}
+
+void
+AsyncMysqlClient::closeConnection(const std::shared_ptr<Connection>& conn)
+{
+  ++conn->waitId;
+  std::unique_lock<std::mutex> lock(m_handleMutex);
+  conn->isConnected = false;
+  lock.unlock();
+  conn->timer.cancel();
+  conn->cont = nullptr;
+  conn->onComplete = nullptr;
+
+  if (conn->socket != nullptr) {
+    conn->socket->cancel();
+    // the descriptor belongs to MariaDB, which closes it in mysql_close
+    conn->socket->release();
+    conn->socket.reset();
+  }
+  if (conn->result != nullptr) {
+    mysql_free_result(conn->result);
+    conn->result = nullptr;
+  }
+  if (conn->mysql != nullptr) {
+    lock.lock();
+    mysql_close(conn->mysql);
+    conn->mysql = nullptr;
+  }
+}
+
+void
+AsyncMysqlClient::startConnect(const std::shared_ptr<Connection>& conn)
+{
+  MYSQL* mysql = mysql_init(nullptr);
+  if (mysql == nullptr) {
+    throw Error("cannot allocate a MySQL connection");
+  }
+  mysql_options(mysql, MYSQL_OPT_NONBLOCK, 0);
+  mysql_options(mysql, MYSQL_SET_CHARSET_NAME, "utf8");
+  {
+    std::lock_guard<std::mutex> lock(m_handleMutex);
+    conn->mysql = mysql;
+  }
+
+  Connection* c = conn.get();
+  int status = mysql_real_connect_start(&c->connectResult, c->mysql,
+                                        m_details.server.c_str(),
+                                        m_details.user.c_str(),
+                                        m_details.password.c_str(),
+                                        m_details.database.c_str(),
+                                        m_details.port, nullptr, 0);
+  await(conn, status,
+        [c] (int event) { return mysql_real_connect_cont(&c->connectResult, c->mysql, event); },
+        std::bind(&AsyncMysqlClient::onConnected, this, conn));
+}
+
+void
+AsyncMysqlClient::onConnected(const std::shared_ptr<Connection>& conn)
+{
+  if (conn->connectResult == nullptr) {
+    _LOG_ERROR("Cannot connect to the database: " << mysql_error(conn->mysql));
+    closeConnection(conn);
+    expirePendingRequests();
+
+    conn->timer.expires_from_now(boost::posix_time::seconds(RECONNECT_INTERVAL));
+    conn->timer.async_wait([this, conn] (const boost::system::error_code& error) {
+        if (!error && !m_isClosed) {
+          startConnect(conn);
+        }
+      });
+    return;
+  }
+
+  _LOG_DEBUG("Connected to the database " << m_details.database);
+  {
+    std::lock_guard<std::mutex> lock(m_handleMutex);
+    conn->isConnected = true;
+  }
+  release(conn);
+}
+
+void
+AsyncMysqlClient::expirePendingRequests()
+{
+  for (const auto& conn : m_connections) {
+    if (conn->isConnected) {
+      // the requests are served once this connection is free
+      return;
+    }
+  }
+
+  auto deadline = std::chrono::steady_clock::now() - m_details.acquireTimeout;
+  while (!m_pendingRequests.empty() && m_pendingRequests.front().queuedAt <= deadline) {
+    Request request = m_pendingRequests.front();
+    m_pendingRequests.pop_front();
+    if (request.onError) {
+      request.onError(CR_CONN_HOST_ERROR, "timed out waiting for a database connection");
+    }
+    if (m_isClosed) {
+      // closed by the callback
+      return;
+    }
+  }
+}
+
+void
+AsyncMysqlClient::enqueue(const Request& request)
+{
+  if (m_isClosed) {
+    return;
+  }
+
+  if (m_idleConnections.empty()) {
+    m_pendingRequests.push_back(request);
+    m_pendingRequests.back().queuedAt = std::chrono::steady_clock::now();
+    return;
+  }
+
+  std::shared_ptr<Connection> conn = m_idleConnections.back();
+  m_idleConnections.pop_back();
+  startQuery(conn, request);
+}
+
+void
+AsyncMysqlClient::release(const std::shared_ptr<Connection>& conn)
+{
+  if (m_isClosed) {
+    return;
+  }
+
+  if (m_pendingRequests.empty()) {
+    m_idleConnections.push_back(conn);
+    return;
+  }
+
+  Request request = m_pendingRequests.front();
+  m_pendingRequests.pop_front();
+  startQuery(conn, request);
+}
+
+void
+AsyncMysqlClient::startQuery(const std::shared_ptr<Connection>& conn, const Request& request)
+{
+  conn->request = request;
+
+  Connection* c = conn.get();
+  int status = mysql_real_query_start(&c->error, c->mysql,
+                                      c->request.sql.data(), c->request.sql.size());
+  await(conn, status,
+        [c] (int event) { return mysql_real_query_cont(&c->error, c->mysql, event); },
+        std::bind(&AsyncMysqlClient::onQueryDone, this, conn));
+}
+
+void
+AsyncMysqlClient::onQueryDone(const std::shared_ptr<Connection>& conn)
+{
+  if (conn->error != 0) {
+    onQueryFailed(conn);
+    return;
+  }
+
+  Connection* c = conn.get();
+  int status = mysql_store_result_start(&c->result, c->mysql);
+  await(conn, status,
+        [c] (int event) { return mysql_store_result_cont(&c->result, c->mysql, event); },
+        std::bind(&AsyncMysqlClient::onResultStored, this, conn));
+}
+
+void
+AsyncMysqlClient::onResultStored(const std::shared_ptr<Connection>& conn)
+{
+  Rows rows;
+  if (conn->result != nullptr) {
+    // the whole result set is in memory now, fetching the rows does not touch the socket
+    unsigned int nFields = mysql_num_fields(conn->result);
+    MYSQL_ROW row;
+    while ((row = mysql_fetch_row(conn->result)) != nullptr) {
+      unsigned long* lengths = mysql_fetch_lengths(conn->result);
+      Row values;
+      values.reserve(nFields);
+      for (unsigned int i = 0; i < nFields; ++i) {
+        values.push_back(row[i] == nullptr ? std::string() : std::string(row[i], lengths[i]));
+      }
+      rows.push_back(values);
+    }
+    mysql_free_result(conn->result);
+    conn->result = nullptr;
+  }
+  else if (mysql_field_count(conn->mysql) != 0) {
+    // the statement has a result set, but it could not be retrieved
+    onQueryFailed(conn);
+    return;
+  }
+
+  if (!conn->request.next.empty()) {
+    // the next statement of the sequence keeps the connection
+    Request request = conn->request;
+    request.sql = request.next.front();
+    request.next.pop_front();
+    startQuery(conn, request);
+    return;
+  }
+
+  Request request = conn->request;
+  // the connection can serve the next request while the callback is running
+  release(conn);
+  if (request.onResult) {
+    request.onResult(rows);
+  }
+}
+
+void
+AsyncMysqlClient::onQueryFailed(const std::shared_ptr<Connection>& conn)
+{
+  std::string reason(mysql_error(conn->mysql));
+  unsigned int errorNo = mysql_errno(conn->mysql);
+  Request request = conn->request;
+
+  if (errorNo == CR_SERVER_GONE_ERROR || errorNo == CR_SERVER_LOST) {
+    _LOG_ERROR("Lost the database connection: " << reason);
+    closeConnection(conn);
+    startConnect(conn);
+  }
+  else if (request.isTransaction) {
+    // the connection is released once the rollback completes
+    Request rollback;
+    rollback.sql = "ROLLBACK";
+    rollback.onError = [] (unsigned int, const std::string& reason) {
+      _LOG_ERROR("Cannot roll back: " << reason);
+    };
+    startQuery(conn, rollback);
+  }
+  else {
+    release(conn);
+  }
+
+  if (request.onError) {
+    request.onError(errorNo, reason);
+  }
+}
+
+void
+AsyncMysqlClient::await(const std::shared_ptr<Connection>& conn, int status,
+                        const Continuation& cont, const std::function<void()>& onComplete)
+{
+  if (status == 0) {
+    // drop the stored callbacks, they hold a reference to the connection
+    conn->cont = nullptr;
+    conn->onComplete = nullptr;
+    onComplete();
+    return;
+  }
+
+  conn->cont = cont;
+  conn->onComplete = onComplete;
+  uint64_t waitId = ++conn->waitId;
+
+  if (conn->socket == nullptr) {
+    conn->socket.reset(new boost::asio::posix::stream_descriptor(m_ioService,
+                                                                 mysql_get_socket(conn->mysql)));
+  }
+
+  using std::placeholders::_1;
+  if (status & MYSQL_WAIT_READ) {
+    conn->socket->async_read_some(boost::asio::null_buffers(),
+                                  std::bind(&AsyncMysqlClient::onReady, this,
+                                            conn, waitId, MYSQL_WAIT_READ, _1));
+  }
+  if (status & MYSQL_WAIT_WRITE) {
+    conn->socket->async_write_some(boost::asio::null_buffers(),
+                                   std::bind(&AsyncMysqlClient::onReady, this,
+                                             conn, waitId, MYSQL_WAIT_WRITE, _1));
+  }
+  if (status & MYSQL_WAIT_TIMEOUT) {
+    conn->timer.expires_from_now(boost::posix_time::seconds(mysql_get_timeout_value(conn->mysql)));
+    conn->timer.async_wait(std::bind(&AsyncMysqlClient::onReady, this,
+                                     conn, waitId, MYSQL_WAIT_TIMEOUT, _1));
+  }
+}
+
+void
+AsyncMysqlClient::onReady(const std::shared_ptr<Connection>& conn, uint64_t waitId, int event,
+                          const boost::system::error_code& error)
+{
+  if (error == boost::asio::error::operation_aborted || waitId != conn->waitId || m_isClosed) {
+    return;
+  }
+
+  // the first ready event wins, the other waits of this round become stale
+  ++conn->waitId;
+  conn->socket->cancel();
+  conn->timer.cancel();
+
+  Continuation cont = conn->cont;
+  std::function<void()> onComplete = conn->onComplete;
+  await(conn, cont(event), cont, onComplete);
+}
+
+} // namespace util
+} // namespace atmos
+
+#endif // HAVE_MYSQL_NONBLOCKING
@@ -0,0 +1,224 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_ASYNC_MYSQL_CLIENT_HPP
+#define ATMOS_UTIL_ASYNC_MYSQL_CLIENT_HPP
+
+#include "config.hpp"
+
+#ifdef HAVE_MYSQL_NONBLOCKING
+
+#include "util/mysql-util.hpp"
+#include "util/rows.hpp"
+
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace atmos {
+namespace util {
+
+/**
+ * AsyncMysqlClient runs SQL statements over a few MySQL connections without blocking, using the
+ * non-blocking API of the MariaDB client library (mysql_*_start / mysql_*_cont).
+ *
+ * The connection sockets are watched by the io_service, so a single thread (the one that runs
+ * Face::processEvents) keeps as many statements in flight as there are connections; statements
+ * submitted while all connections are busy wait in a FIFO queue. While the database cannot be
+ * reached, the statements that have waited longer than acquireTimeout fail instead. Callbacks are
+ * invoked in the io_service thread.
+ */
+class AsyncMysqlClient : boost::noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  typedef std::function<void(const Rows& rows)> ResultCallback;
+  typedef std::function<void(const std::string& reason)> ErrorCallback;
+  // called with the MySQL error number as well, see isTransientError
+  typedef std::function<void(unsigned int errorNo, const std::string& reason)>
+    TransactionErrorCallback;
+
+  /**
+   * Constructor, starts connecting to the database in the background
+   *
+   * @param ioService:    io_service that drives the connections
+   * @param details:      database to connect to
+   * @param nConnections: number of connections, i.e., maximum number of statements in flight
+   */
+  AsyncMysqlClient(boost::asio::io_service& ioService,
+                   const ConnectionDetails& details,
+                   size_t nConnections);
+
+  ~AsyncMysqlClient();
+
+  /**
+   * Run a SQL statement, can be called from any thread
+   *
+   * @param sql:     the statement
+   * @param onResult: called with the rows of the result set (empty if the statement does not
+   *                  return any), in the io_service thread
+   * @param onError:  called with the MySQL error message if the statement fails
+   */
+  void
+  query(const std::string& sql, const ResultCallback& onResult, const ErrorCallback& onError);
+
+  /**
+   * Run SQL statements in one transaction, on one connection, can be called from any thread
+   *
+   * @param statements: the statements, in order
+   * @param onCommit:   called once the transaction is committed
+   * @param onError:    called with the MySQL error of the first statement that fails, the
+   *                    transaction is rolled back
+   */
+  void
+  transaction(const std::vector<std::string>& statements,
+              const std::function<void()>& onCommit,
+              const TransactionErrorCallback& onError);
+
+  /**
+   * @return true if a statement that failed with this MySQL error may succeed when run again,
+   *         e.g., the connection was lost or the statement could not get a lock; false if the
+   *         database rejects the statement
+   */
+  static bool
+  isTransientError(unsigned int errorNo);
+
+  /**
+   * Escape a value so that it can be embedded in a quoted SQL string literal, using the
+   * character set of the connections, can be called from any thread
+   *
+   * @throw Error if the client is closed
+   */
+  std::string
+  escape(const std::string& value) const;
+
+  /**
+   * Close all connections, the callbacks of the pending statements are never called
+   */
+  void
+  close();
+
+private:
+  struct Request
+  {
+    Request()
+      : isTransaction(false)
+    {
+    }
+
+    std::string sql;
+    ResultCallback onResult;
+    TransactionErrorCallback onError;
+    // statements run on the same connection once this one completes, onResult is called after
+    // the last one
+    std::deque<std::string> next;
+    // a failure rolls back the transaction before the connection is released
+    bool isTransaction;
+    // when the request started waiting for a connection
+    std::chrono::steady_clock::time_point queuedAt;
+  };
+
+  struct Connection;
+  // continues a pending MariaDB operation with the ready events, returns the events to wait for
+  typedef std::function<int(int)> Continuation;
+
+  void
+  startConnect(const std::shared_ptr<Connection>& conn);
+
+  void
+  onConnected(const std::shared_ptr<Connection>& conn);
+
+  void
+  closeConnection(const std::shared_ptr<Connection>& conn);
+
+  /**
+   * Fail the pending requests that have waited longer than acquireTimeout, if no connection is up
+   */
+  void
+  expirePendingRequests();
+
+  void
+  enqueue(const Request& request);
+
+  void
+  startQuery(const std::shared_ptr<Connection>& conn, const Request& request);
+
+  void
+  onQueryDone(const std::shared_ptr<Connection>& conn);
+
+  void
+  onResultStored(const std::shared_ptr<Connection>& conn);
+
+  void
+  onQueryFailed(const std::shared_ptr<Connection>& conn);
+
+  /**
+   * Give the connection to the next pending request, or put it back in the idle list
+   */
+  void
+  release(const std::shared_ptr<Connection>& conn);
+
+  /**
+   * Wait for the events MariaDB asked for, then continue the operation until it completes
+   */
+  void
+  await(const std::shared_ptr<Connection>& conn, int status,
+        const Continuation& cont, const std::function<void()>& onComplete);
+
+  void
+  onReady(const std::shared_ptr<Connection>& conn, uint64_t waitId, int event,
+          const boost::system::error_code& error);
+
+private:
+  boost::asio::io_service& m_ioService;
+  const ConnectionDetails m_details;
+  std::vector<std::shared_ptr<Connection>> m_connections;
+  // guards the MySQL handles of the connections, which escape() uses from other threads
+  mutable std::mutex m_handleMutex;
+  // @{ only accessed in the io_service thread
+  std::vector<std::shared_ptr<Connection>> m_idleConnections;
+  std::deque<Request> m_pendingRequests;
+  bool m_isClosed;
+  // @}
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // HAVE_MYSQL_NONBLOCKING
+
+#endif // ATMOS_UTIL_ASYNC_MYSQL_CLIENT_HPP
@@ -0,0 +1,144 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_BOUNDED_QUEUE_HPP
+#define ATMOS_UTIL_BOUNDED_QUEUE_HPP
+
+#include <boost/noncopyable.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace atmos {
+namespace util {
+
+/**
+ * Blocking multi-producer multi-consumer FIFO queue holding at most capacity elements
+ *
+ * push() waits while the queue is full and pop() waits while it is empty, so that a producer
+ * cannot run ahead of its consumers. Once closed, push() fails and pop() drains what is left.
+ */
+template <typename T>
+class BoundedQueue : boost::noncopyable
+{
+public:
+  explicit
+  BoundedQueue(size_t capacity)
+    : m_capacity(capacity)
+    , m_isClosed(false)
+  {
+  }
+
+  /**
+   * @return false if the queue is closed, the value is dropped
+   */
+  bool
+  push(T value)
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_notFull.wait(lock, [this] { return m_isClosed || m_queue.size() < m_capacity; });
+    if (m_isClosed) {
+      return false;
+    }
+    m_queue.push_back(std::move(value));
+    lock.unlock();
+    m_notEmpty.notify_one();
+    return true;
+  }
+
+  /**
+   * Queue the value only if there is room right away
+   *
+   * @return false if the queue is full or closed, the value is left as it is
+   */
+  bool
+  tryPush(T& value)
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_isClosed || m_queue.size() >= m_capacity) {
+      return false;
+    }
+    m_queue.push_back(std::move(value));
+    lock.unlock();
+    m_notEmpty.notify_one();
+    return true;
+  }
+
+  /**
+   * @return false if the queue is empty and closed
+   */
+  bool
+  pop(T& value)
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_notEmpty.wait(lock, [this] { return m_isClosed || !m_queue.empty(); });
+    if (m_queue.empty()) {
+      return false;
+    }
+    value = std::move(m_queue.front());
+    m_queue.pop_front();
+    lock.unlock();
+    m_notFull.notify_one();
+    return true;
+  }
+
+  /**
+   * Fail the pending and future pushes, and wake up the consumers once the queue is drained
+   */
+  void
+  close()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_isClosed = true;
+    }
+    m_notFull.notify_all();
+    m_notEmpty.notify_all();
+  }
+
+  size_t
+  size() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_queue.size();
+  }
+
+  size_t
+  getCapacity() const
+  {
+    return m_capacity;
+  }
+
+private:
+  const size_t m_capacity;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_notFull;
+  std::condition_variable m_notEmpty;
+  // @{ need m_mutex protection
+  std::deque<T> m_queue;
+  bool m_isClosed;
+  // @}
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_BOUNDED_QUEUE_HPP
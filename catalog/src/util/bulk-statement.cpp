@@ -0,0 +1,154 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/bulk-statement.hpp"
+
+namespace atmos {
+namespace util {
+
+// sizes of the chunks, largest first
+static const size_t CHUNK_SIZES[] = {128, 32, 8, 1};
+
+static std::string
+makeInsertPrefix(const std::string& command, const std::string& table,
+                 const std::vector<std::string>& columns)
+{
+  std::string prefix = command + " " + table + " (";
+  for (size_t i = 0; i < columns.size(); ++i) {
+    if (i != 0)
+      prefix += ", ";
+    prefix += columns[i];
+  }
+  prefix += ") VALUES";
+  return prefix;
+}
+
+BulkStatement
+BulkStatement::insert(const std::string& table, const std::vector<std::string>& columns)
+{
+  return BulkStatement(makeInsertPrefix("INSERT INTO", table, columns), columns.size(),
+                       "(", ")", "");
+}
+
+BulkStatement
+BulkStatement::upsert(const std::string& table, const std::vector<std::string>& columns,
+                      const std::string& keyColumn, SqlDialect dialect)
+{
+  if (dialect == DIALECT_SQLITE) {
+    return BulkStatement(makeInsertPrefix("INSERT OR IGNORE INTO", table, columns),
+                         columns.size(), "(", ")", "");
+  }
+  // unlike INSERT IGNORE, the other errors still fail the statement
+  return BulkStatement(makeInsertPrefix("INSERT INTO", table, columns), columns.size(),
+                       "(", ")", " ON DUPLICATE KEY UPDATE " + keyColumn + "=" + keyColumn);
+}
+
+BulkStatement
+BulkStatement::remove(const std::string& table, const std::string& column)
+{
+  return BulkStatement("DELETE FROM " + table + " WHERE " + column + " IN (", 1, "", "", ")");
+}
+
+BulkStatement::BulkStatement(const std::string& prefix, size_t nColumns,
+                             const std::string& rowOpen, const std::string& rowClose,
+                             const std::string& suffix)
+  : m_prefix(prefix)
+  , m_nColumns(nColumns)
+  , m_rowOpen(rowOpen)
+  , m_rowClose(rowClose)
+  , m_suffix(suffix)
+{
+}
+
+void
+BulkStatement::addOwnedValue(const std::string& value)
+{
+  m_ownedValues.push_back(value);
+  addValue(m_ownedValues.back().data(), m_ownedValues.back().size());
+}
+
+char*
+BulkStatement::keepBuffer(std::string buffer)
+{
+  m_ownedValues.push_back(std::move(buffer));
+  return &m_ownedValues.back()[0];
+}
+
+void
+BulkStatement::discardPartialRow()
+{
+  m_values.resize(getNRows() * m_nColumns);
+}
+
+std::string
+BulkStatement::getSql(size_t nRows) const
+{
+  std::string row = m_rowOpen;
+  for (size_t i = 0; i < m_nColumns; ++i) {
+    row += i == 0 ? "?" : ",?";
+  }
+  row += m_rowClose;
+
+  std::string sql = m_prefix;
+  sql.reserve(m_prefix.size() + nRows * (row.size() + 1) + m_suffix.size());
+  for (size_t i = 0; i < nRows; ++i) {
+    if (i != 0)
+      sql += ",";
+    sql += row;
+  }
+  sql += m_suffix;
+  return sql;
+}
+
+std::vector<size_t>
+BulkStatement::getChunks() const
+{
+  std::vector<size_t> chunks;
+  size_t nRows = getNRows();
+  for (size_t size : CHUNK_SIZES) {
+    if (size * m_nColumns > MAX_BULK_PARAMETERS && size != 1) {
+      continue;
+    }
+    for (; nRows >= size; nRows -= size) {
+      chunks.push_back(size);
+    }
+  }
+  return chunks;
+}
+
+std::string
+BulkStatement::toSql(const std::function<std::string(const ValueRef& value)>& quote) const
+{
+  std::string sql = m_prefix;
+  for (size_t row = 0; row < getNRows(); ++row) {
+    if (row != 0)
+      sql += ",";
+    sql += m_rowOpen;
+    for (size_t i = 0; i < m_nColumns; ++i) {
+      if (i != 0)
+        sql += ",";
+      sql += quote(m_values[row * m_nColumns + i]);
+    }
+    sql += m_rowClose;
+  }
+  sql += m_suffix;
+  return sql;
+}
+
+} // namespace util
+} // namespace atmos
@@ -0,0 +1,189 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_BULK_STATEMENT_HPP
+#define ATMOS_UTIL_BULK_STATEMENT_HPP
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace atmos {
+namespace util {
+
+// most parameters a statement binds, the lowest limit of the supported databases (SQLite)
+#define MAX_BULK_PARAMETERS 999
+
+// the SQL syntax to use where the supported databases differ
+enum SqlDialect {DIALECT_MYSQL, DIALECT_SQLITE};
+
+/**
+ * A value bound to a statement parameter, pointing into memory the caller keeps alive
+ */
+struct ValueRef
+{
+  const char* data;
+  size_t size;
+};
+
+/**
+ * BulkStatement is an INSERT or a DELETE of many rows, run as multi-row statements whose values
+ * are bound to '?' parameters rather than pasted into the SQL.
+ *
+ * The rows are run in chunks of a few fixed sizes (128, 32, 8 and 1 rows, within
+ * MAX_BULK_PARAMETERS), so that a statement is prepared once per size and executed again for
+ * each chunk of that size. The values are kept by pointer and length; the ones computed by the
+ * caller, e.g., digests, can be handed over to the statement instead.
+ */
+class BulkStatement
+{
+public:
+  /**
+   * INSERT INTO <table> (<columns>) VALUES (?, ...), ...
+   */
+  static BulkStatement
+  insert(const std::string& table, const std::vector<std::string>& columns);
+
+  /**
+   * INSERT that leaves the rows whose unique key is already in the table alone, instead of
+   * failing the whole statement:
+   * INSERT INTO <table> (<columns>) VALUES (?, ...), ... ON DUPLICATE KEY UPDATE <key>=<key>
+   * on MySQL, INSERT OR IGNORE INTO ... on SQLite
+   */
+  static BulkStatement
+  upsert(const std::string& table, const std::vector<std::string>& columns,
+         const std::string& keyColumn, SqlDialect dialect);
+
+  /**
+   * DELETE FROM <table> WHERE <column> IN (?, ...)
+   */
+  static BulkStatement
+  remove(const std::string& table, const std::string& column);
+
+  BulkStatement(BulkStatement&&) = default;
+
+  BulkStatement&
+  operator=(BulkStatement&&) = default;
+
+  // the values may point into m_ownedValues, copies would point into the original
+  BulkStatement(const BulkStatement&) = delete;
+
+  BulkStatement&
+  operator=(const BulkStatement&) = delete;
+
+  /**
+   * Add the next value of the current row, the memory must outlive the statement
+   */
+  void
+  addValue(const char* data, size_t size)
+  {
+    m_values.push_back(ValueRef{data, size});
+  }
+
+  /**
+   * Add the next value of the current row, kept by the statement
+   */
+  void
+  addOwnedValue(const std::string& value);
+
+  /**
+   * Keep a buffer as long as the statement, e.g., values computed for many rows at once, which
+   * are then added with addValue
+   *
+   * @return the data of the kept buffer
+   */
+  char*
+  keepBuffer(std::string buffer);
+
+  /**
+   * Drop the values of the current row, e.g., when one of them turns out to be malformed
+   */
+  void
+  discardPartialRow();
+
+  size_t
+  getNColumns() const
+  {
+    return m_nColumns;
+  }
+
+  size_t
+  getNRows() const
+  {
+    return m_values.size() / m_nColumns;
+  }
+
+  bool
+  empty() const
+  {
+    return m_values.empty();
+  }
+
+  /**
+   * @return the values, row after row
+   */
+  const std::vector<ValueRef>&
+  getValues() const
+  {
+    return m_values;
+  }
+
+  /**
+   * @return the statement for nRows rows, with '?' for the values
+   */
+  std::string
+  getSql(size_t nRows) const;
+
+  /**
+   * @return the number of rows of each chunk the rows are run in, in order
+   */
+  std::vector<size_t>
+  getChunks() const;
+
+  /**
+   * Get a single statement for all the rows with the values inlined, for the clients that
+   * cannot bind parameters
+   *
+   * @param quote: turns a value into a SQL literal, escaping it
+   */
+  std::string
+  toSql(const std::function<std::string(const ValueRef& value)>& quote) const;
+
+private:
+  BulkStatement(const std::string& prefix, size_t nColumns, const std::string& rowOpen,
+                const std::string& rowClose, const std::string& suffix);
+
+private:
+  std::string m_prefix;
+  size_t m_nColumns;
+  // around the values of one row
+  std::string m_rowOpen;
+  std::string m_rowClose;
+  std::string m_suffix;
+
+  std::vector<ValueRef> m_values;
+  // a deque does not move its elements when it grows
+  std::deque<std::string> m_ownedValues;
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_BULK_STATEMENT_HPP
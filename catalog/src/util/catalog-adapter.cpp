@@ -18,6 +18,8 @@
 
 #include "catalog-adapter.hpp"
 
+#include <ndn-cxx/util/string-helper.hpp>
+
 namespace atmos {
 namespace util {
 
@@ -46,6 +48,34 @@ CatalogAdapter::onRegisterFailure(const ndn::Name& prefix, const std::string& re
   throw Error("Failed to register prefix " + prefix.toUri() + " : " + reason);
 }
 
+void
+CatalogAdapter::shutdown(const std::function<void()>& onDone)
+{
+  onDone();
+}
+
+ndn::Name
+CatalogAdapter::computeCatalogId() const
+{
+  return computeCatalogId(*m_keyChain, m_signingId);
+}
+
+ndn::Name
+CatalogAdapter::computeCatalogId(ndn::KeyChain& keyChain, const ndn::Name& signingId)
+{
+  // use public key digest as the catalog ID
+  ndn::Name keyId;
+  if (signingId.empty()) {
+    keyId = keyChain.getDefaultKeyNameForIdentity(keyChain.getDefaultIdentity());
+  } else {
+    keyId = keyChain.getDefaultKeyNameForIdentity(signingId);
+  }
+
+  std::shared_ptr<ndn::PublicKey> pKey = keyChain.getPib().getPublicKey(keyId);
+  ndn::Block keyDigest = pKey->computeDigest();
+  return ndn::Name().append(ndn::toHex(*keyDigest.getBuffer()));
+}
+
 void
 CatalogAdapter::onTimeout(const ndn::Interest& interest)
 {
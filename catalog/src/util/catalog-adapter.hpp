@@ -26,6 +26,7 @@
 #include <ndn-cxx/security/key-chain.hpp>
 #include <ndn-cxx/encoding/block.hpp>
 
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -78,6 +79,22 @@ public:
                 const std::vector<std::string>& nameFields,
                 const std::string& databaseTable) = 0;
 
+  /**
+   * Stop taking new work and finish the work in progress, e.g., announce the changes that are
+   * still waiting; called in the Face's thread while the Face still runs
+   *
+   * @param onDone: called in the Face's thread once the Face can be stopped
+   */
+  virtual void
+  shutdown(const std::function<void()>& onDone);
+
+  /**
+   * Helper function that returns the catalog ID of the catalogs that sign with signingId (or
+   * with the default identity if signingId is empty) in keyChain
+   */
+  static ndn::Name
+  computeCatalogId(ndn::KeyChain& keyChain, const ndn::Name& signingId);
+
 protected:
 
   /**
@@ -116,6 +133,13 @@ protected:
   virtual void
   onRegisterFailure(const ndn::Name& prefix, const std::string& reason);
 
+  /**
+   * Helper function that returns the catalog ID, i.e., the digest of the public key of
+   * m_signingId (or of the default identity if m_signingId is empty) as a single name component
+   */
+  ndn::Name
+  computeCatalogId() const;
+
 protected:
   // Face to communicate with
   const std::shared_ptr<ndn::Face> m_face;
@@ -0,0 +1,59 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/catalog-snapshot.hpp"
+
+#include <atomic>
+
+namespace atmos {
+namespace util {
+
+CatalogSnapshot::CatalogSnapshot(uint64_t versionInput, const std::string& digestInput)
+  : version(versionInput)
+  , digest(digestInput)
+{
+}
+
+SnapshotHolder::SnapshotHolder(const std::string& digest)
+  : m_current(std::make_shared<const CatalogSnapshot>(0, digest))
+{
+}
+
+std::shared_ptr<const CatalogSnapshot>
+SnapshotHolder::pin() const
+{
+  return std::atomic_load(&m_current);
+}
+
+bool
+SnapshotHolder::advance(const std::string& digest)
+{
+  std::shared_ptr<const CatalogSnapshot> current = std::atomic_load(&m_current);
+  while (current->digest != digest) {
+    std::shared_ptr<const CatalogSnapshot> next =
+      std::make_shared<const CatalogSnapshot>(current->version + 1, digest);
+    // on failure, current is reloaded with the snapshot published in between
+    if (std::atomic_compare_exchange_strong(&m_current, &current, next)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace util
+} // namespace atmos
@@ -0,0 +1,77 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_CATALOG_SNAPSHOT_HPP
+#define ATMOS_UTIL_CATALOG_SNAPSHOT_HPP
+
+#include <boost/noncopyable.hpp>
+
+#include <memory>
+#include <string>
+
+namespace atmos {
+namespace util {
+
+/**
+ * Immutable, versioned view of the catalog state a query result is generated from
+ */
+struct CatalogSnapshot
+{
+public:
+  CatalogSnapshot(uint64_t versionInput, const std::string& digestInput);
+
+  // increases by one every time a new snapshot is published
+  const uint64_t version;
+  // ChronoSync root digest, used as the version component of query result names
+  const std::string digest;
+};
+
+/**
+ * SnapshotHolder publishes CatalogSnapshots in an RCU fashion. Readers pin the current snapshot
+ * with one atomic load and keep it alive for as long as they need it; the writer builds the next
+ * snapshot aside and swaps it in with one atomic compare-and-swap. Nobody ever blocks.
+ */
+class SnapshotHolder : boost::noncopyable
+{
+public:
+  explicit
+  SnapshotHolder(const std::string& digest);
+
+  /**
+   * @return the current snapshot, which stays valid even after a newer one is published
+   */
+  std::shared_ptr<const CatalogSnapshot>
+  pin() const;
+
+  /**
+   * Publish a new snapshot for this digest, unless it is already the current one
+   *
+   * @return true if this call published a new snapshot
+   */
+  bool
+  advance(const std::string& digest);
+
+private:
+  // only accessed through std::atomic_load and std::atomic_compare_exchange_strong
+  std::shared_ptr<const CatalogSnapshot> m_current;
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_CATALOG_SNAPSHOT_HPP
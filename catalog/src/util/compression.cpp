@@ -0,0 +1,161 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/compression.hpp"
+
+#include <zlib.h>
+
+#include <cstring>
+
+namespace atmos {
+namespace util {
+
+// output produced by one call to deflate or inflate
+static const size_t ZLIB_CHUNK_SIZE = 64 * 1024;
+
+Deflater::Deflater()
+  : m_stream(new z_stream)
+{
+  std::memset(m_stream.get(), 0, sizeof(z_stream));
+  if (deflateInit(m_stream.get(), Z_DEFAULT_COMPRESSION) != Z_OK) {
+    throw CompressionError("Cannot initialize zlib");
+  }
+}
+
+Deflater::~Deflater()
+{
+  deflateEnd(m_stream.get());
+}
+
+void
+Deflater::write(const char* data, size_t size, std::string& compressed)
+{
+  m_stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+  m_stream->avail_in = size;
+
+  // until all the input is consumed, with room left in the output
+  do {
+    size_t offset = compressed.size();
+    compressed.resize(offset + ZLIB_CHUNK_SIZE);
+    m_stream->next_out = reinterpret_cast<Bytef*>(&compressed[offset]);
+    m_stream->avail_out = ZLIB_CHUNK_SIZE;
+    int status = deflate(m_stream.get(), Z_NO_FLUSH);
+    compressed.resize(offset + ZLIB_CHUNK_SIZE - m_stream->avail_out);
+    if (status != Z_OK && status != Z_BUF_ERROR) {
+      throw CompressionError("Cannot compress");
+    }
+  } while (m_stream->avail_in > 0 || m_stream->avail_out == 0);
+}
+
+void
+Deflater::finish(std::string& compressed)
+{
+  m_stream->next_in = nullptr;
+  m_stream->avail_in = 0;
+
+  int status = Z_OK;
+  while (status != Z_STREAM_END) {
+    size_t offset = compressed.size();
+    compressed.resize(offset + ZLIB_CHUNK_SIZE);
+    m_stream->next_out = reinterpret_cast<Bytef*>(&compressed[offset]);
+    m_stream->avail_out = ZLIB_CHUNK_SIZE;
+    status = deflate(m_stream.get(), Z_FINISH);
+    compressed.resize(offset + ZLIB_CHUNK_SIZE - m_stream->avail_out);
+    if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+      throw CompressionError("Cannot compress");
+    }
+  }
+}
+
+Inflater::Inflater()
+  : m_stream(new z_stream)
+  , m_isFinished(false)
+{
+  std::memset(m_stream.get(), 0, sizeof(z_stream));
+  if (inflateInit(m_stream.get()) != Z_OK) {
+    throw CompressionError("Cannot initialize zlib");
+  }
+}
+
+Inflater::~Inflater()
+{
+  inflateEnd(m_stream.get());
+}
+
+void
+Inflater::write(const char* compressed, size_t size, std::string& data)
+{
+  if (m_isFinished) {
+    return;
+  }
+  m_stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed));
+  m_stream->avail_in = size;
+
+  do {
+    size_t offset = data.size();
+    data.resize(offset + ZLIB_CHUNK_SIZE);
+    m_stream->next_out = reinterpret_cast<Bytef*>(&data[offset]);
+    m_stream->avail_out = ZLIB_CHUNK_SIZE;
+    int status = inflate(m_stream.get(), Z_NO_FLUSH);
+    data.resize(offset + ZLIB_CHUNK_SIZE - m_stream->avail_out);
+    if (status == Z_STREAM_END) {
+      m_isFinished = true;
+      return;
+    }
+    // Z_BUF_ERROR once the input is consumed: the rest of the stream is still to come
+    if (status == Z_BUF_ERROR) {
+      return;
+    }
+    if (status != Z_OK) {
+      throw CompressionError("Malformed zlib stream");
+    }
+  } while (m_stream->avail_in > 0 || m_stream->avail_out == 0);
+}
+
+std::string
+compress(const std::string& data)
+{
+  Deflater deflater;
+  std::string compressed;
+  deflater.write(data.data(), data.size(), compressed);
+  deflater.finish(compressed);
+  return compressed;
+}
+
+std::string
+decompress(const std::string& compressed)
+{
+  Inflater inflater;
+  std::string data;
+  inflater.write(compressed.data(), compressed.size(), data);
+  if (!inflater.isFinished()) {
+    throw CompressionError("Truncated zlib stream");
+  }
+  return data;
+}
+
+bool
+isCompressed(const std::string& data)
+{
+  // the CMF byte of a deflate stream with a 32K window, then a header check multiple of 31
+  return data.size() >= 2 && static_cast<uint8_t>(data[0]) == 0x78 &&
+         ((static_cast<uint8_t>(data[0]) << 8) | static_cast<uint8_t>(data[1])) % 31 == 0;
+}
+
+} // namespace util
+} // namespace atmos
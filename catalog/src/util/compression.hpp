@@ -0,0 +1,136 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_COMPRESSION_HPP
+#define ATMOS_UTIL_COMPRESSION_HPP
+
+#include <boost/noncopyable.hpp>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+struct z_stream_s;
+
+namespace atmos {
+namespace util {
+
+class CompressionError : public std::runtime_error
+{
+public:
+  explicit
+  CompressionError(const std::string& what)
+    : std::runtime_error(what)
+  {
+  }
+};
+
+/**
+ * @return the zlib stream of data
+ * @throw CompressionError if zlib fails
+ */
+std::string
+compress(const std::string& data);
+
+/**
+ * @return the data of a zlib stream
+ * @throw CompressionError if the stream is malformed or truncated
+ */
+std::string
+decompress(const std::string& compressed);
+
+/**
+ * Deflater compresses a zlib stream fed piece by piece, so that neither the data nor its
+ * compressed form has to be held at once
+ */
+class Deflater : boost::noncopyable
+{
+public:
+  /**
+   * @throw CompressionError if zlib cannot be initialized
+   */
+  Deflater();
+
+  ~Deflater();
+
+  /**
+   * Compress the next piece of the data, and append the output produced so far to compressed
+   *
+   * @throw CompressionError if zlib fails
+   */
+  void
+  write(const char* data, size_t size, std::string& compressed);
+
+  /**
+   * End the stream, and append the rest of the output to compressed
+   *
+   * @throw CompressionError if zlib fails
+   */
+  void
+  finish(std::string& compressed);
+
+private:
+  std::unique_ptr<z_stream_s> m_stream;
+};
+
+/**
+ * Inflater decompresses a zlib stream received piece by piece
+ */
+class Inflater : boost::noncopyable
+{
+public:
+  /**
+   * @throw CompressionError if zlib cannot be initialized
+   */
+  Inflater();
+
+  ~Inflater();
+
+  /**
+   * Decompress the next piece of the stream, and append its data to data; the bytes past the
+   * end of the stream are ignored
+   *
+   * @throw CompressionError if the stream is malformed
+   */
+  void
+  write(const char* compressed, size_t size, std::string& data);
+
+  /**
+   * @return true once the end of the stream is decompressed
+   */
+  bool
+  isFinished() const
+  {
+    return m_isFinished;
+  }
+
+private:
+  std::unique_ptr<z_stream_s> m_stream;
+  bool m_isFinished;
+};
+
+/**
+ * @return true if data starts like a zlib stream, which a JSON document never does
+ */
+bool
+isCompressed(const std::string& data);
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_COMPRESSION_HPP
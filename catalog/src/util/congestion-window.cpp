@@ -0,0 +1,62 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/congestion-window.hpp"
+
+#include <algorithm>
+
+namespace atmos {
+namespace util {
+
+CongestionWindow::CongestionWindow(size_t initialSize, size_t maxSize)
+  : m_maxSize(std::max<size_t>(maxSize, 1))
+  , m_size(std::min(std::max<size_t>(initialSize, 1), std::max<size_t>(maxSize, 1)))
+  , m_threshold(m_maxSize)
+  , m_isRecovering(false)
+  , m_recoveryPoint(0)
+{
+}
+
+void
+CongestionWindow::onData()
+{
+  if (m_size < m_threshold) {
+    m_size += 1;
+  }
+  else {
+    m_size += 1 / m_size;
+  }
+  m_size = std::min(m_size, m_maxSize);
+}
+
+bool
+CongestionWindow::onTimeout(uint64_t segment, uint64_t highestSent)
+{
+  if (m_isRecovering && segment <= m_recoveryPoint) {
+    return false;
+  }
+
+  m_threshold = std::max(m_size / 2, 1.0);
+  m_size = m_threshold;
+  m_isRecovering = true;
+  m_recoveryPoint = highestSent;
+  return true;
+}
+
+} // namespace util
+} // namespace atmos
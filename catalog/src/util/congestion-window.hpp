@@ -0,0 +1,84 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_CONGESTION_WINDOW_HPP
+#define ATMOS_UTIL_CONGESTION_WINDOW_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace atmos {
+namespace util {
+
+/**
+ * CongestionWindow is the AIMD window that bounds the number of Interests a fetcher keeps in
+ * flight.
+ *
+ * The window starts in slow start, growing by one for each Data, up to the slow start threshold;
+ * past it, it grows by one per window's worth of Data. A timeout halves the window, and sets the
+ * threshold to the halved window. All timeouts of the segments sent before a decrease belong to
+ * the same loss event, so they do not decrease the window again.
+ */
+class CongestionWindow
+{
+public:
+  /**
+   * @param initialSize: window at start, at least 1
+   * @param maxSize:     the window never grows past this
+   */
+  CongestionWindow(size_t initialSize, size_t maxSize);
+
+  /**
+   * A segment has been received
+   */
+  void
+  onData();
+
+  /**
+   * A segment has timed out
+   *
+   * @param segment:     the segment that timed out
+   * @param highestSent: the highest segment sent so far
+   * @return true if the window was decreased, false if the timeout belongs to a loss event
+   *         that already decreased it
+   */
+  bool
+  onTimeout(uint64_t segment, uint64_t highestSent);
+
+  /**
+   * @return the number of Interests that can be in flight
+   */
+  size_t
+  getSize() const
+  {
+    return static_cast<size_t>(m_size);
+  }
+
+private:
+  const double m_maxSize;
+  double m_size;
+  double m_threshold;
+  bool m_isRecovering;
+  // timeouts of the segments up to this one do not decrease the window again
+  uint64_t m_recoveryPoint;
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_CONGESTION_WINDOW_HPP
@@ -0,0 +1,146 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/cuckoo-filter.hpp"
+
+#include <algorithm>
+
+namespace atmos {
+namespace util {
+
+const size_t CuckooFilter::SLOTS_PER_BUCKET;
+const size_t CuckooFilter::MAX_KICKS;
+
+CuckooFilter::CuckooFilter(size_t capacity)
+  : m_size(0)
+  , m_kickState(0x9E3779B97F4A7C15ULL)
+{
+  // the buckets are filled up to about 95%
+  size_t nBuckets = 1;
+  while (nBuckets * SLOTS_PER_BUCKET * 95 / 100 < capacity) {
+    nBuckets *= 2;
+  }
+  m_buckets.assign(nBuckets * SLOTS_PER_BUCKET, 0);
+  m_bucketMask = nBuckets - 1;
+}
+
+uint16_t
+CuckooFilter::fingerprint(uint64_t key) const
+{
+  // the high bits, independent from the bucket index
+  uint16_t value = static_cast<uint16_t>(key >> 48);
+  return value == 0 ? 1 : value;
+}
+
+size_t
+CuckooFilter::otherBucket(size_t bucket, uint16_t fingerprint) const
+{
+  // partial-key cuckoo hashing, the other bucket of the other bucket is the first one
+  return (bucket ^ (fingerprint * 0x5bd1e995ULL)) & m_bucketMask;
+}
+
+bool
+CuckooFilter::insertInto(size_t bucket, uint16_t fingerprint)
+{
+  uint16_t* slots = &m_buckets[bucket * SLOTS_PER_BUCKET];
+  for (size_t i = 0; i < SLOTS_PER_BUCKET; ++i) {
+    if (slots[i] == 0) {
+      slots[i] = fingerprint;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool
+CuckooFilter::removeFrom(size_t bucket, uint16_t fingerprint)
+{
+  uint16_t* slots = &m_buckets[bucket * SLOTS_PER_BUCKET];
+  for (size_t i = 0; i < SLOTS_PER_BUCKET; ++i) {
+    if (slots[i] == fingerprint) {
+      slots[i] = 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool
+CuckooFilter::isIn(size_t bucket, uint16_t fingerprint) const
+{
+  const uint16_t* slots = &m_buckets[bucket * SLOTS_PER_BUCKET];
+  return std::find(slots, slots + SLOTS_PER_BUCKET, fingerprint) != slots + SLOTS_PER_BUCKET;
+}
+
+bool
+CuckooFilter::add(uint64_t key)
+{
+  uint16_t value = fingerprint(key);
+  size_t first = bucket(key);
+  size_t second = otherBucket(first, value);
+  if (insertInto(first, value) || insertInto(second, value)) {
+    ++m_size;
+    return true;
+  }
+
+  // move fingerprints to their other bucket until one finds a free slot
+  size_t current = (m_kickState & 1) ? first : second;
+  for (size_t kick = 0; kick < MAX_KICKS; ++kick) {
+    m_kickState ^= m_kickState << 13;
+    m_kickState ^= m_kickState >> 7;
+    m_kickState ^= m_kickState << 17;
+    std::swap(value, m_buckets[current * SLOTS_PER_BUCKET + m_kickState % SLOTS_PER_BUCKET]);
+    current = otherBucket(current, value);
+    if (insertInto(current, value)) {
+      ++m_size;
+      return true;
+    }
+  }
+  // the last fingerprint moved is dropped, its key is no longer found
+  return false;
+}
+
+bool
+CuckooFilter::contains(uint64_t key) const
+{
+  uint16_t value = fingerprint(key);
+  size_t first = bucket(key);
+  return isIn(first, value) || isIn(otherBucket(first, value), value);
+}
+
+bool
+CuckooFilter::remove(uint64_t key)
+{
+  uint16_t value = fingerprint(key);
+  size_t first = bucket(key);
+  if (removeFrom(first, value) || removeFrom(otherBucket(first, value), value)) {
+    --m_size;
+    return true;
+  }
+  return false;
+}
+
+void
+CuckooFilter::clear()
+{
+  std::fill(m_buckets.begin(), m_buckets.end(), 0);
+  m_size = 0;
+}
+
+} // namespace util
+} // namespace atmos
@@ -0,0 +1,125 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_CUCKOO_FILTER_HPP
+#define ATMOS_UTIL_CUCKOO_FILTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace atmos {
+namespace util {
+
+/**
+ * CuckooFilter is an approximate set of 64-bit keys, e.g., the sha256 of the names in the
+ * catalog, that supports removal.
+ *
+ * Each key is kept as a 16-bit fingerprint in one of two buckets of 4 slots, so the filter
+ * takes about 2 bytes per key. contains() may return true for a key that was never added (about
+ * 0.01% of the keys when the filter is full), never false for a key that was added, unless the
+ * filter overflowed: when both buckets of a key are full, a random fingerprint is moved to its
+ * other bucket, and after MAX_KICKS moves the last one is dropped.
+ *
+ * The keys must be uniformly distributed. The filter is not thread-safe.
+ */
+class CuckooFilter
+{
+public:
+  /**
+   * @param capacity: number of keys the filter can hold, rounded up to a power of two of buckets
+   */
+  explicit
+  CuckooFilter(size_t capacity);
+
+  /**
+   * @return false if the filter is full and a fingerprint was dropped
+   */
+  bool
+  add(uint64_t key);
+
+  bool
+  contains(uint64_t key) const;
+
+  /**
+   * Remove a key that was added before; removing another key may remove a key with the same
+   * fingerprint
+   *
+   * @return false if the key was not found
+   */
+  bool
+  remove(uint64_t key);
+
+  /**
+   * Remove all keys
+   */
+  void
+  clear();
+
+  size_t
+  size() const
+  {
+    return m_size;
+  }
+
+  /**
+   * @return the number of slots, the filter holds about 95% as many keys
+   */
+  size_t
+  getCapacity() const
+  {
+    return m_buckets.size();
+  }
+
+private:
+  static const size_t SLOTS_PER_BUCKET = 4;
+  static const size_t MAX_KICKS = 500;
+
+  uint16_t
+  fingerprint(uint64_t key) const;
+
+  size_t
+  bucket(uint64_t key) const
+  {
+    return key & m_bucketMask;
+  }
+
+  size_t
+  otherBucket(size_t bucket, uint16_t fingerprint) const;
+
+  bool
+  insertInto(size_t bucket, uint16_t fingerprint);
+
+  bool
+  removeFrom(size_t bucket, uint16_t fingerprint);
+
+  bool
+  isIn(size_t bucket, uint16_t fingerprint) const;
+
+private:
+  // SLOTS_PER_BUCKET fingerprints per bucket, 0 for an empty slot
+  std::vector<uint16_t> m_buckets;
+  size_t m_bucketMask;
+  size_t m_size;
+  uint64_t m_kickState;
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_CUCKOO_FILTER_HPP
@@ -0,0 +1,324 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/database-pool.hpp"
+#include "util/logger.hpp"
+
+#include <cstdlib>
+#include <iostream>
+
+namespace atmos {
+namespace util {
+#ifdef HAVE_LOG4CXX
+  INIT_LOGGER("DatabasePool");
+#endif
+
+ReplicaSet::ReplicaSet()
+  : primaryWeight(1)
+  , maxLag(DB_MAX_REPLICA_LAG_S)
+  , checkInterval(DB_HEALTH_CHECK_INTERVAL_MS)
+{
+  // empty
+}
+
+DatabasePool::DatabasePool(const ConnectionDetails& details, const std::string& name)
+  : DatabasePool(details, ReplicaSet(), name)
+{
+}
+
+DatabasePool::DatabasePool(const ConnectionDetails& details, const ReplicaSet& replicas,
+                           const std::string& name)
+  : m_maxWaiting(details.maxWaiting)
+  , m_acquireTimeout(details.acquireTimeout)
+  , m_maxLag(replicas.maxLag)
+  , m_checkInterval(replicas.checkInterval)
+  , m_balancer(details.maxConnections)
+  , m_nInUse(0)
+  , m_nWaiting(0)
+  , m_isStopped(false)
+  , m_inUseMetric(MetricsRegistry::getDefault().get(name + ".db.inUse"))
+  , m_waitingMetric(MetricsRegistry::getDefault().get(name + ".db.waiting"))
+  , m_acquiredMetric(MetricsRegistry::getDefault().get(name + ".db.acquired"))
+  , m_waitTimeMetric(MetricsRegistry::getDefault().get(name + ".db.waitTimeUs"))
+  , m_maxWaitTimeMetric(MetricsRegistry::getDefault().get(name + ".db.maxWaitTimeUs"))
+  , m_timeoutsMetric(MetricsRegistry::getDefault().get(name + ".db.timeouts"))
+  , m_rejectedMetric(MetricsRegistry::getDefault().get(name + ".db.rejected"))
+{
+  if (replicas.replicas.empty()) {
+    addEndpoint(details, replicas.primaryWeight, "");
+    return;
+  }
+
+  addEndpoint(details, replicas.primaryWeight, name);
+  for (const auto& replica : replicas.replicas) {
+    ConnectionDetails replicaDetails(details);
+    replicaDetails.server = replica.server;
+    if (replica.port != 0) {
+      replicaDetails.port = replica.port;
+    }
+    addEndpoint(replicaDetails, replica.weight, name);
+  }
+  m_healthChecker = std::thread(&DatabasePool::checkHealth, this);
+}
+
+DatabasePool::~DatabasePool()
+{
+  stop();
+}
+
+void
+DatabasePool::addEndpoint(const ConnectionDetails& details, size_t weight,
+                          const std::string& name)
+{
+  Endpoint endpoint;
+  endpoint.server = details.server;
+  endpoint.canCheckLag = true;
+  if (name.empty()) {
+    endpoint.pool = *zdbConnectionSetup(details);
+    endpoint.inUseMetric = nullptr;
+    endpoint.healthyMetric = nullptr;
+    endpoint.lagMetric = nullptr;
+  }
+  else {
+    // one more connection for the health check, which does not take a slot
+    ConnectionDetails poolDetails(details);
+    poolDetails.maxConnections += 1;
+    endpoint.pool = *zdbConnectionSetup(poolDetails);
+
+    std::string prefix = name + ".db." + details.server;
+    endpoint.inUseMetric = &MetricsRegistry::getDefault().get(prefix + ".inUse");
+    endpoint.healthyMetric = &MetricsRegistry::getDefault().get(prefix + ".healthy");
+    endpoint.lagMetric = &MetricsRegistry::getDefault().get(prefix + ".lagS");
+    endpoint.healthyMetric->set(1);
+  }
+
+  m_endpoints.push_back(endpoint);
+  m_balancer.addEndpoint(weight);
+}
+
+Connection_T
+DatabasePool::acquire()
+{
+  return acquire(true, true);
+}
+
+Connection_T
+DatabasePool::tryAcquire()
+{
+  return acquire(false, true);
+}
+
+Connection_T
+DatabasePool::acquire(bool canWait, bool canRetry)
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (m_isStopped) {
+    return NULL;
+  }
+
+  int index = m_balancer.acquire();
+  if (index < 0) {
+    if (!canWait || m_nWaiting >= m_maxWaiting) {
+      m_rejectedMetric.add();
+      return NULL;
+    }
+
+    m_waitingMetric.set(++m_nWaiting);
+    m_released.wait_for(lock, m_acquireTimeout, [this, &index] {
+        return m_isStopped || (index = m_balancer.acquire()) >= 0;
+      });
+    m_waitingMetric.set(--m_nWaiting);
+
+    if (index < 0) {
+      m_timeoutsMetric.add();
+      return NULL;
+    }
+  }
+  m_inUseMetric.set(++m_nInUse);
+  Endpoint& endpoint = m_endpoints[index];
+  if (endpoint.inUseMetric != nullptr) {
+    endpoint.inUseMetric->set(m_balancer.getOutstanding(index));
+  }
+  lock.unlock();
+
+  int64_t waitTime = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - start).count();
+  m_acquiredMetric.add();
+  m_waitTimeMetric.add(waitTime);
+  m_maxWaitTimeMetric.setMax(waitTime);
+
+  // the slot guarantees that libzdb has a connection for us, unless the database is down
+  Connection_T conn = ConnectionPool_getConnection(endpoint.pool);
+
+  lock.lock();
+  if (conn == NULL) {
+    m_balancer.release(index);
+    m_inUseMetric.set(--m_nInUse);
+    if (endpoint.inUseMetric != nullptr) {
+      endpoint.inUseMetric->set(m_balancer.getOutstanding(index));
+    }
+    // the health check may not have noticed yet, the read goes to the next pick, e.g., the
+    // primary once no replica is left in rotation
+    bool isRetried = canRetry && m_balancer.size() > 1 && m_balancer.isHealthy(index);
+    if (isRetried) {
+      _LOG_ERROR("Database " << endpoint.server << " cannot be reached, it is taken out of"
+                 << " rotation");
+      m_balancer.setHealthy(index, false);
+      endpoint.healthyMetric->set(0);
+    }
+    lock.unlock();
+    m_released.notify_one();
+    return isRetried ? acquire(canWait, false) : NULL;
+  }
+  m_connectionEndpoints[conn] = index;
+  return conn;
+}
+
+void
+DatabasePool::release(Connection_T conn)
+{
+  {
+    // forget the connection before libzdb can hand it out again
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_connectionEndpoints.find(conn);
+    size_t index = it->second;
+    m_connectionEndpoints.erase(it);
+
+    m_balancer.release(index);
+    m_inUseMetric.set(--m_nInUse);
+    if (m_endpoints[index].inUseMetric != nullptr) {
+      m_endpoints[index].inUseMetric->set(m_balancer.getOutstanding(index));
+    }
+  }
+  Connection_close(conn);
+  m_released.notify_one();
+}
+
+bool
+DatabasePool::isSaturated() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_balancer.isFull() && m_nWaiting >= m_maxWaiting;
+}
+
+void
+DatabasePool::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_isStopped) {
+      return;
+    }
+    m_isStopped = true;
+  }
+  m_released.notify_all();
+  m_stopped.notify_all();
+
+  if (m_healthChecker.joinable()) {
+    m_healthChecker.join();
+  }
+  for (const auto& endpoint : m_endpoints) {
+    ConnectionPool_stop(endpoint.pool);
+  }
+}
+
+void
+DatabasePool::checkHealth()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (!m_isStopped) {
+    for (size_t i = 0; i < m_endpoints.size(); ++i) {
+      lock.unlock();
+      int64_t lag = 0;
+      bool isHealthy = isEndpointHealthy(m_endpoints[i], lag);
+      lock.lock();
+
+      m_endpoints[i].healthyMetric->set(isHealthy ? 1 : 0);
+      m_endpoints[i].lagMetric->set(lag);
+      if (isHealthy == m_balancer.isHealthy(i)) {
+        continue;
+      }
+      m_balancer.setHealthy(i, isHealthy);
+      if (isHealthy) {
+        _LOG_DEBUG("Database " << m_endpoints[i].server << " is back in rotation");
+        // the waiters can use the endpoint now
+        m_released.notify_all();
+      }
+      else {
+        _LOG_ERROR("Database " << m_endpoints[i].server << " is taken out of rotation");
+      }
+    }
+
+    m_stopped.wait_for(lock, m_checkInterval, [this] { return m_isStopped; });
+  }
+}
+
+bool
+DatabasePool::isEndpointHealthy(Endpoint& endpoint, int64_t& lag)
+{
+  Connection_T conn = ConnectionPool_getConnection(endpoint.pool);
+  if (conn == NULL) {
+    return false;
+  }
+
+  // a database that is not a replica has no slave status, and no lag
+  bool isHealthy = true;
+  lag = 0;
+  if (!endpoint.canCheckLag) {
+    Connection_close(conn);
+    return isHealthy;
+  }
+  TRY {
+    ResultSet_T status = Connection_executeQuery(conn, "SHOW SLAVE STATUS");
+    if (ResultSet_next(status)) {
+      const char* secondsBehind = ResultSet_getStringByName(status, "Seconds_Behind_Master");
+      if (secondsBehind == NULL) {
+        // replication is stopped
+        isHealthy = false;
+      }
+      else {
+        lag = std::strtoll(secondsBehind, NULL, 10);
+        isHealthy = lag <= m_maxLag.count();
+      }
+    }
+  }
+  CATCH(SQLException) {
+    std::string error(Connection_getLastError(conn));
+    if (error.find("Access denied") != std::string::npos) {
+      // ER_SPECIFIC_ACCESS_DENIED_ERROR, the user lacks REPLICATION CLIENT; taking every endpoint
+      // out of rotation would leave nothing to serve the reads
+      _LOG_ERROR("Cannot check the replication lag of " << endpoint.server << ": " << error
+                 << "; grant REPLICATION CLIENT to the database user, until then the server"
+                 << " stays in rotation while it can be reached");
+      endpoint.canCheckLag = false;
+    }
+    else {
+      _LOG_ERROR(error);
+      isHealthy = false;
+    }
+  }
+  END_TRY;
+
+  Connection_close(conn);
+  return isHealthy;
+}
+
+} // namespace util
+} // namespace atmos
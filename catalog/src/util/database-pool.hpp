@@ -0,0 +1,208 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_DATABASE_POOL_HPP
+#define ATMOS_UTIL_DATABASE_POOL_HPP
+
+#include "util/metrics.hpp"
+#include "util/mysql-util.hpp"
+#include "util/replica-balancer.hpp"
+
+#include <boost/noncopyable.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace atmos {
+namespace util {
+
+#define DB_MAX_REPLICA_LAG_S 30
+#define DB_HEALTH_CHECK_INTERVAL_MS 5000
+
+/**
+ * Read replicas of a database, which share its name, user and password
+ */
+struct ReplicaSet
+{
+public:
+  ReplicaSet();
+
+  struct Replica
+  {
+    std::string server;
+    // 0 when the replica listens on the same port as the primary
+    unsigned int port;
+    size_t weight;
+  };
+
+  std::vector<Replica> replicas;
+  // share of the reads taken by the primary; with 0, the primary only serves the reads
+  // when no replica is in rotation
+  size_t primaryWeight;
+  // a replica lagging behind the primary by more than this is taken out of rotation
+  std::chrono::seconds maxLag;
+  std::chrono::milliseconds checkInterval;
+};
+
+/**
+ * DatabasePool is the DatabaseHandler of the adapters for MySQL through libzdb.
+ *
+ * It caps the connections of a libzdb ConnectionPool_T at details.maxConnections. When all of
+ * them are in use, up to details.maxWaiting callers wait for one to be released, each for at
+ * most details.acquireTimeout; past that, acquire fails right away, so the caller can push back
+ * instead of piling up. Each adapter owns its pool, which gives separately sized read (query)
+ * and write (publish) pools.
+ *
+ * A pool built with a ReplicaSet spreads the connections over the primary and its replicas as
+ * chosen by a ReplicaBalancer, each endpoint having up to details.maxConnections connections. A
+ * thread checks every endpoint each checkInterval, and takes out of rotation the ones that cannot
+ * be reached, or whose replication is stopped or lags by more than maxLag. An endpoint that
+ * cannot be reached when a connection is acquired is taken out of rotation right away, until the
+ * check finds it back, and the connection is taken from the next pick instead. The lag check
+ * needs the REPLICATION CLIENT privilege; without it, an error is logged once and the endpoint
+ * stays in rotation as long as it can be reached.
+ *
+ * The pool reports "<name>.db.inUse", "<name>.db.waiting", "<name>.db.acquired",
+ * "<name>.db.waitTimeUs", "<name>.db.maxWaitTimeUs", "<name>.db.timeouts" and
+ * "<name>.db.rejected" to the default MetricsRegistry, plus "<name>.db.<server>.inUse",
+ * "<name>.db.<server>.healthy" and "<name>.db.<server>.lagS" for each endpoint of a replicated
+ * pool.
+ */
+class DatabasePool : boost::noncopyable
+{
+public:
+  /**
+   * Constructor
+   *
+   * @param details: database to connect to, and the pool limits
+   * @param name:    prefix of the metrics of this pool, e.g., "query"
+   */
+  DatabasePool(const ConnectionDetails& details, const std::string& name);
+
+  /**
+   * Constructor of a pool that reads from the replicas as well
+   *
+   * @param details:  primary database, and the pool limits of each endpoint
+   * @param replicas: replicas of the primary
+   * @param name:     prefix of the metrics of this pool
+   */
+  DatabasePool(const ConnectionDetails& details, const ReplicaSet& replicas,
+               const std::string& name);
+
+  ~DatabasePool();
+
+  /**
+   * Get a connection, waiting up to acquireTimeout for one to be released
+   *
+   * @return the connection, or NULL if the wait queue is full, the wait timed out, or the
+   *         database cannot be reached. A connection must be given back with release
+   */
+  Connection_T
+  acquire();
+
+  /**
+   * Get a connection only if one is available right away
+   */
+  Connection_T
+  tryAcquire();
+
+  void
+  release(Connection_T conn);
+
+  /**
+   * @return true if all connections are in use and the wait queue is full, i.e., acquire
+   *         would fail right away
+   */
+  bool
+  isSaturated() const;
+
+  void
+  stop();
+
+private:
+  struct Endpoint
+  {
+    std::string server;
+    ConnectionPool_T pool;
+    Metric* inUseMetric;
+    Metric* healthyMetric;
+    Metric* lagMetric;
+    // false once SHOW SLAVE STATUS was denied, the endpoint is then only checked to be reachable;
+    // only accessed by the health check thread
+    bool canCheckLag;
+  };
+
+  void
+  addEndpoint(const ConnectionDetails& details, size_t weight, const std::string& name);
+
+  /**
+   * @param canRetry: when the chosen endpoint cannot be reached, take it out of rotation and
+   *                  try the next pick once
+   */
+  Connection_T
+  acquire(bool canWait, bool canRetry);
+
+  void
+  checkHealth();
+
+  /**
+   * @param lag: set to the replication lag in seconds, 0 for a database that is not a replica or
+   *             whose lag cannot be checked
+   * @return true if the endpoint can serve reads
+   */
+  bool
+  isEndpointHealthy(Endpoint& endpoint, int64_t& lag);
+
+private:
+  std::vector<Endpoint> m_endpoints;
+  const size_t m_maxWaiting;
+  const std::chrono::milliseconds m_acquireTimeout;
+  const std::chrono::seconds m_maxLag;
+  const std::chrono::milliseconds m_checkInterval;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_released;
+  std::condition_variable m_stopped;
+  // @{ need m_mutex protection
+  ReplicaBalancer m_balancer;
+  // endpoint each connection in use was taken from
+  std::map<Connection_T, size_t> m_connectionEndpoints;
+  size_t m_nInUse;
+  size_t m_nWaiting;
+  bool m_isStopped;
+  // @}
+  std::thread m_healthChecker;
+
+  Metric& m_inUseMetric;
+  Metric& m_waitingMetric;
+  Metric& m_acquiredMetric;
+  Metric& m_waitTimeMetric;
+  Metric& m_maxWaitTimeMetric;
+  Metric& m_timeoutsMetric;
+  Metric& m_rejectedMetric;
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_DATABASE_POOL_HPP
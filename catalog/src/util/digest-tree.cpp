@@ -0,0 +1,107 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/digest-tree.hpp"
+
+#include <algorithm>
+
+namespace atmos {
+namespace util {
+
+const size_t DigestTree::FANOUT;
+const size_t DigestTree::MAX_DEPTH;
+
+DigestTree::DigestTree(std::vector<uint64_t> keys)
+  : m_keys(std::move(keys))
+  , m_prefixXor(1, 0)
+{
+  std::sort(m_keys.begin(), m_keys.end());
+  m_prefixXor.reserve(m_keys.size() + 1);
+  for (uint64_t key : m_keys) {
+    m_prefixXor.push_back(m_prefixXor.back() ^ key);
+  }
+}
+
+DigestTree::Node
+DigestTree::getNode(const std::string& hexPrefix) const
+{
+  std::pair<size_t, size_t> range = getRange(hexPrefix);
+  return Node{range.second - range.first, m_prefixXor[range.second] ^ m_prefixXor[range.first]};
+}
+
+std::vector<DigestTree::Node>
+DigestTree::getChildren(const std::string& hexPrefix) const
+{
+  if (hexPrefix.size() > MAX_DEPTH) {
+    throw Error("Digest prefix " + hexPrefix + " has no children");
+  }
+
+  std::vector<Node> children;
+  std::string child = hexPrefix + '0';
+  for (size_t i = 0; i < FANOUT; ++i) {
+    child.back() = "0123456789ABCDEF"[i];
+    children.push_back(getNode(child));
+  }
+  return children;
+}
+
+bool
+DigestTree::contains(uint64_t key) const
+{
+  return std::binary_search(m_keys.begin(), m_keys.end(), key);
+}
+
+std::pair<size_t, size_t>
+DigestTree::getRange(const std::string& hexPrefix) const
+{
+  if (hexPrefix.size() > 16) {
+    throw Error("Digest prefix " + hexPrefix + " is longer than the keys");
+  }
+  if (hexPrefix.empty()) {
+    return std::make_pair(0, m_keys.size());
+  }
+
+  uint64_t value = 0;
+  for (char c : hexPrefix) {
+    int digit;
+    if (c >= '0' && c <= '9') {
+      digit = c - '0';
+    }
+    else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+      digit = (c | 0x20) - 'a' + 10;
+    }
+    else {
+      throw Error("Digest prefix " + hexPrefix + " is not hex");
+    }
+    value = (value << 4) | digit;
+  }
+
+  // the keys in [low, low + span), the last prefix of a length runs to the end
+  int shift = 64 - 4 * hexPrefix.size();
+  uint64_t low = value << shift;
+  size_t begin = std::lower_bound(m_keys.begin(), m_keys.end(), low) - m_keys.begin();
+  size_t end = m_keys.size();
+  uint64_t last = shift == 0 ? low : (~0ULL >> (64 - shift)) | low;
+  if (last != ~0ULL) {
+    end = std::lower_bound(m_keys.begin() + begin, m_keys.end(), last + 1) - m_keys.begin();
+  }
+  return std::make_pair(begin, end);
+}
+
+} // namespace util
+} // namespace atmos
@@ -0,0 +1,120 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_DIGEST_TREE_HPP
+#define ATMOS_UTIL_DIGEST_TREE_HPP
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace atmos {
+namespace util {
+
+/**
+ * DigestTree summarizes the sha256 column of a table as a Merkle tree over digest ranges: the
+ * node of a hex prefix covers the digests that start with it, and holds their number and the
+ * XOR of their first 64 bits. Two catalogs compare the children of the nodes that differ, from
+ * the root down, so the traffic grows with the difference of their tables, not with their size.
+ *
+ * The digests are given by their first 64 bits (sha256HexKey), kept sorted with a prefix XOR,
+ * so a node is found with two binary searches.
+ */
+class DigestTree
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  struct Node
+  {
+    uint64_t count;
+    uint64_t fingerprint;
+
+    bool
+    operator==(const Node& other) const
+    {
+      return count == other.count && fingerprint == other.fingerprint;
+    }
+
+    bool
+    operator!=(const Node& other) const
+    {
+      return !(*this == other);
+    }
+  };
+
+  // children of a node, one per hex digit
+  static const size_t FANOUT = 16;
+  // longest prefix whose children can be asked for
+  static const size_t MAX_DEPTH = 15;
+
+  /**
+   * @param keys: first 64 bits of the digests, in any order
+   */
+  explicit
+  DigestTree(std::vector<uint64_t> keys = std::vector<uint64_t>());
+
+  /**
+   * @param hexPrefix: prefix of the digests, in hex of either case, empty for the root
+   * @throw Error if the prefix is not hex, or longer than 16 digits
+   */
+  Node
+  getNode(const std::string& hexPrefix) const;
+
+  /**
+   * @return the FANOUT children of a node, in the order of their last digit
+   * @throw Error if the prefix is not hex, or longer than MAX_DEPTH digits
+   */
+  std::vector<Node>
+  getChildren(const std::string& hexPrefix) const;
+
+  bool
+  contains(uint64_t key) const;
+
+  size_t
+  size() const
+  {
+    return m_keys.size();
+  }
+
+private:
+  /**
+   * @return the range of m_keys that start with the prefix
+   */
+  std::pair<size_t, size_t>
+  getRange(const std::string& hexPrefix) const;
+
+private:
+  std::vector<uint64_t> m_keys;
+  // m_prefixXor[i] is the XOR of the first i keys
+  std::vector<uint64_t> m_prefixXor;
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_DIGEST_TREE_HPP
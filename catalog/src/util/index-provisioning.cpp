@@ -0,0 +1,123 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/index-provisioning.hpp"
+
+#include <cstdint>
+#include <cstdio>
+
+namespace atmos {
+namespace util {
+
+static const std::string MANAGED_INDEX_PREFIX("atmos_");
+// MySQL identifiers are at most 64 characters long
+static const size_t MAX_INDEX_NAME_LENGTH = 64;
+
+IndexDefinition
+IndexDefinition::fromColumns(const std::vector<std::string>& columns)
+{
+  IndexDefinition index;
+  index.columns = columns;
+  index.name = MANAGED_INDEX_PREFIX;
+  for (size_t i = 0; i < columns.size(); i++) {
+    if (i != 0) {
+      index.name += "_";
+    }
+    index.name += columns[i];
+  }
+
+  if (index.name.size() > MAX_INDEX_NAME_LENGTH) {
+    // keep the name unique with a FNV-1a hash of the full name, which is stable across restarts
+    uint32_t hash = 2166136261u;
+    for (char c : index.name) {
+      hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    char suffix[10];
+    std::snprintf(suffix, sizeof(suffix), "_%08x", hash);
+    index.name = index.name.substr(0, MAX_INDEX_NAME_LENGTH - 9) + suffix;
+  }
+  return index;
+}
+
+IndexChanges::IndexChanges(const std::vector<IndexDefinition>& wanted, const TableIndexes& existing)
+{
+  for (const auto& index : existing) {
+    if (index.first.compare(0, MANAGED_INDEX_PREFIX.size(), MANAGED_INDEX_PREFIX) != 0) {
+      continue;
+    }
+    bool isWanted = false;
+    for (const auto& wantedIndex : wanted) {
+      if (wantedIndex.name == index.first && wantedIndex.columns == index.second) {
+        isWanted = true;
+        break;
+      }
+    }
+    if (!isWanted) {
+      toDrop.push_back(index.first);
+    }
+  }
+
+  for (const auto& wantedIndex : wanted) {
+    bool isExisting = false;
+    for (const auto& index : existing) {
+      if (wantedIndex.name == index.first && wantedIndex.columns == index.second) {
+        isExisting = true;
+        break;
+      }
+    }
+    // the same index may be wanted twice, e.g., as a prefix and as a composite
+    for (const auto& index : toCreate) {
+      if (wantedIndex.name == index.name) {
+        isExisting = true;
+        break;
+      }
+    }
+    if (!isExisting) {
+      toCreate.push_back(wantedIndex);
+    }
+  }
+}
+
+std::string
+IndexChanges::getOnlineAlterStatement(const std::string& table) const
+{
+  std::string sql("ALTER TABLE " + table);
+  bool isFirst = true;
+  for (const auto& name : toDrop) {
+    sql += isFirst ? " " : ", ";
+    sql += "DROP INDEX " + name;
+    isFirst = false;
+  }
+  for (const auto& index : toCreate) {
+    sql += isFirst ? " " : ", ";
+    sql += "ADD INDEX " + index.name + " (";
+    for (size_t i = 0; i < index.columns.size(); i++) {
+      if (i != 0) {
+        sql += ", ";
+      }
+      sql += index.columns[i];
+    }
+    sql += ")";
+    isFirst = false;
+  }
+  sql += ", ALGORITHM=INPLACE, LOCK=NONE;";
+  return sql;
+}
+
+} // namespace util
+} // namespace atmos
@@ -0,0 +1,77 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_INDEX_PROVISIONING_HPP
+#define ATMOS_UTIL_INDEX_PROVISIONING_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace atmos {
+namespace util {
+
+// name and columns of each index of a table, as in SHOW INDEX
+typedef std::vector<std::pair<std::string, std::vector<std::string>>> TableIndexes;
+
+/**
+ * An index the catalog maintains on its table
+ */
+struct IndexDefinition
+{
+public:
+  /**
+   * @return the definition of an index on these columns, named "atmos_<column>_<column>..."
+   */
+  static IndexDefinition
+  fromColumns(const std::vector<std::string>& columns);
+
+  std::string name;
+  std::vector<std::string> columns;
+};
+
+/**
+ * Indexes to create and drop so that the managed indexes of a table are the wanted ones. Only
+ * the indexes named "atmos_..." are managed, the others are never dropped.
+ */
+struct IndexChanges
+{
+public:
+  IndexChanges(const std::vector<IndexDefinition>& wanted, const TableIndexes& existing);
+
+  bool
+  empty() const
+  {
+    return toCreate.empty() && toDrop.empty();
+  }
+
+  /**
+   * @return one MySQL statement that makes all the changes with InnoDB online DDL, so that the
+   *         table can still be read and written while the indexes are built
+   */
+  std::string
+  getOnlineAlterStatement(const std::string& table) const;
+
+  std::vector<IndexDefinition> toCreate;
+  std::vector<std::string> toDrop;
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_INDEX_PROVISIONING_HPP
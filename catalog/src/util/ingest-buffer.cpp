@@ -0,0 +1,80 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/ingest-buffer.hpp"
+
+namespace atmos {
+namespace util {
+
+void
+IngestBuffer::add(const std::string& name, const std::string& digest)
+{
+  record(name, true).digest = digest;
+}
+
+void
+IngestBuffer::remove(const std::string& name, const std::string& digest)
+{
+  record(name, false).digest = digest;
+}
+
+IngestBuffer::Entry&
+IngestBuffer::record(const std::string& name, bool isAdd)
+{
+  auto it = m_entries.find(name);
+  if (it == m_entries.end()) {
+    m_order.push_back(name);
+    it = m_entries.insert(std::make_pair(name, Entry{false, false, ""})).first;
+  }
+
+  if (isAdd) {
+    it->second.isAdded = true;
+  }
+  else {
+    // whatever was added before is gone, and so is the row that was already there
+    it->second.isRemoved = true;
+    it->second.isAdded = false;
+  }
+  return it->second;
+}
+
+IngestBatch
+IngestBuffer::take()
+{
+  IngestBatch batch;
+  for (const auto& name : m_order) {
+    const Entry& entry = m_entries[name];
+    if (entry.isRemoved) {
+      batch.removed.push_back(name);
+      batch.removedDigests.push_back(entry.digest);
+    }
+    if (entry.isAdded) {
+      batch.added.push_back(name);
+      batch.addedDigests.push_back(entry.digest);
+    }
+  }
+
+  batch.progress.swap(m_progress);
+
+  m_order.clear();
+  m_entries.clear();
+  return batch;
+}
+
+} // namespace util
+} // namespace atmos
@@ -0,0 +1,141 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_INGEST_BUFFER_HPP
+#define ATMOS_UTIL_INGEST_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace atmos {
+namespace util {
+
+/**
+ * The net effect of a sequence of add and remove operations on the catalog
+ */
+struct IngestBatch
+{
+public:
+  size_t
+  size() const
+  {
+    return removed.size() + added.size();
+  }
+
+  bool
+  empty() const
+  {
+    return removed.empty() && added.empty() && progress.empty();
+  }
+
+  // names to delete, applied first
+  std::vector<std::string> removed;
+  // sha256 of each removed name, in the same order
+  std::vector<std::string> removedDigests;
+  // names to insert, applied after the deletions
+  std::vector<std::string> added;
+  // sha256 of each added name, in the same order
+  std::vector<std::string> addedDigests;
+  // values to save with the operations of the batch, by key
+  std::map<std::string, uint64_t> progress;
+};
+
+/**
+ * IngestBuffer collects the add and remove operations on file names, and folds them into an
+ * IngestBatch that leaves the catalog as if they had been applied one by one, in order.
+ *
+ * A name removed at any point is deleted, and it is inserted again if its last operation is an
+ * add; a name only added is inserted once. Hence the deletions of a batch run before its
+ * insertions, and the operations on one name keep their order.
+ *
+ * IngestBuffer is not thread-safe.
+ */
+class IngestBuffer
+{
+public:
+  /**
+   * @param digest: sha256 of the name, computed once by the caller
+   */
+  void
+  add(const std::string& name, const std::string& digest);
+
+  /**
+   * @param digest: sha256 of the name, the rows are deleted by it
+   */
+  void
+  remove(const std::string& name, const std::string& digest);
+
+  /**
+   * Record a value to save in the same transaction as the operations buffered so far, e.g.,
+   * the sequence number up to which the updates of a sync session are fetched. The last value
+   * of a key is kept
+   */
+  void
+  setProgress(const std::string& key, uint64_t value)
+  {
+    m_progress[key] = value;
+  }
+
+  /**
+   * @return the number of distinct names buffered
+   */
+  size_t
+  size() const
+  {
+    return m_order.size();
+  }
+
+  bool
+  empty() const
+  {
+    return m_order.empty() && m_progress.empty();
+  }
+
+  /**
+   * Get the batch of the buffered operations, and empty the buffer
+   */
+  IngestBatch
+  take();
+
+private:
+  struct Entry
+  {
+    bool isRemoved;
+    bool isAdded;
+    // the same for the add and the remove operations on a name
+    std::string digest;
+  };
+
+  Entry&
+  record(const std::string& name, bool isAdd);
+
+private:
+  // names in the order of their first operation
+  std::vector<std::string> m_order;
+  std::unordered_map<std::string, Entry> m_entries;
+  std::map<std::string, uint64_t> m_progress;
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_INGEST_BUFFER_HPP
@@ -0,0 +1,170 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/ingest-writer.hpp"
+#include "util/logger.hpp"
+
+#include <iostream>
+
+namespace atmos {
+namespace util {
+#ifdef HAVE_LOG4CXX
+  INIT_LOGGER("IngestWriter");
+#endif
+
+IngestWriter::Options::Options()
+  : maxBatchSize(INGEST_BATCH_SIZE)
+  , maxDelay(INGEST_BATCH_DELAY_MS)
+  , retryInterval(200)
+  , maxBacklog(10 * INGEST_BATCH_SIZE)
+{
+}
+
+IngestWriter::IngestWriter(const Options& options, const WriteCallback& write,
+                           const std::string& name)
+  : m_options(options)
+  , m_write(write)
+  , m_isStopped(false)
+  , m_pendingMetric(MetricsRegistry::getDefault().get(name + ".ingest.pending"))
+  , m_batchesMetric(MetricsRegistry::getDefault().get(name + ".ingest.batches"))
+  , m_rowsMetric(MetricsRegistry::getDefault().get(name + ".ingest.rows"))
+  , m_failuresMetric(MetricsRegistry::getDefault().get(name + ".ingest.failures"))
+{
+  m_thread = std::thread(&IngestWriter::run, this);
+}
+
+IngestWriter::~IngestWriter()
+{
+  stop();
+}
+
+void
+IngestWriter::add(const std::string& name, const std::string& digest)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_buffer.empty()) {
+    m_firstBuffered = std::chrono::steady_clock::now();
+  }
+  m_buffer.add(name, digest);
+  onBuffered();
+}
+
+void
+IngestWriter::remove(const std::string& name, const std::string& digest)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_buffer.empty()) {
+    m_firstBuffered = std::chrono::steady_clock::now();
+  }
+  m_buffer.remove(name, digest);
+  onBuffered();
+}
+
+void
+IngestWriter::setProgress(const std::string& key, uint64_t value)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  bool wasEmpty = m_buffer.empty();
+  if (wasEmpty) {
+    m_firstBuffered = std::chrono::steady_clock::now();
+  }
+  m_buffer.setProgress(key, value);
+  // the thread waits for the first operation, the progress alone is written after maxDelay
+  if (wasEmpty) {
+    m_cv.notify_one();
+  }
+}
+
+void
+IngestWriter::onBuffered()
+{
+  m_pendingMetric.set(m_buffer.size() + m_batch.size());
+  // the thread waits for the first operation, then for a full batch
+  if (m_buffer.size() == 1 || m_buffer.size() >= m_options.maxBatchSize) {
+    m_cv.notify_one();
+  }
+}
+
+bool
+IngestWriter::isBacklogged() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_buffer.size() + m_batch.size() >= m_options.maxBacklog;
+}
+
+void
+IngestWriter::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_isStopped) {
+      return;
+    }
+    m_isStopped = true;
+  }
+  m_cv.notify_one();
+
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+void
+IngestWriter::run()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    if (m_batch.empty()) {
+      m_cv.wait(lock, [this] { return m_isStopped || !m_buffer.empty(); });
+      m_cv.wait_until(lock, m_firstBuffered + m_options.maxDelay, [this] {
+          return m_isStopped || m_buffer.size() >= m_options.maxBatchSize;
+        });
+      if (m_buffer.empty()) {
+        // stopped, and everything is written
+        return;
+      }
+      m_batch = m_buffer.take();
+    }
+
+    IngestBatch batch = m_batch;
+    lock.unlock();
+    bool isWritten = m_write(batch);
+    lock.lock();
+
+    if (isWritten) {
+      m_batchesMetric.add();
+      m_rowsMetric.add(batch.size());
+    }
+    else {
+      m_failuresMetric.add();
+      if (m_isStopped) {
+        _LOG_ERROR("Cannot write the last " << batch.size() << " updates, giving up");
+      }
+      else {
+        _LOG_ERROR("Cannot write " << batch.size() << " updates, trying again");
+        m_cv.wait_for(lock, m_options.retryInterval, [this] { return m_isStopped; });
+        continue;
+      }
+    }
+    m_batch = IngestBatch();
+    m_pendingMetric.set(m_buffer.size());
+  }
+}
+
+} // namespace util
+} // namespace atmos
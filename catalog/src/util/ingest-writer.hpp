@@ -0,0 +1,146 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_INGEST_WRITER_HPP
+#define ATMOS_UTIL_INGEST_WRITER_HPP
+
+#include "util/ingest-buffer.hpp"
+#include "util/metrics.hpp"
+
+#include <boost/noncopyable.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace atmos {
+namespace util {
+
+#define INGEST_BATCH_SIZE 1000
+#define INGEST_BATCH_DELAY_MS 500
+
+/**
+ * IngestWriter buffers the add and remove operations of all publications and sync updates, and
+ * writes them from its own thread, one IngestBatch at a time.
+ *
+ * A batch is written once maxBatchSize names are buffered, or maxDelay after the first of them,
+ * whichever comes first; the write callback is expected to apply it in one transaction. A batch
+ * that cannot be written is tried again every retryInterval, while the next operations keep
+ * being buffered behind it, so the batches are written in order.
+ *
+ * The writer reports "<name>.ingest.pending", "<name>.ingest.batches", "<name>.ingest.rows" and
+ * "<name>.ingest.failures" to the default MetricsRegistry.
+ */
+class IngestWriter : boost::noncopyable
+{
+public:
+  struct Options
+  {
+    Options();
+
+    size_t maxBatchSize;
+    std::chrono::milliseconds maxDelay;
+    std::chrono::milliseconds retryInterval;
+    // isBacklogged is true past this number of pending names
+    size_t maxBacklog;
+  };
+
+  // writes the batch, returns false if it should be tried again later
+  typedef std::function<bool(const IngestBatch& batch)> WriteCallback;
+
+  /**
+   * Constructor, starts the writer thread
+   *
+   * @param options: batching thresholds
+   * @param write:   called in the writer thread with each batch
+   * @param name:    prefix of the metrics of this writer, e.g., "publish"
+   */
+  IngestWriter(const Options& options, const WriteCallback& write, const std::string& name);
+
+  ~IngestWriter();
+
+  /**
+   * Buffer the insertion of a file name and its sha256, can be called from any thread
+   */
+  void
+  add(const std::string& name, const std::string& digest);
+
+  /**
+   * Buffer the deletion of a file name by its sha256, can be called from any thread
+   */
+  void
+  remove(const std::string& name, const std::string& digest);
+
+  /**
+   * Save a value with the operations buffered so far, in the same batch or a later one, can be
+   * called from any thread
+   */
+  void
+  setProgress(const std::string& key, uint64_t value);
+
+  /**
+   * @return true if the database does not keep up, and the producers should slow down
+   */
+  bool
+  isBacklogged() const;
+
+  /**
+   * Write what is buffered, then stop the thread; a batch that still cannot be written is lost
+   */
+  void
+  stop();
+
+private:
+  /**
+   * Must be called with m_mutex held
+   */
+  void
+  onBuffered();
+
+  void
+  run();
+
+private:
+  const Options m_options;
+  WriteCallback m_write;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cv;
+  // @{ need m_mutex protection
+  IngestBuffer m_buffer;
+  // time the oldest buffered operation came in
+  std::chrono::steady_clock::time_point m_firstBuffered;
+  // batch being written, or waiting to be tried again
+  IngestBatch m_batch;
+  bool m_isStopped;
+  // @}
+  std::thread m_thread;
+
+  Metric& m_pendingMetric;
+  Metric& m_batchesMetric;
+  Metric& m_rowsMetric;
+  Metric& m_failuresMetric;
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_INGEST_WRITER_HPP
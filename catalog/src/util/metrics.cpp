@@ -0,0 +1,61 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/metrics.hpp"
+
+namespace atmos {
+namespace util {
+
+void
+Metric::setMax(int64_t newValue)
+{
+  int64_t current = m_value.load(std::memory_order_relaxed);
+  while (newValue > current &&
+         !m_value.compare_exchange_weak(current, newValue, std::memory_order_relaxed)) {
+  }
+}
+
+Metric&
+MetricsRegistry::get(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::unique_ptr<Metric>& metric = m_metrics[name];
+  if (metric == nullptr) {
+    metric.reset(new Metric);
+  }
+  return *metric;
+}
+
+void
+MetricsRegistry::toJson(Json::Value& value) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto& item : m_metrics) {
+    value[item.first] = Json::Int64(item.second->get());
+  }
+}
+
+MetricsRegistry&
+MetricsRegistry::getDefault()
+{
+  static MetricsRegistry registry;
+  return registry;
+}
+
+} // namespace util
+} // namespace atmos
@@ -0,0 +1,106 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_METRICS_HPP
+#define ATMOS_UTIL_METRICS_HPP
+
+#include <json/value.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace atmos {
+namespace util {
+
+/**
+ * A named 64-bit value, used either as a counter (add) or as a gauge (set), that can be
+ * updated from any thread without locking
+ */
+class Metric : boost::noncopyable
+{
+public:
+  Metric()
+    : m_value(0)
+  {
+  }
+
+  void
+  add(int64_t delta = 1)
+  {
+    m_value.fetch_add(delta, std::memory_order_relaxed);
+  }
+
+  void
+  set(int64_t value)
+  {
+    m_value.store(value, std::memory_order_relaxed);
+  }
+
+  /**
+   * Raise the value to newValue if it is larger, e.g., to track a maximum
+   */
+  void
+  setMax(int64_t newValue);
+
+  int64_t
+  get() const
+  {
+    return m_value.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<int64_t> m_value;
+};
+
+/**
+ * MetricsRegistry holds the metrics of the catalog, e.g., "query.db.waiting", so they can be
+ * reported together. A metric is created on first use and lives as long as the registry, hence
+ * the reference returned by get() can be kept by the caller.
+ */
+class MetricsRegistry : boost::noncopyable
+{
+public:
+  Metric&
+  get(const std::string& name);
+
+  /**
+   * Write all metrics as {"<name>": <value>, ...}
+   */
+  void
+  toJson(Json::Value& value) const;
+
+  /**
+   * The registry shared by all the adapters of the process
+   */
+  static MetricsRegistry&
+  getDefault();
+
+private:
+  mutable std::mutex m_mutex;
+  std::map<std::string, std::unique_ptr<Metric>> m_metrics;
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_METRICS_HPP
@@ -0,0 +1,117 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_MPSC_QUEUE_HPP
+#define ATMOS_UTIL_MPSC_QUEUE_HPP
+
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+#include <utility>
+
+namespace atmos {
+namespace util {
+
+/**
+ * Unbounded lock-free multi-producer single-consumer queue (Vyukov's algorithm)
+ *
+ * push() may be called from any thread; pop() and isEmpty() must only be called from the
+ * single consumer thread. A push is wait-free (one atomic exchange); a push in progress may
+ * not be visible to pop() yet while isEmpty() already returns false.
+ */
+template <typename T>
+class MpscQueue : boost::noncopyable
+{
+public:
+  MpscQueue()
+    : m_head(new Node)
+  {
+    m_tail = m_head.load(std::memory_order_relaxed);
+  }
+
+  ~MpscQueue()
+  {
+    T value;
+    while (pop(value)) {
+    }
+    delete m_tail;
+  }
+
+  void
+  push(T value)
+  {
+    Node* node = new Node(std::move(value));
+    Node* prev = m_head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  /**
+   * @return false if no element is available
+   */
+  bool
+  pop(T& value)
+  {
+    Node* tail = m_tail;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return false;
+    }
+
+    // next becomes the new stub node
+    value = std::move(next->value);
+    next->value = T();
+    m_tail = next;
+    delete tail;
+    return true;
+  }
+
+  bool
+  isEmpty() const
+  {
+    return m_head.load(std::memory_order_acquire) == m_tail;
+  }
+
+private:
+  struct Node
+  {
+    Node()
+      : next(nullptr)
+    {
+    }
+
+    explicit
+    Node(T&& valueInput)
+      : value(std::move(valueInput))
+      , next(nullptr)
+    {
+    }
+
+    T value;
+    std::atomic<Node*> next;
+  };
+
+  // producers side
+  std::atomic<Node*> m_head;
+  // consumer side
+  Node* m_tail;
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_MPSC_QUEUE_HPP
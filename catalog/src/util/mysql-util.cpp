@@ -26,7 +26,11 @@ namespace util {
 
 ConnectionDetails::ConnectionDetails(const std::string& serverInput, const std::string& userInput,
                                      const std::string& passwordInput, const std::string& databaseInput)
-  : server(serverInput), user(userInput), password(passwordInput), database(databaseInput)
+  : server(serverInput), port(DB_DEFAULT_PORT)
+  , user(userInput), password(passwordInput), database(databaseInput)
+  , maxConnections(MAX_DB_CONNECTIONS)
+  , maxWaiting(MAX_DB_CONNECTIONS)
+  , acquireTimeout(DB_ACQUIRE_TIMEOUT_MS)
 {
   // empty
 }
@@ -40,18 +44,43 @@ zdbConnectionSetup(const ConnectionDetails& details)
   dbConnStr += details.password;
   dbConnStr += "@";
   dbConnStr += details.server;
-  dbConnStr += ":3306/";
+  dbConnStr += ":";
+  dbConnStr += std::to_string(details.port);
+  dbConnStr += "/";
   dbConnStr += details.database;
 
   URL_T url = URL_new(dbConnStr.c_str());
 
   ConnectionPool_T dbConnPool = ConnectionPool_new(url);
-  ConnectionPool_setMaxConnections(dbConnPool, MAX_DB_CONNECTIONS);
+  ConnectionPool_setMaxConnections(dbConnPool, details.maxConnections);
   ConnectionPool_setReaper(dbConnPool, 1);
   ConnectionPool_start(dbConnPool);
   auto sharedPool = std::make_shared<ConnectionPool_T>(dbConnPool);
   return sharedPool;
 }
 
+void
+zdbExecuteBulk(Connection_T conn, const BulkStatement& statement)
+{
+  const std::vector<ValueRef>& values = statement.getValues();
+  size_t nColumns = statement.getNColumns();
+
+  // a statement is prepared once for each chunk size, the chunks come largest first
+  PreparedStatement_T ps = NULL;
+  size_t psRows = 0;
+  size_t value = 0;
+  for (size_t nRows : statement.getChunks()) {
+    if (nRows != psRows) {
+      ps = Connection_prepareStatement(conn, "%s", statement.getSql(nRows).c_str());
+      psRows = nRows;
+    }
+    // bound as binary by pointer and length, MySQL converts them to the column character set
+    for (size_t i = 1; i <= nRows * nColumns; ++i, ++value) {
+      PreparedStatement_setBlob(ps, i, values[value].data, values[value].size);
+    }
+    PreparedStatement_execute(ps);
+  }
+}
+
 } // namespace util
 } // namespace atmos
@@ -19,7 +19,10 @@
 #ifndef ATMOS_UTIL_CONNECTION_DETAILS_HPP
 #define ATMOS_UTIL_CONNECTION_DETAILS_HPP
 
+#include "util/bulk-statement.hpp"
+
 #include "mysql/mysql.h"
+#include <chrono>
 #include <memory>
 #include <string>
 #include <zdb/zdb.h>
@@ -28,14 +31,24 @@ namespace atmos {
 namespace util {
 
 #define MAX_DB_CONNECTIONS 100
+#define DB_ACQUIRE_TIMEOUT_MS 1000
+#define DB_DEFAULT_PORT 3306
 
 enum DatabaseOperation {CREATE, UPDATE, ADD, REMOVE, QUERY};
 struct ConnectionDetails {
 public:
   std::string server;
+  unsigned int port;
   std::string user;
   std::string password;
   std::string database;
+  // connections to the database, i.e., maximum number of statements running at the same time
+  size_t maxConnections;
+  // maximum number of threads waiting for a connection, and how long each of them waits
+  size_t maxWaiting;
+  std::chrono::milliseconds acquireTimeout;
+  // file of the embedded database, used by SqliteDatabase instead of the server
+  std::string file;
 
   ConnectionDetails(const std::string& serverInput, const std::string& userInput,
                     const std::string& passwordInput, const std::string& databaseInput);
@@ -44,6 +57,14 @@ public:
 std::shared_ptr<ConnectionPool_T>
 zdbConnectionSetup(const ConnectionDetails& details);
 
+/**
+ * Run the chunks of a BulkStatement as prepared statements on a libzdb connection
+ *
+ * @throw SQLException if a chunk fails, through the libzdb exception handling (TRY/CATCH)
+ */
+void
+zdbExecuteBulk(Connection_T conn, const BulkStatement& statement);
+
 } // namespace util
 } // namespace atmos
 #endif //ATMOS_UTIL_CONNECTION_DETAILS_HPP
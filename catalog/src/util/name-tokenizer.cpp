@@ -0,0 +1,94 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/name-tokenizer.hpp"
+
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace atmos {
+namespace util {
+
+const char*
+findSlash(const char* begin, const char* end)
+{
+#ifdef __SSE2__
+  const __m128i slashes = _mm_set1_epi8('/');
+  for (; end - begin >= 16; begin += 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, slashes));
+    if (mask != 0) {
+      return begin + __builtin_ctz(mask);
+    }
+  }
+#endif
+  // the rest is shorter than a vector
+  const void* slash = std::memchr(begin, '/', end - begin);
+  return slash == nullptr ? end : static_cast<const char*>(slash);
+}
+
+bool
+tokenizeName(const ValueRef& name, size_t maxComponents, std::vector<ValueRef>& components,
+             bool allowScheme)
+{
+  const char* position = name.data;
+  const char* end = name.data + name.size;
+  if (allowScheme && name.size >= 5 && std::memcmp(position, "ndn:/", 5) == 0) {
+    position += 5;
+  }
+  else if (name.size >= 1 && *position == '/') {
+    position += 1;
+  }
+  else {
+    return false;
+  }
+
+  const size_t first = components.size();
+  while (true) {
+    if (components.size() - first >= maxComponents) {
+      components.resize(first);
+      return false;
+    }
+    const char* slash = findSlash(position, end);
+    components.push_back(ValueRef{position, static_cast<size_t>(slash - position)});
+    if (slash == end) {
+      return true;
+    }
+    position = slash + 1;
+  }
+}
+
+bool
+splitName(const ValueRef& name, size_t nFields, std::vector<ValueRef>& fields)
+{
+  const size_t first = fields.size();
+  if (!tokenizeName(name, nFields, fields)) {
+    return false;
+  }
+  if (fields.size() - first != nFields) {
+    fields.resize(first);
+    return false;
+  }
+  return true;
+}
+
+} // namespace util
+} // namespace atmos
@@ -0,0 +1,69 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_NAME_TOKENIZER_HPP
+#define ATMOS_UTIL_NAME_TOKENIZER_HPP
+
+#include "util/bulk-statement.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace atmos {
+namespace util {
+
+/**
+ * Find the first '/' in [begin, end), 16 characters at a time where SSE2 is available
+ *
+ * @return the '/', or end if there is none
+ */
+const char*
+findSlash(const char* begin, const char* end);
+
+/**
+ * Split a name into the components between its slashes, in a single pass and without copies
+ *
+ * The name must start with "/", or with "ndn:/" if allowScheme. The text after the last '/' is
+ * the last component, which is empty if the name ends with '/'.
+ *
+ * @param name:          the name, e.g., a file name or the string typed in a query
+ * @param maxComponents: the split fails as soon as the name has more components
+ * @param components:    vector the components are appended to, they point into name
+ * @param allowScheme:   accept names that start with "ndn:/"
+ * @return false if the name does not start with the prefix or has too many components, the
+ *         components of the name are not appended then
+ */
+bool
+tokenizeName(const ValueRef& name, size_t maxComponents, std::vector<ValueRef>& components,
+             bool allowScheme = true);
+
+/**
+ * Split a file name into the values of the name fields, which fails unless the name has one
+ * component per name field
+ *
+ * @param name:    the file name, which starts with "/" or "ndn:/"
+ * @param nFields: the number of name fields
+ * @param fields:  vector the values are appended to, they point into name
+ */
+bool
+splitName(const ValueRef& name, size_t nFields, std::vector<ValueRef>& fields);
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_NAME_TOKENIZER_HPP
@@ -0,0 +1,86 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/outbound-data-queue.hpp"
+#include "util/logger.hpp"
+
+#include <iostream>
+
+namespace atmos {
+namespace util {
+#ifdef HAVE_LOG4CXX
+  INIT_LOGGER("OutboundDataQueue");
+#endif
+
+// yield to other io_service handlers (incoming Interests) after this many packets
+static const size_t BATCH_SIZE = 64;
+
+OutboundDataQueue::OutboundDataQueue(ndn::Face& face)
+  : m_face(face)
+  , m_isDrainScheduled(false)
+  , m_self(this, [] (OutboundDataQueue*) {})
+{
+}
+
+void
+OutboundDataQueue::push(const std::shared_ptr<const ndn::Data>& data)
+{
+  m_queue.push(data);
+  scheduleDrain();
+}
+
+void
+OutboundDataQueue::scheduleDrain()
+{
+  if (!m_isDrainScheduled.exchange(true)) {
+    std::weak_ptr<OutboundDataQueue> self = m_self;
+    m_face.getIoService().post([self] {
+        std::shared_ptr<OutboundDataQueue> queue = self.lock();
+        if (queue != nullptr) {
+          queue->drain();
+        }
+      });
+  }
+}
+
+void
+OutboundDataQueue::drain()
+{
+  // clear the flag first, so that a push racing with this drain schedules another one
+  m_isDrainScheduled.store(false);
+
+  std::shared_ptr<const ndn::Data> data;
+  size_t nPut = 0;
+  for (; nPut < BATCH_SIZE && m_queue.pop(data); ++nPut) {
+    try {
+      m_face.put(*data);
+    }
+    catch (const std::exception& e) {
+      _LOG_ERROR(e.what());
+    }
+  }
+
+  // more than one batch was queued. A producer half-way through its push is not waited for:
+  // it schedules a drain itself once its Data is linked, as the flag is cleared by then
+  if (nPut == BATCH_SIZE) {
+    scheduleDrain();
+  }
+}
+
+} // namespace util
+} // namespace atmos
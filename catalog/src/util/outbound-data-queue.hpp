@@ -0,0 +1,75 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_OUTBOUND_DATA_QUEUE_HPP
+#define ATMOS_UTIL_OUTBOUND_DATA_QUEUE_HPP
+
+#include "util/mpsc-queue.hpp"
+
+#include <ndn-cxx/data.hpp>
+#include <ndn-cxx/face.hpp>
+
+#include <atomic>
+#include <memory>
+
+namespace atmos {
+namespace util {
+
+/**
+ * OutboundDataQueue hands Data packets produced by worker threads over to the Face.
+ *
+ * ndn::Face is not thread-safe, so workers never call Face::put themselves: they push the
+ * signed Data into a lock-free queue, and the queue is drained in batches by a handler posted
+ * to the Face's io_service, i.e., on the thread that runs Face::processEvents. The queue must be
+ * destroyed on that thread; a drain posted before is then skipped.
+ */
+class OutboundDataQueue : boost::noncopyable
+{
+public:
+  explicit
+  OutboundDataQueue(ndn::Face& face);
+
+  /**
+   * Queue the data for sending, can be called from any thread
+   */
+  void
+  push(const std::shared_ptr<const ndn::Data>& data);
+
+private:
+  /**
+   * Put up to BATCH_SIZE queued Data packets to the Face, runs in the io_service thread
+   */
+  void
+  drain();
+
+  void
+  scheduleDrain();
+
+private:
+  ndn::Face& m_face;
+  MpscQueue<std::shared_ptr<const ndn::Data>> m_queue;
+  // true when a drain() is already posted to the io_service
+  std::atomic<bool> m_isDrainScheduled;
+  // the posted drains only hold a weak_ptr to the queue, it does not own it
+  std::shared_ptr<OutboundDataQueue> m_self;
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_OUTBOUND_DATA_QUEUE_HPP
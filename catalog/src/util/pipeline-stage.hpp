@@ -0,0 +1,182 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_PIPELINE_STAGE_HPP
+#define ATMOS_UTIL_PIPELINE_STAGE_HPP
+
+#include "util/bounded-queue.hpp"
+#include "util/metrics.hpp"
+
+#include <boost/noncopyable.hpp>
+
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace atmos {
+namespace util {
+
+/**
+ * Log the error of a PipelineStage handler, out of line so that the header does not set up
+ * a logger of its own in the files that include it
+ */
+void
+logHandlerError(const std::string& stageName, const std::string& what);
+
+/**
+ * PipelineStage runs one step of a pipeline on its own threads. The items come in through a
+ * BoundedQueue, so a stage that falls behind makes the previous one wait instead of buffering
+ * without limit; the handler hands its result over to the next stage, if any.
+ *
+ * The stage reports "<name>.queued" (the queue depth), "<name>.processed" (the items handled,
+ * i.e., the throughput), "<name>.errors" (the items whose handler threw, which are dropped)
+ * and "<name>.timeUs" (the time spent in the handler) to the default MetricsRegistry.
+ */
+template <typename T>
+class PipelineStage : boost::noncopyable
+{
+public:
+  typedef std::function<void(T& item)> Handler;
+
+  /**
+   * Constructor, starts the threads
+   *
+   * @param name:     prefix of the metrics of this stage, e.g., "publish.stage.parse"
+   * @param capacity: maximum number of items waiting for the stage
+   * @param nThreads: number of threads running the handler
+   * @param handler:  called with each item, in one of the stage threads
+   */
+  PipelineStage(const std::string& name, size_t capacity, size_t nThreads,
+                const Handler& handler)
+    : m_name(name)
+    , m_queue(capacity)
+    , m_handler(handler)
+    , m_queuedMetric(MetricsRegistry::getDefault().get(name + ".queued"))
+    , m_processedMetric(MetricsRegistry::getDefault().get(name + ".processed"))
+    , m_errorsMetric(MetricsRegistry::getDefault().get(name + ".errors"))
+    , m_timeMetric(MetricsRegistry::getDefault().get(name + ".timeUs"))
+  {
+    for (size_t i = 0; i < nThreads; ++i) {
+      m_threads.push_back(std::thread(&PipelineStage::run, this));
+    }
+  }
+
+  ~PipelineStage()
+  {
+    stop();
+  }
+
+  /**
+   * Queue an item, waiting while the stage is full, can be called from any thread
+   *
+   * @return false if the stage is stopped, the item is dropped
+   */
+  bool
+  push(T item)
+  {
+    if (!m_queue.push(std::move(item))) {
+      return false;
+    }
+    m_queuedMetric.set(m_queue.size());
+    return true;
+  }
+
+  /**
+   * Queue an item only if the stage has room for it right away, for the producers that must
+   * not wait
+   *
+   * @return false if the stage is full or stopped, the item is left as it is
+   */
+  bool
+  tryPush(T& item)
+  {
+    if (!m_queue.tryPush(item)) {
+      return false;
+    }
+    m_queuedMetric.set(m_queue.size());
+    return true;
+  }
+
+  /**
+   * @return true if the queue is half full, and the producers should slow down
+   */
+  bool
+  isBacklogged() const
+  {
+    return m_queue.size() * 2 >= m_queue.getCapacity();
+  }
+
+  /**
+   * Handle the queued items, then stop the threads
+   */
+  void
+  stop()
+  {
+    m_queue.close();
+    for (auto& thread : m_threads) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+  }
+
+private:
+  void
+  run()
+  {
+    T item;
+    while (m_queue.pop(item)) {
+      m_queuedMetric.set(m_queue.size());
+
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      // an item the handler cannot take must not stop the thread, which the stage needs for
+      // the items after it
+      try {
+        m_handler(item);
+        m_processedMetric.add();
+      }
+      catch (const std::exception& e) {
+        logHandlerError(m_name, e.what());
+        m_errorsMetric.add();
+      }
+      m_timeMetric.add(std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::steady_clock::now() - start).count());
+      item = T();
+    }
+  }
+
+private:
+  const std::string m_name;
+  BoundedQueue<T> m_queue;
+  Handler m_handler;
+  std::vector<std::thread> m_threads;
+
+  Metric& m_queuedMetric;
+  Metric& m_processedMetric;
+  Metric& m_errorsMetric;
+  Metric& m_timeMetric;
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_PIPELINE_STAGE_HPP
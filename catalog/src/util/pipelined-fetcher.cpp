@@ -0,0 +1,262 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/pipelined-fetcher.hpp"
+#include "util/logger.hpp"
+
+#include <functional>
+#include <iostream>
+
+namespace atmos {
+namespace util {
+#ifdef HAVE_LOG4CXX
+  INIT_LOGGER("PipelinedFetcher");
+#endif
+
+PipelinedFetcher::Options::Options()
+  : initialWindow(1)
+  , maxWindow(64)
+  , maxRetries(3)
+  , interestLifetime(4000)
+  , mustBeFresh(true)
+  , pauseInterval(200)
+{
+}
+
+std::shared_ptr<PipelinedFetcher>
+PipelinedFetcher::fetch(ndn::Face& face,
+                        ndn::util::scheduler::Scheduler& scheduler,
+                        const ndn::Name& prefix,
+                        const Options& options,
+                        const SegmentCallback& onSegment,
+                        const CompleteCallback& onComplete,
+                        const ErrorCallback& onError,
+                        const PauseCallback& shouldPause)
+{
+  std::shared_ptr<PipelinedFetcher> fetcher(
+    new PipelinedFetcher(face, scheduler, prefix, options,
+                         onSegment, onComplete, onError, shouldPause));
+  fetcher->fillWindow();
+  return fetcher;
+}
+
+PipelinedFetcher::PipelinedFetcher(ndn::Face& face,
+                                   ndn::util::scheduler::Scheduler& scheduler,
+                                   const ndn::Name& prefix,
+                                   const Options& options,
+                                   const SegmentCallback& onSegment,
+                                   const CompleteCallback& onComplete,
+                                   const ErrorCallback& onError,
+                                   const PauseCallback& shouldPause)
+  : m_face(face)
+  , m_scheduler(scheduler)
+  , m_prefix(prefix)
+  , m_options(options)
+  , m_onSegment(onSegment)
+  , m_onComplete(onComplete)
+  , m_onError(onError)
+  , m_shouldPause(shouldPause)
+  , m_window(options.initialWindow, options.maxWindow)
+  , m_nextSegment(0)
+  , m_nextToDeliver(0)
+  , m_hasFinalBlock(false)
+  , m_finalBlock(0)
+  , m_nRetransmissions(0)
+  , m_isPaused(false)
+  , m_isStopped(false)
+{
+}
+
+void
+PipelinedFetcher::stop()
+{
+  if (m_isStopped) {
+    return;
+  }
+  m_isStopped = true;
+
+  for (const auto& item : m_inFlight) {
+    m_face.removePendingInterest(item.second);
+  }
+  m_inFlight.clear();
+  m_retxQueue.clear();
+  m_reorderBuffer.clear();
+  if (m_isPaused) {
+    m_scheduler.cancelEvent(m_resumeEvent);
+    m_isPaused = false;
+  }
+}
+
+void
+PipelinedFetcher::fillWindow()
+{
+  while (!m_isStopped && !m_isPaused && m_inFlight.size() < m_window.getSize()) {
+    if (!m_retxQueue.empty()) {
+      uint64_t segment = *m_retxQueue.begin();
+      m_retxQueue.erase(m_retxQueue.begin());
+      ++m_nRetransmissions;
+      sendInterest(segment);
+      continue;
+    }
+
+    if (m_hasFinalBlock && m_nextSegment > m_finalBlock) {
+      return;
+    }
+    if (m_shouldPause && m_shouldPause()) {
+      // the consumer cannot keep up, the Interests in flight are still received
+      m_isPaused = true;
+      m_resumeEvent = m_scheduler.scheduleEvent(m_options.pauseInterval,
+                                                std::bind(&PipelinedFetcher::onResume,
+                                                          shared_from_this()));
+      return;
+    }
+    sendInterest(m_nextSegment++);
+  }
+}
+
+void
+PipelinedFetcher::onResume()
+{
+  m_isPaused = false;
+  fillWindow();
+}
+
+void
+PipelinedFetcher::sendInterest(uint64_t segment)
+{
+  ndn::Interest interest(ndn::Name(m_prefix).appendSegment(segment));
+  interest.setInterestLifetime(m_options.interestLifetime);
+  interest.setMustBeFresh(m_options.mustBeFresh);
+
+  m_inFlight[segment] =
+    m_face.expressInterest(interest,
+                           std::bind(&PipelinedFetcher::onData, shared_from_this(),
+                                     std::placeholders::_1, std::placeholders::_2),
+                           std::bind(&PipelinedFetcher::onTimeout, shared_from_this(),
+                                     std::placeholders::_1));
+
+  _LOG_DEBUG("Expressing Interest " << interest.getName()
+             << " window " << m_window.getSize() << " in flight " << m_inFlight.size());
+}
+
+void
+PipelinedFetcher::onData(const ndn::Interest& interest, const ndn::Data& data)
+{
+  // the Face may release the last reference to this fetcher while it runs
+  std::shared_ptr<PipelinedFetcher> self = shared_from_this();
+  if (m_isStopped) {
+    return;
+  }
+
+  const ndn::name::Component& lastComponent = data.getName()[-1];
+  if (!lastComponent.isSegment()) {
+    fail("Data " + data.getName().toUri() + " is not a segment");
+    return;
+  }
+  uint64_t segment = lastComponent.toSegment();
+
+  auto it = m_inFlight.find(segment);
+  if (it == m_inFlight.end()) {
+    // a late answer to an Interest that was retransmitted or cancelled
+    return;
+  }
+  m_inFlight.erase(it);
+  m_window.onData();
+
+  const ndn::name::Component& finalBlockId = data.getMetaInfo().getFinalBlockId();
+  if (!m_hasFinalBlock && finalBlockId.isSegment()) {
+    m_hasFinalBlock = true;
+    m_finalBlock = finalBlockId.toSegment();
+    cancelPastFinalBlock();
+  }
+
+  if (!m_hasFinalBlock || segment <= m_finalBlock) {
+    m_reorderBuffer[segment] = std::make_shared<ndn::Data>(data);
+  }
+  deliver();
+  fillWindow();
+}
+
+void
+PipelinedFetcher::onTimeout(const ndn::Interest& interest)
+{
+  std::shared_ptr<PipelinedFetcher> self = shared_from_this();
+  if (m_isStopped) {
+    return;
+  }
+
+  uint64_t segment = interest.getName()[-1].toSegment();
+  if (m_inFlight.erase(segment) == 0) {
+    return;
+  }
+
+  if (++m_nRetries[segment] > m_options.maxRetries) {
+    fail("Segment " + interest.getName().toUri() + " timed out");
+    return;
+  }
+
+  if (m_window.onTimeout(segment, m_nextSegment - 1)) {
+    _LOG_DEBUG(interest.getName() << " timed out, window decreased to " << m_window.getSize());
+  }
+  m_retxQueue.insert(segment);
+  fillWindow();
+}
+
+void
+PipelinedFetcher::deliver()
+{
+  auto it = m_reorderBuffer.begin();
+  while (it != m_reorderBuffer.end() && it->first == m_nextToDeliver) {
+    std::shared_ptr<const ndn::Data> data = it->second;
+    m_reorderBuffer.erase(it);
+    ++m_nextToDeliver;
+
+    m_onSegment(*data);
+    if (m_isStopped) {
+      return;
+    }
+    it = m_reorderBuffer.begin();
+  }
+
+  if (m_hasFinalBlock && m_nextToDeliver > m_finalBlock) {
+    stop();
+    m_onComplete();
+  }
+}
+
+void
+PipelinedFetcher::cancelPastFinalBlock()
+{
+  auto it = m_inFlight.upper_bound(m_finalBlock);
+  while (it != m_inFlight.end()) {
+    m_face.removePendingInterest(it->second);
+    it = m_inFlight.erase(it);
+  }
+  m_retxQueue.erase(m_retxQueue.upper_bound(m_finalBlock), m_retxQueue.end());
+}
+
+void
+PipelinedFetcher::fail(const std::string& reason)
+{
+  _LOG_ERROR(reason);
+  stop();
+  m_onError(reason);
+}
+
+} // namespace util
+} // namespace atmos
@@ -0,0 +1,207 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_PIPELINED_FETCHER_HPP
+#define ATMOS_UTIL_PIPELINED_FETCHER_HPP
+
+#include "util/congestion-window.hpp"
+
+#include <ndn-cxx/data.hpp>
+#include <ndn-cxx/face.hpp>
+#include <ndn-cxx/interest.hpp>
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/util/scheduler.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+
+namespace atmos {
+namespace util {
+
+/**
+ * PipelinedFetcher fetches all segments of a segmented object, e.g., a publication's file list,
+ * keeping up to a CongestionWindow of Interests in flight.
+ *
+ * A segment that times out is requested again, up to maxRetries times. Segments may arrive out
+ * of order; they are buffered and handed to onSegment in segment order, so the consumer sees
+ * the same sequence as with a stop-and-wait fetch, while the next segments are already on
+ * their way. The fetch ends with the segment named by the FinalBlockId.
+ *
+ * The fetcher keeps itself alive until it completes, fails or is stopped. All callbacks run in
+ * the Face's thread.
+ */
+class PipelinedFetcher : public std::enable_shared_from_this<PipelinedFetcher>,
+                         boost::noncopyable
+{
+public:
+  struct Options
+  {
+    Options();
+
+    size_t initialWindow;
+    size_t maxWindow;
+    // number of times a segment is requested again before the fetch fails
+    size_t maxRetries;
+    ndn::time::milliseconds interestLifetime;
+    bool mustBeFresh;
+    // delay before asking shouldPause again
+    ndn::time::milliseconds pauseInterval;
+  };
+
+  // called with each segment, in order
+  typedef std::function<void(const ndn::Data& data)> SegmentCallback;
+  typedef std::function<void()> CompleteCallback;
+  typedef std::function<void(const std::string& reason)> ErrorCallback;
+  // returns true while the consumer cannot keep up, no new segment is requested meanwhile
+  typedef std::function<bool()> PauseCallback;
+
+  /**
+   * Start fetching the segments of an object
+   *
+   * @param face:        Face to express the Interests with
+   * @param scheduler:   scheduler of the Face's io_service, must outlive the fetch
+   * @param prefix:      name of the object, without the segment number
+   * @param options:     window and retransmission settings
+   * @param onSegment:   called with each segment, in order
+   * @param onComplete:  called after the final segment is handed over
+   * @param onError:     called if a segment cannot be fetched, or the Data is not a segment
+   * @param shouldPause: optional backpressure from the consumer
+   */
+  static std::shared_ptr<PipelinedFetcher>
+  fetch(ndn::Face& face,
+        ndn::util::scheduler::Scheduler& scheduler,
+        const ndn::Name& prefix,
+        const Options& options,
+        const SegmentCallback& onSegment,
+        const CompleteCallback& onComplete,
+        const ErrorCallback& onError,
+        const PauseCallback& shouldPause = PauseCallback());
+
+  /**
+   * Cancel the pending Interests, no callback is invoked afterwards
+   */
+  void
+  stop();
+
+  size_t
+  getWindowSize() const
+  {
+    return m_window.getSize();
+  }
+
+  size_t
+  getNInFlight() const
+  {
+    return m_inFlight.size();
+  }
+
+  /**
+   * @return the number of segments handed to onSegment so far
+   */
+  uint64_t
+  getNDelivered() const
+  {
+    return m_nextToDeliver;
+  }
+
+  uint64_t
+  getNRetransmissions() const
+  {
+    return m_nRetransmissions;
+  }
+
+private:
+  PipelinedFetcher(ndn::Face& face,
+                   ndn::util::scheduler::Scheduler& scheduler,
+                   const ndn::Name& prefix,
+                   const Options& options,
+                   const SegmentCallback& onSegment,
+                   const CompleteCallback& onComplete,
+                   const ErrorCallback& onError,
+                   const PauseCallback& shouldPause);
+
+  /**
+   * Express Interests until the window is full, retransmissions first
+   */
+  void
+  fillWindow();
+
+  void
+  onResume();
+
+  void
+  sendInterest(uint64_t segment);
+
+  void
+  onData(const ndn::Interest& interest, const ndn::Data& data);
+
+  void
+  onTimeout(const ndn::Interest& interest);
+
+  /**
+   * Hand the buffered segments that are next in order to the consumer
+   */
+  void
+  deliver();
+
+  /**
+   * Forget the segments past the final one, requested before the FinalBlockId was known
+   */
+  void
+  cancelPastFinalBlock();
+
+  void
+  fail(const std::string& reason);
+
+private:
+  ndn::Face& m_face;
+  ndn::util::scheduler::Scheduler& m_scheduler;
+  const ndn::Name m_prefix;
+  const Options m_options;
+  SegmentCallback m_onSegment;
+  CompleteCallback m_onComplete;
+  ErrorCallback m_onError;
+  PauseCallback m_shouldPause;
+
+  CongestionWindow m_window;
+  // segment -> its pending Interest
+  std::map<uint64_t, const ndn::PendingInterestId*> m_inFlight;
+  std::map<uint64_t, size_t> m_nRetries;
+  // segments that timed out, waiting for room in the window
+  std::set<uint64_t> m_retxQueue;
+  // segments received ahead of the next one to deliver
+  std::map<uint64_t, std::shared_ptr<const ndn::Data>> m_reorderBuffer;
+  uint64_t m_nextSegment;
+  uint64_t m_nextToDeliver;
+  bool m_hasFinalBlock;
+  uint64_t m_finalBlock;
+  uint64_t m_nRetransmissions;
+  ndn::util::scheduler::EventId m_resumeEvent;
+  bool m_isPaused;
+  bool m_isStopped;
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_PIPELINED_FETCHER_HPP
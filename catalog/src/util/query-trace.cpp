@@ -0,0 +1,163 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/query-trace.hpp"
+
+#include <ndn-cxx/encoding/block-helpers.hpp>
+#include <ndn-cxx/encoding/encoding-buffer.hpp>
+#include <ndn-cxx/util/time.hpp>
+
+namespace atmos {
+namespace util {
+
+// flush the trace file after this many records, so that a killed catalog loses little
+static const size_t TRACE_FLUSH_INTERVAL = 64;
+
+QueryTraceRecord::QueryTraceRecord()
+  : timestamp(0)
+  , hasSegmentNo(false)
+  , segmentNo(0)
+{
+}
+
+QueryTraceRecord::QueryTraceRecord(uint64_t timestampInput, const ndn::Name& queryInput)
+  : timestamp(timestampInput)
+  , query(queryInput)
+  , hasSegmentNo(false)
+  , segmentNo(0)
+{
+}
+
+QueryTraceRecord::QueryTraceRecord(uint64_t timestampInput, const ndn::Name& queryInput,
+                                   uint64_t segmentNoInput)
+  : timestamp(timestampInput)
+  , query(queryInput)
+  , hasSegmentNo(true)
+  , segmentNo(segmentNoInput)
+{
+}
+
+QueryTraceRecord::QueryTraceRecord(const ndn::Block& block)
+{
+  wireDecode(block);
+}
+
+ndn::Block
+QueryTraceRecord::wireEncode() const
+{
+  // TLV elements are prepended, so encode them in the reverse order
+  ndn::EncodingBuffer encoder;
+  size_t totalLength = 0;
+
+  if (hasSegmentNo) {
+    totalLength += ndn::prependNonNegativeIntegerBlock(encoder, tlv::TraceSegmentNo, segmentNo);
+  }
+  totalLength += query.wireEncode(encoder);
+  totalLength += ndn::prependNonNegativeIntegerBlock(encoder, tlv::TraceTimestamp, timestamp);
+
+  totalLength += encoder.prependVarNumber(totalLength);
+  totalLength += encoder.prependVarNumber(tlv::TraceRecord);
+
+  return encoder.block();
+}
+
+void
+QueryTraceRecord::wireDecode(const ndn::Block& block)
+{
+  if (block.type() != tlv::TraceRecord) {
+    throw ndn::tlv::Error("Unexpected TLV type when decoding QueryTraceRecord");
+  }
+  block.parse();
+
+  timestamp = ndn::readNonNegativeInteger(block.get(tlv::TraceTimestamp));
+  query.wireDecode(block.get(ndn::tlv::Name));
+
+  ndn::Block::element_const_iterator it = block.find(tlv::TraceSegmentNo);
+  hasSegmentNo = (it != block.elements_end());
+  segmentNo = hasSegmentNo ? ndn::readNonNegativeInteger(*it) : 0;
+}
+
+QueryTraceWriter::QueryTraceWriter(const std::string& fileName)
+  : m_os(fileName.c_str(), std::ofstream::binary | std::ofstream::app)
+  , m_nUnflushed(0)
+{
+  if (!m_os.is_open()) {
+    throw Error("Cannot open query trace file " + fileName);
+  }
+}
+
+QueryTraceWriter::~QueryTraceWriter()
+{
+  m_os.flush();
+}
+
+void
+QueryTraceWriter::record(const ndn::Name& interestName, size_t queryLength)
+{
+  uint64_t now = ndn::time::duration_cast<ndn::time::microseconds>(
+                   ndn::time::system_clock::now().time_since_epoch()).count();
+
+  // e.g., /<catalog-prefix>/query/<json-query>/<version>/<segment>
+  if (interestName.size() > queryLength + 1 && interestName[-1].isSegment()) {
+    record(QueryTraceRecord(now, interestName.getPrefix(queryLength),
+                            interestName[-1].toSegment()));
+  }
+  else {
+    record(QueryTraceRecord(now, interestName.getPrefix(queryLength)));
+  }
+}
+
+void
+QueryTraceWriter::record(const QueryTraceRecord& record)
+{
+  ndn::Block block = record.wireEncode();
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_os.write(reinterpret_cast<const char*>(block.wire()), block.size());
+  if (++m_nUnflushed >= TRACE_FLUSH_INTERVAL) {
+    m_os.flush();
+    m_nUnflushed = 0;
+  }
+}
+
+QueryTraceReader::QueryTraceReader(const std::string& fileName)
+  : m_is(fileName.c_str(), std::ifstream::binary)
+{
+  if (!m_is.is_open()) {
+    throw Error("Cannot open query trace file " + fileName);
+  }
+}
+
+bool
+QueryTraceReader::next(QueryTraceRecord& record)
+{
+  if (m_is.peek() == std::char_traits<char>::eof()) {
+    return false;
+  }
+
+  try {
+    record.wireDecode(ndn::Block::fromStream(m_is));
+  }
+  catch (const ndn::tlv::Error& e) {
+    throw Error(std::string("Malformed query trace: ") + e.what());
+  }
+  return true;
+}
+
+} // namespace util
+} // namespace atmos
@@ -0,0 +1,164 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_QUERY_TRACE_HPP
+#define ATMOS_UTIL_QUERY_TRACE_HPP
+
+#include <ndn-cxx/encoding/block.hpp>
+#include <ndn-cxx/name.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace atmos {
+namespace util {
+
+/**
+ * TLV types used in the query trace file. They are taken from the application-specific range
+ */
+namespace tlv {
+enum {
+  TraceRecord = 200,
+  TraceTimestamp = 201,
+  TraceSegmentNo = 202
+};
+} // namespace tlv
+
+/**
+ * One entry of the query trace, i.e., one query Interest received by the catalog
+ *
+ * TraceRecord ::= TRACE-RECORD-TYPE TLV-LENGTH
+ *                   TraceTimestamp   (microseconds since the Unix epoch)
+ *                   Name             (canonical query, /<catalog-prefix>/query/<json-query>)
+ *                   TraceSegmentNo?  (present when the Interest asked for a specific segment)
+ */
+struct QueryTraceRecord
+{
+public:
+  QueryTraceRecord();
+
+  QueryTraceRecord(uint64_t timestampInput, const ndn::Name& queryInput);
+
+  QueryTraceRecord(uint64_t timestampInput, const ndn::Name& queryInput, uint64_t segmentNoInput);
+
+  explicit
+  QueryTraceRecord(const ndn::Block& block);
+
+  ndn::Block
+  wireEncode() const;
+
+  void
+  wireDecode(const ndn::Block& block);
+
+public:
+  uint64_t timestamp;
+  ndn::Name query;
+  bool hasSegmentNo;
+  uint64_t segmentNo;
+};
+
+/**
+ * QueryTraceWriter appends QueryTraceRecords to a trace file. It can be called from any thread
+ */
+class QueryTraceWriter : boost::noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  /**
+   * Constructor
+   *
+   * @param fileName: trace file, new records are appended if the file already exists
+   * @throws Error if the file cannot be opened
+   */
+  explicit
+  QueryTraceWriter(const std::string& fileName);
+
+  ~QueryTraceWriter();
+
+  /**
+   * Helper function that records a query Interest with the current time
+   *
+   * @param interestName:  name of the incoming Interest
+   * @param queryLength:   number of components of the canonical query name, i.e., the length
+   *                       of /<catalog-prefix>/query/<json-query>
+   */
+  void
+  record(const ndn::Name& interestName, size_t queryLength);
+
+  void
+  record(const QueryTraceRecord& record);
+
+private:
+  std::mutex m_mutex;
+  // @{ needs m_mutex protection
+  std::ofstream m_os;
+  size_t m_nUnflushed;
+  // @}
+};
+
+/**
+ * QueryTraceReader reads back the records produced by QueryTraceWriter
+ */
+class QueryTraceReader : boost::noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  /**
+   * @throws Error if the file cannot be opened
+   */
+  explicit
+  QueryTraceReader(const std::string& fileName);
+
+  /**
+   * Read the next record, return false at the end of the trace
+   *
+   * @throws Error if the trace is truncated or malformed
+   */
+  bool
+  next(QueryTraceRecord& record);
+
+private:
+  std::ifstream m_is;
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_QUERY_TRACE_HPP
@@ -0,0 +1,115 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/replica-balancer.hpp"
+
+namespace atmos {
+namespace util {
+
+ReplicaBalancer::ReplicaBalancer(size_t maxOutstanding)
+  : m_maxOutstanding(maxOutstanding)
+{
+}
+
+size_t
+ReplicaBalancer::addEndpoint(size_t weight)
+{
+  Endpoint endpoint = {weight, 0, true};
+  m_endpoints.push_back(endpoint);
+  return m_endpoints.size() - 1;
+}
+
+int
+ReplicaBalancer::acquire()
+{
+  bool hasRotation = hasEndpointInRotation();
+
+  int chosen = -1;
+  for (size_t i = 0; i < m_endpoints.size(); ++i) {
+    const Endpoint& endpoint = m_endpoints[i];
+    if (hasRotation ? !isInRotation(i) : i != 0) {
+      continue;
+    }
+    if (endpoint.nOutstanding >= m_maxOutstanding) {
+      continue;
+    }
+    if (chosen < 0) {
+      chosen = i;
+      continue;
+    }
+
+    // compare (outstanding + 1) / weight without dividing; a zero weight only happens for the
+    // primary when it is the fallback, i.e., the only candidate
+    const Endpoint& best = m_endpoints[chosen];
+    if ((endpoint.nOutstanding + 1) * best.weight < (best.nOutstanding + 1) * endpoint.weight) {
+      chosen = i;
+    }
+  }
+
+  if (chosen >= 0) {
+    ++m_endpoints[chosen].nOutstanding;
+  }
+  return chosen;
+}
+
+void
+ReplicaBalancer::release(size_t index)
+{
+  --m_endpoints[index].nOutstanding;
+}
+
+void
+ReplicaBalancer::setHealthy(size_t index, bool isHealthy)
+{
+  m_endpoints[index].isHealthy = isHealthy;
+}
+
+bool
+ReplicaBalancer::isFull() const
+{
+  bool hasRotation = hasEndpointInRotation();
+  for (size_t i = 0; i < m_endpoints.size(); ++i) {
+    if (hasRotation ? !isInRotation(i) : i != 0) {
+      continue;
+    }
+    if (m_endpoints[i].nOutstanding < m_maxOutstanding) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool
+ReplicaBalancer::isInRotation(size_t index) const
+{
+  return m_endpoints[index].isHealthy && m_endpoints[index].weight > 0;
+}
+
+bool
+ReplicaBalancer::hasEndpointInRotation() const
+{
+  for (size_t i = 0; i < m_endpoints.size(); ++i) {
+    if (isInRotation(i)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace util
+} // namespace atmos
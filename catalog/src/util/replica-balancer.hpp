@@ -0,0 +1,118 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_REPLICA_BALANCER_HPP
+#define ATMOS_UTIL_REPLICA_BALANCER_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace atmos {
+namespace util {
+
+/**
+ * ReplicaBalancer chooses the database endpoint a read runs on.
+ *
+ * Endpoint 0 is the primary, the others are read replicas. A read goes to the endpoint in
+ * rotation with the fewest outstanding reads relative to its weight, among the ones that still
+ * have a free connection. An endpoint is in rotation when it is healthy and its weight is not 0;
+ * when no endpoint is in rotation, the primary takes all reads whatever its weight and health.
+ *
+ * ReplicaBalancer is not thread-safe, the owner serializes the calls.
+ */
+class ReplicaBalancer
+{
+public:
+  /**
+   * @param maxOutstanding: maximum number of outstanding reads on each endpoint
+   */
+  explicit
+  ReplicaBalancer(size_t maxOutstanding);
+
+  /**
+   * Add an endpoint, healthy until told otherwise
+   *
+   * @return the index of the endpoint
+   */
+  size_t
+  addEndpoint(size_t weight);
+
+  /**
+   * Choose an endpoint for a new read and count the read as outstanding on it
+   *
+   * @return the index of the endpoint, or -1 if all endpoints in rotation are full
+   */
+  int
+  acquire();
+
+  /**
+   * The read on this endpoint has completed
+   */
+  void
+  release(size_t index);
+
+  void
+  setHealthy(size_t index, bool isHealthy);
+
+  bool
+  isHealthy(size_t index) const
+  {
+    return m_endpoints[index].isHealthy;
+  }
+
+  size_t
+  getOutstanding(size_t index) const
+  {
+    return m_endpoints[index].nOutstanding;
+  }
+
+  size_t
+  size() const
+  {
+    return m_endpoints.size();
+  }
+
+  /**
+   * @return true if acquire would fail
+   */
+  bool
+  isFull() const;
+
+private:
+  bool
+  isInRotation(size_t index) const;
+
+  bool
+  hasEndpointInRotation() const;
+
+private:
+  struct Endpoint
+  {
+    size_t weight;
+    size_t nOutstanding;
+    bool isHealthy;
+  };
+
+  const size_t m_maxOutstanding;
+  std::vector<Endpoint> m_endpoints;
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_REPLICA_BALANCER_HPP
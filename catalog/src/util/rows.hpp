@@ -0,0 +1,36 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_ROWS_HPP
+#define ATMOS_UTIL_ROWS_HPP
+
+#include <string>
+#include <vector>
+
+namespace atmos {
+namespace util {
+
+// the result set of a query, whichever the DatabaseHandler; a NULL column is returned as an
+// empty string
+typedef std::vector<std::string> Row;
+typedef std::vector<Row> Rows;
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_ROWS_HPP
@@ -0,0 +1,354 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/sha256.hpp"
+#include "config.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef HAVE_SHA_INTRINSICS
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace atmos {
+namespace util {
+
+namespace {
+
+const uint32_t INITIAL_STATE[8] = {
+  0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+const uint32_t K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+/**
+ * A value cut into 64-byte blocks: the full blocks are read in place, the last bytes, the
+ * padding and the length go to the tail
+ */
+struct Message
+{
+  void
+  prepare(const uint8_t* dataInput, size_t size)
+  {
+    data = dataInput;
+    nFull = size / 64;
+    size_t rest = size % 64;
+    std::memset(tail, 0, sizeof(tail));
+    std::memcpy(tail, data + nFull * 64, rest);
+    tail[rest] = 0x80;
+
+    size_t tailSize = rest < 56 ? 64 : 128;
+    uint64_t nBits = static_cast<uint64_t>(size) * 8;
+    for (int i = 0; i < 8; ++i) {
+      tail[tailSize - 1 - i] = static_cast<uint8_t>(nBits >> (8 * i));
+    }
+    nBlocks = nFull + tailSize / 64;
+  }
+
+  const uint8_t*
+  block(size_t i) const
+  {
+    return i < nFull ? data + 64 * i : tail + 64 * (i - nFull);
+  }
+
+  const uint8_t* data;
+  size_t nFull;
+  size_t nBlocks;
+  uint8_t tail[128];
+};
+
+inline uint32_t
+rotateRight(uint32_t x, int n)
+{
+  return (x >> n) | (x << (32 - n));
+}
+
+void
+compressPortable(uint32_t* state, const uint8_t* block)
+{
+  uint32_t w[64];
+  for (int i = 0; i < 16; ++i) {
+    w[i] = (uint32_t(block[4 * i]) << 24) | (uint32_t(block[4 * i + 1]) << 16) |
+           (uint32_t(block[4 * i + 2]) << 8) | uint32_t(block[4 * i + 3]);
+  }
+  for (int i = 16; i < 64; ++i) {
+    uint32_t s0 = rotateRight(w[i - 15], 7) ^ rotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    uint32_t s1 = rotateRight(w[i - 2], 17) ^ rotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+  uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+  for (int i = 0; i < 64; ++i) {
+    uint32_t s1 = rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25);
+    uint32_t ch = (e & f) ^ (~e & g);
+    uint32_t t1 = h + s1 + ch + K[i] + w[i];
+    uint32_t s0 = rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22);
+    uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+    uint32_t t2 = s0 + maj;
+    h = g; g = f; f = e; e = d + t1;
+    d = c; c = b; b = a; a = t1 + t2;
+  }
+  state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+  state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+#ifdef HAVE_SHA_INTRINSICS
+
+// the SHA-NI instructions keep the state as ABEF and CDGH
+__attribute__((target("sha,sse4.1")))
+inline void
+loadState(const uint32_t* state, __m128i& abef, __m128i& cdgh)
+{
+  __m128i dcba = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)),
+                                   0xB1);
+  __m128i efgh = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)),
+                                   0x1B);
+  abef = _mm_alignr_epi8(dcba, efgh, 8);
+  cdgh = _mm_blend_epi16(efgh, dcba, 0xF0);
+}
+
+__attribute__((target("sha,sse4.1")))
+inline void
+storeState(uint32_t* state, __m128i abef, __m128i cdgh)
+{
+  __m128i feba = _mm_shuffle_epi32(abef, 0x1B);
+  __m128i dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_blend_epi16(feba, dchg, 0xF0));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+}
+
+/**
+ * Four rounds on the message words of group g, which are computed from the previous groups
+ */
+__attribute__((target("sha,sse4.1")))
+inline void
+fourRounds(int g, const uint8_t* block, __m128i* w, __m128i& abef, __m128i& cdgh)
+{
+  const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+  if (g < 4) {
+    w[g] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * g)),
+                            byteSwap);
+  }
+  else {
+    __m128i t = _mm_sha256msg1_epu32(w[g % 4], w[(g + 1) % 4]);
+    t = _mm_add_epi32(t, _mm_alignr_epi8(w[(g + 3) % 4], w[(g + 2) % 4], 4));
+    w[g % 4] = _mm_sha256msg2_epu32(t, w[(g + 3) % 4]);
+  }
+
+  __m128i message = _mm_add_epi32(w[g % 4],
+                                  _mm_loadu_si128(reinterpret_cast<const __m128i*>(K + 4 * g)));
+  cdgh = _mm_sha256rnds2_epu32(cdgh, abef, message);
+  abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(message, 0x0E));
+}
+
+__attribute__((target("sha,sse4.1")))
+void
+compressInstructions(uint32_t* state, const uint8_t* block)
+{
+  __m128i abef, cdgh;
+  loadState(state, abef, cdgh);
+  __m128i abefSaved = abef;
+  __m128i cdghSaved = cdgh;
+
+  __m128i w[4];
+  for (int g = 0; g < 16; ++g) {
+    fourRounds(g, block, w, abef, cdgh);
+  }
+
+  storeState(state, _mm_add_epi32(abef, abefSaved), _mm_add_epi32(cdgh, cdghSaved));
+}
+
+/**
+ * Compress one block of each of two values, with their rounds interleaved
+ */
+__attribute__((target("sha,sse4.1")))
+void
+compressInstructions2(uint32_t* state1, const uint8_t* block1,
+                      uint32_t* state2, const uint8_t* block2)
+{
+  __m128i abef1, cdgh1, abef2, cdgh2;
+  loadState(state1, abef1, cdgh1);
+  loadState(state2, abef2, cdgh2);
+  __m128i abefSaved1 = abef1, cdghSaved1 = cdgh1;
+  __m128i abefSaved2 = abef2, cdghSaved2 = cdgh2;
+
+  __m128i w1[4], w2[4];
+  for (int g = 0; g < 16; ++g) {
+    fourRounds(g, block1, w1, abef1, cdgh1);
+    fourRounds(g, block2, w2, abef2, cdgh2);
+  }
+
+  storeState(state1, _mm_add_epi32(abef1, abefSaved1), _mm_add_epi32(cdgh1, cdghSaved1));
+  storeState(state2, _mm_add_epi32(abef2, abefSaved2), _mm_add_epi32(cdgh2, cdghSaved2));
+}
+
+bool
+detectInstructions()
+{
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || (ecx & bit_SSE4_1) == 0) {
+    return false;
+  }
+  // CPUID.(EAX=7,ECX=0):EBX.SHA[bit 29]
+  if (__get_cpuid_max(0, nullptr) < 7) {
+    return false;
+  }
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+  return (ebx & (1u << 29)) != 0;
+}
+
+#endif // HAVE_SHA_INTRINSICS
+
+bool
+useInstructions()
+{
+#ifdef HAVE_SHA_INTRINSICS
+  static const bool hasInstructions = detectInstructions();
+  return hasInstructions;
+#else
+  return false;
+#endif
+}
+
+void
+compress(uint32_t* state, const uint8_t* block)
+{
+#ifdef HAVE_SHA_INTRINSICS
+  if (useInstructions()) {
+    compressInstructions(state, block);
+    return;
+  }
+#endif
+  compressPortable(state, block);
+}
+
+void
+hash(const Message& message, uint32_t* state)
+{
+  std::memcpy(state, INITIAL_STATE, sizeof(INITIAL_STATE));
+  for (size_t i = 0; i < message.nBlocks; ++i) {
+    compress(state, message.block(i));
+  }
+}
+
+void
+toHex(const uint32_t* state, char* hex)
+{
+  for (int i = 0; i < 8; ++i) {
+    for (int j = 0; j < 8; ++j) {
+      hex[8 * i + j] = HEX_DIGITS[(state[i] >> (28 - 4 * j)) & 0xF];
+    }
+  }
+}
+
+} // namespace
+
+void
+sha256(const uint8_t* data, size_t size, uint8_t* digest)
+{
+  Message message;
+  message.prepare(data, size);
+  uint32_t state[8];
+  hash(message, state);
+  for (int i = 0; i < 8; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      digest[4 * i + j] = static_cast<uint8_t>(state[i] >> (24 - 8 * j));
+    }
+  }
+}
+
+std::string
+sha256Hex(const std::string& value)
+{
+  std::string hex(SHA256_HEX_SIZE, '0');
+  ValueRef ref{value.data(), value.size()};
+  sha256HexBatch(&ref, 1, &hex[0]);
+  return hex;
+}
+
+void
+sha256HexBatch(const ValueRef* values, size_t nValues, char* hex)
+{
+  Message messages[2];
+  uint32_t states[2][8];
+  size_t i = 0;
+
+#ifdef HAVE_SHA_INTRINSICS
+  if (useInstructions()) {
+    for (; i + 1 < nValues; i += 2) {
+      for (int k = 0; k < 2; ++k) {
+        messages[k].prepare(reinterpret_cast<const uint8_t*>(values[i + k].data),
+                            values[i + k].size);
+        std::memcpy(states[k], INITIAL_STATE, sizeof(INITIAL_STATE));
+      }
+
+      // the blocks the two values have in common are interleaved, the rest is not
+      size_t nCommon = std::min(messages[0].nBlocks, messages[1].nBlocks);
+      for (size_t b = 0; b < nCommon; ++b) {
+        compressInstructions2(states[0], messages[0].block(b), states[1], messages[1].block(b));
+      }
+      for (int k = 0; k < 2; ++k) {
+        for (size_t b = nCommon; b < messages[k].nBlocks; ++b) {
+          compressInstructions(states[k], messages[k].block(b));
+        }
+        toHex(states[k], hex + (i + k) * SHA256_HEX_SIZE);
+      }
+    }
+  }
+#endif
+
+  for (; i < nValues; ++i) {
+    messages[0].prepare(reinterpret_cast<const uint8_t*>(values[i].data), values[i].size);
+    hash(messages[0], states[0]);
+    toHex(states[0], hex + i * SHA256_HEX_SIZE);
+  }
+}
+
+uint64_t
+sha256HexKey(const char* hex)
+{
+  uint64_t key = 0;
+  for (int i = 0; i < 16; ++i) {
+    char c = hex[i];
+    key = (key << 4) | static_cast<uint64_t>(c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+  }
+  return key;
+}
+
+bool
+hasSha256Instructions()
+{
+  return useInstructions();
+}
+
+} // namespace util
+} // namespace atmos
@@ -0,0 +1,78 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_SHA256_HPP
+#define ATMOS_UTIL_SHA256_HPP
+
+#include "util/bulk-statement.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace atmos {
+namespace util {
+
+#define SHA256_DIGEST_SIZE 32
+// upper-case hex, as ndn::util::Digest::toString gives for the sha256 column
+#define SHA256_HEX_SIZE 64
+
+/**
+ * Compute the SHA-256 of data
+ *
+ * On x86-64 CPUs with the SHA extensions, the compression runs on the SHA-NI instructions,
+ * otherwise on portable code; both give the same digests.
+ */
+void
+sha256(const uint8_t* data, size_t size, uint8_t* digest);
+
+/**
+ * Compute the SHA-256 of a value as upper-case hex
+ */
+std::string
+sha256Hex(const std::string& value);
+
+/**
+ * Compute the SHA-256 of many short values, e.g., the file names of a publication, writing
+ * the upper-case hex of the i-th digest to hex + i * SHA256_HEX_SIZE
+ *
+ * With SHA-NI, the values are hashed two at a time, so the rounds of one hide the latency of
+ * the rounds of the other.
+ *
+ * @param hex: buffer of nValues * SHA256_HEX_SIZE characters, e.g., the bind buffer of the
+ *             sha256 column
+ */
+void
+sha256HexBatch(const ValueRef* values, size_t nValues, char* hex);
+
+/**
+ * @return the first 64 bits of a digest given as hex, e.g., a key for a hash table
+ */
+uint64_t
+sha256HexKey(const char* hex);
+
+/**
+ * @return true if the SHA-NI instructions are used
+ */
+bool
+hasSha256Instructions();
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_SHA256_HPP
@@ -0,0 +1,137 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/sharded-content-store.hpp"
+
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
+
+namespace atmos {
+namespace util {
+
+ShardedContentStore::ShardedContentStore(size_t capacity, size_t keyLength, size_t nShards)
+  : m_keyLength(keyLength)
+{
+  size_t shardCapacity = std::max<size_t>(capacity / nShards, 1);
+  for (size_t i = 0; i < nShards; ++i) {
+    m_shards.push_back(std::unique_ptr<Shard>(new Shard(shardCapacity)));
+  }
+}
+
+void
+ShardedContentStore::setKeyLength(size_t keyLength)
+{
+  m_keyLength = keyLength;
+}
+
+ShardedContentStore::Shard*
+ShardedContentStore::getShard(const ndn::Name& name)
+{
+  if (name.size() < m_keyLength) {
+    return nullptr;
+  }
+
+  // hash the component wires directly, to avoid copying the name prefix
+  size_t hash = 0;
+  for (size_t i = 0; i < m_keyLength; ++i) {
+    boost::hash_range(hash, name[i].wire(), name[i].wire() + name[i].size());
+  }
+  return m_shards[hash % m_shards.size()].get();
+}
+
+void
+ShardedContentStore::insert(const ndn::Data& data)
+{
+  Shard* shard = getShard(data.getName());
+  if (shard == nullptr) {
+    // too short to have a key, keep it in the first shard
+    shard = m_shards.front().get();
+  }
+
+  std::lock_guard<std::mutex> lock(shard->mutex);
+  shard->storage.insert(data);
+}
+
+std::shared_ptr<const ndn::Data>
+ShardedContentStore::find(const ndn::Interest& interest)
+{
+  Shard* shard = getShard(interest.getName());
+  if (shard != nullptr) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    return shard->storage.find(interest);
+  }
+
+  for (const auto& s : m_shards) {
+    std::lock_guard<std::mutex> lock(s->mutex);
+    std::shared_ptr<const ndn::Data> data = s->storage.find(interest);
+    if (data) {
+      return data;
+    }
+  }
+  return nullptr;
+}
+
+std::shared_ptr<const ndn::Data>
+ShardedContentStore::find(const ndn::Name& name)
+{
+  Shard* shard = getShard(name);
+  if (shard != nullptr) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    return shard->storage.find(name);
+  }
+
+  for (const auto& s : m_shards) {
+    std::lock_guard<std::mutex> lock(s->mutex);
+    std::shared_ptr<const ndn::Data> data = s->storage.find(name);
+    if (data) {
+      return data;
+    }
+  }
+  return nullptr;
+}
+
+void
+ShardedContentStore::erase(const ndn::Name& prefix, bool isPrefix)
+{
+  Shard* shard = getShard(prefix);
+  if (shard != nullptr) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    shard->storage.erase(prefix, isPrefix);
+    return;
+  }
+
+  for (const auto& s : m_shards) {
+    std::lock_guard<std::mutex> lock(s->mutex);
+    s->storage.erase(prefix, isPrefix);
+  }
+}
+
+size_t
+ShardedContentStore::size()
+{
+  size_t total = 0;
+  for (const auto& s : m_shards) {
+    std::lock_guard<std::mutex> lock(s->mutex);
+    total += s->storage.size();
+  }
+  return total;
+}
+
+} // namespace util
+} // namespace atmos
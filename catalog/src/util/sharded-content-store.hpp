@@ -0,0 +1,110 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_SHARDED_CONTENT_STORE_HPP
+#define ATMOS_UTIL_SHARDED_CONTENT_STORE_HPP
+
+#include <ndn-cxx/data.hpp>
+#include <ndn-cxx/interest.hpp>
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/util/in-memory-storage-lru.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace atmos {
+namespace util {
+
+/**
+ * ShardedContentStore is a thread-safe in-memory Data storage made of independently locked
+ * shards, each of them an ndn::util::InMemoryStorageLru.
+ *
+ * A Data packet lives in the shard selected by the hash of the first keyLength components of
+ * its name, e.g., /<prefix>/query/<json-query> for query results, so all segments of one result
+ * share a shard. A lookup whose name is at least keyLength long only locks that shard; shorter
+ * names and prefix erasure visit every shard. Matching (prefix match, MustBeFresh, ...) is done
+ * by InMemoryStorage::find, hence the semantics are the same as with a single storage.
+ */
+class ShardedContentStore : boost::noncopyable
+{
+public:
+  /**
+   * Constructor
+   *
+   * @param capacity:  total number of packets, split evenly among the shards
+   * @param keyLength: number of name components hashed to select a shard
+   * @param nShards:   number of shards
+   */
+  ShardedContentStore(size_t capacity, size_t keyLength, size_t nShards = 16);
+
+  /**
+   * Change the number of name components hashed to select a shard; the store must be empty
+   * and not used by other threads, e.g., during configuration
+   */
+  void
+  setKeyLength(size_t keyLength);
+
+  void
+  insert(const ndn::Data& data);
+
+  std::shared_ptr<const ndn::Data>
+  find(const ndn::Interest& interest);
+
+  std::shared_ptr<const ndn::Data>
+  find(const ndn::Name& name);
+
+  /**
+   * Erase the Data with this exact name, or all Data under this prefix if isPrefix is true
+   */
+  void
+  erase(const ndn::Name& prefix, bool isPrefix = true);
+
+  size_t
+  size();
+
+private:
+  struct Shard
+  {
+    explicit
+    Shard(size_t capacity)
+      : storage(capacity)
+    {
+    }
+
+    std::mutex mutex;
+    ndn::util::InMemoryStorageLru storage;
+  };
+
+  /**
+   * @return the shard responsible for the name, or nullptr if the name is shorter than the key
+   */
+  Shard*
+  getShard(const ndn::Name& name);
+
+private:
+  std::vector<std::unique_ptr<Shard>> m_shards;
+  size_t m_keyLength;
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_SHARDED_CONTENT_STORE_HPP
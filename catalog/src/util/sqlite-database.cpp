@@ -0,0 +1,291 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/sqlite-database.hpp"
+
+#include <sqlite3.h>
+
+#include <algorithm>
+
+namespace atmos {
+namespace util {
+
+// milliseconds a statement waits for a lock held by another connection before failing
+static const int BUSY_TIMEOUT = 5000;
+
+bool
+SqliteDatabase::Error::isTransient() const
+{
+  switch (m_code & 0xff) {
+  case SQLITE_BUSY:
+  case SQLITE_LOCKED:
+  case SQLITE_NOMEM:
+  case SQLITE_IOERR:
+  case SQLITE_FULL:
+  case SQLITE_CANTOPEN:
+  case SQLITE_PROTOCOL:
+    return true;
+  default:
+    return false;
+  }
+}
+
+SqliteDatabase::SqliteDatabase(const std::string& path, size_t nReaders)
+  : m_writer(nullptr)
+{
+  m_writer = open(path, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+  if (path == ":memory:") {
+    return;
+  }
+
+  try {
+    // readers see the last committed transaction and do not block the writer, nor the other
+    // way around; with synchronous=NORMAL, a power failure may lose the last transactions but
+    // never corrupts the database
+    run(m_writer, "PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL;", {}, nullptr);
+
+    for (size_t i = 0; i < std::max<size_t>(nReaders, 1); i++) {
+      sqlite3* reader = open(path, SQLITE_OPEN_READONLY);
+      m_readers.push_back(reader);
+      m_idleReaders.push_back(reader);
+    }
+  }
+  catch (const Error&) {
+    close();
+    throw;
+  }
+}
+
+SqliteDatabase::~SqliteDatabase()
+{
+  close();
+}
+
+sqlite3*
+SqliteDatabase::open(const std::string& path, int flags)
+{
+  sqlite3* db = nullptr;
+  // each connection is only used by one thread at a time
+  int status = sqlite3_open_v2(path.c_str(), &db, flags | SQLITE_OPEN_NOMUTEX, nullptr);
+  if (status != SQLITE_OK) {
+    std::string reason = db != nullptr ? sqlite3_errmsg(db) : sqlite3_errstr(status);
+    sqlite3_close(db);
+    throw Error("Cannot open " + path + ": " + reason, status);
+  }
+  sqlite3_busy_timeout(db, BUSY_TIMEOUT);
+  return db;
+}
+
+void
+SqliteDatabase::execute(const std::string& sql, const std::vector<std::string>& params)
+{
+  std::lock_guard<std::mutex> lock(m_writerMutex);
+  if (m_writer == nullptr) {
+    throw Error("Database is closed");
+  }
+  run(m_writer, sql, params, nullptr);
+}
+
+void
+SqliteDatabase::transaction(const std::vector<std::string>& statements)
+{
+  std::lock_guard<std::mutex> lock(m_writerMutex);
+  if (m_writer == nullptr) {
+    throw Error("Database is closed");
+  }
+
+  run(m_writer, "BEGIN", {}, nullptr);
+  try {
+    for (const auto& sql : statements) {
+      run(m_writer, sql, {}, nullptr);
+    }
+    run(m_writer, "COMMIT", {}, nullptr);
+  }
+  catch (const Error&) {
+    sqlite3_exec(m_writer, "ROLLBACK", nullptr, nullptr, nullptr);
+    throw;
+  }
+}
+
+void
+SqliteDatabase::executeBulk(const std::vector<BulkStatement>& statements)
+{
+  std::lock_guard<std::mutex> lock(m_writerMutex);
+  if (m_writer == nullptr) {
+    throw Error("Database is closed");
+  }
+
+  run(m_writer, "BEGIN", {}, nullptr);
+  try {
+    for (const auto& statement : statements) {
+      runBulk(m_writer, statement);
+    }
+    run(m_writer, "COMMIT", {}, nullptr);
+  }
+  catch (const Error&) {
+    sqlite3_exec(m_writer, "ROLLBACK", nullptr, nullptr, nullptr);
+    throw;
+  }
+}
+
+Rows
+SqliteDatabase::query(const std::string& sql, const std::vector<std::string>& params)
+{
+  Rows rows;
+
+  std::unique_lock<std::mutex> readersLock(m_readersMutex);
+  if (m_readers.empty()) {
+    // ":memory:" is private to its connection, read through the writer
+    readersLock.unlock();
+    std::lock_guard<std::mutex> lock(m_writerMutex);
+    if (m_writer == nullptr) {
+      throw Error("Database is closed");
+    }
+    run(m_writer, sql, params, &rows);
+    return rows;
+  }
+
+  m_readerReleased.wait(readersLock, [this] { return !m_idleReaders.empty(); });
+  sqlite3* reader = m_idleReaders.back();
+  m_idleReaders.pop_back();
+  readersLock.unlock();
+
+  try {
+    run(reader, sql, params, &rows);
+  }
+  catch (const Error&) {
+    readersLock.lock();
+    m_idleReaders.push_back(reader);
+    readersLock.unlock();
+    m_readerReleased.notify_all();
+    throw;
+  }
+
+  readersLock.lock();
+  m_idleReaders.push_back(reader);
+  readersLock.unlock();
+  m_readerReleased.notify_all();
+  return rows;
+}
+
+void
+SqliteDatabase::close()
+{
+  {
+    std::unique_lock<std::mutex> lock(m_readersMutex);
+    // let the running reads complete
+    m_readerReleased.wait(lock, [this] { return m_idleReaders.size() == m_readers.size(); });
+    for (sqlite3* reader : m_readers) {
+      sqlite3_close(reader);
+    }
+    m_readers.clear();
+    m_idleReaders.clear();
+  }
+
+  std::lock_guard<std::mutex> lock(m_writerMutex);
+  sqlite3_close(m_writer);
+  m_writer = nullptr;
+}
+
+void
+SqliteDatabase::run(sqlite3* db, const std::string& sql, const std::vector<std::string>& params,
+                    Rows* rows)
+{
+  const char* next = sql.c_str();
+  const char* end = next + sql.size();
+  while (next < end) {
+    sqlite3_stmt* statement = nullptr;
+    if (sqlite3_prepare_v2(db, next, end - next, &statement, &next) != SQLITE_OK) {
+      throw Error(sqlite3_errmsg(db), sqlite3_errcode(db));
+    }
+    if (statement == nullptr) {
+      // only white space or a comment was left
+      continue;
+    }
+
+    int nParams = sqlite3_bind_parameter_count(statement);
+    for (int i = 0; i < nParams && i < static_cast<int>(params.size()); i++) {
+      sqlite3_bind_text(statement, i + 1, params[i].data(), params[i].size(), SQLITE_TRANSIENT);
+    }
+
+    int status;
+    while ((status = sqlite3_step(statement)) == SQLITE_ROW) {
+      if (rows == nullptr) {
+        continue;
+      }
+      Row row;
+      for (int column = 0; column < sqlite3_column_count(statement); column++) {
+        const unsigned char* text = sqlite3_column_text(statement, column);
+        if (text == nullptr) {
+          row.push_back(std::string());
+        }
+        else {
+          row.push_back(std::string(reinterpret_cast<const char*>(text),
+                                    sqlite3_column_bytes(statement, column)));
+        }
+      }
+      rows->push_back(row);
+    }
+
+    if (status != SQLITE_DONE) {
+      std::string reason = sqlite3_errmsg(db);
+      int code = sqlite3_errcode(db);
+      sqlite3_finalize(statement);
+      throw Error(reason, code);
+    }
+    sqlite3_finalize(statement);
+  }
+}
+
+void
+SqliteDatabase::runBulk(sqlite3* db, const BulkStatement& statement)
+{
+  const std::vector<ValueRef>& values = statement.getValues();
+  size_t nColumns = statement.getNColumns();
+
+  // a statement is prepared once for each chunk size, the chunks come largest first
+  sqlite3_stmt* prepared = nullptr;
+  size_t preparedRows = 0;
+  size_t value = 0;
+  for (size_t nRows : statement.getChunks()) {
+    if (nRows != preparedRows) {
+      sqlite3_finalize(prepared);
+      std::string sql = statement.getSql(nRows);
+      if (sqlite3_prepare_v2(db, sql.data(), sql.size(), &prepared, nullptr) != SQLITE_OK) {
+        throw Error(sqlite3_errmsg(db), sqlite3_errcode(db));
+      }
+      preparedRows = nRows;
+    }
+
+    // the values outlive the step, SQLite does not need its own copy
+    for (int i = 1; i <= static_cast<int>(nRows * nColumns); ++i, ++value) {
+      sqlite3_bind_text(prepared, i, values[value].data, values[value].size, SQLITE_STATIC);
+    }
+    if (sqlite3_step(prepared) != SQLITE_DONE) {
+      std::string reason = sqlite3_errmsg(db);
+      int code = sqlite3_errcode(db);
+      sqlite3_finalize(prepared);
+      throw Error(reason, code);
+    }
+    sqlite3_reset(prepared);
+  }
+  sqlite3_finalize(prepared);
+}
+
+} // namespace util
+} // namespace atmos
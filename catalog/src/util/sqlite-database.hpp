@@ -0,0 +1,161 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_SQLITE_DATABASE_HPP
+#define ATMOS_UTIL_SQLITE_DATABASE_HPP
+
+#include "util/bulk-statement.hpp"
+#include "util/rows.hpp"
+
+#include <boost/noncopyable.hpp>
+
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct sqlite3;
+
+namespace atmos {
+namespace util {
+
+/**
+ * SqliteDatabase is the DatabaseHandler of the adapters for a catalog kept in-process, in a
+ * SQLite database file, so that no database server is needed.
+ *
+ * The database runs in WAL mode: the writes go through one connection, one after the other,
+ * while up to nReaders reads run at the same time on their own connections and never wait for
+ * the writes. The ":memory:" database has a single connection for the reads and the writes.
+ */
+class SqliteDatabase : boost::noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    /**
+     * @param code: SQLite result code of the failure, 0 if the database is closed
+     */
+    explicit
+    Error(const std::string& what, int code = 0)
+      : std::runtime_error(what)
+      , m_code(code)
+    {
+    }
+
+    /**
+     * @return true if the statement may succeed when run again, e.g., it could not get a lock;
+     *         false if the database rejects it
+     */
+    bool
+    isTransient() const;
+
+  private:
+    int m_code;
+  };
+
+  /**
+   * Constructor, creates the database file if it does not exist
+   *
+   * @param path:     the database file, or ":memory:"
+   * @param nReaders: maximum number of reads running at the same time
+   * @throw Error if the database cannot be opened
+   */
+  SqliteDatabase(const std::string& path, size_t nReaders);
+
+  ~SqliteDatabase();
+
+  /**
+   * Run SQL statements that modify the database, can be called from any thread
+   *
+   * @param sql:    the statements, separated by ';'
+   * @param params: values of the '?' parameters of each statement
+   * @throw Error if a statement fails, the statements before it are not rolled back
+   */
+  void
+  execute(const std::string& sql, const std::vector<std::string>& params = {});
+
+  /**
+   * Run SQL statements in one transaction, can be called from any thread; no other write runs
+   * in between
+   *
+   * @param statements: the statements, in order
+   * @throw Error if a statement fails, the transaction is rolled back
+   */
+  void
+  transaction(const std::vector<std::string>& statements);
+
+  /**
+   * Run bulk statements in one transaction, can be called from any thread; the values are
+   * bound without being copied
+   *
+   * @throw Error if a statement fails, the transaction is rolled back
+   */
+  void
+  executeBulk(const std::vector<BulkStatement>& statements);
+
+  /**
+   * Run a SELECT statement, can be called from any thread; waits when nReaders reads are
+   * already running
+   *
+   * @param sql:    the statement
+   * @param params: values of the '?' parameters
+   * @throw Error if the statement fails
+   */
+  Rows
+  query(const std::string& sql, const std::vector<std::string>& params = {});
+
+  /**
+   * Close all connections, nothing can be run afterwards
+   */
+  void
+  close();
+
+private:
+  sqlite3*
+  open(const std::string& path, int flags);
+
+  /**
+   * Run the statements on this connection, and append the rows they return to rows if not null
+   */
+  void
+  run(sqlite3* db, const std::string& sql, const std::vector<std::string>& params, Rows* rows);
+
+  /**
+   * Run the chunks of a bulk statement on this connection
+   */
+  void
+  runBulk(sqlite3* db, const BulkStatement& statement);
+
+private:
+  std::mutex m_writerMutex;
+  sqlite3* m_writer;
+
+  std::mutex m_readersMutex;
+  std::condition_variable m_readerReleased;
+  // @{ need m_readersMutex protection
+  std::vector<sqlite3*> m_readers;
+  std::vector<sqlite3*> m_idleReaders;
+  // @}
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_SQLITE_DATABASE_HPP
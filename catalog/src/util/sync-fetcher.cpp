@@ -0,0 +1,277 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/sync-fetcher.hpp"
+#include "util/logger.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+namespace atmos {
+namespace util {
+#ifdef HAVE_LOG4CXX
+  INIT_LOGGER("SyncFetcher");
+#endif
+
+SyncFetcher::Options::Options()
+  : maxOutstanding(64)
+  , maxPerSession(8)
+  , maxRetries(5)
+  , initialBackoff(1000)
+  , maxBackoff(60000)
+  , progressInterval(64)
+  , pauseInterval(200)
+{
+}
+
+SyncFetcher::Session::Session()
+  : fetchedUpTo(0)
+  , reportedUpTo(0)
+  , nextSeq(1)
+  , high(0)
+{
+}
+
+SyncFetcher::SyncFetcher(ndn::util::scheduler::Scheduler& scheduler,
+                         const Options& options,
+                         const FetchFunction& fetch,
+                         const ProgressCallback& onProgress,
+                         const std::string& name,
+                         const PauseCallback& shouldPause)
+  : m_scheduler(scheduler)
+  , m_options(options)
+  , m_fetch(fetch)
+  , m_onProgress(onProgress)
+  , m_shouldPause(shouldPause)
+  , m_nOutstanding(0)
+  , m_isFilling(false)
+  , m_isPaused(false)
+  , m_outstandingMetric(MetricsRegistry::getDefault().get(name + ".fetch.outstanding"))
+  , m_missingMetric(MetricsRegistry::getDefault().get(name + ".fetch.missing"))
+  , m_fetchedMetric(MetricsRegistry::getDefault().get(name + ".fetch.fetched"))
+  , m_retriesMetric(MetricsRegistry::getDefault().get(name + ".fetch.retries"))
+  , m_givenUpMetric(MetricsRegistry::getDefault().get(name + ".fetch.givenUp"))
+{
+}
+
+SyncFetcher::~SyncFetcher()
+{
+  for (auto& item : m_sessions) {
+    for (const auto& backoff : item.second.backoff) {
+      m_scheduler.cancelEvent(backoff.second);
+    }
+  }
+  if (m_isPaused) {
+    m_scheduler.cancelEvent(m_resumeEvent);
+  }
+}
+
+void
+SyncFetcher::addMissing(const ndn::Name& name, uint64_t low, uint64_t high,
+                        uint64_t fetchedUpTo)
+{
+  auto it = m_sessions.find(name);
+  if (it == m_sessions.end()) {
+    Session session;
+    // the updates before low are not fetched, as before
+    session.fetchedUpTo = std::max(fetchedUpTo, low > 0 ? low - 1 : 0);
+    session.reportedUpTo = session.fetchedUpTo;
+    session.nextSeq = session.fetchedUpTo + 1;
+    session.high = session.fetchedUpTo;
+    it = m_sessions.insert(std::make_pair(name, session)).first;
+  }
+
+  Session& session = it->second;
+  session.high = std::max(session.high, high);
+  // the session is reachable again, the updates given up are worth another try
+  for (uint64_t seq : session.givenUp) {
+    session.nRetries.erase(seq);
+    session.retryQueue.insert(seq);
+  }
+  session.givenUp.clear();
+
+  fill();
+}
+
+void
+SyncFetcher::onFetched(const ndn::Name& name, uint64_t seq)
+{
+  auto it = m_sessions.find(name);
+  if (it == m_sessions.end() || it->second.inFlight.erase(seq) == 0) {
+    return;
+  }
+  Session& session = it->second;
+  --m_nOutstanding;
+  m_fetchedMetric.add();
+
+  session.nRetries.erase(seq);
+  if (seq > session.fetchedUpTo) {
+    session.fetched.insert(seq);
+  }
+  advance(name, session);
+  fill();
+}
+
+void
+SyncFetcher::onFailed(const ndn::Name& name, uint64_t seq)
+{
+  auto it = m_sessions.find(name);
+  if (it == m_sessions.end() || it->second.inFlight.erase(seq) == 0) {
+    return;
+  }
+  Session& session = it->second;
+  --m_nOutstanding;
+
+  size_t& nRetries = session.nRetries[seq];
+  if (nRetries >= m_options.maxRetries) {
+    _LOG_ERROR("Update " << name << ":" << seq << " given up after " << nRetries << " retries");
+    session.nRetries.erase(seq);
+    session.givenUp.insert(seq);
+    m_givenUpMetric.add();
+  }
+  else {
+    ndn::time::milliseconds delay = std::min(m_options.maxBackoff,
+                                             m_options.initialBackoff *
+                                               (1 << std::min<size_t>(nRetries, 16)));
+    ++nRetries;
+    session.backoff[seq] = m_scheduler.scheduleEvent(delay,
+                                                     std::bind(&SyncFetcher::onBackoffElapsed,
+                                                               this, name, seq));
+  }
+  fill();
+}
+
+uint64_t
+SyncFetcher::getNMissing() const
+{
+  uint64_t nMissing = 0;
+  for (const auto& item : m_sessions) {
+    const Session& session = item.second;
+    nMissing += session.high - session.fetchedUpTo - session.fetched.size();
+  }
+  return nMissing;
+}
+
+uint64_t
+SyncFetcher::getFetchedUpTo(const ndn::Name& name) const
+{
+  auto it = m_sessions.find(name);
+  return it == m_sessions.end() ? 0 : it->second.fetchedUpTo;
+}
+
+void
+SyncFetcher::fill()
+{
+  if (m_isFilling || m_isPaused) {
+    return;
+  }
+  m_isFilling = true;
+
+  bool isStarted = true;
+  while (isStarted && m_nOutstanding < m_options.maxOutstanding) {
+    if (m_shouldPause && m_shouldPause()) {
+      // the consumer cannot keep up, the fetches outstanding still complete
+      m_isPaused = true;
+      m_resumeEvent = m_scheduler.scheduleEvent(m_options.pauseInterval,
+                                                std::bind(&SyncFetcher::onResume, this));
+      break;
+    }
+
+    isStarted = false;
+    auto it = m_sessions.upper_bound(m_lastServed);
+    for (size_t i = 0; i < m_sessions.size() && m_nOutstanding < m_options.maxOutstanding; ++i) {
+      if (it == m_sessions.end()) {
+        it = m_sessions.begin();
+      }
+      if (fetchNext(it->first, it->second)) {
+        m_lastServed = it->first;
+        isStarted = true;
+      }
+      ++it;
+    }
+  }
+
+  m_isFilling = false;
+  m_outstandingMetric.set(m_nOutstanding);
+  m_missingMetric.set(getNMissing());
+}
+
+bool
+SyncFetcher::fetchNext(const ndn::Name& name, Session& session)
+{
+  if (session.inFlight.size() >= m_options.maxPerSession) {
+    return false;
+  }
+
+  uint64_t seq = 0;
+  if (!session.retryQueue.empty()) {
+    seq = *session.retryQueue.begin();
+    session.retryQueue.erase(session.retryQueue.begin());
+    m_retriesMetric.add();
+  }
+  else if (session.nextSeq <= session.high) {
+    seq = session.nextSeq++;
+  }
+  else {
+    return false;
+  }
+
+  session.inFlight.insert(seq);
+  ++m_nOutstanding;
+  m_fetch(name, seq);
+  return true;
+}
+
+void
+SyncFetcher::onBackoffElapsed(const ndn::Name& name, uint64_t seq)
+{
+  auto it = m_sessions.find(name);
+  if (it == m_sessions.end()) {
+    return;
+  }
+  it->second.backoff.erase(seq);
+  it->second.retryQueue.insert(seq);
+  fill();
+}
+
+void
+SyncFetcher::onResume()
+{
+  m_isPaused = false;
+  fill();
+}
+
+void
+SyncFetcher::advance(const ndn::Name& name, Session& session)
+{
+  while (!session.fetched.empty() && *session.fetched.begin() == session.fetchedUpTo + 1) {
+    session.fetched.erase(session.fetched.begin());
+    ++session.fetchedUpTo;
+  }
+
+  // the progress is saved in the database, not after every update
+  if (session.fetchedUpTo > session.reportedUpTo &&
+      (session.fetchedUpTo - session.reportedUpTo >= m_options.progressInterval ||
+       session.fetchedUpTo == session.high)) {
+    session.reportedUpTo = session.fetchedUpTo;
+    m_onProgress(name, session.fetchedUpTo);
+  }
+}
+
+} // namespace util
+} // namespace atmos
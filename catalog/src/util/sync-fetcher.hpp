@@ -0,0 +1,219 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_SYNC_FETCHER_HPP
+#define ATMOS_UTIL_SYNC_FETCHER_HPP
+
+#include "util/metrics.hpp"
+
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/util/scheduler.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+
+namespace atmos {
+namespace util {
+
+/**
+ * SyncFetcher fetches the updates ChronoSync reports missing, keeping a bounded number of
+ * fetches outstanding for each session and across all sessions.
+ *
+ * The missing sequence numbers of a session are requested in order, the sessions taking turns.
+ * A fetch that fails is tried again after a backoff that doubles with each attempt, up to
+ * maxRetries times; the sequence number is then left missing until the session reports updates
+ * again. For each session, the fetcher tracks the sequence number up to which all updates have
+ * been fetched, and hands it to onProgress, so that a restart resumes from there rather than
+ * past the gaps.
+ *
+ * The fetcher reports "<name>.fetch.outstanding", "<name>.fetch.missing", "<name>.fetch.fetched",
+ * "<name>.fetch.retries" and "<name>.fetch.givenUp" to the default MetricsRegistry. It must be
+ * used from the Face's thread.
+ */
+class SyncFetcher : boost::noncopyable
+{
+public:
+  struct Options
+  {
+    Options();
+
+    // fetches outstanding across all sessions
+    size_t maxOutstanding;
+    // fetches outstanding for one session
+    size_t maxPerSession;
+    // number of times a fetch is tried again before the update is left missing
+    size_t maxRetries;
+    // delay before the first retry, doubled for each next one, up to maxBackoff
+    ndn::time::milliseconds initialBackoff;
+    ndn::time::milliseconds maxBackoff;
+    // onProgress is called once this many more updates are fetched, or the session caught up
+    uint64_t progressInterval;
+    // delay before asking shouldPause again
+    ndn::time::milliseconds pauseInterval;
+  };
+
+  // starts fetching an update, its outcome is reported with onFetched or onFailed
+  typedef std::function<void(const ndn::Name& session, uint64_t seq)> FetchFunction;
+  // all updates of the session up to seq are fetched
+  typedef std::function<void(const ndn::Name& session, uint64_t seq)> ProgressCallback;
+  // returns true while the consumer cannot keep up, no new fetch is started meanwhile
+  typedef std::function<bool()> PauseCallback;
+
+  /**
+   * @param scheduler:   scheduler of the Face's io_service, must outlive the fetcher
+   * @param options:     window and retry settings
+   * @param fetch:       starts fetching an update
+   * @param onProgress:  called as the fetched updates of a session advance
+   * @param name:        prefix of the metrics of this fetcher, e.g., "sync"
+   * @param shouldPause: optional backpressure from the consumer
+   */
+  SyncFetcher(ndn::util::scheduler::Scheduler& scheduler,
+              const Options& options,
+              const FetchFunction& fetch,
+              const ProgressCallback& onProgress,
+              const std::string& name,
+              const PauseCallback& shouldPause = PauseCallback());
+
+  ~SyncFetcher();
+
+  bool
+  hasSession(const ndn::Name& session) const
+  {
+    return m_sessions.count(session) > 0;
+  }
+
+  /**
+   * Fetch the updates of a session from low to high. The updates given up before are tried
+   * again
+   *
+   * @param fetchedUpTo: for a session not seen before, the updates up to this one were
+   *                     fetched before, e.g., by the catalog before a restart
+   */
+  void
+  addMissing(const ndn::Name& session, uint64_t low, uint64_t high, uint64_t fetchedUpTo);
+
+  /**
+   * An update has been fetched, or it is invalid and will not be fetched again
+   */
+  void
+  onFetched(const ndn::Name& session, uint64_t seq);
+
+  /**
+   * An update could not be fetched, e.g., it timed out
+   */
+  void
+  onFailed(const ndn::Name& session, uint64_t seq);
+
+  size_t
+  getNOutstanding() const
+  {
+    return m_nOutstanding;
+  }
+
+  /**
+   * @return the number of updates known but not fetched yet, across all sessions
+   */
+  uint64_t
+  getNMissing() const;
+
+  /**
+   * @return the sequence number up to which all updates of the session are fetched
+   */
+  uint64_t
+  getFetchedUpTo(const ndn::Name& session) const;
+
+private:
+  struct Session
+  {
+    Session();
+
+    // all updates up to this one are fetched
+    uint64_t fetchedUpTo;
+    // last value handed to onProgress
+    uint64_t reportedUpTo;
+    // next update never requested
+    uint64_t nextSeq;
+    // highest update known
+    uint64_t high;
+    // updates fetched past fetchedUpTo
+    std::set<uint64_t> fetched;
+    std::set<uint64_t> inFlight;
+    // failed updates whose backoff elapsed, requested before the next ones
+    std::set<uint64_t> retryQueue;
+    // failed updates waiting for their backoff
+    std::map<uint64_t, ndn::util::scheduler::EventId> backoff;
+    std::map<uint64_t, size_t> nRetries;
+    // updates that failed maxRetries times
+    std::set<uint64_t> givenUp;
+  };
+
+  /**
+   * Start fetches until the windows are full, one per session in turn
+   */
+  void
+  fill();
+
+  /**
+   * @return true if a fetch of the session was started
+   */
+  bool
+  fetchNext(const ndn::Name& name, Session& session);
+
+  void
+  onBackoffElapsed(const ndn::Name& name, uint64_t seq);
+
+  void
+  onResume();
+
+  /**
+   * Move fetchedUpTo past the updates fetched in order, and report it
+   */
+  void
+  advance(const ndn::Name& name, Session& session);
+
+private:
+  ndn::util::scheduler::Scheduler& m_scheduler;
+  const Options m_options;
+  FetchFunction m_fetch;
+  ProgressCallback m_onProgress;
+  PauseCallback m_shouldPause;
+
+  std::map<ndn::Name, Session> m_sessions;
+  // the session that started the last fetch, the next turn starts after it
+  ndn::Name m_lastServed;
+  size_t m_nOutstanding;
+  // fill may be reached again from a fetch that completes right away
+  bool m_isFilling;
+  ndn::util::scheduler::EventId m_resumeEvent;
+  bool m_isPaused;
+
+  Metric& m_outstandingMetric;
+  Metric& m_missingMetric;
+  Metric& m_fetchedMetric;
+  Metric& m_retriesMetric;
+  Metric& m_givenUpMetric;
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_SYNC_FETCHER_HPP
@@ -0,0 +1,167 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/table-snapshot.hpp"
+#include "util/compression.hpp"
+
+#include <json/reader.h>
+#include <json/value.h>
+#include <json/writer.h>
+
+namespace atmos {
+namespace util {
+
+// plain bytes handed to the deflater at once
+static const size_t PLAIN_CHUNK_SIZE = 64 * 1024;
+
+TableSnapshot::Writer::Writer(const SessionVector& vector)
+{
+  Json::Value sessions(Json::objectValue);
+  for (const auto& item : vector) {
+    sessions[item.first] = static_cast<Json::UInt64>(item.second);
+  }
+  Json::FastWriter writer;
+  // FastWriter ends the document with a newline
+  m_plain = writer.write(sessions);
+}
+
+void
+TableSnapshot::Writer::addName(const std::string& name)
+{
+  m_plain.append(name);
+  m_plain.push_back('\n');
+  if (m_plain.size() >= PLAIN_CHUNK_SIZE) {
+    flush();
+  }
+}
+
+void
+TableSnapshot::Writer::finish()
+{
+  flush();
+  m_deflater.finish(m_output);
+}
+
+std::string
+TableSnapshot::Writer::takeOutput()
+{
+  std::string output;
+  output.swap(m_output);
+  return output;
+}
+
+void
+TableSnapshot::Writer::flush()
+{
+  m_deflater.write(m_plain.data(), m_plain.size(), m_output);
+  m_plain.clear();
+}
+
+TableSnapshot::Reader::Reader()
+  : m_hasVector(false)
+{
+}
+
+void
+TableSnapshot::Reader::write(const char* data, size_t size)
+{
+  try {
+    m_inflater.write(data, size, m_plain);
+  }
+  catch (const CompressionError& e) {
+    throw Error(std::string("Malformed snapshot encoding: ") + e.what());
+  }
+
+  size_t begin = 0;
+  for (size_t end = m_plain.find('\n'); end != std::string::npos;
+       begin = end + 1, end = m_plain.find('\n', begin)) {
+    if (!m_hasVector) {
+      parseVector(m_plain.substr(begin, end - begin));
+      m_hasVector = true;
+    }
+    else {
+      m_names.push_back(m_plain.substr(begin, end - begin));
+    }
+  }
+  m_plain.erase(0, begin);
+}
+
+void
+TableSnapshot::Reader::finish()
+{
+  if (!m_inflater.isFinished()) {
+    throw Error("Truncated snapshot");
+  }
+  if (!m_hasVector) {
+    throw Error("Snapshot without session vector");
+  }
+  if (!m_plain.empty()) {
+    throw Error("Truncated snapshot");
+  }
+}
+
+std::vector<std::string>
+TableSnapshot::Reader::takeNames()
+{
+  std::vector<std::string> names;
+  names.swap(m_names);
+  return names;
+}
+
+void
+TableSnapshot::Reader::parseVector(const std::string& line)
+{
+  Json::Value sessions;
+  Json::Reader reader;
+  if (!reader.parse(line, sessions) || !sessions.isObject()) {
+    throw Error("Malformed snapshot session vector");
+  }
+  for (const auto& session : sessions.getMemberNames()) {
+    if (!sessions[session].isUInt64()) {
+      throw Error("Malformed sequence number of session " + session);
+    }
+    m_vector[session] = sessions[session].asUInt64();
+  }
+}
+
+std::string
+TableSnapshot::encode() const
+{
+  Writer writer(vector);
+  for (const auto& name : names) {
+    writer.addName(name);
+  }
+  writer.finish();
+  return writer.takeOutput();
+}
+
+TableSnapshot
+TableSnapshot::decode(const std::string& encoded)
+{
+  Reader reader;
+  reader.write(encoded.data(), encoded.size());
+  reader.finish();
+
+  TableSnapshot snapshot;
+  snapshot.vector = reader.getVector();
+  snapshot.names = reader.takeNames();
+  return snapshot;
+}
+
+} // namespace util
+} // namespace atmos
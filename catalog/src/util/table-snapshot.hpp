@@ -0,0 +1,167 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_TABLE_SNAPSHOT_HPP
+#define ATMOS_UTIL_TABLE_SNAPSHOT_HPP
+
+#include "util/compression.hpp"
+
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace atmos {
+namespace util {
+
+/**
+ * TableSnapshot is the content of a catalog's data table at a point of its ChronoSync history:
+ * the names in the table, and for each sync session, the sequence number up to which its
+ * updates are included. A catalog that joins the sync group loads a snapshot of a peer, then only
+ * fetches the updates past its session vector.
+ *
+ * The snapshot is encoded as the JSON object of the session vector on the first line, then one
+ * name per line, compressed with zlib. A large table is encoded with a Writer and decoded with a
+ * Reader, a page of names at a time, so that only its compressed form is held.
+ */
+class TableSnapshot
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  // session name -> sequence number
+  typedef std::map<std::string, uint64_t> SessionVector;
+
+  /**
+   * Writer encodes a snapshot, the session vector first, then the names as they are read
+   */
+  class Writer
+  {
+  public:
+    explicit
+    Writer(const SessionVector& vector);
+
+    void
+    addName(const std::string& name);
+
+    /**
+     * End the encoding, no name is added afterwards
+     */
+    void
+    finish();
+
+    /**
+     * @return the compressed bytes produced since the last call
+     */
+    std::string
+    takeOutput();
+
+  private:
+    void
+    flush();
+
+  private:
+    Deflater m_deflater;
+    // names not yet handed to the deflater
+    std::string m_plain;
+    std::string m_output;
+  };
+
+  /**
+   * Reader decodes a snapshot from the pieces of its encoding, in order, e.g., as the segments
+   * of its Data are fetched
+   */
+  class Reader
+  {
+  public:
+    Reader();
+
+    /**
+     * Decode the next piece of the encoding
+     *
+     * @throw Error if the encoding is malformed
+     */
+    void
+    write(const char* data, size_t size);
+
+    /**
+     * @throw Error if the encoding is truncated
+     */
+    void
+    finish();
+
+    /**
+     * @return the session vector, empty until the first line is decoded
+     */
+    const SessionVector&
+    getVector() const
+    {
+      return m_vector;
+    }
+
+    /**
+     * @return the names decoded since the last call
+     */
+    std::vector<std::string>
+    takeNames();
+
+  private:
+    void
+    parseVector(const std::string& line);
+
+  private:
+    Inflater m_inflater;
+    // the decompressed data past the last complete line
+    std::string m_plain;
+    bool m_hasVector;
+    SessionVector m_vector;
+    std::vector<std::string> m_names;
+  };
+
+  /**
+   * @return the compressed encoding of the snapshot
+   */
+  std::string
+  encode() const;
+
+  /**
+   * Decode a snapshot encoded by encode
+   *
+   * @throw Error if the encoding is malformed
+   */
+  static TableSnapshot
+  decode(const std::string& encoded);
+
+public:
+  SessionVector vector;
+  std::vector<std::string> names;
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_TABLE_SNAPSHOT_HPP
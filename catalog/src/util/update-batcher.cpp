@@ -0,0 +1,131 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/update-batcher.hpp"
+#include "util/compression.hpp"
+
+#include <json/value.h>
+#include <json/writer.h>
+
+namespace atmos {
+namespace util {
+
+UpdateBatcher::Options::Options()
+  : maxDelay(500)
+  , maxNames(10000)
+  , maxPayloadSize(7000)
+  , canCompress(false)
+{
+}
+
+UpdateBatcher::UpdateBatcher(ndn::util::scheduler::Scheduler& scheduler,
+                             const Options& options,
+                             const PublishCallback& publish,
+                             const std::string& name)
+  : m_scheduler(scheduler)
+  , m_options(options)
+  , m_publish(publish)
+  , m_isFlushScheduled(false)
+  , m_updatesMetric(MetricsRegistry::getDefault().get(name + ".batch.updates"))
+  , m_namesMetric(MetricsRegistry::getDefault().get(name + ".batch.names"))
+{
+}
+
+UpdateBatcher::~UpdateBatcher()
+{
+  if (m_isFlushScheduled) {
+    m_scheduler.cancelEvent(m_flushEvent);
+  }
+}
+
+void
+UpdateBatcher::add(const std::string& name)
+{
+  m_changes[name] = true;
+  onChange();
+}
+
+void
+UpdateBatcher::remove(const std::string& name)
+{
+  m_changes[name] = false;
+  onChange();
+}
+
+void
+UpdateBatcher::onChange()
+{
+  if (m_changes.size() >= m_options.maxNames) {
+    flush();
+  }
+  else if (!m_isFlushScheduled) {
+    m_isFlushScheduled = true;
+    m_flushEvent = m_scheduler.scheduleEvent(m_options.maxDelay,
+                                             std::bind(&UpdateBatcher::flush, this));
+  }
+}
+
+void
+UpdateBatcher::flush()
+{
+  if (m_isFlushScheduled) {
+    m_scheduler.cancelEvent(m_flushEvent);
+    m_isFlushScheduled = false;
+  }
+  if (m_changes.empty()) {
+    return;
+  }
+
+  std::vector<std::pair<std::string, bool>> changes(m_changes.begin(), m_changes.end());
+  m_changes.clear();
+  m_namesMetric.add(changes.size());
+  publish(changes.begin(), changes.end());
+}
+
+void
+UpdateBatcher::publish(ChangeIterator begin, ChangeIterator end)
+{
+  std::string payload = encode(begin, end);
+  if (payload.size() > m_options.maxPayloadSize && m_options.canCompress) {
+    payload = compress(payload);
+  }
+  // the halves are published as updates of their own, a single name is published anyway
+  if (payload.size() > m_options.maxPayloadSize && end - begin > 1) {
+    ChangeIterator middle = begin + (end - begin) / 2;
+    publish(begin, middle);
+    publish(middle, end);
+    return;
+  }
+
+  m_updatesMetric.add();
+  m_publish(payload);
+}
+
+std::string
+UpdateBatcher::encode(ChangeIterator begin, ChangeIterator end)
+{
+  Json::Value update(Json::objectValue);
+  for (ChangeIterator change = begin; change != end; ++change) {
+    update[change->second ? "add" : "remove"].append(change->first);
+  }
+  Json::FastWriter writer;
+  return writer.write(update);
+}
+
+} // namespace util
+} // namespace atmos
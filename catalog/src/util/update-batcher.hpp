@@ -0,0 +1,142 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#ifndef ATMOS_UTIL_UPDATE_BATCHER_HPP
+#define ATMOS_UTIL_UPDATE_BATCHER_HPP
+
+#include "util/metrics.hpp"
+
+#include <ndn-cxx/util/scheduler.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace atmos {
+namespace util {
+
+/**
+ * UpdateBatcher coalesces the changes of the publications validated over a short window into a
+ * few sync updates, so that the other catalogs fetch and apply one update rather than one per
+ * publication segment.
+ *
+ * A name keeps the last change made to it, so the additions and the removals of an update are
+ * disjoint, and can be applied in any order. The changes are published once maxDelay elapsed
+ * since the first of them, or once maxNames names are waiting. An update is the JSON of the
+ * publications, {"add": [...], "remove": [...]}; if it does not fit in maxPayloadSize bytes,
+ * it is compressed when canCompress is set, and split into several updates while it still does
+ * not fit. The catalogs that predate compression drop the compressed updates, so it is only
+ * set once all of them decompress.
+ *
+ * The batcher reports "<name>.batch.updates" and "<name>.batch.names" to the default
+ * MetricsRegistry. It must be used from the Face's thread.
+ */
+class UpdateBatcher : boost::noncopyable
+{
+public:
+  struct Options
+  {
+    Options();
+
+    // delay between the first change of an update and its publication
+    ndn::time::milliseconds maxDelay;
+    // names waiting beyond which the update is published right away
+    size_t maxNames;
+    // bytes of the payload of a sync Data
+    size_t maxPayloadSize;
+    // a large update is compressed before it is split
+    bool canCompress;
+  };
+
+  // publishes the payload of a sync update
+  typedef std::function<void(const std::string& payload)> PublishCallback;
+
+  /**
+   * @param scheduler: scheduler of the Face's io_service, must outlive the batcher
+   * @param options:   window and size settings
+   * @param publish:   publishes an update
+   * @param name:      prefix of the metrics of this batcher, e.g., "sync"
+   */
+  UpdateBatcher(ndn::util::scheduler::Scheduler& scheduler,
+                const Options& options,
+                const PublishCallback& publish,
+                const std::string& name);
+
+  ~UpdateBatcher();
+
+  void
+  add(const std::string& name);
+
+  void
+  remove(const std::string& name);
+
+  /**
+   * Publish the waiting changes now
+   */
+  void
+  flush();
+
+  /**
+   * @return the number of names waiting
+   */
+  size_t
+  size() const
+  {
+    return m_changes.size();
+  }
+
+private:
+  typedef std::vector<std::pair<std::string, bool>>::const_iterator ChangeIterator;
+
+  void
+  onChange();
+
+  /**
+   * Publish the changes in [begin, end), in one update if they fit
+   */
+  void
+  publish(ChangeIterator begin, ChangeIterator end);
+
+  /**
+   * @return the JSON of the changes in [begin, end)
+   */
+  static std::string
+  encode(ChangeIterator begin, ChangeIterator end);
+
+private:
+  ndn::util::scheduler::Scheduler& m_scheduler;
+  const Options m_options;
+  PublishCallback m_publish;
+
+  // name -> true if the last change added it, sorted so that the updates compress well
+  std::map<std::string, bool> m_changes;
+  ndn::util::scheduler::EventId m_flushEvent;
+  bool m_isFlushScheduled;
+
+  Metric& m_updatesMetric;
+  Metric& m_namesMetric;
+};
+
+} // namespace util
+} // namespace atmos
+
+#endif // ATMOS_UTIL_UPDATE_BATCHER_HPP
@@ -0,0 +1,82 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "publish/publication-session.hpp"
+#include "boost-test.hpp"
+
+namespace atmos{
+namespace tests{
+
+  BOOST_AUTO_TEST_SUITE(PublicationSessionTestSuite)
+
+  BOOST_AUTO_TEST_CASE(SessionPerPublisherAndNonce)
+  {
+    publish::PublicationSessionTable sessions(10);
+    ndn::Name publisher1("/cmip5/publisher1");
+    ndn::Name publisher2("/cmip5/publisher2");
+    ndn::name::Component nonce1("nonce1");
+    ndn::name::Component nonce2("nonce2");
+
+    std::shared_ptr<publish::PublicationSession> session = sessions.insert(publisher1, nonce1);
+    BOOST_REQUIRE(session != nullptr);
+    BOOST_CHECK_EQUAL(session->getName(), ndn::Name("/cmip5/publisher1/nonce1"));
+    BOOST_CHECK_EQUAL(session->nSegments, 0);
+
+    // the same publication cannot have two sessions
+    BOOST_CHECK(sessions.insert(publisher1, nonce1) == nullptr);
+
+    // other publishers and other publications of the same publisher run in parallel
+    BOOST_CHECK(sessions.insert(publisher1, nonce2) != nullptr);
+    BOOST_CHECK(sessions.insert(publisher2, nonce1) != nullptr);
+    BOOST_CHECK_EQUAL(sessions.size(), 3);
+
+    session->nSegments++;
+    BOOST_CHECK_EQUAL(sessions.find(publisher1, nonce1)->nSegments, 1);
+    BOOST_CHECK_EQUAL(sessions.find(publisher2, nonce1)->nSegments, 0);
+
+    sessions.erase(publisher1, nonce1);
+    BOOST_CHECK(sessions.find(publisher1, nonce1) == nullptr);
+    BOOST_CHECK(sessions.find(publisher1, nonce2) != nullptr);
+    BOOST_CHECK_EQUAL(sessions.size(), 2);
+
+    sessions.clear();
+    BOOST_CHECK_EQUAL(sessions.size(), 0);
+  }
+
+  BOOST_AUTO_TEST_CASE(MaxSessions)
+  {
+    publish::PublicationSessionTable sessions(2);
+    ndn::Name publisher("/cmip5/publisher");
+
+    BOOST_CHECK(sessions.insert(publisher, ndn::name::Component("1")) != nullptr);
+    BOOST_CHECK(sessions.insert(publisher, ndn::name::Component("2")) != nullptr);
+    BOOST_CHECK(sessions.isFull());
+    BOOST_CHECK(sessions.insert(publisher, ndn::name::Component("3")) == nullptr);
+
+    sessions.erase(publisher, ndn::name::Component("1"));
+    BOOST_CHECK(sessions.insert(publisher, ndn::name::Component("3")) != nullptr);
+
+    sessions.setMaxSessions(3);
+    BOOST_CHECK(sessions.insert(publisher, ndn::name::Component("4")) != nullptr);
+    BOOST_CHECK_EQUAL(sessions.size(), 3);
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
@@ -26,6 +26,8 @@
 #include <ndn-cxx/util/dummy-client-face.hpp>
 #include <boost/property_tree/info_parser.hpp>
 
+#include <list>
+
 namespace atmos{
 namespace tests{
 
@@ -82,11 +84,30 @@ namespace tests{
     }
 
     bool
-    testJson2Sql(std::stringstream& sqlString,
-                 Json::Value& jsonValue,
-                 util::DatabaseOperation operation)
+    testJson2Names(Json::Value& jsonValue,
+                   util::DatabaseOperation operation,
+                   std::vector<std::string>& names)
+    {
+      return json2Names(jsonValue, operation, names);
+    }
+
+    bool
+    testNames2Statement(const std::vector<std::string>& names,
+                        util::DatabaseOperation operation,
+                        util::BulkStatement& statement)
+    {
+      // the statement points into the digests
+      m_digests.push_back(std::vector<std::string>());
+      for (const auto& name : names) {
+        m_digests.back().push_back(digestName(name));
+      }
+      return names2Statement(names, m_digests.back(), operation, statement);
+    }
+
+    util::BulkStatement
+    testMakeStatement(util::DatabaseOperation operation)
     {
-      return json2Sql(sqlString, jsonValue, operation);
+      return makeStatement(operation);
     }
 
     bool
@@ -101,6 +122,9 @@ namespace tests{
     {
       return validatePublicationChanges(data);
     }
+
+  private:
+    std::list<std::vector<std::string>> m_digests;
   };
 
   class PublishAdapterFixture : public UnitTestTimeFixture
@@ -268,22 +292,33 @@ namespace tests{
     testJson["remove"][1] = "/a/b/c/d";
     testJson["remove"][2] = "/test/for/remove";
 
-    std::stringstream ss;
+    auto quote = [] (const util::ValueRef& value) {
+      return "'" + std::string(value.data, value.size) + "'";
+    };
+
+    std::vector<std::string> added;
     std::string expectRes1 = "INSERT INTO cmip5 (sha256, name, activity, product, organization, \
 model, experiment, frequency, modeling_realm, variable_name, ensemble, time) VALUES(\
 '3738C9C0E0297DE7FE0EE538030597442DEEFF0F2C88778404D7B6E4BAD589F6','/1/2/3/4/5/6/7/8/9/10',\
 '1','2','3','4','5','6','7','8','9','10'),\
 ('F93128EE9B7769105C6BDF6AA0FAA8CB4ED429395DDBC2CDDBFBA05F35B320FB','ndn:/a/b/c/d/eee/f/gg/h/iiii/j'\
-,'a','b','c','d','eee','f','gg','h','iiii','j');";
-    BOOST_CHECK_EQUAL(publishAdapterTest1.testJson2Sql(ss, testJson, util::ADD), true);
-    BOOST_CHECK_EQUAL(ss.str(), expectRes1);
-
-    ss.str("");
-    ss.clear();
-    std::string expectRes2 = "DELETE FROM cmip5 WHERE name IN ('ndn:/1/2/3/4/5/6/7/8/9/10',\
-'/a/b/c/d','/test/for/remove');";
-    BOOST_CHECK_EQUAL(publishAdapterTest1.testJson2Sql(ss, testJson, util::REMOVE), true);
-    BOOST_CHECK_EQUAL(ss.str(), expectRes2);
+,'a','b','c','d','eee','f','gg','h','iiii','j') ON DUPLICATE KEY UPDATE sha256=sha256";
+    BOOST_CHECK_EQUAL(publishAdapterTest1.testJson2Names(testJson, util::ADD, added), true);
+    util::BulkStatement insert = publishAdapterTest1.testMakeStatement(util::ADD);
+    BOOST_CHECK_EQUAL(publishAdapterTest1.testNames2Statement(added, util::ADD, insert), true);
+    BOOST_CHECK_EQUAL(insert.getNRows(), 2);
+    BOOST_CHECK_EQUAL(insert.toSql(quote), expectRes1);
+
+    std::vector<std::string> removed;
+    std::string expectRes2 = "DELETE FROM cmip5 WHERE sha256 IN (\
+'" + util::sha256Hex("ndn:/1/2/3/4/5/6/7/8/9/10") + "','" + util::sha256Hex("/a/b/c/d") + "','"
+      + util::sha256Hex("/test/for/remove") + "')";
+    BOOST_CHECK_EQUAL(publishAdapterTest1.testJson2Names(testJson, util::REMOVE, removed), true);
+    util::BulkStatement remove = publishAdapterTest1.testMakeStatement(util::REMOVE);
+    BOOST_CHECK_EQUAL(publishAdapterTest1.testNames2Statement(removed, util::REMOVE, remove),
+                      true);
+    BOOST_CHECK_EQUAL(remove.getNRows(), 3);
+    BOOST_CHECK_EQUAL(remove.toSql(quote), expectRes2);
   }
 
   BOOST_AUTO_TEST_CASE(PublishAdapterSqlStringFailureTest)
@@ -291,8 +326,13 @@ model, experiment, frequency, modeling_realm, variable_name, ensemble, time) VAL
     Json::Value testJson;
     testJson["add"][0] = "/1/2/3/4/5/6/7/8/9/10";
     testJson["add"][1] = "/a/b/c/d/eee/f/gg/h/iiii/j/kkk"; //too much components
-    std::stringstream ss;
-    bool res = publishAdapterTest1.testJson2Sql(ss, testJson, util::REMOVE);
+    std::vector<std::string> names;
+    bool res = publishAdapterTest1.testJson2Names(testJson, util::REMOVE, names);
+    BOOST_CHECK(res == false);
+
+    BOOST_CHECK_EQUAL(publishAdapterTest1.testJson2Names(testJson, util::ADD, names), true);
+    util::BulkStatement insert = publishAdapterTest1.testMakeStatement(util::ADD);
+    res = publishAdapterTest1.testNames2Statement(names, util::ADD, insert);
     BOOST_CHECK(res == false);
   }
 
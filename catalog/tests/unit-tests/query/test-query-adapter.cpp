@@ -119,9 +119,7 @@ namespace tests{
       std::shared_ptr<ndn::Data> data = makeReplyData(segmentPrefix,
                                                       fileList, 0, true, false,
                                                       3, 0, 2, true);
-      m_mutex.lock();
       m_cache.insert(*data);
-      m_mutex.unlock();
     }
 
     std::shared_ptr<const ndn::Data>
@@ -138,12 +136,12 @@ namespace tests{
     }
 
     bool
-    json2AutocompletionSqlTest(std::stringstream& sqlQuery,
+    json2AutocompletionSqlTest(query::QueryPlan& plan,
                                Json::Value& jsonValue,
                                bool& lastComponent,
                                std::stringstream& nameField)
     {
-      return json2AutocompletionSql(sqlQuery, jsonValue, lastComponent, nameField);
+      return json2AutocompletionSql(plan, jsonValue, lastComponent, nameField);
     }
 
     bool
@@ -379,123 +377,138 @@ namespace tests{
   {
     initializeQueryAdapterTest2();
 
-    std::stringstream ss, nameField;
+    query::QueryPlan plan;
+    std::stringstream nameField;
     Json::Value testJson;
     bool lastComponent = false;
     testJson["?"] = "/";
     BOOST_CHECK_EQUAL(true,
-                      queryAdapterTest2.json2AutocompletionSqlTest(ss,
+                      queryAdapterTest2.json2AutocompletionSqlTest(plan,
                                                                    testJson,
                                                                    lastComponent,
                                                                    nameField));
     BOOST_CHECK_EQUAL(lastComponent, false);
-    BOOST_CHECK_EQUAL(";", ss.str());
+    BOOST_CHECK_EQUAL("", plan.getWhereClause());
     BOOST_CHECK_EQUAL("activity", nameField.str());
 
-    ss.str("");
-    ss.clear();
+    plan = query::QueryPlan();
     nameField.str("");
     nameField.clear();
     testJson.clear();
     testJson["?"] = "/Activity/";
     BOOST_CHECK_EQUAL(true,
-                      queryAdapterTest2.json2AutocompletionSqlTest(ss,
+                      queryAdapterTest2.json2AutocompletionSqlTest(plan,
                                                                    testJson,
                                                                    lastComponent,
                                                                    nameField));
     BOOST_CHECK_EQUAL(lastComponent, false);
-    BOOST_CHECK_EQUAL(" WHERE activity='Activity';", ss.str());
+    BOOST_CHECK_EQUAL(" WHERE activity = ?", plan.getWhereClause());
+    BOOST_REQUIRE_EQUAL(plan.getValues().size(), 1);
+    BOOST_CHECK_EQUAL("Activity", plan.getValues()[0]);
     BOOST_CHECK_EQUAL("product", nameField.str());
 
-    ss.str("");
-    ss.clear();
+    plan = query::QueryPlan();
     nameField.str("");
     nameField.clear();
     testJson.clear();
     testJson["?"] = "/Activity/Product/Organization/Model/Experiment/";
     BOOST_CHECK_EQUAL(true,
-                      queryAdapterTest2.json2AutocompletionSqlTest(ss,
+                      queryAdapterTest2.json2AutocompletionSqlTest(plan,
                                                                    testJson,
                                                                    lastComponent,
                                                                    nameField));
     BOOST_CHECK_EQUAL(lastComponent, false);
-    BOOST_CHECK_EQUAL(" WHERE activity='Activity' AND \
-experiment='Experiment' AND model='Model' AND organization='Organization' AND product='Product';",
-     ss.str());
+    BOOST_CHECK_EQUAL(" WHERE activity = ? AND experiment = ? AND model = ? AND organization = ? \
+AND product = ?", plan.getWhereClause());
+    std::vector<std::string> values = plan.getValues();
+    std::vector<std::string> expected = {"Activity", "Experiment", "Model", "Organization",
+                                         "Product"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expected.begin(), expected.end());
     BOOST_CHECK_EQUAL("frequency", nameField.str());
 
-    ss.str("");
-    ss.clear();
+    plan = query::QueryPlan();
     nameField.str("");
     nameField.clear();
     testJson.clear();
     testJson["?"] = "/Activity/Product/Organization/Model/Experiment/Frequency/Modeling/\
 Variable/Ensemble/";
     BOOST_CHECK_EQUAL(true,
-                      queryAdapterTest2.json2AutocompletionSqlTest(ss,
+                      queryAdapterTest2.json2AutocompletionSqlTest(plan,
                                                                    testJson,
                                                                    lastComponent,
                                                                    nameField));
     BOOST_CHECK_EQUAL(lastComponent, true);
-    BOOST_CHECK_EQUAL(" WHERE activity='Activity' AND ensemble=\
-'Ensemble' AND experiment='Experiment' AND frequency='Frequency' AND model='Model' AND \
-modeling_realm='Modeling' AND organization='Organization' AND product='Product' AND variable_name=\
-'Variable';",ss.str());
+    BOOST_CHECK_EQUAL(" WHERE activity = ? AND ensemble = ? AND experiment = ? AND frequency = ? \
+AND model = ? AND modeling_realm = ? AND organization = ? AND product = ? AND variable_name = ?",
+                      plan.getWhereClause());
+    BOOST_CHECK_EQUAL(plan.getValues().size(), 9);
     BOOST_CHECK_EQUAL("time", nameField.str());
+
+    // the typed values are bound, they cannot change the statement
+    plan = query::QueryPlan();
+    nameField.str("");
+    nameField.clear();
+    testJson.clear();
+    testJson["?"] = "/Activity' OR '1'='1/";
+    BOOST_CHECK_EQUAL(true,
+                      queryAdapterTest2.json2AutocompletionSqlTest(plan,
+                                                                   testJson,
+                                                                   lastComponent,
+                                                                   nameField));
+    BOOST_CHECK_EQUAL(" WHERE activity = ?", plan.getWhereClause());
+    BOOST_REQUIRE_EQUAL(plan.getValues().size(), 1);
+    BOOST_CHECK_EQUAL("Activity' OR '1'='1", plan.getValues()[0]);
   }
 
   BOOST_AUTO_TEST_CASE(QueryAdapterAutocompletionSqlFailTest)
   {
     initializeQueryAdapterTest2();
 
-    std::stringstream ss, nameField;
+    query::QueryPlan plan;
+    std::stringstream nameField;
     Json::Value testJson;
     bool lastComponent = false;
     testJson["?"] = "serchTest";
     BOOST_CHECK_EQUAL(false,
-                      queryAdapterTest2.json2AutocompletionSqlTest(ss,
+                      queryAdapterTest2.json2AutocompletionSqlTest(plan,
                                                                    testJson,
                                                                    lastComponent,
                                                                    nameField));
 
-    ss.str("");
-    ss.clear();
+    plan = query::QueryPlan();
     nameField.str("");
     nameField.clear();
     testJson.clear();
     testJson["?"] = "/cmip5";
     BOOST_CHECK_EQUAL(false,
-                      queryAdapterTest2.json2AutocompletionSqlTest(ss,
+                      queryAdapterTest2.json2AutocompletionSqlTest(plan,
                                                                    testJson,
                                                                    lastComponent,
                                                                    nameField));
 
-    ss.str("");
-    ss.clear();
+    plan = query::QueryPlan();
     nameField.str("");
     nameField.clear();
     Json::Value testJson2; //simply clear does not work
     testJson2[0] = "test";
     BOOST_CHECK_EQUAL(false,
-                      queryAdapterTest2.json2AutocompletionSqlTest(ss,
+                      queryAdapterTest2.json2AutocompletionSqlTest(plan,
                                                                    testJson,
                                                                    lastComponent,
                                                                    nameField));
 
-    ss.str("");
-    ss.clear();
+    plan = query::QueryPlan();
     nameField.str("");
     nameField.clear();
     Json::Value testJson3;
     testJson3 = Json::Value(Json::arrayValue);
     BOOST_CHECK_EQUAL(false,
-                      queryAdapterTest2.json2AutocompletionSqlTest(ss,
+                      queryAdapterTest2.json2AutocompletionSqlTest(plan,
                                                                    testJson,
                                                                    lastComponent,
                                                                    nameField));
 
-    ss.str("");
-    ss.clear();
+    plan = query::QueryPlan();
     nameField.str("");
     nameField.clear();
     Json::Value testJson4;
@@ -503,7 +516,7 @@ modeling_realm='Modeling' AND organization='Organization' AND product='Product'
     param[0] = "test";
     testJson4["name"] = param;
     BOOST_CHECK_EQUAL(false,
-                      queryAdapterTest2.json2AutocompletionSqlTest(ss,
+                      queryAdapterTest2.json2AutocompletionSqlTest(plan,
                                                                    testJson,
                                                                    lastComponent,
                                                                    nameField));
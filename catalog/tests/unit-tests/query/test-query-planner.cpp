@@ -0,0 +1,91 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "query/query-planner.hpp"
+#include "boost-test.hpp"
+
+namespace atmos{
+namespace tests{
+
+  BOOST_AUTO_TEST_SUITE(QueryPlannerTestSuite)
+
+  BOOST_AUTO_TEST_CASE(ConstrainedPredicatesOnly)
+  {
+    query::QueryPlanner planner({"activity", "product", "organization", "model"});
+
+    std::vector<std::pair<std::string, std::string>> queryParams;
+    queryParams.push_back(std::make_pair("model", "CSIRO%"));
+    queryParams.push_back(std::make_pair("product", "output1"));
+    queryParams.push_back(std::make_pair("organization", "%"));
+    queryParams.push_back(std::make_pair("unknown", "value"));
+
+    query::QueryPlan plan = planner.plan(queryParams);
+    BOOST_CHECK_EQUAL(plan.getWhereClause(), " WHERE product = ? AND model LIKE ?");
+    std::vector<std::string> expectedValues = {"output1", "CSIRO%"};
+    std::vector<std::string> values = plan.getValues();
+    BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(),
+                                  expectedValues.begin(), expectedValues.end());
+    BOOST_CHECK(plan.index.empty());
+
+    // nothing constrained, no WHERE clause at all
+    queryParams.clear();
+    queryParams.push_back(std::make_pair("activity", "%%"));
+    BOOST_CHECK_EQUAL(planner.plan(queryParams).getWhereClause(), "");
+  }
+
+  BOOST_AUTO_TEST_CASE(Wildcards)
+  {
+    BOOST_CHECK(!query::QueryPlanner::hasWildcard("CMIP5"));
+    BOOST_CHECK(query::QueryPlanner::hasWildcard("CMIP%"));
+    BOOST_CHECK(query::QueryPlanner::hasWildcard("CMIP_"));
+    BOOST_CHECK(query::QueryPlanner::hasWildcard("CMIP\\5"));
+  }
+
+  BOOST_AUTO_TEST_CASE(IndexOrder)
+  {
+    query::QueryPlanner planner({"activity", "product", "organization", "model"});
+    std::vector<std::pair<std::string, std::vector<std::string>>> indexes;
+    indexes.push_back(std::make_pair("activity_model",
+                                     std::vector<std::string>{"activity", "model"}));
+    indexes.push_back(std::make_pair("model_organization_product",
+                                     std::vector<std::string>{"model", "organization",
+                                                              "product"}));
+    planner.setIndexes(indexes);
+
+    std::vector<std::pair<std::string, std::string>> queryParams;
+    queryParams.push_back(std::make_pair("product", "output1"));
+    queryParams.push_back(std::make_pair("organization", "CSIRO%"));
+    queryParams.push_back(std::make_pair("model", "ACCESS1-0"));
+
+    // activity is not constrained, so the second index fits best
+    query::QueryPlan plan = planner.plan(queryParams);
+    BOOST_CHECK_EQUAL(plan.index, "model_organization_product");
+    BOOST_CHECK_EQUAL(plan.getWhereClause(),
+                      " WHERE model = ? AND organization LIKE ? AND product = ?");
+
+    queryParams.push_back(std::make_pair("activity", "CMIP5"));
+    plan = planner.plan(queryParams);
+    BOOST_CHECK_EQUAL(plan.index, "activity_model");
+    BOOST_CHECK_EQUAL(plan.getWhereClause(),
+                      " WHERE activity = ? AND model = ? AND product = ? AND organization LIKE ?");
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
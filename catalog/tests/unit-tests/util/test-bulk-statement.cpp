@@ -0,0 +1,104 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/bulk-statement.hpp"
+#include "boost-test.hpp"
+
+namespace atmos{
+namespace tests{
+
+  BOOST_AUTO_TEST_SUITE(BulkStatementTestSuite)
+
+  static std::string
+  quote(const util::ValueRef& value)
+  {
+    return "'" + std::string(value.data, value.size) + "'";
+  }
+
+  BOOST_AUTO_TEST_CASE(Insert)
+  {
+    util::BulkStatement statement = util::BulkStatement::insert("cmip5", {"name", "model"});
+    BOOST_CHECK(statement.empty());
+
+    std::string name("/a/b");
+    statement.addValue(name.data(), name.size());
+    statement.addValue(name.data() + 3, 1);
+    statement.addOwnedValue("/c/d");
+    statement.addOwnedValue("d");
+    BOOST_CHECK_EQUAL(statement.getNRows(), 2);
+
+    BOOST_CHECK_EQUAL(statement.getSql(2), "INSERT INTO cmip5 (name, model) VALUES(?,?),(?,?)");
+    BOOST_CHECK_EQUAL(statement.toSql(&quote),
+                      "INSERT INTO cmip5 (name, model) VALUES('/a/b','b'),('/c/d','d')");
+
+    // a row that cannot be completed is dropped
+    statement.addOwnedValue("/e/f");
+    statement.discardPartialRow();
+    BOOST_CHECK_EQUAL(statement.getValues().size(), 4);
+  }
+
+  BOOST_AUTO_TEST_CASE(Upsert)
+  {
+    util::BulkStatement mysql = util::BulkStatement::upsert("cmip5", {"sha256", "name"}, "sha256",
+                                                            util::DIALECT_MYSQL);
+    BOOST_CHECK_EQUAL(mysql.getSql(2), "INSERT INTO cmip5 (sha256, name) VALUES(?,?),(?,?) \
+ON DUPLICATE KEY UPDATE sha256=sha256");
+
+    util::BulkStatement sqlite = util::BulkStatement::upsert("cmip5", {"sha256", "name"},
+                                                             "sha256", util::DIALECT_SQLITE);
+    sqlite.addOwnedValue("A1");
+    sqlite.addOwnedValue("/a");
+    BOOST_CHECK_EQUAL(sqlite.toSql(&quote),
+                      "INSERT OR IGNORE INTO cmip5 (sha256, name) VALUES('A1','/a')");
+  }
+
+  BOOST_AUTO_TEST_CASE(Remove)
+  {
+    util::BulkStatement statement = util::BulkStatement::remove("cmip5", "name");
+    statement.addOwnedValue("/a");
+    statement.addOwnedValue("/b");
+
+    BOOST_CHECK_EQUAL(statement.getSql(2), "DELETE FROM cmip5 WHERE name IN (?,?)");
+    BOOST_CHECK_EQUAL(statement.toSql(&quote), "DELETE FROM cmip5 WHERE name IN ('/a','/b')");
+  }
+
+  BOOST_AUTO_TEST_CASE(Chunks)
+  {
+    util::BulkStatement statement = util::BulkStatement::remove("cmip5", "name");
+    for (int i = 0; i < 128 + 2 * 32 + 8 + 3; ++i) {
+      statement.addOwnedValue(std::to_string(i));
+    }
+    std::vector<size_t> expected = {128, 32, 32, 8, 1, 1, 1};
+    std::vector<size_t> chunks = statement.getChunks();
+    BOOST_CHECK_EQUAL_COLLECTIONS(chunks.begin(), chunks.end(), expected.begin(), expected.end());
+
+    // the chunks stay within the parameters a statement can bind
+    util::BulkStatement wide = util::BulkStatement::insert("cmip5",
+                                                           std::vector<std::string>(12, "c"));
+    for (int i = 0; i < 12 * 100; ++i) {
+      wide.addOwnedValue("v");
+    }
+    expected = {32, 32, 32, 1, 1, 1, 1};
+    chunks = wide.getChunks();
+    BOOST_CHECK_EQUAL_COLLECTIONS(chunks.begin(), chunks.end(), expected.begin(), expected.end());
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
@@ -0,0 +1,50 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/catalog-snapshot.hpp"
+#include "boost-test.hpp"
+
+namespace atmos{
+namespace tests{
+
+  BOOST_AUTO_TEST_SUITE(CatalogSnapshotTestSuite)
+
+  BOOST_AUTO_TEST_CASE(PinAndAdvance)
+  {
+    util::SnapshotHolder holder("0");
+    std::shared_ptr<const util::CatalogSnapshot> pinned = holder.pin();
+    BOOST_CHECK_EQUAL(pinned->version, 0);
+    BOOST_CHECK_EQUAL(pinned->digest, "0");
+
+    // same digest, nothing is published
+    BOOST_CHECK(!holder.advance("0"));
+    BOOST_CHECK_EQUAL(holder.pin(), pinned);
+
+    BOOST_CHECK(holder.advance("abcd"));
+    BOOST_CHECK_EQUAL(holder.pin()->version, 1);
+    BOOST_CHECK_EQUAL(holder.pin()->digest, "abcd");
+
+    // the pinned snapshot is not affected by the newer one
+    BOOST_CHECK_EQUAL(pinned->version, 0);
+    BOOST_CHECK_EQUAL(pinned->digest, "0");
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
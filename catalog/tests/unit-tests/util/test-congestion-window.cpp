@@ -0,0 +1,81 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/congestion-window.hpp"
+#include "boost-test.hpp"
+
+namespace atmos{
+namespace tests{
+
+  BOOST_AUTO_TEST_SUITE(CongestionWindowTestSuite)
+
+  BOOST_AUTO_TEST_CASE(SlowStartThenLinear)
+  {
+    util::CongestionWindow window(1, 8);
+    BOOST_CHECK_EQUAL(window.getSize(), 1);
+
+    // slow start grows by one per Data, up to the maximum
+    for (int i = 0; i < 10; ++i) {
+      window.onData();
+    }
+    BOOST_CHECK_EQUAL(window.getSize(), 8);
+
+    BOOST_CHECK(window.onTimeout(5, 20));
+    BOOST_CHECK_EQUAL(window.getSize(), 4);
+
+    // past the threshold, the window grows by one per window's worth of Data
+    for (int i = 0; i < 4; ++i) {
+      window.onData();
+    }
+    BOOST_CHECK_EQUAL(window.getSize(), 4);
+    window.onData();
+    BOOST_CHECK_EQUAL(window.getSize(), 5);
+  }
+
+  BOOST_AUTO_TEST_CASE(OneDecreasePerLossEvent)
+  {
+    util::CongestionWindow window(16, 16);
+
+    BOOST_CHECK(window.onTimeout(3, 18));
+    BOOST_CHECK_EQUAL(window.getSize(), 8);
+
+    // segments sent before the decrease belong to the same loss event
+    BOOST_CHECK(!window.onTimeout(4, 20));
+    BOOST_CHECK(!window.onTimeout(18, 20));
+    BOOST_CHECK_EQUAL(window.getSize(), 8);
+
+    BOOST_CHECK(window.onTimeout(19, 25));
+    BOOST_CHECK_EQUAL(window.getSize(), 4);
+
+    // the window never goes below one
+    BOOST_CHECK(window.onTimeout(26, 30));
+    BOOST_CHECK(window.onTimeout(31, 35));
+    BOOST_CHECK(window.onTimeout(36, 40));
+    BOOST_CHECK_EQUAL(window.getSize(), 1);
+  }
+
+  BOOST_AUTO_TEST_CASE(InitialSizeBounds)
+  {
+    BOOST_CHECK_EQUAL(util::CongestionWindow(0, 8).getSize(), 1);
+    BOOST_CHECK_EQUAL(util::CongestionWindow(20, 8).getSize(), 8);
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
@@ -0,0 +1,83 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/cuckoo-filter.hpp"
+#include "util/sha256.hpp"
+#include "boost-test.hpp"
+
+#include <string>
+
+namespace atmos{
+namespace tests{
+
+  BOOST_AUTO_TEST_SUITE(CuckooFilterTestSuite)
+
+  static uint64_t
+  key(size_t i)
+  {
+    return util::sha256HexKey(util::sha256Hex("/name/" + std::to_string(i)).c_str());
+  }
+
+  BOOST_AUTO_TEST_CASE(AddRemove)
+  {
+    util::CuckooFilter filter(1000);
+    BOOST_CHECK_GE(filter.getCapacity(), 1000);
+
+    for (size_t i = 0; i < 1000; ++i) {
+      BOOST_CHECK(filter.add(key(i)));
+    }
+    BOOST_CHECK_EQUAL(filter.size(), 1000);
+
+    for (size_t i = 0; i < 1000; ++i) {
+      BOOST_CHECK(filter.contains(key(i)));
+    }
+    size_t nFalsePositives = 0;
+    for (size_t i = 1000; i < 11000; ++i) {
+      nFalsePositives += filter.contains(key(i)) ? 1 : 0;
+    }
+    BOOST_CHECK_LT(nFalsePositives, 10);
+
+    for (size_t i = 0; i < 500; ++i) {
+      BOOST_CHECK(filter.remove(key(i)));
+    }
+    BOOST_CHECK_EQUAL(filter.size(), 500);
+    for (size_t i = 500; i < 1000; ++i) {
+      BOOST_CHECK(filter.contains(key(i)));
+    }
+
+    filter.clear();
+    BOOST_CHECK_EQUAL(filter.size(), 0);
+    BOOST_CHECK(!filter.contains(key(600)));
+  }
+
+  BOOST_AUTO_TEST_CASE(Overflow)
+  {
+    // keys beyond the capacity are dropped, not the filter
+    util::CuckooFilter filter(100);
+    size_t nAdded = 0;
+    for (size_t i = 0; i < 1000; ++i) {
+      nAdded += filter.add(key(i)) ? 1 : 0;
+    }
+    BOOST_CHECK_LT(nAdded, 1000);
+    BOOST_CHECK_LE(filter.size(), filter.getCapacity());
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
@@ -0,0 +1,125 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/digest-tree.hpp"
+#include "util/sha256.hpp"
+#include "boost-test.hpp"
+
+#include <set>
+
+namespace atmos{
+namespace tests{
+
+  BOOST_AUTO_TEST_SUITE(DigestTreeTestSuite)
+
+  // the prefixes of the leaves whose nodes differ, walking from the root like two catalogs do
+  static void
+  findDifferences(const util::DigestTree& local, const util::DigestTree& remote,
+                  const std::string& prefix, std::vector<std::string>& leaves,
+                  size_t& nRequests)
+  {
+    ++nRequests;
+    std::vector<util::DigestTree::Node> localChildren = local.getChildren(prefix);
+    std::vector<util::DigestTree::Node> remoteChildren = remote.getChildren(prefix);
+    for (size_t i = 0; i < util::DigestTree::FANOUT; ++i) {
+      if (localChildren[i] == remoteChildren[i]) {
+        continue;
+      }
+      std::string child = prefix + "0123456789ABCDEF"[i];
+      if (remoteChildren[i].count <= 4) {
+        leaves.push_back(child);
+      }
+      else {
+        findDifferences(local, remote, child, leaves, nRequests);
+      }
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(Nodes)
+  {
+    util::DigestTree tree({0x1230000000000000ULL, 0x1240000000000000ULL,
+                           0xFFFFFFFFFFFFFFFFULL, 0x0000000000000001ULL});
+    BOOST_CHECK_EQUAL(tree.size(), 4);
+    BOOST_CHECK_EQUAL(tree.getNode("").count, 4);
+    BOOST_CHECK_EQUAL(tree.getNode("1").count, 2);
+    BOOST_CHECK_EQUAL(tree.getNode("12").fingerprint,
+                      0x1230000000000000ULL ^ 0x1240000000000000ULL);
+    BOOST_CHECK_EQUAL(tree.getNode("123").count, 1);
+    BOOST_CHECK_EQUAL(tree.getNode("f").count, 1);
+    BOOST_CHECK_EQUAL(tree.getNode("FFFFFFFFFFFFFFFF").count, 1);
+    BOOST_CHECK_EQUAL(tree.getNode("0000000000000001").count, 1);
+    BOOST_CHECK_EQUAL(tree.getNode("0000000000000002").count, 0);
+
+    std::vector<util::DigestTree::Node> children = tree.getChildren("");
+    BOOST_CHECK_EQUAL(children.size(), util::DigestTree::FANOUT);
+    BOOST_CHECK_EQUAL(children[0].count, 1);
+    BOOST_CHECK_EQUAL(children[1].count, 2);
+    BOOST_CHECK_EQUAL(children[15].count, 1);
+
+    BOOST_CHECK(tree.contains(0x1240000000000000ULL));
+    BOOST_CHECK(!tree.contains(0x1250000000000000ULL));
+
+    BOOST_CHECK_THROW(tree.getNode("12G"), util::DigestTree::Error);
+    BOOST_CHECK_THROW(tree.getChildren("0000000000000000"), util::DigestTree::Error);
+  }
+
+  BOOST_AUTO_TEST_CASE(Reconcile)
+  {
+    std::vector<uint64_t> localKeys;
+    std::vector<uint64_t> remoteKeys;
+    std::set<uint64_t> missing;
+    for (int i = 0; i < 20000; ++i) {
+      uint64_t key = util::sha256HexKey(util::sha256Hex(std::to_string(i)).data());
+      remoteKeys.push_back(key);
+      // the local catalog lost a few updates
+      if (i % 4000 == 7) {
+        missing.insert(key);
+      }
+      else {
+        localKeys.push_back(key);
+      }
+    }
+
+    util::DigestTree local(localKeys);
+    util::DigestTree remote(remoteKeys);
+    BOOST_CHECK(local.getNode("") != remote.getNode(""));
+
+    std::vector<std::string> leaves;
+    size_t nRequests = 0;
+    findDifferences(local, remote, "", leaves, nRequests);
+    BOOST_CHECK_EQUAL(leaves.size(), missing.size());
+    // a few requests per missing name, rather than one per name in the table
+    BOOST_CHECK_LT(nRequests, 5 * missing.size());
+
+    // the names of the differing leaves the local catalog does not have
+    std::set<uint64_t> found;
+    for (uint64_t key : remoteKeys) {
+      for (const auto& leaf : leaves) {
+        if (key >> (64 - 4 * leaf.size()) == std::stoull(leaf, nullptr, 16) &&
+            !local.contains(key)) {
+          found.insert(key);
+        }
+      }
+    }
+    BOOST_CHECK(found == missing);
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
@@ -0,0 +1,74 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/index-provisioning.hpp"
+#include "boost-test.hpp"
+
+namespace atmos{
+namespace tests{
+
+  BOOST_AUTO_TEST_SUITE(IndexProvisioningTestSuite)
+
+  BOOST_AUTO_TEST_CASE(IndexName)
+  {
+    util::IndexDefinition index = util::IndexDefinition::fromColumns({"activity", "product"});
+    BOOST_CHECK_EQUAL(index.name, "atmos_activity_product");
+
+    std::vector<std::string> columns = {"activity", "product", "organization", "model",
+                                        "experiment", "frequency", "modeling_realm"};
+    util::IndexDefinition longIndex = util::IndexDefinition::fromColumns(columns);
+    BOOST_CHECK_EQUAL(longIndex.name.size(), 64);
+    BOOST_CHECK_EQUAL(longIndex.name, util::IndexDefinition::fromColumns(columns).name);
+    columns.pop_back();
+    columns.push_back("variable_name");
+    BOOST_CHECK_NE(longIndex.name, util::IndexDefinition::fromColumns(columns).name);
+  }
+
+  BOOST_AUTO_TEST_CASE(Changes)
+  {
+    std::vector<util::IndexDefinition> wanted;
+    wanted.push_back(util::IndexDefinition::fromColumns({"activity", "product"}));
+    wanted.push_back(util::IndexDefinition::fromColumns({"model"}));
+    wanted.push_back(util::IndexDefinition::fromColumns({"model"}));
+
+    util::TableIndexes existing;
+    existing.push_back(std::make_pair("PRIMARY", std::vector<std::string>{"id"}));
+    existing.push_back(std::make_pair("sha256", std::vector<std::string>{"sha256"}));
+    existing.push_back(std::make_pair("atmos_activity_product",
+                                      std::vector<std::string>{"activity", "product"}));
+    existing.push_back(std::make_pair("atmos_experiment",
+                                      std::vector<std::string>{"experiment"}));
+
+    util::IndexChanges changes(wanted, existing);
+    BOOST_REQUIRE_EQUAL(changes.toCreate.size(), 1);
+    BOOST_CHECK_EQUAL(changes.toCreate[0].name, "atmos_model");
+    BOOST_REQUIRE_EQUAL(changes.toDrop.size(), 1);
+    BOOST_CHECK_EQUAL(changes.toDrop[0], "atmos_experiment");
+    BOOST_CHECK_EQUAL(changes.getOnlineAlterStatement("cmip5"),
+                      "ALTER TABLE cmip5 DROP INDEX atmos_experiment, "
+                      "ADD INDEX atmos_model (model), ALGORITHM=INPLACE, LOCK=NONE;");
+
+    existing.pop_back();
+    existing.push_back(std::make_pair("atmos_model", std::vector<std::string>{"model"}));
+    BOOST_CHECK(util::IndexChanges(wanted, existing).empty());
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
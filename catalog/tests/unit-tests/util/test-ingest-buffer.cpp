@@ -0,0 +1,107 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/ingest-buffer.hpp"
+#include "boost-test.hpp"
+
+namespace atmos{
+namespace tests{
+
+  BOOST_AUTO_TEST_SUITE(IngestBufferTestSuite)
+
+  BOOST_AUTO_TEST_CASE(FoldOperations)
+  {
+    util::IngestBuffer buffer;
+    buffer.add("/a", "da");
+    buffer.add("/b", "db");
+    buffer.remove("/c", "dc");
+    buffer.add("/a", "da");
+    BOOST_CHECK_EQUAL(buffer.size(), 3);
+
+    util::IngestBatch batch = buffer.take();
+    BOOST_CHECK(buffer.empty());
+
+    std::vector<std::string> added = {"/a", "/b"};
+    std::vector<std::string> removed = {"/c"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(batch.added.begin(), batch.added.end(),
+                                  added.begin(), added.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(batch.removed.begin(), batch.removed.end(),
+                                  removed.begin(), removed.end());
+    BOOST_CHECK_EQUAL(batch.size(), 3);
+
+    std::vector<std::string> digests = {"da", "db"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(batch.addedDigests.begin(), batch.addedDigests.end(),
+                                  digests.begin(), digests.end());
+    std::vector<std::string> removedDigests = {"dc"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(batch.removedDigests.begin(), batch.removedDigests.end(),
+                                  removedDigests.begin(), removedDigests.end());
+  }
+
+  BOOST_AUTO_TEST_CASE(OrderPerName)
+  {
+    util::IngestBuffer buffer;
+    // added then removed: deleted, in case it was already in the catalog
+    buffer.add("/a", "da");
+    buffer.remove("/a", "da");
+    // removed then added: the old row is replaced
+    buffer.remove("/b", "db");
+    buffer.add("/b", "db");
+    // added, removed, added again
+    buffer.add("/c", "dc");
+    buffer.remove("/c", "dc");
+    buffer.add("/c", "dc");
+
+    util::IngestBatch batch = buffer.take();
+    std::vector<std::string> added = {"/b", "/c"};
+    std::vector<std::string> removed = {"/a", "/b", "/c"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(batch.added.begin(), batch.added.end(),
+                                  added.begin(), added.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(batch.removed.begin(), batch.removed.end(),
+                                  removed.begin(), removed.end());
+
+    BOOST_CHECK(buffer.take().empty());
+  }
+
+  BOOST_AUTO_TEST_CASE(Progress)
+  {
+    util::IngestBuffer buffer;
+    buffer.add("/a", "da");
+    buffer.setProgress("/session/1", 5);
+    buffer.setProgress("/session/2", 3);
+    buffer.setProgress("/session/1", 7);
+    // the progress is not a name, but it is written
+    BOOST_CHECK_EQUAL(buffer.size(), 1);
+
+    util::IngestBatch batch = buffer.take();
+    BOOST_CHECK_EQUAL(batch.size(), 1);
+    BOOST_REQUIRE_EQUAL(batch.progress.size(), 2);
+    BOOST_CHECK_EQUAL(batch.progress["/session/1"], 7);
+    BOOST_CHECK_EQUAL(batch.progress["/session/2"], 3);
+
+    buffer.setProgress("/session/1", 8);
+    BOOST_CHECK(!buffer.empty());
+    batch = buffer.take();
+    BOOST_CHECK(!batch.empty());
+    BOOST_CHECK(batch.added.empty());
+    BOOST_CHECK(buffer.empty());
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
@@ -0,0 +1,153 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/ingest-writer.hpp"
+#include "boost-test.hpp"
+
+#include <atomic>
+#include <vector>
+
+namespace atmos{
+namespace tests{
+
+  BOOST_AUTO_TEST_SUITE(IngestWriterTestSuite)
+
+  BOOST_AUTO_TEST_CASE(BatchSize)
+  {
+    std::mutex mutex;
+    std::vector<util::IngestBatch> batches;
+
+    util::IngestWriter::Options options;
+    options.maxBatchSize = 3;
+    options.maxDelay = std::chrono::milliseconds(10000);
+    util::IngestWriter writer(options,
+                              [&] (const util::IngestBatch& batch) {
+                                std::lock_guard<std::mutex> lock(mutex);
+                                batches.push_back(batch);
+                                return true;
+                              },
+                              "test.batchSize");
+    writer.add("/a", "da");
+    writer.remove("/b", "db");
+    writer.add("/c", "dc");
+
+    // the batch is full, it does not wait for maxDelay
+    for (int i = 0; i < 100 && batches.size() < 1; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    writer.add("/d", "dd");
+
+    // the rest is written when the writer stops
+    writer.stop();
+    BOOST_REQUIRE_EQUAL(batches.size(), 2);
+    BOOST_CHECK_EQUAL(batches[0].added.size(), 2);
+    BOOST_CHECK_EQUAL(batches[0].removed.size(), 1);
+    BOOST_CHECK_EQUAL(batches[1].added.size(), 1);
+    BOOST_CHECK_EQUAL(batches[1].added[0], "/d");
+  }
+
+  BOOST_AUTO_TEST_CASE(BatchDelay)
+  {
+    std::atomic<size_t> nWritten(0);
+
+    util::IngestWriter::Options options;
+    options.maxDelay = std::chrono::milliseconds(20);
+    util::IngestWriter writer(options,
+                              [&] (const util::IngestBatch& batch) {
+                                nWritten += batch.size();
+                                return true;
+                              },
+                              "test.batchDelay");
+    writer.add("/a", "da");
+    writer.add("/b", "db");
+
+    for (int i = 0; i < 100 && nWritten < 2; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    BOOST_CHECK_EQUAL(nWritten, 2);
+  }
+
+  BOOST_AUTO_TEST_CASE(ProgressOnly)
+  {
+    std::atomic<uint64_t> progress(0);
+
+    util::IngestWriter::Options options;
+    options.maxDelay = std::chrono::milliseconds(20);
+    util::IngestWriter writer(options,
+                              [&] (const util::IngestBatch& batch) {
+                                auto it = batch.progress.find("/session");
+                                if (it != batch.progress.end()) {
+                                  progress = it->second;
+                                }
+                                return true;
+                              },
+                              "test.progress");
+    writer.setProgress("/session", 4);
+
+    for (int i = 0; i < 100 && progress == 0; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    BOOST_CHECK_EQUAL(progress, 4);
+  }
+
+  BOOST_AUTO_TEST_CASE(RetryInOrder)
+  {
+    std::mutex mutex;
+    std::vector<util::IngestBatch> batches;
+    std::atomic<size_t> nAttempts(0);
+
+    util::IngestWriter::Options options;
+    options.maxBatchSize = 1;
+    options.retryInterval = std::chrono::milliseconds(20);
+    options.maxBacklog = 2;
+    util::IngestWriter writer(options,
+                              [&] (const util::IngestBatch& batch) {
+                                std::lock_guard<std::mutex> lock(mutex);
+                                // the database is down for the first attempts
+                                if (++nAttempts <= 3) {
+                                  return false;
+                                }
+                                batches.push_back(batch);
+                                return true;
+                              },
+                              "test.retry");
+    writer.add("/a", "da");
+    for (int i = 0; i < 100 && nAttempts == 0; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    // the next operations wait behind the batch that cannot be written
+    writer.remove("/a", "da");
+    writer.add("/b", "db");
+    BOOST_CHECK(writer.isBacklogged());
+
+    for (int i = 0; i < 100 && batches.size() < 2; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    writer.stop();
+
+    BOOST_REQUIRE_EQUAL(batches.size(), 2);
+    BOOST_CHECK_EQUAL(batches[0].added[0], "/a");
+    BOOST_CHECK_EQUAL(batches[1].removed[0], "/a");
+    BOOST_CHECK_EQUAL(batches[1].added[0], "/b");
+    BOOST_CHECK(!writer.isBacklogged());
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
@@ -0,0 +1,52 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/metrics.hpp"
+#include "boost-test.hpp"
+
+namespace atmos{
+namespace tests{
+
+  BOOST_AUTO_TEST_SUITE(MetricsTestSuite)
+
+  BOOST_AUTO_TEST_CASE(CounterAndGauge)
+  {
+    util::MetricsRegistry registry;
+
+    util::Metric& counter = registry.get("test.counter");
+    counter.add();
+    counter.add(2);
+    BOOST_CHECK_EQUAL(registry.get("test.counter").get(), 3);
+
+    util::Metric& gauge = registry.get("test.gauge");
+    gauge.set(10);
+    gauge.setMax(5);
+    BOOST_CHECK_EQUAL(gauge.get(), 10);
+    gauge.setMax(12);
+    BOOST_CHECK_EQUAL(gauge.get(), 12);
+
+    Json::Value value;
+    registry.toJson(value);
+    BOOST_CHECK_EQUAL(value["test.counter"].asInt64(), 3);
+    BOOST_CHECK_EQUAL(value["test.gauge"].asInt64(), 12);
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
@@ -0,0 +1,89 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/mpsc-queue.hpp"
+#include "boost-test.hpp"
+
+#include <thread>
+#include <vector>
+
+namespace atmos{
+namespace tests{
+
+  BOOST_AUTO_TEST_SUITE(MpscQueueTestSuite)
+
+  BOOST_AUTO_TEST_CASE(SingleProducer)
+  {
+    util::MpscQueue<int> queue;
+    int value = 0;
+    BOOST_CHECK(queue.isEmpty());
+    BOOST_CHECK_EQUAL(queue.pop(value), false);
+
+    queue.push(1);
+    queue.push(2);
+    BOOST_CHECK(!queue.isEmpty());
+
+    BOOST_CHECK_EQUAL(queue.pop(value), true);
+    BOOST_CHECK_EQUAL(value, 1);
+    BOOST_CHECK_EQUAL(queue.pop(value), true);
+    BOOST_CHECK_EQUAL(value, 2);
+    BOOST_CHECK_EQUAL(queue.pop(value), false);
+    BOOST_CHECK(queue.isEmpty());
+  }
+
+  BOOST_AUTO_TEST_CASE(MultipleProducers)
+  {
+    // every element must come out exactly once, in the order of its producer
+    const int nProducers = 4;
+    const int nItems = 10000;
+    util::MpscQueue<int> queue;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < nProducers; ++p) {
+      producers.push_back(std::thread([&queue, p, nItems] {
+            for (int i = 0; i < nItems; ++i) {
+              queue.push(p * nItems + i);
+            }
+          }));
+    }
+
+    std::vector<int> lastSeen(nProducers, -1);
+    int nPopped = 0;
+    bool isOrdered = true;
+    int value = 0;
+    while (nPopped < nProducers * nItems) {
+      if (queue.pop(value)) {
+        int producer = value / nItems;
+        isOrdered = isOrdered && (value % nItems == lastSeen[producer] + 1);
+        lastSeen[producer] = value % nItems;
+        ++nPopped;
+      }
+    }
+
+    for (auto& producer : producers) {
+      producer.join();
+    }
+
+    BOOST_CHECK(isOrdered);
+    BOOST_CHECK(queue.isEmpty());
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
@@ -0,0 +1,110 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/name-tokenizer.hpp"
+#include "boost-test.hpp"
+
+#include <string>
+
+namespace atmos{
+namespace tests{
+
+  BOOST_AUTO_TEST_SUITE(NameTokenizerTestSuite)
+
+  static util::ValueRef
+  toRef(const std::string& value)
+  {
+    return util::ValueRef{value.data(), value.size()};
+  }
+
+  static std::string
+  str(const util::ValueRef& value)
+  {
+    return std::string(value.data, value.size);
+  }
+
+  BOOST_AUTO_TEST_CASE(FindSlash)
+  {
+    // the slash may be in the vector part or in the rest
+    for (size_t size = 1; size < 40; ++size) {
+      for (size_t i = 0; i < size; ++i) {
+        std::string value(size, 'a');
+        value[i] = '/';
+        BOOST_CHECK_EQUAL(util::findSlash(value.data(), value.data() + size) - value.data(), i);
+      }
+      std::string value(size, 'a');
+      BOOST_CHECK(util::findSlash(value.data(), value.data() + size) == value.data() + size);
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(Tokenize)
+  {
+    std::vector<util::ValueRef> components;
+    std::string name1("/Activity/Product/");
+    BOOST_CHECK(util::tokenizeName(toRef(name1), 3, components, false));
+    BOOST_REQUIRE_EQUAL(components.size(), 3);
+    BOOST_CHECK_EQUAL(str(components[0]), "Activity");
+    BOOST_CHECK_EQUAL(str(components[1]), "Product");
+    BOOST_CHECK_EQUAL(str(components[2]), "");
+
+    // too many components, the components of the name are not kept
+    BOOST_CHECK(!util::tokenizeName(toRef(name1), 2, components));
+    BOOST_CHECK_EQUAL(components.size(), 3);
+
+    components.clear();
+    std::string name2("ndn:/a//b");
+    BOOST_CHECK(!util::tokenizeName(toRef(name2), 5, components, false));
+    BOOST_CHECK(util::tokenizeName(toRef(name2), 5, components));
+    BOOST_REQUIRE_EQUAL(components.size(), 3);
+    BOOST_CHECK_EQUAL(str(components[1]), "");
+    BOOST_CHECK_EQUAL(str(components[2]), "b");
+
+    components.clear();
+    std::string name3("a/b");
+    BOOST_CHECK(!util::tokenizeName(toRef(name3), 5, components));
+    std::string name4("");
+    BOOST_CHECK(!util::tokenizeName(toRef(name4), 5, components));
+    BOOST_CHECK(components.empty());
+  }
+
+  BOOST_AUTO_TEST_CASE(SplitName)
+  {
+    std::vector<util::ValueRef> fields;
+    std::string name1("/1/2/3/4/5/6/7/8/9/10");
+    BOOST_CHECK(util::splitName(toRef(name1), 10, fields));
+    BOOST_REQUIRE_EQUAL(fields.size(), 10);
+    BOOST_CHECK_EQUAL(str(fields[0]), "1");
+    BOOST_CHECK_EQUAL(str(fields[9]), "10");
+
+    // too many or too few components
+    BOOST_CHECK(!util::splitName(toRef(name1), 9, fields));
+    BOOST_CHECK(!util::splitName(toRef(name1), 11, fields));
+    BOOST_CHECK_EQUAL(fields.size(), 10);
+
+    // the fields of the next name are appended
+    std::string name2("ndn:/a/b/c/d/eee/f/gg/h/iiii/j");
+    BOOST_CHECK(util::splitName(toRef(name2), 10, fields));
+    BOOST_REQUIRE_EQUAL(fields.size(), 20);
+    BOOST_CHECK_EQUAL(str(fields[14]), "eee");
+    BOOST_CHECK_EQUAL(str(fields[19]), "j");
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
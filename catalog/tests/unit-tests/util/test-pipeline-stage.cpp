@@ -0,0 +1,143 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/pipeline-stage.hpp"
+#include "boost-test.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace atmos{
+namespace tests{
+
+  BOOST_AUTO_TEST_SUITE(PipelineStageTestSuite)
+
+  BOOST_AUTO_TEST_CASE(BoundedQueueClose)
+  {
+    util::BoundedQueue<int> queue(2);
+    BOOST_CHECK(queue.push(1));
+    BOOST_CHECK(queue.push(2));
+    BOOST_CHECK_EQUAL(queue.size(), 2);
+
+    // a push to a full queue waits for a pop
+    std::thread producer([&queue] { queue.push(3); });
+    int value = 0;
+    BOOST_CHECK(queue.pop(value));
+    BOOST_CHECK_EQUAL(value, 1);
+    producer.join();
+    BOOST_CHECK_EQUAL(queue.size(), 2);
+
+    // once closed, the queue is drained, and nothing else comes in
+    queue.close();
+    BOOST_CHECK(!queue.push(4));
+    BOOST_CHECK(queue.pop(value));
+    BOOST_CHECK_EQUAL(value, 2);
+    BOOST_CHECK(queue.pop(value));
+    BOOST_CHECK_EQUAL(value, 3);
+    BOOST_CHECK(!queue.pop(value));
+  }
+
+  BOOST_AUTO_TEST_CASE(BoundedQueueTryPush)
+  {
+    util::BoundedQueue<std::string> queue(1);
+    std::string value("a");
+    BOOST_CHECK(queue.tryPush(value));
+
+    // a full queue does not take the value, which the caller keeps
+    value = "b";
+    BOOST_CHECK(!queue.tryPush(value));
+    BOOST_CHECK_EQUAL(value, "b");
+
+    std::string popped;
+    BOOST_CHECK(queue.pop(popped));
+    BOOST_CHECK_EQUAL(popped, "a");
+    BOOST_CHECK(queue.tryPush(value));
+    BOOST_CHECK_EQUAL(queue.size(), 1);
+
+    queue.close();
+    value = "c";
+    BOOST_CHECK(!queue.tryPush(value));
+  }
+
+  BOOST_AUTO_TEST_CASE(ChainedStages)
+  {
+    std::mutex mutex;
+    std::vector<int> results;
+
+    util::PipelineStage<int> last("test.stage.last", 4, 1, [&] (int& item) {
+        std::lock_guard<std::mutex> lock(mutex);
+        results.push_back(item);
+      });
+    util::PipelineStage<int> first("test.stage.first", 4, 3, [&] (int& item) {
+        last.push(item * 10);
+      });
+
+    for (int i = 0; i < 100; ++i) {
+      BOOST_CHECK(first.push(i));
+    }
+
+    // stopping in order handles every item
+    first.stop();
+    last.stop();
+    BOOST_CHECK(!first.push(100));
+
+    BOOST_REQUIRE_EQUAL(results.size(), 100);
+    std::sort(results.begin(), results.end());
+    for (int i = 0; i < 100; ++i) {
+      BOOST_CHECK_EQUAL(results[i], i * 10);
+    }
+
+    util::MetricsRegistry& metrics = util::MetricsRegistry::getDefault();
+    BOOST_CHECK_EQUAL(metrics.get("test.stage.first.processed").get(), 100);
+    BOOST_CHECK_EQUAL(metrics.get("test.stage.last.processed").get(), 100);
+    BOOST_CHECK_EQUAL(metrics.get("test.stage.last.queued").get(), 0);
+  }
+
+  BOOST_AUTO_TEST_CASE(HandlerError)
+  {
+    std::mutex mutex;
+    std::vector<int> results;
+
+    util::PipelineStage<int> stage("test.stage.error", 4, 2, [&] (int& item) {
+        if (item % 3 == 0) {
+          throw std::runtime_error("malformed item");
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        results.push_back(item);
+      });
+
+    for (int i = 0; i < 30; ++i) {
+      BOOST_CHECK(stage.push(i));
+    }
+    stage.stop();
+
+    // the items that failed are dropped, the threads go on with the others
+    BOOST_CHECK_EQUAL(results.size(), 20);
+    util::MetricsRegistry& metrics = util::MetricsRegistry::getDefault();
+    BOOST_CHECK_EQUAL(metrics.get("test.stage.error.processed").get(), 20);
+    BOOST_CHECK_EQUAL(metrics.get("test.stage.error.errors").get(), 10);
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
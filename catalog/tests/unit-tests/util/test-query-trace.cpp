@@ -0,0 +1,91 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/query-trace.hpp"
+#include "boost-test.hpp"
+
+#include <boost/filesystem.hpp>
+
+namespace atmos{
+namespace tests{
+
+  class QueryTraceFixture
+  {
+  public:
+    QueryTraceFixture()
+      : traceFile((boost::filesystem::temp_directory_path() /
+                   boost::filesystem::unique_path()).string())
+    {
+    }
+
+    ~QueryTraceFixture()
+    {
+      boost::filesystem::remove(traceFile);
+    }
+
+  protected:
+    std::string traceFile;
+  };
+
+  BOOST_FIXTURE_TEST_SUITE(QueryTraceTestSuite, QueryTraceFixture)
+
+  BOOST_AUTO_TEST_CASE(RecordEncodeDecode)
+  {
+    util::QueryTraceRecord record(1234567, ndn::Name("/cmip5/query/json"), 3);
+    util::QueryTraceRecord decoded(record.wireEncode());
+
+    BOOST_CHECK_EQUAL(decoded.timestamp, 1234567);
+    BOOST_CHECK_EQUAL(decoded.query, ndn::Name("/cmip5/query/json"));
+    BOOST_CHECK_EQUAL(decoded.hasSegmentNo, true);
+    BOOST_CHECK_EQUAL(decoded.segmentNo, 3);
+
+    util::QueryTraceRecord noSegment(7654321, ndn::Name("/cmip5/query/json"));
+    util::QueryTraceRecord decoded2(noSegment.wireEncode());
+    BOOST_CHECK_EQUAL(decoded2.timestamp, 7654321);
+    BOOST_CHECK_EQUAL(decoded2.hasSegmentNo, false);
+  }
+
+  BOOST_AUTO_TEST_CASE(WriteAndRead)
+  {
+    {
+      util::QueryTraceWriter writer(traceFile);
+      writer.record(ndn::Name("/cmip5/query/json"), 3);
+      writer.record(ndn::Name("/cmip5/query/json/version").appendSegment(5), 3);
+    }
+
+    util::QueryTraceReader reader(traceFile);
+    util::QueryTraceRecord record;
+
+    BOOST_REQUIRE(reader.next(record));
+    BOOST_CHECK_EQUAL(record.query, ndn::Name("/cmip5/query/json"));
+    BOOST_CHECK_EQUAL(record.hasSegmentNo, false);
+    uint64_t firstTimestamp = record.timestamp;
+
+    BOOST_REQUIRE(reader.next(record));
+    BOOST_CHECK_EQUAL(record.query, ndn::Name("/cmip5/query/json"));
+    BOOST_CHECK_EQUAL(record.hasSegmentNo, true);
+    BOOST_CHECK_EQUAL(record.segmentNo, 5);
+    BOOST_CHECK(record.timestamp >= firstTimestamp);
+
+    BOOST_CHECK(!reader.next(record));
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
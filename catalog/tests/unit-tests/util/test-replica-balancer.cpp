@@ -0,0 +1,77 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/replica-balancer.hpp"
+#include "boost-test.hpp"
+
+namespace atmos{
+namespace tests{
+
+  BOOST_AUTO_TEST_SUITE(ReplicaBalancerTestSuite)
+
+  BOOST_AUTO_TEST_CASE(LeastOutstandingByWeight)
+  {
+    util::ReplicaBalancer balancer(3);
+    balancer.addEndpoint(1);
+    balancer.addEndpoint(2);
+
+    // the endpoint with weight 2 takes two reads for each read of the other one
+    BOOST_CHECK_EQUAL(balancer.acquire(), 1);
+    BOOST_CHECK_EQUAL(balancer.acquire(), 0);
+    BOOST_CHECK_EQUAL(balancer.acquire(), 1);
+    BOOST_CHECK_EQUAL(balancer.getOutstanding(0), 1);
+    BOOST_CHECK_EQUAL(balancer.getOutstanding(1), 2);
+
+    balancer.release(1);
+    balancer.release(1);
+    BOOST_CHECK_EQUAL(balancer.acquire(), 1);
+
+    // endpoint 1 is full
+    BOOST_CHECK_EQUAL(balancer.acquire(), 1);
+    BOOST_CHECK_EQUAL(balancer.acquire(), 1);
+    BOOST_CHECK_EQUAL(balancer.acquire(), 0);
+    BOOST_CHECK_EQUAL(balancer.acquire(), 0);
+    BOOST_CHECK(balancer.isFull());
+    BOOST_CHECK_EQUAL(balancer.acquire(), -1);
+  }
+
+  BOOST_AUTO_TEST_CASE(OutOfRotation)
+  {
+    util::ReplicaBalancer balancer(10);
+    balancer.addEndpoint(0);
+    balancer.addEndpoint(1);
+    balancer.addEndpoint(1);
+
+    // a primary with weight 0 only serves as the fallback
+    balancer.setHealthy(1, false);
+    BOOST_CHECK_EQUAL(balancer.acquire(), 2);
+    BOOST_CHECK_EQUAL(balancer.acquire(), 2);
+
+    balancer.setHealthy(2, false);
+    BOOST_CHECK_EQUAL(balancer.acquire(), 0);
+
+    balancer.setHealthy(1, true);
+    BOOST_CHECK_EQUAL(balancer.acquire(), 1);
+    BOOST_CHECK_EQUAL(balancer.getOutstanding(0), 1);
+    BOOST_CHECK_EQUAL(balancer.getOutstanding(2), 2);
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
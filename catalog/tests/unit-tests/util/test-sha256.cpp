@@ -0,0 +1,78 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/sha256.hpp"
+#include "boost-test.hpp"
+
+#include <vector>
+
+namespace atmos{
+namespace tests{
+
+  BOOST_AUTO_TEST_SUITE(Sha256TestSuite)
+
+  BOOST_AUTO_TEST_CASE(KnownDigests)
+  {
+    BOOST_CHECK_EQUAL(util::sha256Hex(""),
+                      "E3B0C44298FC1C149AFBF4C8996FB92427AE41E4649B934CA495991B7852B855");
+    BOOST_CHECK_EQUAL(util::sha256Hex("abc"),
+                      "BA7816BF8F01CFEA414140DE5DAE2223B00361A396177A9CB410FF61F20015AD");
+    BOOST_CHECK_EQUAL(util::sha256Hex("/1/2/3/4/5/6/7/8/9/10"),
+                      "3738C9C0E0297DE7FE0EE538030597442DEEFF0F2C88778404D7B6E4BAD589F6");
+
+    // the padding fits in the last block, or needs one more
+    BOOST_CHECK_EQUAL(util::sha256Hex(std::string(55, 'a')),
+                      "9F4390F8D30C2DD92EC9F095B65E2B9AE9B0A925A5258E241C9F1E910F734318");
+    BOOST_CHECK_EQUAL(util::sha256Hex(std::string(56, 'a')),
+                      "B35439A4AC6F0948B6D6F9E3C6AF0F5F590CE20F1BDE7090EF7970686EC6738A");
+    BOOST_CHECK_EQUAL(util::sha256Hex(std::string(64, 'a')),
+                      "FFE054FE7AE0CB6DC65C3AF9B61D5209F439851DB43D0BA5997337DF154668EB");
+    BOOST_CHECK_EQUAL(util::sha256Hex(std::string(1000, 'a')),
+                      "41EDECE42D63E8D9BF515A9BA6932E1C20CBC9F5A5D134645ADB5DB1B9737EA3");
+
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    std::string abc("abc");
+    util::sha256(reinterpret_cast<const uint8_t*>(abc.data()), abc.size(), digest);
+    BOOST_CHECK_EQUAL(digest[0], 0xBA);
+    BOOST_CHECK_EQUAL(digest[SHA256_DIGEST_SIZE - 1], 0xAD);
+  }
+
+  BOOST_AUTO_TEST_CASE(Batch)
+  {
+    // values of different lengths are hashed in pairs, with different numbers of blocks
+    std::vector<std::string> values;
+    for (size_t size = 0; size <= 200; ++size) {
+      values.push_back(std::string(size, static_cast<char>('a' + size % 26)));
+    }
+    std::vector<util::ValueRef> refs;
+    for (const auto& value : values) {
+      refs.push_back(util::ValueRef{value.data(), value.size()});
+    }
+
+    std::string hex(values.size() * SHA256_HEX_SIZE, ' ');
+    util::sha256HexBatch(refs.data(), refs.size(), &hex[0]);
+    for (size_t i = 0; i < values.size(); ++i) {
+      BOOST_CHECK_EQUAL(hex.substr(i * SHA256_HEX_SIZE, SHA256_HEX_SIZE),
+                        util::sha256Hex(values[i]));
+    }
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
@@ -0,0 +1,92 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/sharded-content-store.hpp"
+#include "boost-test.hpp"
+
+#include <ndn-cxx/security/key-chain.hpp>
+
+namespace atmos{
+namespace tests{
+
+  class ShardedContentStoreFixture
+  {
+  public:
+    ShardedContentStoreFixture()
+      : store(1000, 3, 4)
+    {
+    }
+
+    std::shared_ptr<ndn::Data>
+    makeData(const ndn::Name& name)
+    {
+      std::shared_ptr<ndn::Data> data = std::make_shared<ndn::Data>(name);
+      data->setFreshnessPeriod(ndn::time::milliseconds(10000));
+      keyChain.sign(*data);
+      return data;
+    }
+
+  protected:
+    ndn::KeyChain keyChain;
+    util::ShardedContentStore store;
+  };
+
+  BOOST_FIXTURE_TEST_SUITE(ShardedContentStoreTestSuite, ShardedContentStoreFixture)
+
+  BOOST_AUTO_TEST_CASE(ExactAndPrefixLookup)
+  {
+    for (int i = 0; i < 20; ++i) {
+      ndn::Name name("/test/query");
+      name.append(ndn::Name::Component(std::to_string(i))).append("version").appendSegment(0);
+      store.insert(*makeData(name));
+    }
+    BOOST_CHECK_EQUAL(store.size(), 20);
+
+    // Interest longer than the shard key
+    ndn::Interest interest(ndn::Name("/test/query/7"));
+    std::shared_ptr<const ndn::Data> data = store.find(interest);
+    BOOST_REQUIRE(data);
+    BOOST_CHECK_EQUAL(data->getName(),
+                      ndn::Name("/test/query/7/version").appendSegment(0));
+
+    BOOST_CHECK(store.find(ndn::Name("/test/query/7/version").appendSegment(0)));
+
+    // Interest shorter than the shard key visits every shard
+    BOOST_CHECK(store.find(ndn::Interest(ndn::Name("/test/query"))));
+
+    BOOST_CHECK(!store.find(ndn::Interest(ndn::Name("/test/query/20"))));
+  }
+
+  BOOST_AUTO_TEST_CASE(Erase)
+  {
+    store.insert(*makeData(ndn::Name("/test/query/1/version").appendSegment(0)));
+    store.insert(*makeData(ndn::Name("/test/query/1/version").appendSegment(1)));
+    store.insert(*makeData(ndn::Name("/test/query/2/version").appendSegment(0)));
+
+    store.erase(ndn::Name("/test/query/1"));
+    BOOST_CHECK_EQUAL(store.size(), 1);
+    BOOST_CHECK(!store.find(ndn::Interest(ndn::Name("/test/query/1"))));
+
+    store.erase(ndn::Name("/"));
+    BOOST_CHECK_EQUAL(store.size(), 0);
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
@@ -0,0 +1,149 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/sqlite-database.hpp"
+#include "boost-test.hpp"
+
+#include <boost/filesystem.hpp>
+
+namespace atmos{
+namespace tests{
+
+  BOOST_AUTO_TEST_SUITE(SqliteDatabaseTestSuite)
+
+  BOOST_AUTO_TEST_CASE(MemoryDatabase)
+  {
+    util::SqliteDatabase database(":memory:", 4);
+    database.execute("CREATE TABLE cmip5 (name TEXT NOT NULL, has_metadata INTEGER);"
+                     "INSERT INTO cmip5 (name, has_metadata) VALUES ('/a/b', 1), ('/a/c', NULL);");
+
+    util::Rows rows =
+      database.query("SELECT name, has_metadata FROM cmip5 WHERE name LIKE ? ORDER BY name",
+                     {"/a/%"});
+    BOOST_REQUIRE_EQUAL(rows.size(), 2);
+    BOOST_CHECK_EQUAL(rows[0][0], "/a/b");
+    BOOST_CHECK_EQUAL(rows[0][1], "1");
+    BOOST_CHECK_EQUAL(rows[1][0], "/a/c");
+    BOOST_CHECK_EQUAL(rows[1][1], "");
+
+    // the values are bound, not pasted into the statement
+    database.execute("INSERT INTO cmip5 (name) VALUES (?)", {"/a/'d"});
+    BOOST_CHECK_EQUAL(database.query("SELECT name FROM cmip5 WHERE name = ?", {"/a/'d"}).size(), 1);
+
+    BOOST_CHECK_THROW(database.query("SELECT name FROM cmip6"), util::SqliteDatabase::Error);
+
+    // a closed database does not come back, so running the statement again does not help
+    database.close();
+    try {
+      database.query("SELECT name FROM cmip5");
+      BOOST_ERROR("the closed database is queried");
+    }
+    catch (const util::SqliteDatabase::Error& e) {
+      BOOST_CHECK(!e.isTransient());
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(Transaction)
+  {
+    util::SqliteDatabase database(":memory:", 1);
+    database.execute("CREATE TABLE cmip5 (name TEXT NOT NULL)");
+
+    database.transaction({"INSERT INTO cmip5 VALUES ('/a'), ('/b')",
+                          "DELETE FROM cmip5 WHERE name = '/a'"});
+    BOOST_CHECK_EQUAL(database.query("SELECT name FROM cmip5").size(), 1);
+
+    // a failing statement rolls back the whole transaction
+    BOOST_CHECK_THROW(database.transaction({"INSERT INTO cmip5 VALUES ('/c')",
+                                            "INSERT INTO cmip5 VALUES (NULL)"}),
+                      util::SqliteDatabase::Error);
+    BOOST_CHECK_EQUAL(database.query("SELECT name FROM cmip5").size(), 1);
+
+    // and the writer is usable again
+    database.execute("INSERT INTO cmip5 VALUES ('/d')");
+    BOOST_CHECK_EQUAL(database.query("SELECT name FROM cmip5").size(), 2);
+  }
+
+  BOOST_AUTO_TEST_CASE(BulkTransaction)
+  {
+    util::SqliteDatabase database(":memory:", 1);
+    database.execute("CREATE TABLE cmip5 (name TEXT NOT NULL, model TEXT)");
+
+    std::vector<util::BulkStatement> statements;
+    statements.push_back(util::BulkStatement::insert("cmip5", {"name", "model"}));
+    for (int i = 0; i < 50; ++i) {
+      statements[0].addOwnedValue("/" + std::to_string(i) + "/it's");
+      statements[0].addOwnedValue("it's");
+    }
+    database.executeBulk(statements);
+    BOOST_CHECK_EQUAL(database.query("SELECT name FROM cmip5 WHERE model = ?", {"it's"}).size(),
+                      50);
+
+    statements.clear();
+    statements.push_back(util::BulkStatement::remove("cmip5", "name"));
+    statements[0].addOwnedValue("/0/it's");
+    statements[0].addOwnedValue("/1/it's");
+    // a failing statement rolls back the deletions as well
+    statements.push_back(util::BulkStatement::insert("cmip5", {"name", "model"}));
+    // a null pointer binds NULL, which the name cannot be
+    statements[1].addValue(nullptr, 0);
+    statements[1].addOwnedValue("m");
+    BOOST_CHECK_THROW(database.executeBulk(statements), util::SqliteDatabase::Error);
+    BOOST_CHECK_EQUAL(database.query("SELECT name FROM cmip5").size(), 50);
+    // which would fail again
+    try {
+      database.executeBulk(statements);
+      BOOST_ERROR("the NULL name is inserted");
+    }
+    catch (const util::SqliteDatabase::Error& e) {
+      BOOST_CHECK(!e.isTransient());
+    }
+
+    statements.pop_back();
+    database.executeBulk(statements);
+    BOOST_CHECK_EQUAL(database.query("SELECT name FROM cmip5").size(), 48);
+  }
+
+  BOOST_AUTO_TEST_CASE(WalDatabase)
+  {
+    boost::filesystem::path path = boost::filesystem::temp_directory_path() /
+                                   boost::filesystem::unique_path("catalog-%%%%-%%%%.db");
+    {
+      util::SqliteDatabase database(path.string(), 2);
+      BOOST_CHECK_EQUAL(database.query("PRAGMA journal_mode")[0][0], "wal");
+
+      database.execute("CREATE TABLE chronosync_update_info (session_name TEXT, seq_num INTEGER)");
+      database.execute("INSERT INTO chronosync_update_info VALUES (?, ?)", {"/session", "7"});
+      util::Rows rows =
+        database.query("SELECT seq_num FROM chronosync_update_info WHERE session_name = ?",
+                       {"/session"});
+      BOOST_REQUIRE_EQUAL(rows.size(), 1);
+      BOOST_CHECK_EQUAL(rows[0][0], "7");
+
+      // the readers cannot write
+      BOOST_CHECK_THROW(database.query("DELETE FROM chronosync_update_info"),
+                        util::SqliteDatabase::Error);
+    }
+    boost::filesystem::remove(path);
+    boost::filesystem::remove(path.string() + "-wal");
+    boost::filesystem::remove(path.string() + "-shm");
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
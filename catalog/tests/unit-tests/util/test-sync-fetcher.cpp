@@ -0,0 +1,132 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/sync-fetcher.hpp"
+#include "boost-test.hpp"
+#include "../../unit-test-time-fixture.hpp"
+
+#include <utility>
+#include <vector>
+
+namespace atmos{
+namespace tests{
+
+  class SyncFetcherFixture : public UnitTestTimeFixture
+  {
+  public:
+    SyncFetcherFixture()
+      : scheduler(io)
+    {
+      options.maxOutstanding = 3;
+      options.maxPerSession = 2;
+      options.maxRetries = 1;
+      options.initialBackoff = ndn::time::milliseconds(100);
+      options.progressInterval = 2;
+    }
+
+    std::unique_ptr<util::SyncFetcher>
+    makeFetcher(const std::string& name)
+    {
+      return std::unique_ptr<util::SyncFetcher>(
+        new util::SyncFetcher(scheduler, options,
+                              [this] (const ndn::Name& session, uint64_t seq) {
+                                fetches.push_back(std::make_pair(session, seq));
+                              },
+                              [this] (const ndn::Name& session, uint64_t seq) {
+                                progress.push_back(std::make_pair(session, seq));
+                              },
+                              name));
+    }
+
+  public:
+    ndn::util::scheduler::Scheduler scheduler;
+    util::SyncFetcher::Options options;
+    std::vector<std::pair<ndn::Name, uint64_t>> fetches;
+    std::vector<std::pair<ndn::Name, uint64_t>> progress;
+  };
+
+  BOOST_FIXTURE_TEST_SUITE(SyncFetcherTestSuite, SyncFetcherFixture)
+
+  BOOST_AUTO_TEST_CASE(Window)
+  {
+    std::unique_ptr<util::SyncFetcher> fetcher = makeFetcher("test.syncWindow");
+    ndn::Name a("/a"), b("/b");
+    // the updates up to 2 of /a were fetched before
+    fetcher->addMissing(a, 1, 5, 2);
+    BOOST_CHECK_EQUAL(fetcher->getNOutstanding(), 2);
+    fetcher->addMissing(b, 1, 5, 0);
+    // the sessions take turns, within the window across sessions
+    BOOST_CHECK_EQUAL(fetcher->getNOutstanding(), 3);
+    BOOST_REQUIRE_EQUAL(fetches.size(), 3);
+    BOOST_CHECK_EQUAL(fetches[0].second, 3);
+    BOOST_CHECK_EQUAL(fetches[1].second, 4);
+    BOOST_CHECK_EQUAL(fetches[2].first, b);
+    BOOST_CHECK_EQUAL(fetcher->getNMissing(), 8);
+
+    // out of order, the progress waits for the update before
+    fetcher->onFetched(a, 4);
+    BOOST_CHECK_EQUAL(fetcher->getFetchedUpTo(a), 2);
+    fetcher->onFetched(a, 3);
+    BOOST_CHECK_EQUAL(fetcher->getFetchedUpTo(a), 4);
+    BOOST_REQUIRE_EQUAL(progress.size(), 1);
+    BOOST_CHECK_EQUAL(progress[0].second, 4);
+    BOOST_CHECK_EQUAL(fetcher->getNOutstanding(), 3);
+  }
+
+  BOOST_AUTO_TEST_CASE(Backoff)
+  {
+    std::unique_ptr<util::SyncFetcher> fetcher = makeFetcher("test.syncBackoff");
+    ndn::Name a("/a");
+    fetcher->addMissing(a, 1, 2, 0);
+    BOOST_REQUIRE_EQUAL(fetches.size(), 2);
+
+    fetcher->onFetched(a, 2);
+    fetcher->onFailed(a, 1);
+    BOOST_CHECK_EQUAL(fetcher->getNOutstanding(), 0);
+    BOOST_CHECK_EQUAL(fetcher->getNMissing(), 1);
+
+    // tried again once the backoff elapsed
+    advanceClocks(ndn::time::milliseconds(50));
+    BOOST_CHECK_EQUAL(fetches.size(), 2);
+    advanceClocks(ndn::time::milliseconds(60));
+    BOOST_REQUIRE_EQUAL(fetches.size(), 3);
+    BOOST_CHECK_EQUAL(fetches[2].second, 1);
+
+    // given up, the gap holds the progress back until the session reports updates again
+    fetcher->onFailed(a, 1);
+    advanceClocks(ndn::time::milliseconds(500));
+    BOOST_CHECK_EQUAL(fetches.size(), 3);
+    BOOST_CHECK_EQUAL(fetcher->getFetchedUpTo(a), 0);
+    BOOST_CHECK(progress.empty());
+
+    fetcher->addMissing(a, 3, 3, 0);
+    BOOST_REQUIRE_EQUAL(fetches.size(), 5);
+    BOOST_CHECK_EQUAL(fetches[3].second, 1);
+    fetcher->onFetched(a, 1);
+    BOOST_CHECK_EQUAL(fetcher->getFetchedUpTo(a), 2);
+    fetcher->onFetched(a, 3);
+    BOOST_CHECK_EQUAL(fetcher->getFetchedUpTo(a), 3);
+    BOOST_REQUIRE_EQUAL(progress.size(), 2);
+    BOOST_CHECK_EQUAL(progress[0].second, 2);
+    BOOST_CHECK_EQUAL(progress[1].second, 3);
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
@@ -0,0 +1,100 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/table-snapshot.hpp"
+#include "boost-test.hpp"
+
+namespace atmos{
+namespace tests{
+
+  BOOST_AUTO_TEST_SUITE(TableSnapshotTestSuite)
+
+  BOOST_AUTO_TEST_CASE(EncodeDecode)
+  {
+    util::TableSnapshot snapshot;
+    snapshot.vector["/cmip5/sync/catalog1/1450000000"] = 42;
+    snapshot.vector["/cmip5/sync/catalog2/1450000001"] = 7;
+    for (int i = 0; i < 10000; ++i) {
+      snapshot.names.push_back("/CMIP5/output/MOHC/HadCM3/decadal1990/day/atmos/tas/r3i2p1/" +
+                               std::to_string(i));
+    }
+
+    std::string encoded = snapshot.encode();
+    // the names share long prefixes
+    BOOST_CHECK_LT(encoded.size(), 10000 * 10);
+
+    util::TableSnapshot decoded = util::TableSnapshot::decode(encoded);
+    BOOST_CHECK(decoded.vector == snapshot.vector);
+    BOOST_CHECK(decoded.names == snapshot.names);
+
+    util::TableSnapshot empty = util::TableSnapshot::decode(util::TableSnapshot().encode());
+    BOOST_CHECK(empty.vector.empty());
+    BOOST_CHECK(empty.names.empty());
+  }
+
+  BOOST_AUTO_TEST_CASE(Streaming)
+  {
+    util::TableSnapshot::SessionVector vector;
+    vector["/cmip5/sync/catalog1/1450000000"] = 42;
+    util::TableSnapshot::Writer writer(vector);
+    std::string encoded;
+    for (int i = 0; i < 100000; ++i) {
+      writer.addName("/CMIP5/output/MOHC/HadCM3/decadal1990/day/atmos/tas/r3i2p1/" +
+                     std::to_string(i));
+      encoded.append(writer.takeOutput());
+    }
+    writer.finish();
+    encoded.append(writer.takeOutput());
+
+    // in pieces of the size of a Data packet, the lines cut anywhere
+    util::TableSnapshot::Reader reader;
+    size_t nNames = 0;
+    for (size_t offset = 0; offset < encoded.size(); offset += 7000) {
+      reader.write(encoded.data() + offset, std::min<size_t>(7000, encoded.size() - offset));
+      std::vector<std::string> names = reader.takeNames();
+      for (const auto& name : names) {
+        BOOST_CHECK_EQUAL(name, "/CMIP5/output/MOHC/HadCM3/decadal1990/day/atmos/tas/r3i2p1/" +
+                                std::to_string(nNames));
+        ++nNames;
+      }
+    }
+    BOOST_CHECK_NO_THROW(reader.finish());
+    BOOST_CHECK(reader.getVector() == vector);
+    BOOST_CHECK_EQUAL(nNames, 100000);
+
+    util::TableSnapshot::Reader truncated;
+    truncated.write(encoded.data(), encoded.size() / 2);
+    BOOST_CHECK_THROW(truncated.finish(), util::TableSnapshot::Error);
+  }
+
+  BOOST_AUTO_TEST_CASE(Malformed)
+  {
+    util::TableSnapshot snapshot;
+    snapshot.vector["/session"] = 1;
+    snapshot.names.push_back("/a/b");
+    std::string encoded = snapshot.encode();
+
+    BOOST_CHECK_THROW(util::TableSnapshot::decode(encoded.substr(0, encoded.size() / 2)),
+                      util::TableSnapshot::Error);
+    BOOST_CHECK_THROW(util::TableSnapshot::decode("not compressed"), util::TableSnapshot::Error);
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
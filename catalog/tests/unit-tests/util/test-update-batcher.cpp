@@ -0,0 +1,153 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+**/
+
+#include "util/update-batcher.hpp"
+#include "util/compression.hpp"
+#include "boost-test.hpp"
+#include "../../unit-test-time-fixture.hpp"
+
+#include <json/reader.h>
+#include <json/value.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace atmos{
+namespace tests{
+
+  class UpdateBatcherFixture : public UnitTestTimeFixture
+  {
+  public:
+    UpdateBatcherFixture()
+      : scheduler(io)
+    {
+      options.maxDelay = ndn::time::milliseconds(100);
+      options.maxNames = 1000;
+      options.maxPayloadSize = 1000;
+    }
+
+    std::unique_ptr<util::UpdateBatcher>
+    makeBatcher(const std::string& name)
+    {
+      return std::unique_ptr<util::UpdateBatcher>(
+        new util::UpdateBatcher(scheduler, options,
+                                [this] (const std::string& payload) {
+                                  payloads.push_back(payload);
+                                },
+                                name));
+    }
+
+    Json::Value
+    parse(const std::string& payload)
+    {
+      Json::Value update;
+      Json::Reader reader;
+      BOOST_REQUIRE(reader.parse(util::isCompressed(payload) ? util::decompress(payload) :
+                                                              payload,
+                                 update));
+      return update;
+    }
+
+  public:
+    ndn::util::scheduler::Scheduler scheduler;
+    util::UpdateBatcher::Options options;
+    std::vector<std::string> payloads;
+  };
+
+  BOOST_FIXTURE_TEST_SUITE(UpdateBatcherTestSuite, UpdateBatcherFixture)
+
+  BOOST_AUTO_TEST_CASE(Window)
+  {
+    std::unique_ptr<util::UpdateBatcher> batcher = makeBatcher("test.batchWindow");
+    batcher->add("/a/1");
+    batcher->add("/a/2");
+    batcher->remove("/a/3");
+    advanceClocks(ndn::time::milliseconds(50));
+    // the last change of a name wins
+    batcher->remove("/a/2");
+    batcher->add("/a/3");
+    BOOST_CHECK(payloads.empty());
+    BOOST_CHECK_EQUAL(batcher->size(), 3);
+
+    advanceClocks(ndn::time::milliseconds(60));
+    BOOST_REQUIRE_EQUAL(payloads.size(), 1);
+    BOOST_CHECK(!util::isCompressed(payloads[0]));
+    Json::Value update = parse(payloads[0]);
+    BOOST_REQUIRE_EQUAL(update["add"].size(), 2);
+    BOOST_CHECK_EQUAL(update["add"][0].asString(), "/a/1");
+    BOOST_CHECK_EQUAL(update["add"][1].asString(), "/a/3");
+    BOOST_REQUIRE_EQUAL(update["remove"].size(), 1);
+    BOOST_CHECK_EQUAL(update["remove"][0].asString(), "/a/2");
+    BOOST_CHECK_EQUAL(batcher->size(), 0);
+
+    advanceClocks(ndn::time::milliseconds(500));
+    BOOST_CHECK_EQUAL(payloads.size(), 1);
+  }
+
+  BOOST_AUTO_TEST_CASE(Large)
+  {
+    options.maxNames = 500;
+    options.canCompress = true;
+    std::unique_ptr<util::UpdateBatcher> batcher = makeBatcher("test.batchLarge");
+    for (int i = 0; i < 500; ++i) {
+      batcher->add("/CMIP5/output/MOHC/HadCM3/decadal1990/day/atmos/tas/r3i2p1/" +
+                   std::to_string(i));
+    }
+
+    // published once maxNames are waiting, compressed and split to fit
+    BOOST_CHECK_EQUAL(batcher->size(), 0);
+    BOOST_CHECK_GT(payloads.size(), 1);
+    std::set<std::string> names;
+    for (const auto& payload : payloads) {
+      BOOST_CHECK_LE(payload.size(), options.maxPayloadSize);
+      BOOST_CHECK(util::isCompressed(payload));
+      Json::Value update = parse(payload);
+      for (const auto& name : update["add"]) {
+        names.insert(name.asString());
+      }
+    }
+    BOOST_CHECK_EQUAL(names.size(), 500);
+  }
+
+  BOOST_AUTO_TEST_CASE(LargeUncompressed)
+  {
+    options.maxNames = 500;
+    std::unique_ptr<util::UpdateBatcher> batcher = makeBatcher("test.batchLargeUncompressed");
+    for (int i = 0; i < 500; ++i) {
+      batcher->add("/CMIP5/output/MOHC/HadCM3/decadal1990/day/atmos/tas/r3i2p1/" +
+                   std::to_string(i));
+    }
+
+    // only split, for the catalogs that do not decompress
+    std::set<std::string> names;
+    for (const auto& payload : payloads) {
+      BOOST_CHECK_LE(payload.size(), options.maxPayloadSize);
+      BOOST_CHECK(!util::isCompressed(payload));
+      Json::Value update = parse(payload);
+      for (const auto& name : update["add"]) {
+        names.insert(name.asString());
+      }
+    }
+    BOOST_CHECK_EQUAL(names.size(), 500);
+  }
+
+  BOOST_AUTO_TEST_SUITE_END()
+
+}//tests
+}//atmos
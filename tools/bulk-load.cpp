@@ -0,0 +1,642 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "config.hpp"
+#include "util/bulk-statement.hpp"
+#include "util/catalog-adapter.hpp"
+#include "util/config-file.hpp"
+#include "util/mysql-util.hpp"
+#include "util/name-tokenizer.hpp"
+#include "util/sha256.hpp"
+#include "util/sqlite-database.hpp"
+
+#include <ndn-cxx/face.hpp>
+
+#include <ChronoSync/socket.hpp>
+#include <json/value.h>
+#include <json/writer.h>
+#include <mysql/mysql.h>
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// bytes of the name list tokenized at once, while the previous block is written
+#define BULK_LOAD_BLOCK_SIZE (16 * 1024 * 1024)
+// bytes of the names of one sync update, which must fit in a Data packet with its signature
+#define MAX_UPDATE_SIZE 7000
+
+void
+usage(const char *fileName)
+{
+  std::cout << "\n Usage:\n " << fileName <<
+    " [-h] -f name list file [-c config file] [-e] [-j threads] [-a seconds]\n"
+    "   [-f name list file]  - set the file that contains one file name per line\n"
+    "   [-c config file]     - set the catalog config file, which gives the name fields, the\n"
+    "                          data table and the publishAdapter database\n"
+    "   [-e]                 - load into the embedded SQLite database set by dbFile\n"
+    "   [-j threads]         - set the number of threads tokenizing and hashing the names\n"
+    "   [-a seconds]         - announce the names through ChronoSync, and serve the updates\n"
+    "                          to the other catalogs for this long\n"
+    "   [-h]                 - print help and exit\n"
+    "\n"
+    " The data table must exist, i.e., the catalog must have been started once.\n"
+    " Names already in a MySQL catalog are skipped.\n"
+    "\n";
+}
+
+namespace ndn {
+namespace atmos {
+
+/**
+ * MappedFile maps a whole file read-only into memory
+ */
+class MappedFile : noncopyable
+{
+public:
+  explicit
+  MappedFile(const std::string& path)
+    : m_data(nullptr)
+    , m_size(0)
+  {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("cannot open " + path);
+    }
+
+    struct stat status;
+    if (::fstat(fd, &status) != 0) {
+      ::close(fd);
+      throw std::runtime_error("cannot stat " + path);
+    }
+    m_size = status.st_size;
+
+    if (m_size > 0) {
+      void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("cannot map " + path);
+      }
+      m_data = static_cast<const char*>(data);
+      // the names are read once, front to back
+      ::madvise(data, m_size, MADV_SEQUENTIAL);
+    }
+    ::close(fd);
+  }
+
+  ~MappedFile()
+  {
+    if (m_data != nullptr) {
+      ::munmap(const_cast<char*>(m_data), m_size);
+    }
+  }
+
+  const char*
+  begin() const
+  {
+    return m_data;
+  }
+
+  const char*
+  end() const
+  {
+    return m_data + m_size;
+  }
+
+private:
+  const char* m_data;
+  size_t m_size;
+};
+
+/**
+ * MysqlInfile streams the rows of BulkStatements to LOAD DATA LOCAL INFILE, in its default
+ * tab-separated format
+ */
+class MysqlInfile : noncopyable
+{
+public:
+  explicit
+  MysqlInfile(const std::vector<::atmos::util::BulkStatement>& statements)
+    : m_statements(statements)
+    , m_statement(0)
+    , m_value(0)
+    , m_offset(0)
+  {
+  }
+
+  size_t
+  read(char* buffer, size_t size)
+  {
+    size_t nRead = 0;
+    while (nRead < size) {
+      if (m_offset == m_row.size() && !nextRow()) {
+        break;
+      }
+      size_t count = std::min(size - nRead, m_row.size() - m_offset);
+      std::memcpy(buffer + nRead, m_row.data() + m_offset, count);
+      nRead += count;
+      m_offset += count;
+    }
+    return nRead;
+  }
+
+private:
+  bool
+  nextRow()
+  {
+    while (m_statement < m_statements.size() &&
+           m_value == m_statements[m_statement].getValues().size()) {
+      ++m_statement;
+      m_value = 0;
+    }
+    if (m_statement == m_statements.size()) {
+      return false;
+    }
+
+    const ::atmos::util::BulkStatement& statement = m_statements[m_statement];
+    m_row.clear();
+    m_offset = 0;
+    for (size_t i = 0; i < statement.getNColumns(); ++i, ++m_value) {
+      if (i != 0) {
+        m_row += '\t';
+      }
+      const ::atmos::util::ValueRef& value = statement.getValues()[m_value];
+      for (size_t j = 0; j < value.size; ++j) {
+        switch (value.data[j]) {
+          case '\\': m_row += "\\\\"; break;
+          case '\t': m_row += "\\t"; break;
+          case '\n': m_row += "\\n"; break;
+          case '\0': m_row += "\\0"; break;
+          default: m_row += value.data[j];
+        }
+      }
+    }
+    m_row += '\n';
+    return true;
+  }
+
+private:
+  const std::vector<::atmos::util::BulkStatement>& m_statements;
+  size_t m_statement;
+  size_t m_value;
+  std::string m_row;
+  size_t m_offset;
+};
+
+/**
+ * BulkLoader seeds the data table of a catalog from a list of file names. The list is mapped
+ * into memory and cut into blocks; the names of a block are tokenized and hashed by several
+ * threads while the previous block is written, with LOAD DATA LOCAL INFILE on MySQL, or with
+ * bound multi-row inserts in one transaction per block on SQLite.
+ */
+class BulkLoader : noncopyable
+{
+public:
+  BulkLoader()
+    : m_configFile(DEFAULT_CONFIG_FILE)
+    , m_isEmbedded(false)
+    , m_nThreads(std::max(std::thread::hardware_concurrency(), 1u))
+    , m_announceTime(-1)
+    , m_dbPort(DB_DEFAULT_PORT)
+    , m_syncPrefix("ndn:/ndn-atmos/broadcast/chronosync")
+    , m_mysql(nullptr)
+    , m_nLoaded(0)
+    , m_nMalformed(0)
+  {
+  }
+
+  ~BulkLoader()
+  {
+    if (m_mysql != nullptr) {
+      mysql_close(m_mysql);
+    }
+  }
+
+  void
+  run()
+  {
+    ::atmos::util::ConfigFile config(&::atmos::util::ConfigFile::ignoreUnknownSection);
+    config.addSectionHandler("general", bind(&BulkLoader::onGeneralConfig, this, _1));
+    config.addSectionHandler("publishAdapter", bind(&BulkLoader::onPublishConfig, this, _1));
+    config.parse(m_configFile, false);
+
+    // the columns of the data table, as created by the publish adapter
+    m_columns = m_nameFields;
+    m_columns.insert(m_columns.begin(), "name");
+    m_columns.insert(m_columns.begin(), "sha256");
+
+    m_file.reset(new MappedFile(m_nameFile));
+    time::steady_clock::TimePoint start = time::steady_clock::now();
+    if (m_isEmbedded) {
+      m_sqlite.reset(new ::atmos::util::SqliteDatabase(m_dbFile, 1));
+    }
+    else {
+      connectMysql();
+    }
+    load();
+
+    std::cout << "loaded " << m_nLoaded << " names, skipped " << m_nMalformed
+              << " malformed names in "
+              << time::duration_cast<time::seconds>(time::steady_clock::now() - start)
+              << std::endl;
+
+    if (m_announceTime >= 0) {
+      announce();
+    }
+  }
+
+private:
+  void
+  onGeneralConfig(const ::atmos::util::ConfigSection& section)
+  {
+    m_prefix = Name(section.get<std::string>("prefix", ""));
+    m_table = section.get<std::string>("databaseTable", "");
+
+    std::istringstream ss(section.get<std::string>("nameFields", ""));
+    std::string token;
+    while (std::getline(ss, token, ',')) {
+      m_nameFields.push_back(token);
+    }
+
+    if (m_nameFields.empty() || m_table.empty()) {
+      throw std::runtime_error("no \"nameFields\" or \"databaseTable\" in \"general\" section");
+    }
+  }
+
+  void
+  onPublishConfig(const ::atmos::util::ConfigSection& section)
+  {
+    m_signingId = Name(section.get<std::string>("signingId", ""));
+    m_dbServer = section.get<std::string>("database.dbServer", "");
+    m_dbPort = section.get<unsigned int>("database.dbPort", DB_DEFAULT_PORT);
+    if (m_dbPort == 0 || m_dbPort > 65535) {
+      throw std::runtime_error("invalid \"dbPort\" in \"publishAdapter\" section");
+    }
+    m_dbName = section.get<std::string>("database.dbName", "");
+    m_dbUser = section.get<std::string>("database.dbUser", "");
+    m_dbPasswd = section.get<std::string>("database.dbPasswd", "");
+    m_dbFile = section.get<std::string>("database.dbFile", "");
+    m_syncPrefix = Name(section.get<std::string>("sync.prefix", m_syncPrefix.toUri()));
+  }
+
+  void
+  connectMysql()
+  {
+    m_mysql = mysql_init(nullptr);
+    if (m_mysql == nullptr) {
+      throw std::runtime_error("cannot allocate a MySQL connection");
+    }
+    unsigned int isLocalInfile = 1;
+    mysql_options(m_mysql, MYSQL_OPT_LOCAL_INFILE, &isLocalInfile);
+    mysql_options(m_mysql, MYSQL_SET_CHARSET_NAME, "utf8");
+
+    if (mysql_real_connect(m_mysql, m_dbServer.c_str(), m_dbUser.c_str(), m_dbPasswd.c_str(),
+                           m_dbName.c_str(), m_dbPort, nullptr, CLIENT_LOCAL_FILES) == nullptr) {
+      throw std::runtime_error(std::string("cannot connect to MySQL: ") + mysql_error(m_mysql));
+    }
+  }
+
+  void
+  load()
+  {
+    const char* next = m_file->begin();
+    std::future<std::vector<::atmos::util::BulkStatement>> block;
+    if (next != m_file->end()) {
+      block = std::async(std::launch::async, &BulkLoader::prepareBlock, this, next,
+                         blockEnd(next));
+      next = blockEnd(next);
+    }
+
+    while (block.valid()) {
+      std::vector<::atmos::util::BulkStatement> statements = block.get();
+      // the mapped names outlive the statements, so the next block can be prepared meanwhile
+      if (next != m_file->end()) {
+        block = std::async(std::launch::async, &BulkLoader::prepareBlock, this, next,
+                           blockEnd(next));
+        next = blockEnd(next);
+      }
+
+      if (m_isEmbedded) {
+        m_sqlite->executeBulk(statements);
+      }
+      else {
+        writeMysql(statements);
+      }
+
+      for (const auto& statement : statements) {
+        m_nLoaded += statement.getNRows();
+      }
+      std::cout << "\r" << m_nLoaded << " names" << std::flush;
+    }
+    std::cout << std::endl;
+  }
+
+  /**
+   * @return the end of the block starting at begin, right after a line
+   */
+  const char*
+  blockEnd(const char* begin) const
+  {
+    if (m_file->end() - begin <= BULK_LOAD_BLOCK_SIZE) {
+      return m_file->end();
+    }
+    return lineEnd(begin + BULK_LOAD_BLOCK_SIZE, m_file->end());
+  }
+
+  static const char*
+  lineEnd(const char* position, const char* end)
+  {
+    const char* newline = static_cast<const char*>(std::memchr(position, '\n', end - position));
+    return newline == nullptr ? end : newline + 1;
+  }
+
+  /**
+   * Tokenize and hash the names of [begin, end), one slice per thread
+   *
+   * @return one statement per slice
+   */
+  std::vector<::atmos::util::BulkStatement>
+  prepareBlock(const char* begin, const char* end)
+  {
+    // cut the block at line ends, so each name is in one slice
+    std::vector<const char*> bounds(1, begin);
+    size_t sliceSize = (end - begin) / m_nThreads + 1;
+    while (bounds.back() != end) {
+      const char* sliceBegin = bounds.back();
+      bounds.push_back(static_cast<size_t>(end - sliceBegin) <= sliceSize ?
+                       end : lineEnd(sliceBegin + sliceSize, end));
+    }
+
+    // the names already in the catalog are skipped, as LOAD DATA LOCAL does on MySQL
+    std::vector<::atmos::util::BulkStatement> statements;
+    for (size_t i = 1; i < bounds.size(); ++i) {
+      statements.push_back(::atmos::util::BulkStatement::upsert(m_table, m_columns, "sha256",
+                                                                ::atmos::util::DIALECT_SQLITE));
+    }
+
+    std::vector<size_t> nMalformed(statements.size(), 0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < statements.size(); ++i) {
+      threads.push_back(std::thread(&BulkLoader::prepareSlice, this, bounds[i], bounds[i + 1],
+                                    std::ref(statements[i]), std::ref(nMalformed[i])));
+    }
+    for (size_t i = 0; i < threads.size(); ++i) {
+      threads[i].join();
+      m_nMalformed += nMalformed[i];
+    }
+    return statements;
+  }
+
+  void
+  prepareSlice(const char* begin, const char* end, ::atmos::util::BulkStatement& statement,
+               size_t& nMalformed)
+  {
+    // the names of the slice are validated first, then hashed in one batch
+    std::vector<::atmos::util::ValueRef> names;
+    std::vector<::atmos::util::ValueRef> fields;
+    while (begin != end) {
+      const char* next = lineEnd(begin, end);
+      ::atmos::util::ValueRef name = trimLine(begin, next);
+      begin = next;
+      if (name.size == 0) {
+        continue;
+      }
+
+      if (!::atmos::util::splitName(name, m_nameFields.size(), fields)) {
+        ++nMalformed;
+        continue;
+      }
+      names.push_back(name);
+    }
+
+    // same digest as the publish adapter
+    char* digests = statement.keepBuffer(std::string(names.size() * SHA256_HEX_SIZE, '0'));
+    ::atmos::util::sha256HexBatch(names.data(), names.size(), digests);
+
+    const size_t nNameFields = m_nameFields.size();
+    for (size_t i = 0; i < names.size(); ++i) {
+      statement.addValue(digests + i * SHA256_HEX_SIZE, SHA256_HEX_SIZE);
+      statement.addValue(names[i].data, names[i].size);
+      for (size_t j = 0; j < nNameFields; ++j) {
+        statement.addValue(fields[i * nNameFields + j].data, fields[i * nNameFields + j].size);
+      }
+    }
+  }
+
+  /**
+   * @return the line [begin, end) without its line break
+   */
+  static ::atmos::util::ValueRef
+  trimLine(const char* begin, const char* end)
+  {
+    while (end != begin && (end[-1] == '\n' || end[-1] == '\r')) {
+      --end;
+    }
+    return ::atmos::util::ValueRef{begin, static_cast<size_t>(end - begin)};
+  }
+
+  void
+  writeMysql(const std::vector<::atmos::util::BulkStatement>& statements)
+  {
+    MysqlInfile infile(statements);
+    mysql_set_local_infile_handler(m_mysql,
+      [] (void** ptr, const char* fileName, void* userdata) {
+        *ptr = userdata;
+        return 0;
+      },
+      [] (void* ptr, char* buffer, unsigned int size) {
+        return static_cast<int>(static_cast<MysqlInfile*>(ptr)->read(buffer, size));
+      },
+      [] (void* ptr) {
+      },
+      [] (void* ptr, char* message, unsigned int size) {
+        std::strncpy(message, "bulk load aborted", size);
+        return 1;
+      },
+      &infile);
+
+    // the file name is not opened, the rows come from the handler above
+    std::string columns;
+    for (const auto& column : m_columns) {
+      columns += (columns.empty() ? "" : ", ") + column;
+    }
+    std::string sql = "LOAD DATA LOCAL INFILE 'bulk-load' INTO TABLE " + m_table +
+                      " CHARACTER SET utf8 (" + columns + ")";
+
+    int result = mysql_real_query(m_mysql, sql.c_str(), sql.size());
+    mysql_set_local_infile_default(m_mysql);
+    if (result != 0) {
+      throw std::runtime_error(std::string("cannot load the names: ") + mysql_error(m_mysql));
+    }
+  }
+
+  /**
+   * Publish the loaded names as sync updates of a new session of the catalog, then serve them.
+   * The session is named like the ones of the catalog, so that the other catalogs load its
+   * snapshot and reconcile with it
+   */
+  void
+  announce()
+  {
+    Face face;
+    KeyChain keyChain;
+    Name session = Name(m_prefix).append("sync")
+                     .append(::atmos::util::CatalogAdapter::computeCatalogId(keyChain,
+                                                                             m_signingId));
+    chronosync::Socket socket(m_syncPrefix, session, face,
+                              [] (const std::vector<chronosync::MissingDataInfo>&) {},
+                              m_signingId);
+
+    // the updates are as large as a Data packet allows, so all of them are announced together
+    Json::FastWriter writer;
+    Json::Value update;
+    size_t updateSize = 0;
+    uint64_t nUpdates = 0;
+    auto publish = [&] {
+      std::string payload = writer.write(update);
+      socket.publishData(reinterpret_cast<const uint8_t*>(payload.data()), payload.size(),
+                         time::seconds(3600));
+      update.clear();
+      updateSize = 0;
+      ++nUpdates;
+    };
+
+    std::vector<::atmos::util::ValueRef> fields;
+    for (const char* begin = m_file->begin(); begin != m_file->end(); ) {
+      const char* next = lineEnd(begin, m_file->end());
+      ::atmos::util::ValueRef name = trimLine(begin, next);
+      begin = next;
+      fields.clear();
+      if (name.size == 0 || !::atmos::util::splitName(name, m_nameFields.size(), fields)) {
+        continue;
+      }
+
+      // the quotes and the comma around the name
+      if (updateSize + name.size + 3 > MAX_UPDATE_SIZE && updateSize > 0) {
+        publish();
+      }
+      update["add"].append(std::string(name.data, name.size));
+      updateSize += name.size + 3;
+    }
+    if (updateSize > 0) {
+      publish();
+    }
+
+    std::cout << "announced " << nUpdates << " updates under " << session
+              << ", serving them for " << m_announceTime << " seconds" << std::endl;
+    face.processEvents(time::seconds(m_announceTime));
+  }
+
+public:
+  std::string m_nameFile;
+  std::string m_configFile;
+  bool m_isEmbedded;
+  size_t m_nThreads;
+  int m_announceTime;
+
+private:
+  Name m_prefix;
+  std::vector<std::string> m_nameFields;
+  std::string m_table;
+  std::vector<std::string> m_columns;
+  std::string m_dbServer;
+  unsigned int m_dbPort;
+  std::string m_dbName;
+  std::string m_dbUser;
+  std::string m_dbPasswd;
+  std::string m_dbFile;
+  Name m_signingId;
+  Name m_syncPrefix;
+
+  std::unique_ptr<MappedFile> m_file;
+  MYSQL* m_mysql;
+  std::unique_ptr<::atmos::util::SqliteDatabase> m_sqlite;
+
+  uint64_t m_nLoaded;
+  // updated once the threads of a block are joined
+  uint64_t m_nMalformed;
+};
+
+}
+}
+
+int
+main(int argc, char** argv)
+{
+  ndn::atmos::BulkLoader loader;
+  const char* programName = argv[0];
+  int option;
+
+  while ((option = getopt(argc, argv, "f:c:ej:a:h")) != -1) {
+    switch (option) {
+      case 'f':
+        loader.m_nameFile = optarg;
+        break;
+      case 'c':
+        loader.m_configFile = optarg;
+        break;
+      case 'e':
+        loader.m_isEmbedded = true;
+        break;
+      case 'j': {
+        // atoi gives 0 for what is not a number, and a negative count would wrap around
+        int nThreads = atoi(optarg);
+        if (nThreads <= 0) {
+          std::cerr << "ERROR: the number of threads must be positive" << std::endl;
+          usage(programName);
+          return 1;
+        }
+        loader.m_nThreads = nThreads;
+        break;
+      }
+      case 'a':
+        loader.m_announceTime = atoi(optarg);
+        break;
+      case 'h':
+      default:
+        usage(programName);
+        return 0;
+    }
+  }
+
+  argc -= optind;
+  argv += optind;
+  if (argc != 0 || loader.m_nameFile.empty()) {
+    usage(programName);
+    return 1;
+  }
+
+  try {
+    loader.run();
+  }
+  catch (const std::exception& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,230 @@
+/** NDN-Atmos: Cataloging Service for distributed data originally developed
+ *  for atmospheric science data
+ *  Copyright (C) 2015 Colorado State University
+ *
+ *  NDN-Atmos is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  NDN-Atmos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with NDN-Atmos.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "util/query-trace.hpp"
+
+#include <ndn-cxx/face.hpp>
+#include <ndn-cxx/util/scheduler.hpp>
+
+#include <iostream>
+#include <map>
+#include <getopt.h>
+#include <stdlib.h>
+
+void
+usage(const char *fileName)
+{
+  std::cout << "\n Usage:\n " << fileName <<
+    " [-h] -f trace file [-c catalogPrefix] [-s speed]\n"
+    "   [-f trace file]      - set the query trace recorded by the catalog\n"
+    "   [-c catalogPrefix]   - replay against this catalog prefix instead of the recorded one\n"
+    "   [-s speed]           - replay speed, e.g., 1 or 10; 0 replays as fast as possible\n"
+    "   [-h]                 - print help and exit\n"
+    "\n";
+}
+
+namespace ndn {
+namespace atmos {
+
+/**
+ * QueryReplayer re-issues the query Interests recorded in a query trace, keeping the recorded
+ * inter-arrival times scaled by the replay speed
+ */
+class QueryReplayer : noncopyable
+{
+public:
+  QueryReplayer()
+    : m_speed(1)
+    , m_scheduler(m_face.getIoService())
+    , m_traceStart(0)
+    , m_nSent(0)
+    , m_nData(0)
+    , m_nTimeouts(0)
+    , m_nUnknownVersions(0)
+    , m_totalLatency(0)
+  {
+  }
+
+  void
+  run()
+  {
+    m_trace.reset(new ::atmos::util::QueryTraceReader(m_traceFile));
+    m_replayStart = time::steady_clock::now();
+    scheduleNext();
+    m_face.processEvents();
+
+    std::cout << "sent " << m_nSent << ", data " << m_nData
+              << ", timeouts " << m_nTimeouts
+              << ", segments sent before their version was known " << m_nUnknownVersions;
+    if (m_nData > 0) {
+      std::cout << ", mean latency "
+                << time::duration_cast<time::milliseconds>(m_totalLatency / m_nData);
+    }
+    std::cout << std::endl;
+  }
+
+private:
+  void
+  scheduleNext()
+  {
+    ::atmos::util::QueryTraceRecord record;
+    if (!m_trace->next(record)) {
+      return;
+    }
+
+    if (m_nSent == 0) {
+      m_traceStart = record.timestamp;
+    }
+
+    time::nanoseconds delay(0);
+    if (m_speed > 0 && record.timestamp > m_traceStart) {
+      time::microseconds offset(static_cast<int64_t>((record.timestamp - m_traceStart) / m_speed));
+      delay = (m_replayStart + offset) - time::steady_clock::now();
+      if (delay < time::nanoseconds::zero()) {
+        delay = time::nanoseconds::zero();
+      }
+    }
+
+    m_scheduler.scheduleEvent(delay, bind(&QueryReplayer::sendQuery, this, record));
+  }
+
+  void
+  sendQuery(const ::atmos::util::QueryTraceRecord& record)
+  {
+    Name query = rewritePrefix(record.query);
+    Name interestName(query);
+
+    if (record.hasSegmentNo) {
+      // segments are named after the version of the catalog that generated them, so use the
+      // version that the test catalog returned for the same query
+      auto version = m_versions.find(query);
+      if (version != m_versions.end()) {
+        interestName.append(version->second).appendSegment(record.segmentNo);
+      }
+      else {
+        ++m_nUnknownVersions;
+      }
+    }
+
+    Interest interest(interestName);
+    interest.setInterestLifetime(time::milliseconds(4000));
+    interest.setMustBeFresh(true);
+
+    m_face.expressInterest(interest,
+                           bind(&QueryReplayer::onData, this, _1, _2, query,
+                                time::steady_clock::now()),
+                           bind(&QueryReplayer::onTimeout, this, _1));
+    ++m_nSent;
+
+    scheduleNext();
+  }
+
+  void
+  onData(const Interest& interest, const Data& data, const Name& query,
+         const time::steady_clock::TimePoint& sentTime)
+  {
+    ++m_nData;
+    m_totalLatency += time::steady_clock::now() - sentTime;
+
+    // data name is /<prefix>/query/<json-query>/<version>/<segment>
+    if (data.getName().size() > query.size()) {
+      m_versions[query] = data.getName()[query.size()];
+    }
+  }
+
+  void
+  onTimeout(const Interest& interest)
+  {
+    ++m_nTimeouts;
+  }
+
+  Name
+  rewritePrefix(const Name& query)
+  {
+    // recorded query is /<prefix>/query/<json-query>
+    if (m_catalogPrefix.empty() || query.size() < 2) {
+      return query;
+    }
+    return Name(m_catalogPrefix).append(query.getSubName(query.size() - 2));
+  }
+
+public:
+  std::string m_traceFile;
+  Name m_catalogPrefix;
+  double m_speed;
+
+private:
+  Face m_face;
+  util::scheduler::Scheduler m_scheduler;
+  std::unique_ptr<::atmos::util::QueryTraceReader> m_trace;
+  std::map<Name, name::Component> m_versions;
+
+  uint64_t m_traceStart;
+  time::steady_clock::TimePoint m_replayStart;
+
+  uint64_t m_nSent;
+  uint64_t m_nData;
+  uint64_t m_nTimeouts;
+  uint64_t m_nUnknownVersions;
+  time::nanoseconds m_totalLatency;
+};
+
+}
+}
+
+int
+main(int argc, char** argv)
+{
+  ndn::atmos::QueryReplayer replayer;
+  const char* programName = argv[0];
+  int option;
+
+  while ((option = getopt(argc, argv, "f:c:s:h")) != -1) {
+    switch (option) {
+      case 'f':
+        replayer.m_traceFile = optarg;
+        break;
+      case 'c':
+        replayer.m_catalogPrefix = ndn::Name(optarg);
+        break;
+      case 's':
+        replayer.m_speed = atof(optarg);
+        break;
+      case 'h':
+      default:
+        usage(programName);
+        return 0;
+    }
+  }
+
+  argc -= optind;
+  argv += optind;
+  if (argc != 0 || replayer.m_traceFile.empty() || replayer.m_speed < 0) {
+    usage(programName);
+    return 1;
+  }
+
+  try {
+    replayer.run();
+  }
+  catch (const std::exception& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}